@@ -1,13 +1,16 @@
 #include "LesionSegmentationCLI.h"
 #include "itkLesionSegmentationImageFilter8.h"
 #include "itkImageFileReader.h"
+#include "itkMemoryMappedMetaImageReader.h"
 #include "itkImageFileWriter.h"
+#include "itkChunkedCompressionMetaImageWriter.h"
+#include "itkRunLengthSegmentationFileWriter.h"
 #include "LesionSegmentationCLI.h"
 #include "itkGDCMImageIO.h"
 #include "itkGDCMImageIOFactory.h"
-#include "itkGDCMSeriesFileNames.h"
 #include "itkMetaImageIOFactory.h"
-#include "itkImageSeriesReader.h"
+#include "itkDICOMSeriesRegionReader.h"
+#include "itkDICOMSeriesIndex.h"
 #include "itkLesionSegmentationCommandLineProgressReporter.h"
 #include "itkEventObject.h"
 #include "itkImageToVTKImageFilter.h"
@@ -68,28 +71,31 @@ protected:
 
 
 // --------------------------------------------------------------------------
-InputImageType::Pointer GetImage( std::string dir, bool ignoreDirection )
-{
-  const unsigned int Dimension = ImageDimension;
-  typedef itk::Image< PixelType, Dimension >         ImageType;
-
-  typedef itk::ImageSeriesReader< ImageType >        ReaderType;
-  ReaderType::Pointer reader = ReaderType::New();
+// Number of slices read on each side of the ROI, for the B-spline
+// coefficients of the isotropic resampling (the HaloRadius of
+// itk::IsotropicResamplerImageFilter).
+const unsigned int ResamplingHaloSlices = 8;
 
-  typedef itk::GDCMImageIO       ImageIOType;
-  ImageIOType::Pointer dicomIO = ImageIOType::New();
+typedef itk::DICOMSeriesRegionReader< InputImageType > SeriesReaderType;
+typedef itk::DICOMSeriesIndex< InputImageType > SeriesIndexType;
 
-  reader->SetImageIO( dicomIO );
 
-  typedef itk::GDCMSeriesFileNames NamesGeneratorType;
-  NamesGeneratorType::Pointer nameGenerator = NamesGeneratorType::New();
+// --------------------------------------------------------------------------
+// Sorts the files of the first series of the directory by slice position.
+// Only the headers of the files are read, no slice is decoded yet. The
+// series and sorted files are taken from the index file of the directory
+// when it is up to date.
+SeriesReaderType::Pointer GetSeriesReader( std::string dir )
+{
+  SeriesIndexType::Pointer seriesIndex = SeriesIndexType::New();
 
-  nameGenerator->SetUseSeriesDetails( true );
-  nameGenerator->AddSeriesRestriction("0008|0021" );
-  nameGenerator->SetDirectory( dir );
+  seriesIndex->SetDirectory( dir );
+  seriesIndex->AddSeriesRestriction("0008|0021" );
 
   try
     {
+    seriesIndex->Update();
+
     std::cout << std::endl << "The directory: " << std::endl;
     std::cout << std::endl << dir << std::endl << std::endl;
     std::cout << "Contains the following DICOM Series: ";
@@ -97,7 +103,7 @@ InputImageType::Pointer GetImage( std::string dir, bool ignoreDirection )
 
     typedef std::vector< std::string >    SeriesIdContainer;
 
-    const SeriesIdContainer & seriesUID = nameGenerator->GetSeriesUIDs();
+    const SeriesIdContainer & seriesUID = seriesIndex->GetSeriesUIDs();
 
     SeriesIdContainer::const_iterator seriesItr = seriesUID.begin();
     SeriesIdContainer::const_iterator seriesEnd = seriesUID.end();
@@ -107,6 +113,10 @@ InputImageType::Pointer GetImage( std::string dir, bool ignoreDirection )
       seriesItr++;
       }
 
+    if (seriesUID.empty())
+      {
+      return NULL;
+      }
 
     std::string seriesIdentifier;
     seriesIdentifier = seriesUID.begin()->c_str();
@@ -118,13 +128,12 @@ InputImageType::Pointer GetImage( std::string dir, bool ignoreDirection )
     std::cout << std::endl << std::endl;
 
 
-    typedef std::vector< std::string >   FileNamesContainer;
-    FileNamesContainer fileNames;
+    SeriesReaderType::Pointer reader = seriesIndex->GetSeriesReader( seriesIdentifier );
 
-    fileNames = nameGenerator->GetFileNames( seriesIdentifier );
+    const SeriesReaderType::FileNamesContainer & fileNames = reader->GetSortedFileNames();
 
-    FileNamesContainer::const_iterator  fitr = fileNames.begin();
-    FileNamesContainer::const_iterator  fend = fileNames.end();
+    SeriesReaderType::FileNamesContainer::const_iterator  fitr = fileNames.begin();
+    SeriesReaderType::FileNamesContainer::const_iterator  fend = fileNames.end();
 
     while( fitr != fend )
       {
@@ -132,33 +141,55 @@ InputImageType::Pointer GetImage( std::string dir, bool ignoreDirection )
       ++fitr;
       }
 
+    return reader;
+    }
+  catch (itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    return NULL;
+    }
 
-    reader->SetFileNames( fileNames );
-
-    try
-      {
-      reader->Update();
-      }
-    catch (itk::ExceptionObject &ex)
-      {
-      std::cout << ex << std::endl;
-      return NULL;
-      }
+  return NULL;
+}
 
+// --------------------------------------------------------------------------
+// Image with the geometry of the series and no pixels, to map the seeds and
+// the ROI to indices before decoding the slices.
+InputImageType::Pointer GetImageGeometry( SeriesReaderType * reader, bool ignoreDirection )
+{
+  InputImageType::Pointer image = InputImageType::New();
+  image->CopyInformation( reader->GetOutput() );
+  image->SetRegions( reader->GetOutput()->GetLargestPossibleRegion() );
 
-    ImageType::Pointer image = reader->GetOutput();
-    ImageType::DirectionType direction;
+  if (ignoreDirection)
+    {
+    InputImageType::DirectionType direction;
     direction.SetIdentity();
-    image->DisconnectPipeline();
-    std::cout << "Image Direction:" << image->GetDirection() << std::endl;
+    image->SetDirection(direction);
+    }
+  return image;
+}
 
+// --------------------------------------------------------------------------
+// Decodes the slices that the region covers, with a halo of slices for the
+// resampling. The image keeps the indices of the whole series.
+InputImageType::Pointer GetImage( SeriesReaderType * reader,
+  InputImageType::RegionType region, bool ignoreDirection )
+{
+  InputImageType::SizeType halo;
+  halo.Fill(0);
+  halo[2] = ResamplingHaloSlices;
+  region.PadByRadius( halo );
+  region.Crop( reader->GetOutput()->GetLargestPossibleRegion() );
 
-    if (ignoreDirection)
-      {
-      std::cout << "Ignoring the direction of the DICOM image and using identity." << std::endl;
-      image->SetDirection(direction);
-      }
-    return image;
+  std::cout << "Decoding slices " << region.GetIndex()[2] << " to "
+            << region.GetIndex()[2] + region.GetSize()[2] - 1 << " of "
+            << reader->GetNumberOfSlices() << std::endl;
+
+  try
+    {
+    reader->GetOutput()->SetRequestedRegion( region );
+    reader->Update();
     }
   catch (itk::ExceptionObject &ex)
     {
@@ -166,7 +197,19 @@ InputImageType::Pointer GetImage( std::string dir, bool ignoreDirection )
     return NULL;
     }
 
-  return NULL;
+  InputImageType::Pointer image = reader->GetOutput();
+  InputImageType::DirectionType direction;
+  direction.SetIdentity();
+  image->DisconnectPipeline();
+  std::cout << "Image Direction:" << image->GetDirection() << std::endl;
+
+
+  if (ignoreDirection)
+    {
+    std::cout << "Ignoring the direction of the DICOM image and using identity." << std::endl;
+    image->SetDirection(direction);
+    }
+  return image;
 }
 
 // --------------------------------------------------------------------------
@@ -355,8 +398,11 @@ int main( int argc, char * argv[] )
 
   LesionSegmentationCLI args( argc, argv );
 
-  typedef itk::ImageFileReader< InputImageType > InputReaderType;
+  // Uncompressed MetaImage inputs are mapped in memory, so that only the
+  // pages of the ROI are read
+  typedef itk::MemoryMappedMetaImageReader< InputImageType > InputReaderType;
   typedef itk::ImageFileWriter< RealImageType > OutputWriterType;
+  typedef itk::RunLengthSegmentationFileWriter< ImageDimension > SegmentationWriterType;
   typedef itk::LesionSegmentationImageFilter8<
           InputImageType, RealImageType > SegmentationFilterType;
 
@@ -364,31 +410,36 @@ int main( int argc, char * argv[] )
   // Read the volume
   InputReaderType::Pointer reader = InputReaderType::New();
   InputImageType::Pointer image;
+  SeriesReaderType::Pointer seriesReader;
 
   std::cout << "Reading " << args.GetValueAsString("InputImage") << ".." << std::endl;
   if (!args.GetValueAsString("InputDICOMDir").empty())
     {
     std::cout << "Reading from DICOM dir " << args.GetValueAsString("InputDICOMDir") << ".." << std::endl;
-    image = GetImage(
-      args.GetValueAsString("InputDICOMDir"),
-      args.GetValueAsBool("IgnoreDirection"));
+    seriesReader = GetSeriesReader(args.GetValueAsString("InputDICOMDir"));
 
-    if (!image)
+    if (!seriesReader)
       {
       std::cerr << "Failed to read the input image" << std::endl;
       return EXIT_FAILURE;
       }
+
+    // Only the slices of the ROI are decoded, once it is known
+    image = GetImageGeometry(seriesReader, args.GetValueAsBool("IgnoreDirection"));
     }
 
   if (!args.GetValueAsString("InputImage").empty())
     {
+    seriesReader = NULL;
     reader->SetFileName(args.GetValueAsString("InputImage"));
     reader->Update();
     image = reader->GetOutput();
     }
 
-  // Set the image object on the args
+  // Set the image object on the args, and the headers of the slices for the
+  // seeds given by slice name
   args.SetImage( image );
+  args.SetSeriesReader( seriesReader );
 
 
   // Compute the ROI region
@@ -430,6 +481,24 @@ int main( int argc, char * argv[] )
    << " mm^3" << std::endl;
 
 
+  // Decode the slices of the DICOM series the segmentation needs, all of
+  // them for the visualization
+  if (seriesReader)
+    {
+    image = GetImage( seriesReader,
+      args.GetOptionWasSet("Visualize") ? image->GetLargestPossibleRegion() : roiRegion,
+      args.GetValueAsBool("IgnoreDirection"));
+
+    if (!image)
+      {
+      std::cerr << "Failed to read the input image" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    args.SetImage( image );
+    }
+
+
   // Write ROI if requested
   if (args.GetOptionWasSet("OutputROI"))
     {
@@ -439,9 +508,10 @@ int main( int argc, char * argv[] )
     ROIFilterType::Pointer roiFilter = ROIFilterType::New();
     roiFilter->SetRegionOfInterest( roiRegion );
 
-    typedef itk::ImageFileWriter< InputImageType > ROIWriterType;
+    typedef itk::ChunkedCompressionMetaImageWriter< InputImageType > ROIWriterType;
     ROIWriterType::Pointer roiWriter = ROIWriterType::New();
     roiWriter->SetFileName( args.GetValueAsString("OutputROI") );
+    roiWriter->SetUseCompression( args.GetValueAsBool("CompressOutputROI") );
     roiFilter->SetInput( image );
     roiWriter->SetInput( roiFilter->GetOutput() );
 
@@ -492,6 +562,22 @@ int main( int argc, char * argv[] )
     writer->Update();
     }
 
+  if (!args.GetValueAsString("OutputSegmentation").empty())
+    {
+    std::cout << "Writing the compact output segmentation "
+              << args.GetValueAsString("OutputSegmentation") << std::endl;
+    SegmentationWriterType::Pointer segmentationWriter = SegmentationWriterType::New();
+    segmentationWriter->SetFileName(args.GetValueAsString("OutputSegmentation"));
+    segmentationWriter->SetInput(seg->GetOutput());
+    if (args.GetOptionWasSet("OutputSegmentationBandWidth"))
+      {
+      const float bandWidth = args.GetValueAsFloat("OutputSegmentationBandWidth");
+      segmentationWriter->SetUseNarrowBand( bandWidth >= 0.0 );
+      segmentationWriter->SetNarrowBandWidth( bandWidth );
+      }
+    segmentationWriter->Update();
+    }
+
   // Compute volume
 
   typedef itk::ImageToVTKImageFilter< RealImageType > RealITKToVTKFilterType;
@@ -10,7 +10,9 @@
 #include "itkImageFileReader.h"
 #include "itkMetaDataDictionary.h"
 #include "itkMetaDataObject.h"
+#include "itkDICOMSeriesRegionReader.h"
 #include <vtksys/SystemTools.hxx>
+#include <cstdio>
 #include <fstream>
 #include <sys/types.h>
 #include <dirent.h>
@@ -30,17 +32,22 @@ class LesionSegmentationCLI : public MetaCommand
 public:
   typedef itk::LandmarkSpatialObject< 3 >    SeedSpatialObjectType;
   typedef SeedSpatialObjectType::PointListType   PointListType;
+  typedef itk::DICOMSeriesRegionReader< InputImageType > SeriesReaderType;
 
   LesionSegmentationCLI( int argc, char *argv[] ) : MetaCommand()
   {
     m_Image = NULL;
+    m_SeriesReader = NULL;
     this->DisableDeprecatedWarnings();
 
     this->AddArgument("InputImage",false,"Input image to be segmented.");
     this->AddArgument("InputDICOMDir",false,"DICOM directory containing series of the Input image to be segmented.");
     this->AddArgument("OutputImage", false, "Output segmented image");
+    this->AddArgument("OutputSegmentation", false, "Output segmentation in the compact run-length format (.rle filename expected). It holds the mask of the -0.5 iso-value and the level set values around the contour, in a fraction of the size of OutputImage. Its volume can be estimated without decoding it.");
+    this->AddArgument("OutputSegmentationBandWidth", false, "Largest distance to the iso-value of the level set values written in OutputSegmentation. All the values off the plateaus are written by default. A negative value writes a binary mask.", MetaCommand::FLOAT);
     this->AddArgument("OutputMesh", false, "Output segmented surface (STL filename expected)");
     this->AddArgument("OutputROI", false, "Write the ROI within which the segmentation will be confined to (for debugging purposes)");
+    this->AddArgument("CompressOutputROI", false, "Compress the OutputROI image, on several threads for MetaImage files. It is written uncompressed by default.", MetaCommand::BOOL, "0");
     this->AddArgument("Visualize", false, "Visualize the input image and the segmented surface.", MetaCommand::BOOL, "0");
     this->AddArgument("Wireframe", false, "Visualize the input image and the segmented surface as a wireframe. Only valid if the Visualize flag is also enabled.", MetaCommand::BOOL, "0");
     this->AddArgument("IgnoreDirection", false, "Ignore the direction of the DICOM image", MetaCommand::BOOL, "0");
@@ -140,9 +147,17 @@ public:
           {
           std::string substring =
             this->GetValueAsString("GetZSpacingFromSliceNameRegex");
-          std::vector< std::string > filesInDir =
-            this->GetFilesInDirectory(this->GetValueAsString("InputDICOMDir"));
           bool found = false;
+          if (this->m_SeriesReader)
+            {
+            found = this->GetZPositionFromSliceHeaders(substring, sz);
+            }
+          std::vector< std::string > filesInDir;
+          if (!found)
+            {
+            filesInDir =
+              this->GetFilesInDirectory(this->GetValueAsString("InputDICOMDir"));
+            }
           for (std::vector< std::string >::iterator it = filesInDir.begin();
               it != filesInDir.end(); ++it)
             {
@@ -209,11 +224,11 @@ public:
       pointSeed[2] = sz;
       IndexType indexSeed;
       m_Image->TransformPhysicalPointToIndex(pointSeed, indexSeed);
-      if (!this->m_Image->GetBufferedRegion().IsInside(indexSeed))
+      if (!this->m_Image->GetLargestPossibleRegion().IsInside(indexSeed))
         {
         std::cerr << "Seed with pixel units of index: " <<
             indexSeed << " does not lie within the image. The images extents are"
-          << this->m_Image->GetBufferedRegion() << std::endl;
+          << this->m_Image->GetLargestPossibleRegion() << std::endl;
         exit(-1);
         }      
 
@@ -227,6 +242,13 @@ public:
     this->m_Image = image;
     }
 
+  // Sorted slices of the DICOM series and their headers, to find the slice
+  // of a seed by name without reading the files of the directory.
+  void SetSeriesReader( const SeriesReaderType * reader )
+    {
+    this->m_SeriesReader = reader;
+    }
+
   typedef InputImageType::IndexType IndexType;
   typedef IndexType::IndexValueType IndexValueType;
 
@@ -281,8 +303,55 @@ protected:
 
 
 
+  // Same search as in GetSeeds, through the file names and then the SOP
+  // instance UIDs of the slices of the series, from their headers.
+  bool GetZPositionFromSliceHeaders( const std::string & substring, double & z )
+    {
+    const SeriesReaderType::FileNamesContainer & fileNames =
+      this->m_SeriesReader->GetSortedFileNames();
+
+    for (unsigned int pass = 0; pass < 2; ++pass)
+      {
+      for (unsigned int slice = 0; slice < fileNames.size(); ++slice)
+        {
+        const std::string name =
+          vtksys::SystemTools::GetFilenameName(fileNames[slice]);
+        if (name.find("vvi") != std::string::npos)
+          {
+          continue;
+          }
+
+        const itk::MetaDataDictionary & dict =
+          this->m_SeriesReader->GetSliceMetaDataDictionary(slice);
+        std::string sopInstanceUID;
+        itk::ExposeMetaData<std::string>( dict, "0008|0018", sopInstanceUID );
+
+        const std::string & matched = (pass == 0) ? name : sopInstanceUID;
+        if (matched.find(substring) == std::string::npos)
+          {
+          continue;
+          }
+
+        // Image position (patient), as the origin of the slice
+        std::string position;
+        itk::ExposeMetaData<std::string>( dict, "0020|0032", position );
+        double x, y;
+        if (sscanf(position.c_str(), "%lf\\%lf\\%lf", &x, &y, &z) != 3)
+          {
+          return false;
+          }
+
+        std::cout << "Found slice: " << fileNames[slice] << "\n  with SOPInstanceUID " << sopInstanceUID << "\n  matching string " << substring << std::endl;
+        return true;
+        }
+      }
+
+    return false;
+    }
+
   double ROI[6];
   InputImageType * m_Image;
+  const SeriesReaderType * m_SeriesReader;
 };
 
 #endif
@@ -1,10 +1,13 @@
 #include "LesionSegmentationQIBenchCLI.h"
 #include "itkLesionSegmentationImageFilter8.h"
 #include "itkImageFileReader.h"
+#include "itkMemoryMappedMetaImageReader.h"
 #include "itkImageFileWriter.h"
-#include "itkGDCMImageIO.h"
-#include "itkGDCMSeriesFileNames.h"
-#include "itkImageSeriesReader.h"
+#include "itkChunkedCompressionMetaImageWriter.h"
+#include "itkRunLengthSegmentationFileWriter.h"
+#include "itkDICOMSeriesRegionReader.h"
+#include "itkDICOMSeriesIndex.h"
+#include "itkMetaDataObject.h"
 #include "itkLesionSegmentationCommandLineProgressReporter.h"
 #include "itkEventObject.h"
 #include "itkImageToVTKImageFilter.h"
@@ -48,22 +51,22 @@ const std::string                                    SeriesRestriction = "0008|0
 const unsigned int                                   ImageDimension = 3;
 const float                                          ContourValue = -0.5;
 
+// Number of slices read on each side of the ROI, for the B-spline
+// coefficients of the isotropic resampling (the HaloRadius of
+// itk::IsotropicResamplerImageFilter).
+const unsigned int ResamplingHaloSlices = 8;
+
 typedef short                                        PixelType;
 typedef itk::Image< PixelType, ImageDimension >      InputImageType;
 typedef InputImageType                               ImageType;
 typedef itk::LandmarkSpatialObject< ImageDimension > LandmarkType;
 typedef LandmarkType::PointType                      PointType;
 typedef LandmarkType::PointListType                  PointListType;
-typedef itk::ImageSeriesReader< ImageType >          ReaderType;
+typedef itk::DICOMSeriesRegionReader< ImageType >    SeriesReaderType;
 typedef itk::Image< float, ImageDimension >          RealImageType;
-typedef itk::GDCMImageIO                             ImageIOType;
-typedef itk::GDCMSeriesFileNames                     NamesGeneratorType;
+typedef itk::DICOMSeriesIndex< ImageType >           SeriesIndexType;
 typedef std::vector< std::string >                   SeriesIdContainer;
-typedef std::vector< std::string >                   FileNamesContainer;
 typedef std::vector< std::string >                   UIDStorageVector;
-typedef itk::MetaDataObject< std::string >           MetaDataStringType;
-typedef const MetaDataStringType*                    MetaDataStringConstPointer;
-typedef const itk::MetaDataObjectBase*               MetaDataUncastedPointer;
 
 
 // --------------------------------------------------------------------------
@@ -130,31 +133,44 @@ public:
   UIDStorageVector sopInstanceUIDVector;
 
   InputImageType::Pointer image;
+
+  SeriesReaderType::Pointer seriesReader;
 };
 
 // --------------------------------------------------------------------------
-ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDirection )
+std::string GetTagValue( const itk::MetaDataDictionary & dict, const std::string & tag )
 {
+  std::string value;
+  itk::ExposeMetaData< std::string >( dict, tag, value );
+  return value;
+}
 
-  ReaderType::Pointer reader = ReaderType::New();
-  ImageIOType::Pointer dicomIO = ImageIOType::New();
+// --------------------------------------------------------------------------
+// Sorts the files of the first series of the directory by slice position
+// and gathers the meta data, reading only the headers of the files. The
+// series, sorted files and headers are taken from the index file of the
+// directory when it is up to date. The image has the geometry of the series
+// and no pixels until ReadSlices().
+ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDirection )
+{
 
-  reader->SetImageIO( dicomIO );
+  SeriesReaderType::Pointer reader;
 
-  NamesGeneratorType::Pointer nameGenerator = NamesGeneratorType::New();
+  SeriesIndexType::Pointer seriesIndex = SeriesIndexType::New();
 
-  nameGenerator->SetUseSeriesDetails( true );
-  nameGenerator->AddSeriesRestriction( SeriesRestriction );
-  nameGenerator->SetDirectory( dir );
+  seriesIndex->SetDirectory( dir );
+  seriesIndex->AddSeriesRestriction( SeriesRestriction );
 
   try
     {
+    seriesIndex->Update();
+
     std::cout << std::endl << "The directory: " << std::endl;
     std::cout << std::endl << dir << std::endl << std::endl;
     std::cout << "Contains the following DICOM Series: ";
     std::cout << std::endl << std::endl;
 
-    const SeriesIdContainer & seriesUID = nameGenerator->GetSeriesUIDs();
+    const SeriesIdContainer & seriesUID = seriesIndex->GetSeriesUIDs();
 
     SeriesIdContainer::const_iterator seriesItr = seriesUID.begin();
     SeriesIdContainer::const_iterator seriesEnd = seriesUID.end();
@@ -164,6 +180,11 @@ ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDire
       seriesItr++;
       }
 
+    if( seriesUID.empty() )
+      {
+      return NULL;
+      }
+
     std::string seriesIdentifier;
     seriesIdentifier = seriesUID.begin()->c_str();
 
@@ -172,61 +193,41 @@ ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDire
     std::cout << seriesIdentifier << std::endl;
     std::cout << std::endl << std::endl;
 
-    FileNamesContainer fileNames;
-
-    fileNames = nameGenerator->GetFileNames( seriesIdentifier );
-    reader->SetFileNames( fileNames );
-
     try
       {
-      reader->Update();
+      reader = seriesIndex->GetSeriesReader( seriesIdentifier );
       }
     catch (itk::ExceptionObject &ex)
       {
       std::cout << ex << std::endl;
       return NULL;
       }
-    
-    ReaderType::DictionaryArrayRawPointer dictOfDicts =
-      reader->GetMetaDataDictionaryArray();
+
     UIDStorageVector sopClassUIDVector;
-    sopClassUIDVector.reserve(dictOfDicts->size());
+    sopClassUIDVector.reserve(reader->GetNumberOfSlices());
     UIDStorageVector sopInstanceUIDVector;
-    sopInstanceUIDVector.reserve(dictOfDicts->size());
-    ReaderType::DictionaryArrayType::const_iterator itr;
-    for( itr = dictOfDicts->begin(); itr != dictOfDicts->end(); ++itr )
+    sopInstanceUIDVector.reserve(reader->GetNumberOfSlices());
+    for( unsigned int slice = 0; slice < reader->GetNumberOfSlices(); ++slice )
       {
-      ReaderType::DictionaryRawPointer dict = *itr;
-
-      MetaDataUncastedPointer sopClassUIDBase = dict->Get(SOPClassUIDTag);
-      MetaDataUncastedPointer sopInstanceUIDBase = dict->Get(SOPInstanceUIDTag);
+      const itk::MetaDataDictionary & dict = reader->GetSliceMetaDataDictionary( slice );
 
-      MetaDataStringConstPointer elClassUID;
-      MetaDataStringConstPointer elInstanceUID;
-      elClassUID = dynamic_cast<MetaDataStringConstPointer>(sopClassUIDBase);
-      elInstanceUID = dynamic_cast<MetaDataStringConstPointer>(sopInstanceUIDBase);
-
-      if( elClassUID )
+      if( dict.HasKey( SOPClassUIDTag ) )
         {
-        sopClassUIDVector.push_back(elClassUID->GetMetaDataObjectValue());
+        sopClassUIDVector.push_back( GetTagValue( dict, SOPClassUIDTag ) );
         }
-      if( elInstanceUID )
+      if( dict.HasKey( SOPInstanceUIDTag ) )
         {
-        sopInstanceUIDVector.push_back(elInstanceUID->GetMetaDataObjectValue());
+        sopInstanceUIDVector.push_back( GetTagValue( dict, SOPInstanceUIDTag ) );
         }
       }
 
-    std::string patientName;
-    std::string patientId;
-    std::string patientSex;
-    std::string studyInstanceUID;
-    std::string seriesInstanceUID;
-    
-    dicomIO->GetValueFromTag( PatientNameTag, patientName );
-    dicomIO->GetValueFromTag( PatientIdTag, patientName );
-    dicomIO->GetValueFromTag( PatientSexTag, patientSex );
-    dicomIO->GetValueFromTag( StudyInstanceUIDTag, studyInstanceUID );
-    dicomIO->GetValueFromTag( SeriesInstanceUIDTag, seriesInstanceUID );
+    const itk::MetaDataDictionary & dict = reader->GetSliceMetaDataDictionary( 0 );
+
+    std::string patientName = GetTagValue( dict, PatientNameTag );
+    std::string patientId = GetTagValue( dict, PatientIdTag );
+    std::string patientSex = GetTagValue( dict, PatientSexTag );
+    std::string studyInstanceUID = GetTagValue( dict, StudyInstanceUIDTag );
+    std::string seriesInstanceUID = GetTagValue( dict, SeriesInstanceUIDTag );
 
     std::cout << "Patient Name: " << patientName << std::endl
               << "Patient ID: " << patientId << std::endl
@@ -234,10 +235,11 @@ ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDire
               << "Study Instance UID: " << studyInstanceUID << std::endl
               << "Series Instance UID: " << seriesInstanceUID << std::endl;
 
-    ImageType::Pointer image = reader->GetOutput();
+    ImageType::Pointer image = ImageType::New();
+    image->CopyInformation( reader->GetOutput() );
+    image->SetRegions( reader->GetOutput()->GetLargestPossibleRegion() );
     ImageType::DirectionType direction;
     direction.SetIdentity();
-    image->DisconnectPipeline();
 
     if (ignoreDirection)
       {
@@ -254,6 +256,7 @@ ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDire
                                             sopClassUIDVector,
                                             sopInstanceUIDVector,
                                             image );
+    output->seriesReader = reader;
     return output;
     }
   catch (itk::ExceptionObject &ex)
@@ -265,6 +268,49 @@ ImageAndMetaDataContainer* GetImageAndMetaData( std::string dir, bool ignoreDire
   return NULL;
 }
 
+// --------------------------------------------------------------------------
+// Decodes the slices that the region covers, with a halo of slices for the
+// resampling. The image keeps the indices of the whole series.
+bool ReadSlices( ImageAndMetaDataContainer* data,
+                 ImageType::RegionType region, bool ignoreDirection )
+{
+  SeriesReaderType * reader = data->seriesReader;
+
+  ImageType::SizeType halo;
+  halo.Fill(0);
+  halo[2] = ResamplingHaloSlices;
+  region.PadByRadius( halo );
+  region.Crop( reader->GetOutput()->GetLargestPossibleRegion() );
+
+  std::cout << "Decoding slices " << region.GetIndex()[2] << " to "
+            << region.GetIndex()[2] + region.GetSize()[2] - 1 << " of "
+            << reader->GetNumberOfSlices() << std::endl;
+
+  try
+    {
+    reader->GetOutput()->SetRequestedRegion( region );
+    reader->Update();
+    }
+  catch (itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    return false;
+    }
+
+  ImageType::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+
+  if (ignoreDirection)
+    {
+    ImageType::DirectionType direction;
+    direction.SetIdentity();
+    image->SetDirection(direction);
+    }
+
+  data->image = image;
+  return true;
+}
+
 // --------------------------------------------------------------------------
 int ViewImageAndSegmentationSurface(
     InputImageType::Pointer image, vtkPolyData *pd, LesionSegmentationQIBenchCLI &args )
@@ -403,8 +449,12 @@ int main( int argc, char * argv[] )
 {
   LesionSegmentationQIBenchCLI args( argc, argv );
 
-  typedef itk::ImageFileReader< InputImageType >    InputReaderType;
+  // Uncompressed MetaImage inputs are mapped in memory, so that only the
+  // pages of the ROI are read
+  typedef itk::MemoryMappedMetaImageReader< InputImageType > InputReaderType;
   typedef itk::ImageFileWriter< RealImageType >     OutputWriterType;
+  typedef itk::RunLengthSegmentationFileWriter<
+          ImageDimension >                          SegmentationWriterType;
   typedef itk::ImageToAIMXMLFilter<
           RealImageType, InputImageType >           AIMFilterType;
   typedef itk::LesionSegmentationImageFilter8<
@@ -422,17 +472,15 @@ int main( int argc, char * argv[] )
     data = GetImageAndMetaData(
       args.GetValueAsString("InputDICOMDir"),
       args.GetValueAsBool("IgnoreDirection"));
-    image = data->image;
 
-    if (!image)
+    if (!data)
       {
       std::cerr << "Failed to read the input image" << std::endl;
-      if(data)
-        {
-        delete data;
-        }
       return EXIT_FAILURE;
       }
+
+    // Only the slices of the ROI are decoded, once it is known
+    image = data->image;
     }
 
   if (!args.GetValueAsString("InputImage").empty())
@@ -500,6 +548,22 @@ int main( int argc, char * argv[] )
             << roiRegion << std::endl;
 
 
+  // Decode the slices of the DICOM series the segmentation needs, all of
+  // them for the visualization
+  if( data && args.GetValueAsString("InputImage").empty() )
+    {
+    if( !ReadSlices( data,
+          args.GetOptionWasSet("Visualize") ? image->GetLargestPossibleRegion() : roiRegion,
+          args.GetValueAsBool("IgnoreDirection") ) )
+      {
+      std::cerr << "Failed to read the input image" << std::endl;
+      delete data;
+      return EXIT_FAILURE;
+      }
+    image = data->image;
+    }
+
+
   // Write ROI if requested
   if (args.GetOptionWasSet("OutputROI"))
     {
@@ -509,9 +573,10 @@ int main( int argc, char * argv[] )
     ROIFilterType::Pointer roiFilter = ROIFilterType::New();
     roiFilter->SetRegionOfInterest( roiRegion );
 
-    typedef itk::ImageFileWriter< InputImageType > ROIWriterType;
+    typedef itk::ChunkedCompressionMetaImageWriter< InputImageType > ROIWriterType;
     ROIWriterType::Pointer roiWriter = ROIWriterType::New();
     roiWriter->SetFileName( args.GetValueAsString("OutputROI") );
+    roiWriter->SetUseCompression( args.GetValueAsBool("CompressOutputROI") );
     roiFilter->SetInput( image );
     roiWriter->SetInput( roiFilter->GetOutput() );
 
@@ -614,6 +679,23 @@ int main( int argc, char * argv[] )
     writer->Update();
     }
 
+  if (!args.GetValueAsString("OutputSegmentation").empty())
+    {
+    std::cout << "Writing the compact output segmentation "
+              << args.GetValueAsString("OutputSegmentation") << std::endl;
+    SegmentationWriterType::Pointer segmentationWriter = SegmentationWriterType::New();
+    segmentationWriter->SetFileName(args.GetValueAsString("OutputSegmentation"));
+    segmentationWriter->SetInput(seg->GetOutput());
+    segmentationWriter->SetIsoValue( ContourValue );
+    if (args.GetOptionWasSet("OutputSegmentationBandWidth"))
+      {
+      const float bandWidth = args.GetValueAsFloat("OutputSegmentationBandWidth");
+      segmentationWriter->SetUseNarrowBand( bandWidth >= 0.0 );
+      segmentationWriter->SetNarrowBandWidth( bandWidth );
+      }
+    segmentationWriter->Update();
+    }
+
   if (!args.GetValueAsString("OutputAIM").empty())
     {
     std::cout << "Writing the output segmented level set in AIM XML format. "
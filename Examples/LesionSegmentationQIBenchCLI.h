@@ -22,10 +22,13 @@ public:
     this->AddArgument("InputImage",false,"Input image to be segmented.");
     this->AddArgument("InputDICOMDir",false,"DICOM directory containing series of the Input image to be segmented.");
     this->AddArgument("OutputImage", false, "Output segmented image");
+    this->AddArgument("OutputSegmentation", false, "Output segmentation in the compact run-length format (.rle filename expected). It holds the mask of the -0.5 iso-value and the level set values around the contour, in a fraction of the size of OutputImage. Its volume can be estimated without decoding it.");
+    this->AddArgument("OutputSegmentationBandWidth", false, "Largest distance to the iso-value of the level set values written in OutputSegmentation. All the values off the plateaus are written by default. A negative value writes a binary mask.", MetaCommand::FLOAT);
     this->AddArgument("OutputAIM", false, 
                       "Output segmented image in AIM format");
     this->AddArgument("OutputMesh", true, "Output segmented surface (STL filename expected)");
     this->AddArgument("OutputROI", false, "Write the ROI within which the segmentation will be confined to (for debugging purposes)");
+    this->AddArgument("CompressOutputROI", false, "Compress the OutputROI image, on several threads for MetaImage files. It is written uncompressed by default.", MetaCommand::BOOL, "0");
     this->AddArgument("Visualize", false, "Visualize the input image and the segmented surface.", MetaCommand::BOOL, "0");
     this->AddArgument("Wireframe", false, "Visualize the input image and the segmented surface as a wireframe. Only valid if the Visualize flag is also enabled.", MetaCommand::BOOL, "0");
     this->AddArgument("IgnoreDirection", false, "Ignore the direction of the DICOM image", MetaCommand::BOOL, "0");
@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBucketQueueFastMarchingImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBucketQueueFastMarchingImageFilter_h
+#define __itkBucketQueueFastMarchingImageFilter_h
+
+#include "itkImage.h"
+#include "itkImageToImageFilter.h"
+#include "itkLevelSet.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class BucketQueueFastMarchingImageFilter
+ *
+ * \brief Fast marching solver ordered by a bucketed priority queue.
+ *
+ * Solves the same Eikonal equation, with the same first order upwind update
+ * and the same trial point initialization, as FastMarchingImageFilter. The
+ * input image is the speed, the output the arrival time.
+ *
+ * The binary heap of FastMarchingImageFilter is replaced by an array of
+ * buckets of width BucketWidth over the arrival times. Pushing and popping
+ * a point are constant time, and points are popped in arbitrary order
+ * within a bucket, which bounds the error on the arrival times by the
+ * bucket width. A trial point whose value decreases is moved between
+ * buckets instead of being pushed again, so the queue holds no stale
+ * entries.
+ *
+ * The points are addressed by their linear offset in a working buffer
+ * padded by one pixel on each side, which removes the bounds checks from
+ * the neighbor visits. The state of each point is kept in compact arrays
+ * of status bytes, arrival times, squared inverse speeds and positions in
+ * the buckets.
+ *
+ * Pixels of null or negative speed are never reached. Points with a value
+ * above the stopping value are left as trial points and never queued.
+ *
+ * \ingroup LevelSetSegmentation
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TLevelSet, class TSpeedImage = Image< float, TLevelSet::ImageDimension > >
+class ITK_EXPORT BucketQueueFastMarchingImageFilter :
+    public ImageToImageFilter< TSpeedImage, TLevelSet >
+{
+public:
+  /** Standard class typedefs. */
+  typedef BucketQueueFastMarchingImageFilter              Self;
+  typedef ImageToImageFilter< TSpeedImage, TLevelSet >    Superclass;
+  typedef SmartPointer<Self>                              Pointer;
+  typedef SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BucketQueueFastMarchingImageFilter, ImageToImageFilter);
+
+  /** Dimension of the level set. */
+  itkStaticConstMacro(SetDimension, unsigned int, TLevelSet::ImageDimension);
+
+  /** Same node types as FastMarchingImageFilter. */
+  typedef LevelSetTypeDefault< TLevelSet >                LevelSetType;
+  typedef typename LevelSetType::LevelSetImageType        LevelSetImageType;
+  typedef typename LevelSetType::PixelType                PixelType;
+  typedef typename LevelSetType::NodeType                 NodeType;
+  typedef typename LevelSetType::NodeContainer            NodeContainer;
+  typedef typename LevelSetType::NodeContainerPointer     NodeContainerPointer;
+
+  typedef TSpeedImage                                     SpeedImageType;
+  typedef typename SpeedImageType::ConstPointer           SpeedImageConstPointer;
+
+  typedef typename LevelSetImageType::IndexType           IndexType;
+  typedef typename LevelSetImageType::RegionType          RegionType;
+  typedef typename LevelSetImageType::OffsetValueType     OffsetValueType;
+
+  /** Points from which the front starts, with their initial arrival
+   * time. */
+  void SetTrialPoints( NodeContainer * points )
+    {
+    this->m_TrialPoints = points;
+    this->Modified();
+    }
+  NodeContainerPointer GetTrialPoints()
+    { return this->m_TrialPoints; }
+
+  /** The propagation stops once every point below this value is alive. */
+  itkSetMacro( StoppingValue, double );
+  itkGetConstMacro( StoppingValue, double );
+
+  /** Width of the buckets, in units of arrival time. Zero, the default,
+   * picks half of h / ( F sqrt(N) ), the smallest time the front takes to
+   * reach a neighbor, with h the smallest spacing, F the largest speed and
+   * N the dimension. */
+  itkSetMacro( BucketWidth, double );
+  itkGetConstMacro( BucketWidth, double );
+
+  /** Value given to the pixels never reached by the front. */
+  itkGetConstMacro( LargeValue, PixelType );
+
+  /** Bounding box of the alive points after the last update. */
+  itkGetConstReferenceMacro( ReachedRegion, RegionType );
+
+  /** Number of points made alive by the last update. */
+  itkGetConstMacro( NumberOfProcessedPoints, SizeValueType );
+
+protected:
+  BucketQueueFastMarchingImageFilter();
+  ~BucketQueueFastMarchingImageFilter() {}
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The whole speed image is needed and the whole level set is
+   * produced. */
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion( DataObject * output );
+
+  void GenerateData();
+
+private:
+  BucketQueueFastMarchingImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  typedef unsigned char                     StatusType;
+  typedef unsigned int                      PositionType;
+  typedef std::vector< OffsetValueType >    BucketType;
+
+  enum { OutsidePoint = 0, FarPoint, TrialPoint, InitialTrialPoint, AlivePoint };
+
+  /** Copy the speed image in the padded buffer and set the statuses. */
+  void InitializeWorkingBuffers();
+
+  /** Padded offset of an index of the level set. */
+  OffsetValueType ComputePaddedOffset( const IndexType & index ) const;
+
+  /** Index of the level set of a padded offset. */
+  IndexType ComputeIndex( OffsetValueType offset ) const;
+
+  /** Upwind solution of the Eikonal equation at a point from its alive
+   * neighbors. Returns the large value when no neighbor is alive. */
+  double SolveEikonal( OffsetValueType offset ) const;
+
+  SizeValueType ComputeBucket( double value ) const;
+  void Enqueue( OffsetValueType offset );
+  void Dequeue( OffsetValueType offset );
+
+  /** Re-bucket the points of the last bucket once all the others are
+   * empty. */
+  void Rebase();
+
+  NodeContainerPointer         m_TrialPoints;
+  double                       m_StoppingValue;
+  double                       m_BucketWidth;
+  PixelType                    m_LargeValue;
+  RegionType                   m_ReachedRegion;
+  SizeValueType                m_NumberOfProcessedPoints;
+
+  /** Working buffers, padded by one pixel on each side. */
+  std::vector< StatusType >    m_Status;
+  std::vector< PixelType >     m_ArrivalTime;
+  std::vector< float >         m_InverseSquaredSpeed;
+  std::vector< PositionType >  m_Position;
+
+  OffsetValueType              m_Stride[SetDimension];
+  double                       m_InverseSquaredSpacing[SetDimension];
+  RegionType                   m_BufferRegion;
+
+  std::vector< BucketType >    m_Buckets;
+  SizeValueType                m_CurrentBucket;
+  double                       m_BucketOrigin;
+  double                       m_EffectiveBucketWidth;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBucketQueueFastMarchingImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,607 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBucketQueueFastMarchingImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBucketQueueFastMarchingImageFilter_hxx
+#define __itkBucketQueueFastMarchingImageFilter_hxx
+
+#include "itkBucketQueueFastMarchingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TLevelSet, class TSpeedImage>
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::BucketQueueFastMarchingImageFilter()
+{
+  this->m_TrialPoints = NULL;
+  this->m_LargeValue = static_cast< PixelType >( NumericTraits< PixelType >::max() / 2.0 );
+  this->m_StoppingValue = static_cast< double >( this->m_LargeValue );
+  this->m_BucketWidth = 0.0;
+  this->m_NumberOfProcessedPoints = 0;
+
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    this->m_Stride[d] = 0;
+    this->m_InverseSquaredSpacing[d] = 1.0;
+    }
+
+  this->m_CurrentBucket = 0;
+  this->m_BucketOrigin = 0.0;
+  this->m_EffectiveBucketWidth = 1.0;
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Trial points: " << this->m_TrialPoints.GetPointer() << std::endl;
+  os << indent << "Stopping value: " << this->m_StoppingValue << std::endl;
+  os << indent << "Bucket width: " << this->m_BucketWidth << std::endl;
+  os << indent << "Large value: " << this->m_LargeValue << std::endl;
+  os << indent << "Reached region: " << this->m_ReachedRegion << std::endl;
+  os << indent << "Number of processed points: " << this->m_NumberOfProcessedPoints << std::endl;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  SpeedImageType * speedImage = const_cast< SpeedImageType * >( this->GetInput() );
+
+  if( speedImage )
+    {
+    speedImage->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+typename BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>::OffsetValueType
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::ComputePaddedOffset( const IndexType & index ) const
+{
+  OffsetValueType offset = 0;
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    offset += ( index[d] - this->m_BufferRegion.GetIndex()[d] + 1 ) * this->m_Stride[d];
+    }
+  return offset;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+typename BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>::IndexType
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::ComputeIndex( OffsetValueType offset ) const
+{
+  IndexType index;
+  for( int d = SetDimension - 1; d >= 0; d-- )
+    {
+    const OffsetValueType coordinate = offset / this->m_Stride[d];
+    offset -= coordinate * this->m_Stride[d];
+    index[d] = this->m_BufferRegion.GetIndex()[d] + coordinate - 1;
+    }
+  return index;
+}
+
+
+/**
+ * Copies the squared inverse of the speed in the padded buffer. The padding
+ * pixels, and the pixels that the front cannot enter, are outside points.
+ */
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::InitializeWorkingBuffers()
+{
+  const SpeedImageType * speedImage = this->GetInput();
+
+  this->m_BufferRegion = this->GetOutput()->GetLargestPossibleRegion();
+
+  const typename RegionType::SizeType & size = this->m_BufferRegion.GetSize();
+
+  SizeValueType paddedSize = 1;
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    this->m_Stride[d] = paddedSize;
+    paddedSize *= size[d] + 2;
+    const double spacing = this->GetOutput()->GetSpacing()[d];
+    this->m_InverseSquaredSpacing[d] = 1.0 / ( spacing * spacing );
+    }
+
+  this->m_Status.assign( paddedSize, static_cast< StatusType >( OutsidePoint ) );
+  this->m_ArrivalTime.assign( paddedSize, this->m_LargeValue );
+  this->m_InverseSquaredSpeed.assign( paddedSize, 0.0f );
+  this->m_Position.assign( paddedSize, NumericTraits< PositionType >::max() );
+
+  typedef ImageRegionConstIterator< SpeedImageType > SpeedIteratorType;
+  SpeedIteratorType sit( speedImage, this->m_BufferRegion );
+
+  OffsetValueType offset = 0;
+  SizeValueType counter[SetDimension];
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    offset += this->m_Stride[d];
+    counter[d] = 0;
+    }
+
+  for( sit.GoToBegin(); !sit.IsAtEnd(); ++sit )
+    {
+    const double speed = static_cast< double >( sit.Get() );
+    if( speed > 0.0 )
+      {
+      this->m_Status[offset] = FarPoint;
+      this->m_InverseSquaredSpeed[offset] = static_cast< float >( 1.0 / ( speed * speed ) );
+      }
+
+    // Move to the next pixel of the padded buffer, skipping the two padding
+    // layers along every dimension that wraps.
+    ++offset;
+    for( unsigned int d = 0; d < SetDimension; d++ )
+      {
+      if( ++counter[d] < size[d] )
+        {
+        break;
+        }
+      counter[d] = 0;
+      offset += 2 * this->m_Stride[d];
+      }
+    }
+}
+
+
+/**
+ * Same first order upwind solution as FastMarchingImageFilter::UpdateValue.
+ */
+template <class TLevelSet, class TSpeedImage>
+double
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::SolveEikonal( OffsetValueType offset ) const
+{
+  const double largeValue = static_cast< double >( this->m_LargeValue );
+
+  double values[SetDimension];
+  double factors[SetDimension];
+  unsigned int count = 0;
+
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    const OffsetValueType lower = offset - this->m_Stride[d];
+    const OffsetValueType upper = offset + this->m_Stride[d];
+
+    double value = largeValue;
+    if( this->m_Status[lower] == AlivePoint )
+      {
+      value = this->m_ArrivalTime[lower];
+      }
+    if( this->m_Status[upper] == AlivePoint && this->m_ArrivalTime[upper] < value )
+      {
+      value = this->m_ArrivalTime[upper];
+      }
+
+    if( value < largeValue )
+      {
+      // Insertion in the list of neighbor values, sorted in increasing order.
+      unsigned int j = count++;
+      while( j > 0 && values[j - 1] > value )
+        {
+        values[j] = values[j - 1];
+        factors[j] = factors[j - 1];
+        --j;
+        }
+      values[j] = value;
+      factors[j] = this->m_InverseSquaredSpacing[d];
+      }
+    }
+
+  double aa = 0.0;
+  double bb = 0.0;
+  double cc = -this->m_InverseSquaredSpeed[offset];
+  double solution = largeValue;
+
+  for( unsigned int j = 0; j < count; j++ )
+    {
+    if( solution < values[j] )
+      {
+      break;
+      }
+    aa += factors[j];
+    bb += values[j] * factors[j];
+    cc += values[j] * values[j] * factors[j];
+
+    const double discriminant = bb * bb - aa * cc;
+    if( discriminant < 0.0 )
+      {
+      itkExceptionMacro("Discriminant of quadratic equation is negative");
+      }
+    solution = ( vcl_sqrt( discriminant ) + bb ) / aa;
+    }
+
+  return solution;
+}
+
+
+/**
+ * Bucket of an arrival time. Points below the current bucket go in the
+ * current bucket, points beyond the last bucket go in the last one.
+ */
+template <class TLevelSet, class TSpeedImage>
+SizeValueType
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::ComputeBucket( double value ) const
+{
+  const SizeValueType lastBucket = this->m_Buckets.size() - 1;
+  const double position = ( value - this->m_BucketOrigin ) / this->m_EffectiveBucketWidth;
+
+  if( position >= static_cast< double >( lastBucket ) )
+    {
+    return lastBucket;
+    }
+
+  const SizeValueType bucket = ( position > 0.0 ) ? static_cast< SizeValueType >( position ) : 0;
+
+  return ( bucket > this->m_CurrentBucket ) ? bucket : this->m_CurrentBucket;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::Enqueue( OffsetValueType offset )
+{
+  const double value = this->m_ArrivalTime[offset];
+
+  if( value > this->m_StoppingValue )
+    {
+    this->m_Position[offset] = NumericTraits< PositionType >::max();
+    return;
+    }
+
+  BucketType & bucket = this->m_Buckets[ this->ComputeBucket( value ) ];
+  this->m_Position[offset] = static_cast< PositionType >( bucket.size() );
+  bucket.push_back( offset );
+}
+
+
+/**
+ * Removes a point from its bucket by moving the last point of the bucket in
+ * its place. The arrival time of the point must not have changed since it
+ * was queued.
+ */
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::Dequeue( OffsetValueType offset )
+{
+  const PositionType position = this->m_Position[offset];
+
+  if( position == NumericTraits< PositionType >::max() )
+    {
+    return;
+    }
+
+  BucketType & bucket = this->m_Buckets[ this->ComputeBucket( this->m_ArrivalTime[offset] ) ];
+
+  const OffsetValueType moved = bucket.back();
+  bucket[position] = moved;
+  this->m_Position[moved] = position;
+  bucket.pop_back();
+
+  this->m_Position[offset] = NumericTraits< PositionType >::max();
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::Rebase()
+{
+  BucketType points;
+  points.swap( this->m_Buckets.back() );
+
+  double minimum = static_cast< double >( this->m_LargeValue );
+  for( typename BucketType::const_iterator itr = points.begin(); itr != points.end(); ++itr )
+    {
+    minimum = vnl_math_min( minimum, static_cast< double >( this->m_ArrivalTime[*itr] ) );
+    }
+
+  this->m_BucketOrigin = minimum;
+  this->m_CurrentBucket = 0;
+
+  for( typename BucketType::const_iterator itr = points.begin(); itr != points.end(); ++itr )
+    {
+    this->Enqueue( *itr );
+    }
+}
+
+
+/**
+ * Generate Data
+ */
+template <class TLevelSet, class TSpeedImage>
+void
+BucketQueueFastMarchingImageFilter<TLevelSet, TSpeedImage>
+::GenerateData()
+{
+  LevelSetImageType * output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  this->InitializeWorkingBuffers();
+
+  const double largeValue = static_cast< double >( this->m_LargeValue );
+
+  // Initial trial points. As in FastMarchingImageFilter, points outside of
+  // the image are ignored and the last value given to a point is kept.
+  std::vector< OffsetValueType > seeds;
+  double minimumSeedValue = largeValue;
+
+  if( this->m_TrialPoints )
+    {
+    typename NodeContainer::ConstIterator pointsIter = this->m_TrialPoints->Begin();
+    typename NodeContainer::ConstIterator pointsEnd = this->m_TrialPoints->End();
+
+    for( ; pointsIter != pointsEnd; ++pointsIter )
+      {
+      const NodeType & node = pointsIter.Value();
+
+      if( !this->m_BufferRegion.IsInside( node.GetIndex() ) )
+        {
+        continue;
+        }
+
+      const OffsetValueType offset = this->ComputePaddedOffset( node.GetIndex() );
+
+      this->m_ArrivalTime[offset] = node.GetValue();
+      this->m_Status[offset] = InitialTrialPoint;
+      seeds.push_back( offset );
+
+      minimumSeedValue = vnl_math_min( minimumSeedValue, static_cast< double >( node.GetValue() ) );
+      }
+    }
+
+  // Bucket width and number of buckets.
+  double width = this->m_BucketWidth;
+
+  if( width <= 0.0 )
+    {
+    float minimumInverseSquaredSpeed = NumericTraits< float >::max();
+    for( SizeValueType i = 0; i < this->m_Status.size(); i++ )
+      {
+      if( this->m_Status[i] != OutsidePoint && this->m_InverseSquaredSpeed[i] > 0.0f )
+        {
+        minimumInverseSquaredSpeed =
+          vnl_math_min( minimumInverseSquaredSpeed, this->m_InverseSquaredSpeed[i] );
+        }
+      }
+
+    double maximumInverseSquaredSpacing = this->m_InverseSquaredSpacing[0];
+    for( unsigned int d = 1; d < SetDimension; d++ )
+      {
+      maximumInverseSquaredSpacing =
+        vnl_math_max( maximumInverseSquaredSpacing, this->m_InverseSquaredSpacing[d] );
+      }
+
+    // The front takes at least h / ( F sqrt(N) ) to move to a neighbor.
+    width = 0.5 * vcl_sqrt( minimumInverseSquaredSpeed /
+                            ( maximumInverseSquaredSpacing * SetDimension ) );
+
+    if( !( width > 0.0 ) || minimumInverseSquaredSpeed == NumericTraits< float >::max() )
+      {
+      width = 1.0;
+      }
+    }
+
+  const SizeValueType maximumNumberOfBuckets = 65536;
+
+  const double range = ( minimumSeedValue < largeValue ) ?
+    ( this->m_StoppingValue - minimumSeedValue ) / width : 0.0;
+
+  SizeValueType numberOfBuckets = maximumNumberOfBuckets;
+  if( range < static_cast< double >( maximumNumberOfBuckets - 2 ) )
+    {
+    numberOfBuckets = static_cast< SizeValueType >( vnl_math_max( range, 0.0 ) ) + 2;
+    }
+
+  this->m_Buckets.clear();
+  this->m_Buckets.resize( numberOfBuckets );
+  this->m_EffectiveBucketWidth = width;
+  this->m_BucketOrigin = ( minimumSeedValue < largeValue ) ? minimumSeedValue : 0.0;
+  this->m_CurrentBucket = 0;
+
+  for( typename std::vector< OffsetValueType >::const_iterator seedItr = seeds.begin();
+       seedItr != seeds.end(); ++seedItr )
+    {
+    if( this->m_Position[*seedItr] == NumericTraits< PositionType >::max() )
+      {
+      this->Enqueue( *seedItr );
+      }
+    }
+
+  // Propagation.
+  IndexType lower;
+  IndexType upper;
+  lower.Fill( 0 );
+  upper.Fill( 0 );
+
+  this->m_NumberOfProcessedPoints = 0;
+
+  const SizeValueType lastBucket = numberOfBuckets - 1;
+  double oldProgress = 0.0;
+
+  while( true )
+    {
+    while( this->m_CurrentBucket < lastBucket && this->m_Buckets[this->m_CurrentBucket].empty() )
+      {
+      ++this->m_CurrentBucket;
+      }
+
+    if( this->m_CurrentBucket == lastBucket )
+      {
+      if( this->m_Buckets[lastBucket].empty() )
+        {
+        break;
+        }
+      this->Rebase();
+      continue;
+      }
+
+    BucketType & bucket = this->m_Buckets[this->m_CurrentBucket];
+    const OffsetValueType offset = bucket.back();
+    bucket.pop_back();
+    this->m_Position[offset] = NumericTraits< PositionType >::max();
+
+    this->m_Status[offset] = AlivePoint;
+
+    const IndexType index = this->ComputeIndex( offset );
+    for( unsigned int d = 0; d < SetDimension; d++ )
+      {
+      if( this->m_NumberOfProcessedPoints == 0 || index[d] < lower[d] )
+        {
+        lower[d] = index[d];
+        }
+      if( this->m_NumberOfProcessedPoints == 0 || index[d] > upper[d] )
+        {
+        upper[d] = index[d];
+        }
+      }
+    ++this->m_NumberOfProcessedPoints;
+
+    // Update the neighbors that are neither alive, initial trial points
+    // nor outside.
+    for( unsigned int d = 0; d < SetDimension; d++ )
+      {
+      for( int side = -1; side < 2; side += 2 )
+        {
+        const OffsetValueType neighbor = offset + side * this->m_Stride[d];
+        const StatusType status = this->m_Status[neighbor];
+
+        if( status != FarPoint && status != TrialPoint )
+          {
+          continue;
+          }
+
+        const double solution = this->SolveEikonal( neighbor );
+
+        if( solution < largeValue )
+          {
+          if( status == TrialPoint )
+            {
+            this->Dequeue( neighbor );
+            }
+          this->m_ArrivalTime[neighbor] = static_cast< PixelType >( solution );
+          this->m_Status[neighbor] = TrialPoint;
+          this->Enqueue( neighbor );
+          }
+        }
+      }
+
+    if( !( this->m_NumberOfProcessedPoints % 10000 ) )
+      {
+      const double newProgress = this->m_ArrivalTime[offset] / this->m_StoppingValue;
+      if( newProgress - oldProgress > 0.01 )
+        {
+        this->UpdateProgress( newProgress );
+        oldProgress = newProgress;
+        if( this->GetAbortGenerateData() )
+          {
+          this->InvokeEvent( AbortEvent() );
+          this->ResetPipeline();
+          ProcessAborted e(__FILE__, __LINE__);
+          e.SetDescription("Process aborted.");
+          e.SetLocation(ITK_LOCATION);
+          throw e;
+          }
+        }
+      }
+    }
+
+  typename RegionType::SizeType reachedSize;
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    reachedSize[d] = ( this->m_NumberOfProcessedPoints > 0 ) ? upper[d] - lower[d] + 1 : 0;
+    }
+  this->m_ReachedRegion.SetIndex( lower );
+  this->m_ReachedRegion.SetSize( reachedSize );
+
+  // Copy the arrival times out of the padded buffer.
+  typedef ImageRegionIterator< LevelSetImageType > OutputIteratorType;
+  OutputIteratorType oit( output, this->m_BufferRegion );
+
+  const typename RegionType::SizeType & size = this->m_BufferRegion.GetSize();
+
+  OffsetValueType offset = 0;
+  SizeValueType counter[SetDimension];
+  for( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    offset += this->m_Stride[d];
+    counter[d] = 0;
+    }
+
+  for( oit.GoToBegin(); !oit.IsAtEnd(); ++oit )
+    {
+    oit.Set( this->m_ArrivalTime[offset] );
+
+    ++offset;
+    for( unsigned int d = 0; d < SetDimension; d++ )
+      {
+      if( ++counter[d] < size[d] )
+        {
+        break;
+        }
+      counter[d] = 0;
+      offset += 2 * this->m_Stride[d];
+      }
+    }
+
+  // Release the working memory.
+  std::vector< StatusType >().swap( this->m_Status );
+  std::vector< PixelType >().swap( this->m_ArrivalTime );
+  std::vector< float >().swap( this->m_InverseSquaredSpeed );
+  std::vector< PositionType >().swap( this->m_Position );
+  std::vector< BucketType >().swap( this->m_Buckets );
+
+  this->UpdateProgress( 1.0 );
+}
+
+} // end namespace itk
+
+#endif
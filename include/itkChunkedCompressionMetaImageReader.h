@@ -0,0 +1,130 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkChunkedCompressionMetaImageReader.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkChunkedCompressionMetaImageReader_h
+#define __itkChunkedCompressionMetaImageReader_h
+
+#include "itkImageSource.h"
+#include "itkImageFileReader.h"
+#include "itkIntTypes.h"
+#include "itkMultiThreader.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ChunkedCompressionMetaImageReader
+ * \brief Reads an image, inflating the chunks of the MetaImage files written
+ * by ChunkedCompressionMetaImageWriter on several threads.
+ *
+ * When the compressed data of a MetaImage is followed by the chunk table of
+ * the ChunkedCompressionMetaImageWriter, and the file has the pixel type of
+ * the output and the byte order of the system, the compressed data is read
+ * at once and the threads inflate the chunks straight into the output
+ * buffer. The checksum of the zlib stream is verified.
+ *
+ * Other files are read, and their pixels converted, by ImageFileReader.
+ *
+ * The output is the whole image.
+ *
+ * \sa ChunkedCompressionMetaImageWriter
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TOutputImage>
+class ITK_EXPORT ChunkedCompressionMetaImageReader : public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ChunkedCompressionMetaImageReader   Self;
+  typedef ImageSource< TOutputImage >         Superclass;
+  typedef SmartPointer<Self>                  Pointer;
+  typedef SmartPointer<const Self>            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ChunkedCompressionMetaImageReader, ImageSource);
+
+  /** Output image typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputImagePixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+
+  typedef ImageFileReader< OutputImageType >          FileReaderType;
+
+  /** File of the image. */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Whether the last update inflated the chunks of the file on several
+   * threads. */
+  itkGetConstMacro( IsChunkCompressed, bool );
+
+protected:
+  ChunkedCompressionMetaImageReader();
+  virtual ~ChunkedCompressionMetaImageReader();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Reads the header of the file. */
+  virtual void GenerateOutputInformation();
+
+  /** The whole image is produced. */
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Inflates the chunks of the file, or reads it. */
+  virtual void GenerateData();
+
+private:
+  ChunkedCompressionMetaImageReader(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** File that holds the compressed data of a MetaImage header, and its
+   * offset in that file, when the data is followed by a chunk table that
+   * matches the image. The offsets of the chunks in the compressed data are
+   * then set. */
+  bool ReadChunkTable( std::string & dataFileName, unsigned long & offset );
+
+  void DecompressChunks( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  static ITK_THREAD_RETURN_TYPE DecompressChunksThreaderCallback( void * arg );
+
+  std::string                           m_FileName;
+  typename FileReaderType::Pointer      m_FileReader;
+  bool                                  m_IsChunkCompressed;
+
+  std::vector< unsigned char >          m_CompressedData;
+  std::vector< uint64_t >               m_ChunkOffsets;
+  SizeValueType                         m_ChunkLength;
+
+  unsigned char *                       m_Buffer;
+  SizeValueType                         m_BufferLength;
+
+  std::vector< unsigned long >          m_ChunkChecksums;
+  std::vector< std::string >            m_ThreadErrors;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkChunkedCompressionMetaImageReader.hxx"
+#endif
+
+#endif
@@ -0,0 +1,433 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkChunkedCompressionMetaImageReader.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkChunkedCompressionMetaImageReader_hxx
+#define __itkChunkedCompressionMetaImageReader_hxx
+
+#include "itkChunkedCompressionMetaImageReader.h"
+#include "itkChunkedCompressionMetaImageWriter.h"
+#include "itkMetaImageIO.h"
+#include "itkByteSwapper.h"
+#include "itksys/SystemTools.hxx"
+#include "itk_zlib.h"
+
+#include <fstream>
+#include <cstring>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TOutputImage>
+ChunkedCompressionMetaImageReader<TOutputImage>
+::ChunkedCompressionMetaImageReader()
+{
+  this->m_FileReader = FileReaderType::New();
+  this->m_IsChunkCompressed = false;
+
+  this->m_ChunkLength = 0;
+  this->m_Buffer = NULL;
+  this->m_BufferLength = 0;
+}
+
+
+/**
+ * Destructor
+ */
+template <class TOutputImage>
+ChunkedCompressionMetaImageReader<TOutputImage>
+::~ChunkedCompressionMetaImageReader()
+{
+}
+
+
+template <class TOutputImage>
+void
+ChunkedCompressionMetaImageReader<TOutputImage>
+::GenerateOutputInformation()
+{
+  OutputImageType * output = this->GetOutput();
+
+  this->m_FileReader->SetFileName( this->m_FileName );
+  this->m_FileReader->UpdateOutputInformation();
+
+  output->CopyInformation( this->m_FileReader->GetOutput() );
+  output->SetMetaDataDictionary( this->m_FileReader->GetMetaDataDictionary() );
+}
+
+
+template <class TOutputImage>
+void
+ChunkedCompressionMetaImageReader<TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+/**
+ * The compressed data of a MetaImage follows the ElementDataFile entry, which
+ * ends the header, or starts the file named by that entry. The chunk table
+ * ends the file that holds the data, and the compressed sizes of the chunks
+ * must add up to the data between the zlib header and the checksum.
+ */
+template <class TOutputImage>
+bool
+ChunkedCompressionMetaImageReader<TOutputImage>
+::ReadChunkTable( std::string & dataFileName, unsigned long & offset )
+{
+  MetaImageIO * io = dynamic_cast< MetaImageIO * >( this->m_FileReader->GetImageIO() );
+
+  if( !io ||
+      io->GetNumberOfDimensions() != OutputImageType::ImageDimension ||
+      io->GetNumberOfComponents() != 1 ||
+      io->GetComponentType() != ImageIOBase::MapPixelType< OutputImagePixelType >::CType )
+    {
+    return false;
+    }
+
+  const ImageIOBase::ByteOrder systemByteOrder =
+    ByteSwapper< int >::SystemIsBigEndian() ? ImageIOBase::BigEndian : ImageIOBase::LittleEndian;
+
+  MetaImage * metaImage = io->GetMetaImagePointer();
+
+  if( io->GetByteOrder() != systemByteOrder || !metaImage->CompressedData() )
+    {
+    return false;
+    }
+
+  const std::string elementDataFile = metaImage->ElementDataFileName();
+
+  offset = 0;
+
+  if( elementDataFile == "LOCAL" )
+    {
+    std::ifstream is( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+
+    bool found = false;
+    std::string line;
+    while( !found && std::getline( is, line ) )
+      {
+      const std::string::size_type start = line.find_first_not_of( " \t" );
+      if( start != std::string::npos && line.compare( start, 15, "ElementDataFile" ) == 0 )
+        {
+        offset = static_cast< unsigned long >( is.tellg() );
+        found = true;
+        }
+      }
+    if( !found )
+      {
+      return false;
+      }
+    dataFileName = this->m_FileName;
+    }
+  else
+    {
+    if( elementDataFile == "LIST" || elementDataFile.find( '%' ) != std::string::npos )
+      {
+      return false;
+      }
+
+    dataFileName = elementDataFile;
+    if( !itksys::SystemTools::FileIsFullPath( dataFileName.c_str() ) )
+      {
+      const std::string path = itksys::SystemTools::GetFilenamePath( this->m_FileName );
+      if( !path.empty() )
+        {
+        dataFileName = path + "/" + elementDataFile;
+        }
+      }
+    }
+
+  //
+  // Number of chunks, uncompressed size of the chunks and signature
+  //
+  const uint64_t fileLength = itksys::SystemTools::FileLength( dataFileName.c_str() );
+
+  if( fileLength < offset + 6 + 3 * 8 )
+    {
+    return false;
+    }
+
+  std::ifstream is( dataFileName.c_str(), std::ios::in | std::ios::binary );
+
+  unsigned char tail[3 * 8];
+  is.seekg( static_cast< std::streamoff >( fileLength - sizeof( tail ) ) );
+  is.read( reinterpret_cast< char * >( tail ), sizeof( tail ) );
+
+  if( !is ||
+      std::memcmp( tail + 16, ChunkedCompressionMetaImageWriter< OutputImageType >::GetChunkTableSignature(), 8 ) != 0 )
+    {
+    return false;
+    }
+
+  uint64_t chunkLength = 0;
+  uint64_t numberOfChunks = 0;
+  for( unsigned int b = 0; b < 8; b++ )
+    {
+    chunkLength |= static_cast< uint64_t >( tail[b] ) << ( 8 * b );
+    numberOfChunks |= static_cast< uint64_t >( tail[8 + b] ) << ( 8 * b );
+    }
+
+  const uint64_t bufferLength =
+    static_cast< uint64_t >( io->GetImageSizeInPixels() ) * sizeof( OutputImagePixelType );
+
+  if( chunkLength == 0 || numberOfChunks == 0 ||
+      numberOfChunks > ( fileLength - offset ) / 8 )
+    {
+    return false;
+    }
+
+  // An empty image still has one chunk
+  const uint64_t expectedNumberOfChunks = ( bufferLength + chunkLength - 1 ) / chunkLength;
+
+  if( numberOfChunks != ( expectedNumberOfChunks > 0 ? expectedNumberOfChunks : 1 ) )
+    {
+    return false;
+    }
+
+  //
+  // Compressed sizes of the chunks
+  //
+  const uint64_t tableBegin = fileLength - sizeof( tail ) - 8 * numberOfChunks;
+
+  if( tableBegin < offset + 6 )
+    {
+    return false;
+    }
+
+  std::vector< uint64_t > chunkSizes( numberOfChunks );
+  is.seekg( static_cast< std::streamoff >( tableBegin ) );
+  is.read( reinterpret_cast< char * >( &chunkSizes[0] ), 8 * numberOfChunks );
+  ByteSwapper< uint64_t >::SwapRangeFromSystemToLittleEndian( &chunkSizes[0], numberOfChunks );
+
+  if( !is )
+    {
+    return false;
+    }
+
+  this->m_ChunkOffsets.resize( numberOfChunks + 1 );
+  this->m_ChunkOffsets[0] = 2;
+  for( uint64_t i = 0; i < numberOfChunks; i++ )
+    {
+    if( chunkSizes[i] > tableBegin )
+      {
+      return false;
+      }
+    this->m_ChunkOffsets[i + 1] = this->m_ChunkOffsets[i] + chunkSizes[i];
+    }
+
+  if( this->m_ChunkOffsets[numberOfChunks] + 4 != tableBegin - offset )
+    {
+    return false;
+    }
+
+  this->m_ChunkLength = static_cast< SizeValueType >( chunkLength );
+
+  return true;
+}
+
+
+/**
+ * The compressed data is read at once, the chunks are shared among the
+ * threads, and each chunk is inflated into its place in the output buffer.
+ */
+template <class TOutputImage>
+void
+ChunkedCompressionMetaImageReader<TOutputImage>
+::GenerateData()
+{
+  OutputImageType * output = this->GetOutput();
+
+  this->m_IsChunkCompressed = false;
+
+  std::string dataFileName;
+  unsigned long offset = 0;
+
+  if( !this->ReadChunkTable( dataFileName, offset ) )
+    {
+    this->m_FileReader->GetOutput()->SetRequestedRegion( output->GetRequestedRegion() );
+    this->m_FileReader->Update();
+
+    this->GraftOutput( this->m_FileReader->GetOutput() );
+    return;
+    }
+
+  const SizeValueType numberOfChunks = this->m_ChunkOffsets.size() - 1;
+
+  this->m_CompressedData.resize( this->m_ChunkOffsets[numberOfChunks] + 4 );
+
+  std::ifstream is( dataFileName.c_str(), std::ios::in | std::ios::binary );
+  is.seekg( static_cast< std::streamoff >( offset ) );
+  is.read( reinterpret_cast< char * >( &this->m_CompressedData[0] ), this->m_CompressedData.size() );
+
+  if( !is )
+    {
+    itkExceptionMacro("Could not read the compressed data of " << this->m_FileName );
+    }
+
+  output->SetBufferedRegion( output->GetLargestPossibleRegion() );
+  output->Allocate();
+
+  this->m_Buffer = reinterpret_cast< unsigned char * >( output->GetBufferPointer() );
+  this->m_BufferLength = output->GetBufferedRegion().GetNumberOfPixels() * sizeof( OutputImagePixelType );
+
+  this->m_ChunkChecksums.assign( numberOfChunks, 0 );
+
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    vnl_math_max( vnl_math_min( static_cast< SizeValueType >( this->GetNumberOfThreads() ), numberOfChunks ),
+                  static_cast< SizeValueType >( 1 ) ) );
+
+  this->m_ThreadErrors.assign( numberOfThreads, std::string() );
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->DecompressChunksThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  //
+  // The checksum of the chunks must be the checksum of the stream
+  //
+  uLong checksum = this->m_ChunkChecksums[0];
+  for( SizeValueType i = 1; i < numberOfChunks; i++ )
+    {
+    const SizeValueType chunkBegin = i * this->m_ChunkLength;
+    const SizeValueType chunkLength = vnl_math_min( this->m_ChunkLength, this->m_BufferLength - chunkBegin );
+    checksum = adler32_combine( checksum, this->m_ChunkChecksums[i], static_cast< z_off_t >( chunkLength ) );
+    }
+
+  const unsigned char * trailer = &this->m_CompressedData[this->m_ChunkOffsets[numberOfChunks]];
+
+  uLong streamChecksum = 0;
+  for( unsigned int b = 0; b < 4; b++ )
+    {
+    streamChecksum = ( streamChecksum << 8 ) | trailer[b];
+    }
+
+  std::vector< unsigned char >().swap( this->m_CompressedData );
+
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    if( !this->m_ThreadErrors[t].empty() )
+      {
+      itkExceptionMacro( << this->m_ThreadErrors[t] << " in " << this->m_FileName );
+      }
+    }
+
+  if( checksum != streamChecksum )
+    {
+    itkExceptionMacro("The checksum of the pixels of " << this->m_FileName << " does not match");
+    }
+
+  this->m_IsChunkCompressed = true;
+}
+
+
+template <class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ChunkedCompressionMetaImageReader<TOutputImage>
+::DecompressChunksThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+
+  Self * reader = static_cast< Self * >( info->UserData );
+
+  try
+    {
+    reader->DecompressChunks( info->ThreadID, info->NumberOfThreads );
+    }
+  catch( ExceptionObject & excp )
+    {
+    reader->m_ThreadErrors[info->ThreadID] = excp.GetDescription();
+    }
+  catch( std::exception & excp )
+    {
+    reader->m_ThreadErrors[info->ThreadID] = excp.what();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * Each chunk starts on a byte boundary with an empty window, so that it is
+ * inflated as a raw deflate stream of its own. It must fill its part of the
+ * buffer exactly.
+ */
+template <class TOutputImage>
+void
+ChunkedCompressionMetaImageReader<TOutputImage>
+::DecompressChunks( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const SizeValueType numberOfChunks = this->m_ChunkOffsets.size() - 1;
+
+  for( SizeValueType i = threadId; i < numberOfChunks; i += numberOfThreads )
+    {
+    const SizeValueType chunkBegin = i * this->m_ChunkLength;
+    const SizeValueType chunkLength = vnl_math_min( this->m_ChunkLength, this->m_BufferLength - chunkBegin );
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    if( inflateInit2( &stream, -MAX_WBITS ) != Z_OK )
+      {
+      itkExceptionMacro("Could not initialize the decompression of chunk " << i );
+      }
+
+    stream.next_in = &this->m_CompressedData[this->m_ChunkOffsets[i]];
+    stream.avail_in = static_cast< uInt >( this->m_ChunkOffsets[i + 1] - this->m_ChunkOffsets[i] );
+    stream.next_out = this->m_Buffer + chunkBegin;
+    stream.avail_out = static_cast< uInt >( chunkLength );
+
+    const int status = inflate( &stream, Z_SYNC_FLUSH );
+
+    const uLong decompressedLength = stream.total_out;
+
+    inflateEnd( &stream );
+
+    if( ( status != Z_OK && status != Z_STREAM_END ) || decompressedLength != chunkLength )
+      {
+      itkExceptionMacro("Could not decompress chunk " << i );
+      }
+
+    this->m_ChunkChecksums[i] = adler32( adler32( 0L, Z_NULL, 0 ), this->m_Buffer + chunkBegin,
+                                         static_cast< uInt >( chunkLength ) );
+    }
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TOutputImage>
+void
+ChunkedCompressionMetaImageReader<TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "File name: " << this->m_FileName << std::endl;
+  os << indent << "Chunk compressed: " << this->m_IsChunkCompressed << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,159 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkChunkedCompressionMetaImageWriter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkChunkedCompressionMetaImageWriter_h
+#define __itkChunkedCompressionMetaImageWriter_h
+
+#include "itkProcessObject.h"
+#include "itkImage.h"
+#include "itkIntTypes.h"
+#include "itkMultiThreader.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ChunkedCompressionMetaImageWriter
+ * \brief Writes an image as a compressed MetaImage, compressing chunks of
+ * the pixels on several threads.
+ *
+ * The pixels are cut in chunks of ChunkSize bytes, that the threads deflate
+ * independently. Each chunk but the last ends with a full flush, so that the
+ * chunks put end to end, between the zlib header and the checksum of the
+ * whole buffer, make a single zlib stream. The file is therefore a regular
+ * compressed MetaImage (.mha, or .mhd with a .zraw data file), that any
+ * MetaImage reader reads.
+ *
+ * The compressed size of every chunk is appended after the compressed data,
+ * where MetaImage readers do not look, so that the
+ * ChunkedCompressionMetaImageReader can inflate the chunks on several threads
+ * as well. The table is made of the compressed sizes, the uncompressed size
+ * of the chunks and the number of chunks, as 64 bits little endian integers,
+ * followed by the signature "LSTKCHNK".
+ *
+ * Files that are not MetaImages are written by ImageFileWriter, with its
+ * own compression. When UseCompression is off, the image is written
+ * uncompressed by ImageFileWriter.
+ *
+ * \sa ChunkedCompressionMetaImageReader
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TInputImage>
+class ITK_EXPORT ChunkedCompressionMetaImageWriter : public ProcessObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef ChunkedCompressionMetaImageWriter   Self;
+  typedef ProcessObject                       Superclass;
+  typedef SmartPointer<Self>                  Pointer;
+  typedef SmartPointer<const Self>            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ChunkedCompressionMetaImageWriter, ProcessObject);
+
+  /** Input image typedefs. */
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::PixelType        InputImagePixelType;
+  typedef typename InputImageType::RegionType       InputImageRegionType;
+
+  /** Image to write. */
+  using ProcessObject::SetInput;
+  void SetInput( const InputImageType * image );
+  const InputImageType * GetInput() const;
+
+  /** Set / Get the output filename */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Uncompressed size of the chunks, in bytes. It is rounded down to a
+   * whole number of pixels. */
+  itkSetClampMacro( ChunkSize, SizeValueType, 1, 1 << 30 );
+  itkGetConstMacro( ChunkSize, SizeValueType );
+
+  /** Whether the pixels are compressed. On by default. */
+  itkSetMacro( UseCompression, bool );
+  itkGetConstMacro( UseCompression, bool );
+  itkBooleanMacro( UseCompression );
+
+  /** zlib compression level, from 0 to 9, or -1 for the default level. */
+  itkSetClampMacro( CompressionLevel, int, -1, 9 );
+  itkGetConstMacro( CompressionLevel, int );
+
+  /** Number of chunks of the last file written. */
+  itkGetConstMacro( NumberOfChunks, SizeValueType );
+
+  /** Writes the whole input. */
+  virtual void Write();
+
+  /** Writers are updated by writing. */
+  virtual void Update()
+    { this->Write(); }
+
+  /** Signature that ends the chunk table. */
+  static const char * GetChunkTableSignature()
+    { return "LSTKCHNK"; }
+
+protected:
+  ChunkedCompressionMetaImageWriter();
+  virtual ~ChunkedCompressionMetaImageWriter();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void GenerateData();
+
+private:
+  ChunkedCompressionMetaImageWriter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** MetaImage element type of the pixels, empty when the pixels cannot be
+   * written as a single MetaImage element. */
+  static std::string GetMetaElementType();
+
+  void CompressChunks( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  static ITK_THREAD_RETURN_TYPE CompressChunksThreaderCallback( void * arg );
+
+  void WriteHeader( std::ostream & os, const std::string & elementType,
+                    uint64_t compressedDataSize, const std::string & dataFileName ) const;
+
+  std::string                                   m_FileName;
+  bool                                          m_UseCompression;
+  SizeValueType                                 m_ChunkSize;
+  int                                           m_CompressionLevel;
+  SizeValueType                                 m_NumberOfChunks;
+
+  const unsigned char *                         m_Buffer;
+  SizeValueType                                 m_BufferLength;
+  SizeValueType                                 m_ChunkLength;
+
+  std::vector< std::vector< unsigned char > >   m_CompressedChunks;
+  std::vector< unsigned long >                  m_ChunkChecksums;
+  std::vector< std::string >                    m_ThreadErrors;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkChunkedCompressionMetaImageWriter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,478 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkChunkedCompressionMetaImageWriter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkChunkedCompressionMetaImageWriter_hxx
+#define __itkChunkedCompressionMetaImageWriter_hxx
+
+#include "itkChunkedCompressionMetaImageWriter.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIOBase.h"
+#include "itkByteSwapper.h"
+#include "itksys/SystemTools.hxx"
+#include "itk_zlib.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage>
+ChunkedCompressionMetaImageWriter<TInputImage>
+::ChunkedCompressionMetaImageWriter()
+{
+  this->SetNumberOfRequiredInputs( 1 );
+
+  this->m_UseCompression = true;
+  this->m_ChunkSize = 1 << 20;
+  this->m_CompressionLevel = Z_DEFAULT_COMPRESSION;
+  this->m_NumberOfChunks = 0;
+
+  this->m_Buffer = NULL;
+  this->m_BufferLength = 0;
+  this->m_ChunkLength = 0;
+}
+
+
+/**
+ * Destructor
+ */
+template <class TInputImage>
+ChunkedCompressionMetaImageWriter<TInputImage>
+::~ChunkedCompressionMetaImageWriter()
+{
+}
+
+
+template <class TInputImage>
+void
+ChunkedCompressionMetaImageWriter<TInputImage>
+::SetInput( const InputImageType * image )
+{
+  this->SetNthInput( 0, const_cast< InputImageType * >( image ) );
+}
+
+
+template <class TInputImage>
+const typename ChunkedCompressionMetaImageWriter<TInputImage>::InputImageType *
+ChunkedCompressionMetaImageWriter<TInputImage>
+::GetInput() const
+{
+  return static_cast< const InputImageType * >( this->ProcessObject::GetInput(0) );
+}
+
+
+template <class TInputImage>
+std::string
+ChunkedCompressionMetaImageWriter<TInputImage>
+::GetMetaElementType()
+{
+  switch( ImageIOBase::MapPixelType< InputImagePixelType >::CType )
+    {
+    case ImageIOBase::UCHAR:
+      return "MET_UCHAR";
+    case ImageIOBase::CHAR:
+      return "MET_CHAR";
+    case ImageIOBase::USHORT:
+      return "MET_USHORT";
+    case ImageIOBase::SHORT:
+      return "MET_SHORT";
+    case ImageIOBase::UINT:
+      return "MET_UINT";
+    case ImageIOBase::INT:
+      return "MET_INT";
+    case ImageIOBase::ULONG:
+      return sizeof( unsigned long ) == 4 ? "MET_ULONG" : "MET_ULONG_LONG";
+    case ImageIOBase::LONG:
+      return sizeof( long ) == 4 ? "MET_LONG" : "MET_LONG_LONG";
+    case ImageIOBase::FLOAT:
+      return "MET_FLOAT";
+    case ImageIOBase::DOUBLE:
+      return "MET_DOUBLE";
+    default:
+      return "";
+    }
+}
+
+
+template <class TInputImage>
+void
+ChunkedCompressionMetaImageWriter<TInputImage>
+::Write()
+{
+  InputImageType * input = const_cast< InputImageType * >( this->GetInput() );
+
+  if( !input )
+    {
+    itkExceptionMacro("Missing input image");
+    }
+
+  if( this->m_FileName.empty() )
+    {
+    itkExceptionMacro("Missing output file name");
+    }
+
+  this->InvokeEvent( StartEvent() );
+
+  input->UpdateOutputInformation();
+  input->SetRequestedRegionToLargestPossibleRegion();
+  input->Update();
+
+  this->GenerateData();
+
+  this->InvokeEvent( EndEvent() );
+
+  if( input->ShouldIReleaseData() )
+    {
+    input->ReleaseData();
+    }
+}
+
+
+/**
+ * The chunks are shared among the threads, each chunk is deflated with its
+ * own stream, and the compressed chunks are then written in order.
+ */
+template <class TInputImage>
+void
+ChunkedCompressionMetaImageWriter<TInputImage>
+::GenerateData()
+{
+  const InputImageType * input = this->GetInput();
+
+  const std::string extension =
+    itksys::SystemTools::LowerCase( itksys::SystemTools::GetFilenameLastExtension( this->m_FileName ) );
+
+  const std::string elementType = GetMetaElementType();
+
+  this->m_NumberOfChunks = 0;
+
+  if( !this->m_UseCompression || ( extension != ".mha" && extension != ".mhd" ) || elementType.empty() )
+    {
+    typedef ImageFileWriter< InputImageType > FileWriterType;
+    typename FileWriterType::Pointer writer = FileWriterType::New();
+    writer->SetFileName( this->m_FileName );
+    writer->SetInput( input );
+    writer->SetUseCompression( this->m_UseCompression );
+    writer->Update();
+    return;
+    }
+
+  const SizeValueType pixelSize = sizeof( InputImagePixelType );
+
+  this->m_Buffer = reinterpret_cast< const unsigned char * >( input->GetBufferPointer() );
+  this->m_BufferLength = input->GetBufferedRegion().GetNumberOfPixels() * pixelSize;
+  this->m_ChunkLength = vnl_math_max( this->m_ChunkSize / pixelSize, static_cast< SizeValueType >( 1 ) ) * pixelSize;
+  this->m_NumberOfChunks = vnl_math_max(
+    ( this->m_BufferLength + this->m_ChunkLength - 1 ) / this->m_ChunkLength, static_cast< SizeValueType >( 1 ) );
+
+  this->m_CompressedChunks.assign( this->m_NumberOfChunks, std::vector< unsigned char >() );
+  this->m_ChunkChecksums.assign( this->m_NumberOfChunks, 0 );
+
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    vnl_math_max( vnl_math_min( static_cast< SizeValueType >( this->GetNumberOfThreads() ), this->m_NumberOfChunks ),
+                  static_cast< SizeValueType >( 1 ) ) );
+
+  this->m_ThreadErrors.assign( numberOfThreads, std::string() );
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->CompressChunksThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    if( !this->m_ThreadErrors[t].empty() )
+      {
+      itkExceptionMacro( << this->m_ThreadErrors[t] );
+      }
+    }
+
+  //
+  // The checksum of the stream is the checksum of the whole buffer
+  //
+  uLong checksum = this->m_ChunkChecksums[0];
+  uint64_t compressedDataSize = 2 + 4 + this->m_CompressedChunks[0].size();
+
+  for( SizeValueType i = 1; i < this->m_NumberOfChunks; i++ )
+    {
+    const SizeValueType chunkBegin = i * this->m_ChunkLength;
+    const SizeValueType chunkLength = vnl_math_min( this->m_ChunkLength, this->m_BufferLength - chunkBegin );
+    checksum = adler32_combine( checksum, this->m_ChunkChecksums[i], static_cast< z_off_t >( chunkLength ) );
+    compressedDataSize += this->m_CompressedChunks[i].size();
+    }
+
+  std::string dataFileName = "LOCAL";
+  std::string dataFilePath = this->m_FileName;
+
+  if( extension == ".mhd" )
+    {
+    dataFileName = itksys::SystemTools::GetFilenameWithoutLastExtension( this->m_FileName ) + ".zraw";
+    const std::string path = itksys::SystemTools::GetFilenamePath( this->m_FileName );
+    dataFilePath = path.empty() ? dataFileName : path + "/" + dataFileName;
+    }
+
+  std::ofstream os( this->m_FileName.c_str(), std::ios::out | std::ios::binary );
+
+  if( !os )
+    {
+    itkExceptionMacro("Could not open " << this->m_FileName << " for writing");
+    }
+
+  this->WriteHeader( os, elementType, compressedDataSize, dataFileName );
+
+  std::ofstream dataStream;
+
+  if( dataFileName != "LOCAL" )
+    {
+    os.close();
+
+    dataStream.open( dataFilePath.c_str(), std::ios::out | std::ios::binary );
+    if( !dataStream )
+      {
+      itkExceptionMacro("Could not open " << dataFilePath << " for writing");
+      }
+    }
+
+  std::ostream & ds = ( dataFileName != "LOCAL" ) ? static_cast< std::ostream & >( dataStream ) : os;
+
+  // zlib header, with the compression level hint of the chunks
+  const int level = ( this->m_CompressionLevel < 0 ) ? 6 : this->m_CompressionLevel;
+  const unsigned int levelFlags = ( level < 2 ) ? 0 : ( level < 6 ) ? 1 : ( level == 6 ) ? 2 : 3;
+  unsigned char header[2];
+  header[0] = 0x78;
+  header[1] = static_cast< unsigned char >( levelFlags << 6 );
+  header[1] += static_cast< unsigned char >( ( 31 - ( header[0] * 256 + header[1] ) % 31 ) % 31 );
+
+  ds.write( reinterpret_cast< const char * >( header ), 2 );
+
+  for( SizeValueType i = 0; i < this->m_NumberOfChunks; i++ )
+    {
+    if( !this->m_CompressedChunks[i].empty() )
+      {
+      ds.write( reinterpret_cast< const char * >( &this->m_CompressedChunks[i][0] ),
+                this->m_CompressedChunks[i].size() );
+      }
+    }
+
+  unsigned char trailer[4];
+  for( unsigned int b = 0; b < 4; b++ )
+    {
+    trailer[b] = static_cast< unsigned char >( ( checksum >> ( 24 - 8 * b ) ) & 0xff );
+    }
+  ds.write( reinterpret_cast< const char * >( trailer ), 4 );
+
+  //
+  // Chunk table, after the compressed data
+  //
+  std::vector< uint64_t > table;
+  for( SizeValueType i = 0; i < this->m_NumberOfChunks; i++ )
+    {
+    table.push_back( this->m_CompressedChunks[i].size() );
+    }
+  table.push_back( this->m_ChunkLength );
+  table.push_back( this->m_NumberOfChunks );
+
+  ByteSwapper< uint64_t >::SwapWriteRangeFromSystemToLittleEndian(
+    &table[0], static_cast< int >( table.size() ), &ds );
+
+  ds.write( GetChunkTableSignature(), 8 );
+
+  std::vector< std::vector< unsigned char > >().swap( this->m_CompressedChunks );
+
+  if( dataFileName != "LOCAL" )
+    {
+    dataStream.close();
+    }
+  else
+    {
+    os.close();
+    }
+
+  if( os.fail() || dataStream.fail() )
+    {
+    itkExceptionMacro("Could not write " << this->m_FileName );
+    }
+}
+
+
+template <class TInputImage>
+void
+ChunkedCompressionMetaImageWriter<TInputImage>
+::WriteHeader( std::ostream & os, const std::string & elementType,
+               uint64_t compressedDataSize, const std::string & dataFileName ) const
+{
+  const InputImageType * input = this->GetInput();
+
+  const unsigned int dimension = InputImageType::ImageDimension;
+
+  const InputImageRegionType region = input->GetBufferedRegion();
+
+  typename InputImageType::PointType origin;
+  input->TransformIndexToPhysicalPoint( region.GetIndex(), origin );
+
+  const typename InputImageType::DirectionType & direction = input->GetDirection();
+
+  os << "ObjectType = Image\n";
+  os << "NDims = " << dimension << "\n";
+  os << "BinaryData = True\n";
+  os << "BinaryDataByteOrderMSB = " << ( ByteSwapper< int >::SystemIsBigEndian() ? "True" : "False" ) << "\n";
+  os << "CompressedData = True\n";
+  os << "CompressedDataSize = " << compressedDataSize << "\n";
+
+  os << std::setprecision( 17 );
+
+  // The columns of the direction are the axes of the image
+  os << "TransformMatrix =";
+  for( unsigned int i = 0; i < dimension; i++ )
+    {
+    for( unsigned int j = 0; j < dimension; j++ )
+      {
+      os << " " << direction[j][i];
+      }
+    }
+  os << "\nOffset =";
+  for( unsigned int i = 0; i < dimension; i++ )
+    {
+    os << " " << origin[i];
+    }
+  os << "\nElementSpacing =";
+  for( unsigned int i = 0; i < dimension; i++ )
+    {
+    os << " " << input->GetSpacing()[i];
+    }
+  os << "\nDimSize =";
+  for( unsigned int i = 0; i < dimension; i++ )
+    {
+    os << " " << region.GetSize()[i];
+    }
+  os << "\nElementType = " << elementType;
+  os << "\nElementDataFile = " << dataFileName << "\n";
+}
+
+
+template <class TInputImage>
+ITK_THREAD_RETURN_TYPE
+ChunkedCompressionMetaImageWriter<TInputImage>
+::CompressChunksThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+
+  Self * writer = static_cast< Self * >( info->UserData );
+
+  try
+    {
+    writer->CompressChunks( info->ThreadID, info->NumberOfThreads );
+    }
+  catch( ExceptionObject & excp )
+    {
+    writer->m_ThreadErrors[info->ThreadID] = excp.GetDescription();
+    }
+  catch( std::exception & excp )
+    {
+    writer->m_ThreadErrors[info->ThreadID] = excp.what();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * Each chunk is deflated without zlib header, and all but the last end
+ * with a full flush: they end on a byte boundary and the next chunk does
+ * not refer to them.
+ */
+template <class TInputImage>
+void
+ChunkedCompressionMetaImageWriter<TInputImage>
+::CompressChunks( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  for( SizeValueType i = threadId; i < this->m_NumberOfChunks; i += numberOfThreads )
+    {
+    const SizeValueType chunkBegin = i * this->m_ChunkLength;
+    const SizeValueType chunkLength = vnl_math_min( this->m_ChunkLength, this->m_BufferLength - chunkBegin );
+    const bool lastChunk = ( i + 1 == this->m_NumberOfChunks );
+
+    Bytef * chunk = const_cast< Bytef * >( this->m_Buffer + chunkBegin );
+
+    this->m_ChunkChecksums[i] = adler32( adler32( 0L, Z_NULL, 0 ), chunk, static_cast< uInt >( chunkLength ) );
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    if( deflateInit2( &stream, this->m_CompressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+      {
+      itkExceptionMacro("Could not initialize the compression of chunk " << i );
+      }
+
+    std::vector< unsigned char > & compressedChunk = this->m_CompressedChunks[i];
+    compressedChunk.resize( deflateBound( &stream, static_cast< uLong >( chunkLength ) ) + 16 );
+
+    stream.next_in = chunk;
+    stream.avail_in = static_cast< uInt >( chunkLength );
+
+    const int flush = lastChunk ? Z_FINISH : Z_FULL_FLUSH;
+
+    int status = Z_OK;
+
+    do
+      {
+      if( stream.total_out == compressedChunk.size() )
+        {
+        compressedChunk.resize( 2 * compressedChunk.size() );
+        }
+      stream.next_out = &compressedChunk[stream.total_out];
+      stream.avail_out = static_cast< uInt >( compressedChunk.size() - stream.total_out );
+
+      status = deflate( &stream, flush );
+      }
+    while( status == Z_OK && ( stream.avail_out == 0 || lastChunk ) );
+
+    compressedChunk.resize( stream.total_out );
+
+    deflateEnd( &stream );
+
+    if( status != ( lastChunk ? Z_STREAM_END : Z_OK ) || stream.avail_in != 0 )
+      {
+      itkExceptionMacro("Could not compress chunk " << i );
+      }
+    }
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TInputImage>
+void
+ChunkedCompressionMetaImageWriter<TInputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "File name: " << this->m_FileName << std::endl;
+  os << indent << "Use compression: " << this->m_UseCompression << std::endl;
+  os << indent << "Chunk size: " << this->m_ChunkSize << std::endl;
+  os << indent << "Compression level: " << this->m_CompressionLevel << std::endl;
+  os << indent << "Number of chunks: " << this->m_NumberOfChunks << std::endl;
+}
+
+} // end namespace itk
+
+#endif
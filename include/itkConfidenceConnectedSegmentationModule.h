@@ -18,15 +18,20 @@
 #define __itkConfidenceConnectedSegmentationModule_h
 
 #include "itkRegionGrowingSegmentationModule.h"
-#include "itkConfidenceConnectedImageFilter.h"
+#include "itkScanlineFloodFillImageFilter.h"
 
 namespace itk
 {
 
 /** \class ConfidenceConnectedSegmentationModule
- * \brief This class applies the connected threshold region growing
+ * \brief This class applies the confidence connected region growing
  * segmentation method.
  *
+ * The region is filled by ScanlineFloodFillImageFilter. Its mean and
+ * variance are updated with the pixels added at each iteration, and an
+ * iteration whose interval only widens grows the region from its border
+ * instead of filling it again from the seeds.
+ *
  * SpatialObjects are used as inputs and outputs of this class.
  *
  * \ingroup SpatialObjectFilters
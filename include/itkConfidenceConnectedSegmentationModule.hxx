@@ -65,7 +65,7 @@ void
 ConfidenceConnectedSegmentationModule<NDimension>
 ::GenerateData()
 {
-  typedef ConfidenceConnectedImageFilter<
+  typedef ScanlineFloodFillImageFilter<
     FeatureImageType, OutputImageType >           FilterType;
 
   typename FilterType::Pointer filter = FilterType::New();
@@ -93,6 +93,7 @@ ConfidenceConnectedSegmentationModule<NDimension>
     filter->AddSeed( index );
     }
 
+  filter->UseConfidenceThresholdsOn();
   filter->SetMultiplier( this->m_SigmaMultiplier );
 
   filter->SetReplaceValue( 1.0 );
@@ -18,7 +18,7 @@
 #define __itkConnectedThresholdSegmentationModule_h
 
 #include "itkRegionGrowingSegmentationModule.h"
-#include "itkConnectedThresholdImageFilter.h"
+#include "itkScanlineFloodFillImageFilter.h"
 
 namespace itk
 {
@@ -27,6 +27,9 @@ namespace itk
  * \brief This class applies the connected threshold region growing
  * segmentation method.
  *
+ * The region is filled by ScanlineFloodFillImageFilter, which splits the
+ * image in slabs filled in parallel.
+ *
  * SpatialObjects are used as inputs and outputs of this class.
  *
  * \ingroup SpatialObjectFilters
@@ -65,7 +65,7 @@ void
 ConnectedThresholdSegmentationModule<NDimension>
 ::GenerateData()
 {
-  typedef ConnectedThresholdImageFilter<
+  typedef ScanlineFloodFillImageFilter<
     FeatureImageType, OutputImageType >           FilterType;
 
   typename FilterType::Pointer filter = FilterType::New();
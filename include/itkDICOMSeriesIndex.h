@@ -0,0 +1,165 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkDICOMSeriesIndex.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkDICOMSeriesIndex_h
+#define __itkDICOMSeriesIndex_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkDICOMSeriesRegionReader.h"
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class DICOMSeriesIndex
+ * \brief Index of the DICOM series of a directory, kept in a file.
+ *
+ * The first time a directory is indexed, its series are found with
+ * GDCMSeriesFileNames. The first time the reader of a series is asked for,
+ * the headers of its files are read and sorted by DICOMSeriesRegionReader.
+ * The series, their sorted files, the geometry and the headers of the slices
+ * are saved in the index file, along with the modification times of the
+ * directory and of the files.
+ *
+ * As long as these modification times do not change, the directory is
+ * neither scanned nor are the headers read again: the readers of the series
+ * are set up from the index file. Since modification times only count
+ * seconds, an index file is out of date when the directory was modified in
+ * the second it was scanned.
+ *
+ * The index file is in the directory by default. When it cannot be written,
+ * the index is only kept in memory.
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TOutputImage>
+class ITK_EXPORT DICOMSeriesIndex : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef DICOMSeriesIndex               Self;
+  typedef Object                         Superclass;
+  typedef SmartPointer<Self>             Pointer;
+  typedef SmartPointer<const Self>       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DICOMSeriesIndex, Object);
+
+  /** Reader of the series. */
+  typedef DICOMSeriesRegionReader< TOutputImage >     ReaderType;
+  typedef typename ReaderType::Pointer                ReaderPointer;
+  typedef typename ReaderType::FileNamesContainer     FileNamesContainer;
+  typedef typename ReaderType::DictionaryArrayType    DictionaryArrayType;
+  typedef typename ReaderType::SizeType               SizeType;
+  typedef typename ReaderType::SpacingType            SpacingType;
+  typedef typename ReaderType::PointType              PointType;
+  typedef typename ReaderType::DirectionType          DirectionType;
+
+  typedef std::vector< std::string >                  SeriesUIDContainer;
+
+  /** Directory of the series. */
+  itkSetStringMacro( Directory );
+  itkGetStringMacro( Directory );
+
+  /** File of the index. Defaults to DefaultIndexFileName in the
+   * directory. */
+  itkSetStringMacro( IndexFileName );
+  itkGetStringMacro( IndexFileName );
+
+  /** Tags that tell apart the series, as in GDCMSeriesFileNames. */
+  void AddSeriesRestriction( const std::string & tag );
+
+  /** Loads the index file, or scans the directory when the index file is
+   * missing or out of date. */
+  void Update();
+
+  /** Series of the directory. */
+  const SeriesUIDContainer & GetSeriesUIDs() const;
+
+  /** Reader of a series, with its output information up to date. The
+   * headers of the files are only read when the index does not hold them
+   * yet, and the index file is then saved. */
+  ReaderPointer GetSeriesReader( const std::string & seriesUID );
+
+  /** Whether the last update loaded the index file. */
+  itkGetConstMacro( IndexFileWasLoaded, bool );
+
+  /** Name of the index file in the directory. */
+  static const char * GetDefaultIndexFileName();
+
+protected:
+  DICOMSeriesIndex();
+  virtual ~DICOMSeriesIndex();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  DICOMSeriesIndex(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** Files of a series. Once the headers are read, the files are sorted and
+   * the geometry and headers of the slices are set. */
+  struct SeriesEntry
+    {
+    FileNamesContainer        FileNames;
+    std::vector< long >       FileModifiedTimes;
+    bool                      HasHeaders;
+    DictionaryArrayType       SliceDictionaries;
+    SizeType                  Size;
+    SpacingType               Spacing;
+    PointType                 Origin;
+    DirectionType             Direction;
+    };
+
+  typedef std::map< std::string, SeriesEntry >  SeriesMapType;
+
+  std::string GetIndexFilePath() const;
+
+  void ScanDirectory();
+  bool ReadIndexFile();
+  void WriteIndexFile();
+  void WriteIndex( std::ostream & os ) const;
+
+  static std::string Escape( const std::string & value );
+  static std::string Unescape( const std::string & value );
+
+  std::string                           m_Directory;
+  std::string                           m_IndexFileName;
+  std::vector< std::string >            m_SeriesRestrictions;
+
+  long                                  m_DirectoryModifiedTime;
+  long                                  m_ScanStartTime;
+  SeriesUIDContainer                    m_SeriesUIDs;
+  SeriesMapType                         m_Series;
+
+  bool                                  m_IndexFileWasLoaded;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkDICOMSeriesIndex.hxx"
+#endif
+
+#endif
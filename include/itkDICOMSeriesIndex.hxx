@@ -0,0 +1,560 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkDICOMSeriesIndex.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkDICOMSeriesIndex_hxx
+#define __itkDICOMSeriesIndex_hxx
+
+#include "itkDICOMSeriesIndex.h"
+#include "itkGDCMSeriesFileNames.h"
+#include "itkMetaDataObject.h"
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+#include <iomanip>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TOutputImage>
+DICOMSeriesIndex<TOutputImage>
+::DICOMSeriesIndex()
+{
+  this->m_DirectoryModifiedTime = 0;
+  this->m_ScanStartTime = 0;
+  this->m_IndexFileWasLoaded = false;
+}
+
+
+/**
+ * Destructor
+ */
+template <class TOutputImage>
+DICOMSeriesIndex<TOutputImage>
+::~DICOMSeriesIndex()
+{
+}
+
+
+template <class TOutputImage>
+const char *
+DICOMSeriesIndex<TOutputImage>
+::GetDefaultIndexFileName()
+{
+  return ".LesionSizingToolkitDICOMIndex";
+}
+
+
+template <class TOutputImage>
+void
+DICOMSeriesIndex<TOutputImage>
+::AddSeriesRestriction( const std::string & tag )
+{
+  this->m_SeriesRestrictions.push_back( tag );
+  this->Modified();
+}
+
+
+template <class TOutputImage>
+const typename DICOMSeriesIndex<TOutputImage>::SeriesUIDContainer &
+DICOMSeriesIndex<TOutputImage>
+::GetSeriesUIDs() const
+{
+  return this->m_SeriesUIDs;
+}
+
+
+template <class TOutputImage>
+std::string
+DICOMSeriesIndex<TOutputImage>
+::GetIndexFilePath() const
+{
+  if( !this->m_IndexFileName.empty() )
+    {
+    return this->m_IndexFileName;
+    }
+
+  return this->m_Directory + "/" + GetDefaultIndexFileName();
+}
+
+
+template <class TOutputImage>
+void
+DICOMSeriesIndex<TOutputImage>
+::Update()
+{
+  if( this->m_Directory.empty() )
+    {
+    itkExceptionMacro("No DICOM directory to index");
+    }
+
+  this->m_IndexFileWasLoaded = this->ReadIndexFile();
+
+  if( !this->m_IndexFileWasLoaded )
+    {
+    this->ScanDirectory();
+    this->WriteIndexFile();
+    }
+}
+
+
+/**
+ * Creating the index file in the directory changes the modification time
+ * of the directory, so the file is created, or emptied, before that time is
+ * recorded and the directory is scanned. The file is then emptied again, and
+ * its modification time tells the second of the scan on the clock of the
+ * file system.
+ */
+template <class TOutputImage>
+void
+DICOMSeriesIndex<TOutputImage>
+::ScanDirectory()
+{
+  const std::string indexFilePath = this->GetIndexFilePath();
+
+  std::ofstream os( indexFilePath.c_str() );
+  os.close();
+
+  this->m_DirectoryModifiedTime = itksys::SystemTools::ModifiedTime( this->m_Directory.c_str() );
+
+  os.open( indexFilePath.c_str() );
+  os.close();
+
+  this->m_ScanStartTime = itksys::SystemTools::ModifiedTime( indexFilePath.c_str() );
+  this->m_SeriesUIDs.clear();
+  this->m_Series.clear();
+
+  GDCMSeriesFileNames::Pointer nameGenerator = GDCMSeriesFileNames::New();
+
+  nameGenerator->SetUseSeriesDetails( true );
+  for( unsigned int r = 0; r < this->m_SeriesRestrictions.size(); r++ )
+    {
+    nameGenerator->AddSeriesRestriction( this->m_SeriesRestrictions[r] );
+    }
+  nameGenerator->SetDirectory( this->m_Directory );
+
+  this->m_SeriesUIDs = nameGenerator->GetSeriesUIDs();
+
+  for( unsigned int i = 0; i < this->m_SeriesUIDs.size(); i++ )
+    {
+    SeriesEntry & entry = this->m_Series[ this->m_SeriesUIDs[i] ];
+
+    entry.FileNames = nameGenerator->GetFileNames( this->m_SeriesUIDs[i] );
+    entry.FileModifiedTimes.resize( entry.FileNames.size() );
+    for( unsigned int f = 0; f < entry.FileNames.size(); f++ )
+      {
+      entry.FileModifiedTimes[f] = itksys::SystemTools::ModifiedTime( entry.FileNames[f].c_str() );
+      }
+    entry.HasHeaders = false;
+    }
+}
+
+
+template <class TOutputImage>
+typename DICOMSeriesIndex<TOutputImage>::ReaderPointer
+DICOMSeriesIndex<TOutputImage>
+::GetSeriesReader( const std::string & seriesUID )
+{
+  typename SeriesMapType::iterator seriesItr = this->m_Series.find( seriesUID );
+
+  if( seriesItr == this->m_Series.end() )
+    {
+    itkExceptionMacro("The series " << seriesUID << " is not in " << this->m_Directory);
+    }
+
+  SeriesEntry & entry = seriesItr->second;
+
+  ReaderPointer reader = ReaderType::New();
+
+  if( entry.HasHeaders )
+    {
+    reader->SetSeriesInformation( entry.FileNames, entry.SliceDictionaries,
+      entry.Size, entry.Spacing, entry.Origin, entry.Direction );
+    reader->UpdateOutputInformation();
+    return reader;
+    }
+
+  reader->SetFileNames( entry.FileNames );
+  reader->UpdateOutputInformation();
+
+  std::map< std::string, long > fileModifiedTimes;
+  for( unsigned int f = 0; f < entry.FileNames.size(); f++ )
+    {
+    fileModifiedTimes[ entry.FileNames[f] ] = entry.FileModifiedTimes[f];
+    }
+
+  entry.FileNames = reader->GetSortedFileNames();
+  entry.SliceDictionaries.resize( entry.FileNames.size() );
+  for( unsigned int s = 0; s < entry.FileNames.size(); s++ )
+    {
+    entry.FileModifiedTimes[s] = fileModifiedTimes[ entry.FileNames[s] ];
+    entry.SliceDictionaries[s] = reader->GetSliceMetaDataDictionary( s );
+    }
+
+  const TOutputImage * output = reader->GetOutput();
+  entry.Size = output->GetLargestPossibleRegion().GetSize();
+  entry.Spacing = output->GetSpacing();
+  entry.Origin = output->GetOrigin();
+  entry.Direction = output->GetDirection();
+  entry.HasHeaders = true;
+
+  this->WriteIndexFile();
+
+  return reader;
+}
+
+
+/**
+ * The index file is only used when it was written for the same series
+ * restrictions, and when neither the directory nor any of the indexed
+ * files have been modified since. Modification times only count seconds,
+ * so the directory must also have been modified before the second of the
+ * scan: a file added in that second may have been missed.
+ */
+template <class TOutputImage>
+bool
+DICOMSeriesIndex<TOutputImage>
+::ReadIndexFile()
+{
+  std::ifstream is( this->GetIndexFilePath().c_str() );
+  if( !is )
+    {
+    return false;
+    }
+
+  std::string line;
+  std::string keyword;
+  unsigned int count = 0;
+
+  std::getline( is, line );
+  if( line != "LesionSizingToolkit DICOM series index 2" )
+    {
+    return false;
+    }
+
+  long directoryModifiedTime = 0;
+  long scanStartTime = 0;
+  is >> keyword >> directoryModifiedTime >> scanStartTime;
+  if( !is || keyword != "directory" || directoryModifiedTime >= scanStartTime ||
+      directoryModifiedTime != itksys::SystemTools::ModifiedTime( this->m_Directory.c_str() ) )
+    {
+    return false;
+    }
+
+  is >> keyword >> count;
+  std::getline( is, line );
+  if( !is || keyword != "restrictions" || count != this->m_SeriesRestrictions.size() )
+    {
+    return false;
+    }
+  for( unsigned int r = 0; r < count; r++ )
+    {
+    std::getline( is, line );
+    if( Unescape( line ) != this->m_SeriesRestrictions[r] )
+      {
+      return false;
+      }
+    }
+
+  unsigned int numberOfSeries = 0;
+  is >> keyword >> numberOfSeries;
+  std::getline( is, line );
+  if( !is || keyword != "series" )
+    {
+    return false;
+    }
+
+  SeriesUIDContainer seriesUIDs( numberOfSeries );
+  SeriesMapType series;
+
+  for( unsigned int i = 0; i < numberOfSeries; i++ )
+    {
+    std::getline( is, line );
+    if( line.compare( 0, 4, "uid " ) != 0 )
+      {
+      return false;
+      }
+    seriesUIDs[i] = Unescape( line.substr( 4 ) );
+
+    SeriesEntry & entry = series[ seriesUIDs[i] ];
+
+    is >> keyword >> count;
+    std::getline( is, line );
+    if( !is || keyword != "files" )
+      {
+      return false;
+      }
+
+    entry.FileNames.resize( count );
+    entry.FileModifiedTimes.resize( count );
+    for( unsigned int f = 0; f < count; f++ )
+      {
+      is >> entry.FileModifiedTimes[f];
+      is.get();
+      std::getline( is, line );
+      entry.FileNames[f] = Unescape( line );
+
+      if( !is || entry.FileModifiedTimes[f] !=
+          itksys::SystemTools::ModifiedTime( entry.FileNames[f].c_str() ) )
+        {
+        return false;
+        }
+      }
+
+    is >> keyword >> entry.HasHeaders;
+    if( !is || keyword != "headers" )
+      {
+      return false;
+      }
+
+    if( !entry.HasHeaders )
+      {
+      std::getline( is, line );
+      continue;
+      }
+
+    is >> keyword;
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      is >> entry.Size[d];
+      }
+    is >> keyword;
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      is >> entry.Spacing[d];
+      }
+    is >> keyword;
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      is >> entry.Origin[d];
+      }
+    is >> keyword;
+    for( unsigned int r = 0; r < 3; r++ )
+      {
+      for( unsigned int c = 0; c < 3; c++ )
+        {
+        is >> entry.Direction[r][c];
+        }
+      }
+    std::getline( is, line );
+    if( !is || keyword != "direction" )
+      {
+      return false;
+      }
+
+    entry.SliceDictionaries.resize( entry.FileNames.size() );
+    for( unsigned int s = 0; s < entry.FileNames.size(); s++ )
+      {
+      is >> keyword >> count;
+      std::getline( is, line );
+      if( !is || keyword != "slice" )
+        {
+        return false;
+        }
+
+      for( unsigned int e = 0; e < count; e++ )
+        {
+        std::getline( is, line );
+        const std::string::size_type tab = line.find( '\t' );
+        if( tab == std::string::npos )
+          {
+          return false;
+          }
+        EncapsulateMetaData< std::string >( entry.SliceDictionaries[s],
+          Unescape( line.substr( 0, tab ) ), Unescape( line.substr( tab + 1 ) ) );
+        }
+      }
+    }
+
+  if( !is )
+    {
+    return false;
+    }
+
+  this->m_DirectoryModifiedTime = directoryModifiedTime;
+  this->m_ScanStartTime = scanStartTime;
+  this->m_SeriesUIDs = seriesUIDs;
+  this->m_Series = series;
+
+  return true;
+}
+
+
+/**
+ * The index file was created by the scan, so writing over it does not
+ * change the modification time of the directory.
+ */
+template <class TOutputImage>
+void
+DICOMSeriesIndex<TOutputImage>
+::WriteIndexFile()
+{
+  const std::string indexFilePath = this->GetIndexFilePath();
+
+  std::ofstream os( indexFilePath.c_str() );
+  if( !os )
+    {
+    itkWarningMacro("Cannot write the index file " << indexFilePath);
+    return;
+    }
+
+  this->WriteIndex( os );
+}
+
+
+template <class TOutputImage>
+void
+DICOMSeriesIndex<TOutputImage>
+::WriteIndex( std::ostream & os ) const
+{
+  os << "LesionSizingToolkit DICOM series index 2" << std::endl;
+  os << "directory " << this->m_DirectoryModifiedTime << " " << this->m_ScanStartTime << std::endl;
+
+  os << "restrictions " << this->m_SeriesRestrictions.size() << std::endl;
+  for( unsigned int r = 0; r < this->m_SeriesRestrictions.size(); r++ )
+    {
+    os << Escape( this->m_SeriesRestrictions[r] ) << std::endl;
+    }
+
+  os << std::setprecision( 17 );
+  os << "series " << this->m_SeriesUIDs.size() << std::endl;
+
+  for( unsigned int i = 0; i < this->m_SeriesUIDs.size(); i++ )
+    {
+    const SeriesEntry & entry = this->m_Series.find( this->m_SeriesUIDs[i] )->second;
+
+    os << "uid " << Escape( this->m_SeriesUIDs[i] ) << std::endl;
+
+    os << "files " << entry.FileNames.size() << std::endl;
+    for( unsigned int f = 0; f < entry.FileNames.size(); f++ )
+      {
+      os << entry.FileModifiedTimes[f] << " " << Escape( entry.FileNames[f] ) << std::endl;
+      }
+
+    os << "headers " << entry.HasHeaders << std::endl;
+    if( !entry.HasHeaders )
+      {
+      continue;
+      }
+
+    os << "size " << entry.Size[0] << " " << entry.Size[1] << " " << entry.Size[2] << std::endl;
+    os << "spacing " << entry.Spacing[0] << " " << entry.Spacing[1] << " " << entry.Spacing[2] << std::endl;
+    os << "origin " << entry.Origin[0] << " " << entry.Origin[1] << " " << entry.Origin[2] << std::endl;
+    os << "direction";
+    for( unsigned int r = 0; r < 3; r++ )
+      {
+      for( unsigned int c = 0; c < 3; c++ )
+        {
+        os << " " << entry.Direction[r][c];
+        }
+      }
+    os << std::endl;
+
+    for( unsigned int s = 0; s < entry.SliceDictionaries.size(); s++ )
+      {
+      const MetaDataDictionary & dictionary = entry.SliceDictionaries[s];
+      const std::vector< std::string > keys = dictionary.GetKeys();
+
+      os << "slice " << keys.size() << std::endl;
+      for( unsigned int k = 0; k < keys.size(); k++ )
+        {
+        std::string value;
+        ExposeMetaData< std::string >( dictionary, keys[k], value );
+        os << Escape( keys[k] ) << "\t" << Escape( value ) << std::endl;
+        }
+      }
+    }
+}
+
+
+/**
+ * The names and values are kept on a line each, and apart from the tab
+ * that separates them.
+ */
+template <class TOutputImage>
+std::string
+DICOMSeriesIndex<TOutputImage>
+::Escape( const std::string & value )
+{
+  std::string escaped;
+  escaped.reserve( value.size() );
+
+  for( std::string::size_type i = 0; i < value.size(); i++ )
+    {
+    switch( value[i] )
+      {
+      case '\\': escaped += "\\\\"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\r': escaped += "\\r"; break;
+      case '\t': escaped += "\\t"; break;
+      default: escaped += value[i];
+      }
+    }
+
+  return escaped;
+}
+
+
+template <class TOutputImage>
+std::string
+DICOMSeriesIndex<TOutputImage>
+::Unescape( const std::string & value )
+{
+  std::string unescaped;
+  unescaped.reserve( value.size() );
+
+  for( std::string::size_type i = 0; i < value.size(); i++ )
+    {
+    if( value[i] != '\\' || i + 1 == value.size() )
+      {
+      unescaped += value[i];
+      continue;
+      }
+
+    switch( value[++i] )
+      {
+      case 'n': unescaped += '\n'; break;
+      case 'r': unescaped += '\r'; break;
+      case 't': unescaped += '\t'; break;
+      default: unescaped += value[i];
+      }
+    }
+
+  return unescaped;
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TOutputImage>
+void
+DICOMSeriesIndex<TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Directory: " << this->m_Directory << std::endl;
+  os << indent << "Index file: " << this->GetIndexFilePath() << std::endl;
+  os << indent << "Number of series restrictions: " << this->m_SeriesRestrictions.size() << std::endl;
+  os << indent << "Number of series: " << this->m_SeriesUIDs.size() << std::endl;
+  os << indent << "Index file was loaded: " << this->m_IndexFileWasLoaded << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,166 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkDICOMSeriesRegionReader.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkDICOMSeriesRegionReader_h
+#define __itkDICOMSeriesRegionReader_h
+
+#include "itkImageSource.h"
+#include "itkMetaDataDictionary.h"
+#include "itkMultiThreader.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class DICOMSeriesRegionReader
+ * \brief Reads the slices of a DICOM series that the requested region covers.
+ *
+ * The files are sorted by their position along the normal of the slices,
+ * and the geometry of the volume is computed, from the headers of the files
+ * only: the pixel data is neither read nor decoded when the output
+ * information is updated. The pixels are then decoded only for the slices
+ * of the requested region of the output, which is enlarged to whole slices.
+ * The largest possible region is the whole series, so that the indices and
+ * the physical points of the output do not depend on the slices read.
+ *
+ * The slices are decoded concurrently, each thread writing its slices at
+ * their offset in the output buffer, so that compressed transfer syntaxes
+ * are decoded on all the threads of the reader.
+ *
+ * The header of every slice is kept as a meta data dictionary, in the
+ * order of the slices, with the keys of GDCMImageIO.
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TOutputImage>
+class ITK_EXPORT DICOMSeriesRegionReader : public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef DICOMSeriesRegionReader        Self;
+  typedef ImageSource< TOutputImage >    Superclass;
+  typedef SmartPointer<Self>             Pointer;
+  typedef SmartPointer<const Self>       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DICOMSeriesRegionReader, ImageSource);
+
+  /** Dimension of the output image. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Output image typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputImagePixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename SizeType::SizeValueType            SizeValueType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::PointType         PointType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+
+  typedef std::vector< std::string >                  FileNamesContainer;
+  typedef std::vector< MetaDataDictionary >           DictionaryArrayType;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(ThreeDimensionalCheck,
+    (Concept::SameDimension<ImageDimension, 3>));
+  /** End concept checking */
+#endif
+
+  /** Files of the series, in any order. */
+  void SetFileNames( const FileNamesContainer & fileNames );
+  const FileNamesContainer & GetFileNames() const;
+
+  /** Files of the series, sorted by slice position. Valid once the output
+   * information has been updated. */
+  const FileNamesContainer & GetSortedFileNames() const;
+
+  /** Header of a slice, in the order of the slices. Valid once the output
+   * information has been updated. */
+  const MetaDataDictionary & GetSliceMetaDataDictionary( unsigned int slice ) const;
+
+  /** Sorted files, geometry and headers of a series, as computed by an
+   * earlier reader and kept by DICOMSeriesIndex. The headers of the files
+   * are then not read again. */
+  void SetSeriesInformation( const FileNamesContainer & sortedFileNames,
+                             const DictionaryArrayType & sliceDictionaries,
+                             const SizeType & size,
+                             const SpacingType & spacing,
+                             const PointType & origin,
+                             const DirectionType & direction );
+
+  /** Number of slices of the series. */
+  unsigned int GetNumberOfSlices() const;
+
+  /** Number of slices decoded by the last update. */
+  itkGetConstMacro( NumberOfSlicesRead, unsigned int );
+
+protected:
+  DICOMSeriesRegionReader();
+  virtual ~DICOMSeriesRegionReader();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Sorts the files and computes the geometry from their headers. The
+   * headers are only read again when the file names change. */
+  virtual void GenerateOutputInformation();
+
+  /** The slices are decoded whole. */
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Decodes the slices of the requested region, on several threads. */
+  virtual void GenerateData();
+
+  /** Decodes the slices of a thread into the output buffer. */
+  void ReadSlices( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  static ITK_THREAD_RETURN_TYPE ReadSlicesThreaderCallback( void * arg );
+
+private:
+  DICOMSeriesRegionReader(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  void ReadHeaders();
+
+  FileNamesContainer                    m_FileNames;
+  FileNamesContainer                    m_SortedFileNames;
+  DictionaryArrayType                   m_SliceMetaDataDictionaries;
+
+  SizeType                              m_Size;
+  SpacingType                           m_Spacing;
+  PointType                             m_Origin;
+  DirectionType                         m_Direction;
+  TimeStamp                             m_HeadersReadTime;
+
+  unsigned int                          m_NumberOfSlicesRead;
+
+  std::vector< std::string >            m_ThreadErrors;
+  std::vector< unsigned int >           m_ThreadNumberOfSlicesRead;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkDICOMSeriesRegionReader.hxx"
+#endif
+
+#endif
@@ -0,0 +1,507 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkDICOMSeriesRegionReader.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkDICOMSeriesRegionReader_hxx
+#define __itkDICOMSeriesRegionReader_hxx
+
+#include "itkDICOMSeriesRegionReader.h"
+#include "itkImageFileReader.h"
+#include "itkGDCMImageIO.h"
+#include "itkMetaDataObject.h"
+#include "itkProcessObject.h"
+#include "vnl/vnl_math.h"
+
+#include "gdcmReader.h"
+#include "gdcmImageHelper.h"
+#include "gdcmStringFilter.h"
+#include "gdcmDataSetHelper.h"
+
+#include <algorithm>
+#include <set>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TOutputImage>
+DICOMSeriesRegionReader<TOutputImage>
+::DICOMSeriesRegionReader()
+{
+  this->m_Size.Fill( 0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+  this->m_NumberOfSlicesRead = 0;
+}
+
+
+/**
+ * Destructor
+ */
+template <class TOutputImage>
+DICOMSeriesRegionReader<TOutputImage>
+::~DICOMSeriesRegionReader()
+{
+}
+
+
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::SetFileNames( const FileNamesContainer & fileNames )
+{
+  this->m_FileNames = fileNames;
+  this->Modified();
+}
+
+
+template <class TOutputImage>
+const typename DICOMSeriesRegionReader<TOutputImage>::FileNamesContainer &
+DICOMSeriesRegionReader<TOutputImage>
+::GetFileNames() const
+{
+  return this->m_FileNames;
+}
+
+
+template <class TOutputImage>
+const typename DICOMSeriesRegionReader<TOutputImage>::FileNamesContainer &
+DICOMSeriesRegionReader<TOutputImage>
+::GetSortedFileNames() const
+{
+  return this->m_SortedFileNames;
+}
+
+
+template <class TOutputImage>
+const MetaDataDictionary &
+DICOMSeriesRegionReader<TOutputImage>
+::GetSliceMetaDataDictionary( unsigned int slice ) const
+{
+  if( slice >= this->m_SliceMetaDataDictionaries.size() )
+    {
+    itkExceptionMacro("Slice " << slice << " is out of the "
+                      << this->m_SliceMetaDataDictionaries.size() << " slices read");
+    }
+
+  return this->m_SliceMetaDataDictionaries[slice];
+}
+
+
+/**
+ * The headers are marked as read after the modification of the reader, so
+ * that GenerateOutputInformation() does not read them again.
+ */
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::SetSeriesInformation( const FileNamesContainer & sortedFileNames,
+                        const DictionaryArrayType & sliceDictionaries,
+                        const SizeType & size,
+                        const SpacingType & spacing,
+                        const PointType & origin,
+                        const DirectionType & direction )
+{
+  if( sortedFileNames.empty() ||
+      sortedFileNames.size() != sliceDictionaries.size() ||
+      sortedFileNames.size() != size[2] )
+    {
+    itkExceptionMacro("The series information has " << sortedFileNames.size() << " files, "
+                      << sliceDictionaries.size() << " headers and " << size[2] << " slices");
+    }
+
+  this->m_FileNames = sortedFileNames;
+  this->m_SortedFileNames = sortedFileNames;
+  this->m_SliceMetaDataDictionaries = sliceDictionaries;
+  this->m_Size = size;
+  this->m_Spacing = spacing;
+  this->m_Origin = origin;
+  this->m_Direction = direction;
+
+  this->Modified();
+  this->m_HeadersReadTime.Modified();
+}
+
+
+template <class TOutputImage>
+unsigned int
+DICOMSeriesRegionReader<TOutputImage>
+::GetNumberOfSlices() const
+{
+  return static_cast< unsigned int >( this->m_SortedFileNames.size() );
+}
+
+
+/**
+ * The files are read up to their pixel data. The slices are sorted by the
+ * projection of their image position on the normal of the first slice. As
+ * in ImageSeriesReader, the last axis goes from the first slice to the last
+ * one, which differs from the normal for tilted gantries, and the spacing
+ * between the slices is the mean distance between them.
+ */
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::ReadHeaders()
+{
+  const unsigned int numberOfFiles = static_cast< unsigned int >( this->m_FileNames.size() );
+
+  if( numberOfFiles == 0 )
+    {
+    itkExceptionMacro("No DICOM file to read");
+    }
+
+  std::vector< PointType > origins( numberOfFiles );
+  std::vector< MetaDataDictionary > dictionaries( numberOfFiles );
+  std::vector< std::pair< double, unsigned int > > positions( numberOfFiles );
+
+  double normal[3] = { 0.0, 0.0, 1.0 };
+
+  std::set< gdcm::Tag > skipTags;
+  const gdcm::Tag pixelDataTag( 0x7fe0, 0x0010 );
+
+  for( unsigned int i = 0; i < numberOfFiles; i++ )
+    {
+    gdcm::Reader reader;
+    reader.SetFileName( this->m_FileNames[i].c_str() );
+    if( !reader.ReadUpToTag( pixelDataTag, skipTags ) )
+      {
+      itkExceptionMacro("Cannot read the header of " << this->m_FileNames[i]);
+      }
+
+    const gdcm::File & file = reader.GetFile();
+
+    const std::vector< unsigned int > dimensions = gdcm::ImageHelper::GetDimensionsValue( file );
+    const std::vector< double > origin = gdcm::ImageHelper::GetOriginValue( file );
+
+    if( dimensions.size() > 2 && dimensions[2] > 1 )
+      {
+      itkExceptionMacro("The file " << this->m_FileNames[i] << " holds more than one slice");
+      }
+
+    if( i == 0 )
+      {
+      const std::vector< double > spacing = gdcm::ImageHelper::GetSpacingValue( file );
+      const std::vector< double > cosines = gdcm::ImageHelper::GetDirectionCosinesValue( file );
+
+      normal[0] = cosines[1] * cosines[5] - cosines[2] * cosines[4];
+      normal[1] = cosines[2] * cosines[3] - cosines[0] * cosines[5];
+      normal[2] = cosines[0] * cosines[4] - cosines[1] * cosines[3];
+
+      for( unsigned int d = 0; d < 3; d++ )
+        {
+        this->m_Direction[d][0] = cosines[d];
+        this->m_Direction[d][1] = cosines[3 + d];
+        this->m_Direction[d][2] = normal[d];
+        }
+
+      this->m_Size[0] = dimensions[0];
+      this->m_Size[1] = dimensions[1];
+      this->m_Spacing[0] = spacing[0];
+      this->m_Spacing[1] = spacing[1];
+      this->m_Spacing[2] = ( spacing.size() > 2 && spacing[2] > 0.0 ) ? spacing[2] : 1.0;
+      }
+    else if( dimensions[0] != this->m_Size[0] || dimensions[1] != this->m_Size[1] )
+      {
+      itkExceptionMacro("The size of the slice " << this->m_FileNames[i]
+                        << " differs from the size of " << this->m_FileNames[0]);
+      }
+
+    double position = 0.0;
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      origins[i][d] = origin[d];
+      position += origin[d] * normal[d];
+      }
+    positions[i] = std::make_pair( position, i );
+
+    // Header entries with the keys of GDCMImageIO.
+    gdcm::StringFilter stringFilter;
+    stringFilter.SetFile( file );
+
+    const gdcm::DataSet & dataSet = file.GetDataSet();
+    for( gdcm::DataSet::ConstIterator it = dataSet.Begin(); it != dataSet.End(); ++it )
+      {
+      const gdcm::Tag & tag = it->GetTag();
+      const gdcm::VR vr = gdcm::DataSetHelper::ComputeVR( file, dataSet, tag );
+
+      if( tag.IsPrivate() || ( vr & ( gdcm::VR::SQ | gdcm::VR::OB | gdcm::VR::OW | gdcm::VR::UN ) ) )
+        {
+        continue;
+        }
+
+      EncapsulateMetaData< std::string >( dictionaries[i], tag.PrintAsPipeSeparatedString(),
+                                          stringFilter.ToStringPair( tag ).second );
+      }
+    }
+
+  std::sort( positions.begin(), positions.end() );
+
+  this->m_SortedFileNames.resize( numberOfFiles );
+  this->m_SliceMetaDataDictionaries.resize( numberOfFiles );
+
+  for( unsigned int s = 0; s < numberOfFiles; s++ )
+    {
+    const unsigned int i = positions[s].second;
+
+    if( s > 0 && positions[s].first == positions[s - 1].first )
+      {
+      itkExceptionMacro("The slices " << this->m_FileNames[positions[s - 1].second]
+                        << " and " << this->m_FileNames[i] << " share their position");
+      }
+
+    this->m_SortedFileNames[s] = this->m_FileNames[i];
+    this->m_SliceMetaDataDictionaries[s] = dictionaries[i];
+    }
+
+  this->m_Size[2] = numberOfFiles;
+  this->m_Origin = origins[ positions[0].second ];
+
+  if( numberOfFiles > 1 )
+    {
+    const typename PointType::VectorType sliceAxis =
+      origins[ positions[numberOfFiles - 1].second ] - this->m_Origin;
+    const double length = sliceAxis.GetNorm();
+
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      this->m_Direction[d][2] = sliceAxis[d] / length;
+      }
+    this->m_Spacing[2] = length / ( numberOfFiles - 1 );
+    }
+}
+
+
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::GenerateOutputInformation()
+{
+  OutputImageType * output = this->GetOutput();
+
+  if( this->m_HeadersReadTime < this->GetMTime() )
+    {
+    this->ReadHeaders();
+    this->m_HeadersReadTime.Modified();
+    }
+
+  OutputImageRegionType largestRegion;
+  largestRegion.SetSize( this->m_Size );
+
+  output->SetLargestPossibleRegion( largestRegion );
+  output->SetSpacing( this->m_Spacing );
+  output->SetOrigin( this->m_Origin );
+  output->SetDirection( this->m_Direction );
+  output->SetMetaDataDictionary( this->m_SliceMetaDataDictionaries[0] );
+}
+
+
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+
+  OutputImageType * image = dynamic_cast< OutputImageType * >( output );
+  if( !image )
+    {
+    return;
+    }
+
+  const OutputImageRegionType & largestRegion = image->GetLargestPossibleRegion();
+
+  OutputImageRegionType region = image->GetRequestedRegion();
+  for( unsigned int d = 0; d < 2; d++ )
+    {
+    region.SetIndex( d, largestRegion.GetIndex( d ) );
+    region.SetSize( d, largestRegion.GetSize( d ) );
+    }
+
+  image->SetRequestedRegion( region );
+}
+
+
+/**
+ * The slices are shared among the threads, and each thread decodes its
+ * slices straight into their place in the output buffer.
+ */
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::GenerateData()
+{
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  const SizeValueType numberOfSlices = output->GetBufferedRegion().GetSize( 2 );
+
+  const ThreadIdType numberOfThreads = static_cast< ThreadIdType >(
+    vnl_math_max( vnl_math_min( static_cast< SizeValueType >( this->GetNumberOfThreads() ), numberOfSlices ),
+                  static_cast< SizeValueType >( 1 ) ) );
+
+  this->m_ThreadErrors.assign( numberOfThreads, std::string() );
+  this->m_ThreadNumberOfSlicesRead.assign( numberOfThreads, 0 );
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->ReadSlicesThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  this->m_NumberOfSlicesRead = 0;
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    this->m_NumberOfSlicesRead += this->m_ThreadNumberOfSlicesRead[t];
+    }
+
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    if( !this->m_ThreadErrors[t].empty() )
+      {
+      itkExceptionMacro( << this->m_ThreadErrors[t] );
+      }
+    }
+
+  if( this->GetAbortGenerateData() )
+    {
+    ProcessAborted e( __FILE__, __LINE__ );
+    e.SetDescription( "Process aborted." );
+    e.SetLocation( ITK_LOCATION );
+    throw e;
+    }
+}
+
+
+template <class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+DICOMSeriesRegionReader<TOutputImage>
+::ReadSlicesThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+
+  Self * reader = static_cast< Self * >( info->UserData );
+
+  try
+    {
+    reader->ReadSlices( info->ThreadID, info->NumberOfThreads );
+    }
+  catch( ExceptionObject & excp )
+    {
+    reader->m_ThreadErrors[info->ThreadID] = excp.GetDescription();
+    }
+  catch( std::exception & excp )
+    {
+    reader->m_ThreadErrors[info->ThreadID] = excp.what();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * A slice whose pixels GDCMImageIO decodes to the pixel type of the output,
+ * after the rescaling to Hounsfield units, is read in place. Others go
+ * through ImageFileReader for the pixel conversion and are copied.
+ */
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::ReadSlices( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  OutputImageType * output = this->GetOutput();
+
+  const OutputImageRegionType & region = output->GetBufferedRegion();
+
+  const SizeValueType firstSlice = region.GetIndex( 2 );
+  const SizeValueType numberOfSlices = region.GetSize( 2 );
+  const SizeValueType numberOfSlicePixels = region.GetSize( 0 ) * region.GetSize( 1 );
+
+  const SizeValueType sliceBegin = numberOfSlices * threadId / numberOfThreads;
+  const SizeValueType sliceEnd = numberOfSlices * ( threadId + 1 ) / numberOfThreads;
+
+  typedef ImageFileReader< OutputImageType >  SliceReaderType;
+
+  GDCMImageIO::Pointer io = GDCMImageIO::New();
+
+  for( SizeValueType s = sliceBegin; s < sliceEnd; s++ )
+    {
+    if( this->GetAbortGenerateData() )
+      {
+      return;
+      }
+
+    const std::string & fileName = this->m_SortedFileNames[firstSlice + s];
+
+    OutputImagePixelType * sliceBuffer = output->GetBufferPointer() + s * numberOfSlicePixels;
+
+    io->SetFileName( fileName.c_str() );
+    io->ReadImageInformation();
+
+    if( io->GetImageSizeInPixels() != numberOfSlicePixels )
+      {
+      itkExceptionMacro("The slice " << fileName << " has " << io->GetImageSizeInPixels()
+                        << " pixels instead of " << numberOfSlicePixels);
+      }
+
+    if( io->GetComponentType() == ImageIOBase::MapPixelType< OutputImagePixelType >::CType &&
+        io->GetNumberOfComponents() == 1 )
+      {
+      io->Read( sliceBuffer );
+      }
+    else
+      {
+      typename SliceReaderType::Pointer sliceReader = SliceReaderType::New();
+      sliceReader->SetImageIO( GDCMImageIO::New() );
+      sliceReader->SetFileName( fileName );
+      sliceReader->Update();
+
+      const OutputImageType * slice = sliceReader->GetOutput();
+      std::copy( slice->GetBufferPointer(), slice->GetBufferPointer() + numberOfSlicePixels,
+                 sliceBuffer );
+      }
+
+    ++this->m_ThreadNumberOfSlicesRead[threadId];
+
+    if( threadId == 0 )
+      {
+      this->UpdateProgress( static_cast< float >( s + 1 - sliceBegin ) / ( sliceEnd - sliceBegin ) );
+      }
+    }
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TOutputImage>
+void
+DICOMSeriesRegionReader<TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Number of files: " << this->m_FileNames.size() << std::endl;
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "Number of slices read: " << this->m_NumberOfSlicesRead << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -17,7 +17,7 @@
 #ifndef __itkDescoteauxSheetnessImageFilter_h
 #define __itkDescoteauxSheetnessImageFilter_h
 
-#include "itkUnaryFunctorImageFilter.h"
+#include "itkEigenvalueFunctorImageFilter.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -45,9 +45,9 @@ class Sheetness
 public:
   Sheetness() 
     {
-    m_Alpha = 0.5; // suggested value in the paper
-    m_Gamma = 0.5; // suggested value in the paper;
-    m_C     = 1.0;
+    this->SetAlpha( 0.5 ); // suggested value in the paper
+    this->SetGamma( 0.5 ); // suggested value in the paper;
+    this->SetC( 1.0 );
     m_DetectBrightSheets = true;
     }
   ~Sheetness() {}
@@ -133,25 +133,85 @@ public:
 
     const double Rs = l2 / l3;
     const double Rb = vnl_math_abs( l3 + l3 - l2 - l1 ) / l3;
-    const double Rn = vcl_sqrt( l3*l3 + l2*l2 + l1*l1 );
+    const double Rn2 = l3*l3 + l2*l2 + l1*l1;
 
-    sheetness  =         vcl_exp( - ( Rs * Rs ) / ( 2.0 * m_Alpha * m_Alpha ) ); 
-    sheetness *= ( 1.0 - vcl_exp( - ( Rb * Rb ) / ( 2.0 * m_Gamma * m_Gamma ) ) ); 
-    sheetness *= ( 1.0 - vcl_exp( - ( Rn * Rn ) / ( 2.0 * m_C     * m_C     ) ) ); 
+    sheetness  =         vcl_exp( - ( Rs * Rs ) * m_SheetnessFactor ); 
+    sheetness *= ( 1.0 - vcl_exp( - ( Rb * Rb ) * m_BloobinessFactor ) ); 
+    sheetness *= ( 1.0 - vcl_exp( - Rn2 * m_NoiseFactor ) ); 
 
     return static_cast<TOutput>( sheetness );
     }
+
+  /** Evaluates the sheetness of a run of eigenvalue triples. Same
+   *  computation as operator(), written without branches so that the loop
+   *  can be vectorized. Rejected pixels are computed with a unit divisor and
+   *  masked at the end. */
+  template< class TReal >
+  void Evaluate( const TReal * A1, const TReal * A2, const TReal * A3,
+                 TReal * output, SizeValueType length ) const
+    {
+    const TReal sheetnessFactor  = static_cast< TReal >( m_SheetnessFactor );
+    const TReal bloobinessFactor = static_cast< TReal >( m_BloobinessFactor );
+    const TReal noiseFactor      = static_cast< TReal >( m_NoiseFactor );
+    const TReal eps  = static_cast< TReal >( vnl_math::eps );
+    const TReal zero = static_cast< TReal >( 0.0 );
+    const TReal one  = static_cast< TReal >( 1.0 );
+    const bool  bright = m_DetectBrightSheets;
+
+    for( SizeValueType i = 0; i < length; i++ )
+      {
+      TReal a1 = A1[i];
+      TReal a2 = A2[i];
+      TReal a3 = A3[i];
+
+      TReal l1 = ( a1 < zero ) ? -a1 : a1;
+      TReal l2 = ( a2 < zero ) ? -a2 : a2;
+      TReal l3 = ( a3 < zero ) ? -a3 : a3;
+
+      // Sorting network on the absolute values, l1 <= l2 <= l3.
+      TReal tl, ta;
+      bool swap = l2 > l3;
+      tl = swap ? l3 : l2; l3 = swap ? l2 : l3; l2 = tl;
+      ta = swap ? a3 : a2; a3 = swap ? a2 : a3; a2 = ta;
+
+      swap = l1 > l2;
+      tl = swap ? l2 : l1; l2 = swap ? l1 : l2; l1 = tl;
+      ta = swap ? a2 : a1; a2 = swap ? a1 : a2; a1 = ta;
+
+      swap = l2 > l3;
+      tl = swap ? l3 : l2; l3 = swap ? l2 : l3; l2 = tl;
+      ta = swap ? a3 : a2; a3 = swap ? a2 : a3; a2 = ta;
+
+      const bool reject = ( bright ? ( a3 > zero ) : ( a3 < zero ) ) || ( l3 < eps );
+
+      const TReal inverseL3 = one / ( reject ? one : l3 );
+
+      const TReal Rs = l2 * inverseL3;
+      TReal Rb = ( l3 + l3 - l2 - l1 ) * inverseL3;
+      Rb = ( Rb < zero ) ? -Rb : Rb;
+      const TReal Rn2 = l3*l3 + l2*l2 + l1*l1;
+
+      TReal sheetness  =         vcl_exp( - ( Rs * Rs ) * sheetnessFactor );
+      sheetness *= ( one - vcl_exp( - ( Rb * Rb ) * bloobinessFactor ) );
+      sheetness *= ( one - vcl_exp( - Rn2 * noiseFactor ) );
+
+      output[i] = reject ? zero : sheetness;
+      }
+    }
   void SetAlpha( double value )
     {
     this->m_Alpha = value;
+    this->m_SheetnessFactor = 1.0 / ( 2.0 * value * value );
     }
   void SetGamma( double value )
     {
     this->m_Gamma = value;
+    this->m_BloobinessFactor = 1.0 / ( 2.0 * value * value );
     }
   void SetC( double value )
     {
     this->m_C = value;
+    this->m_NoiseFactor = 1.0 / ( 2.0 * value * value );
     }
   void SetDetectBrightSheets( bool value )
     {
@@ -167,20 +227,25 @@ private:
   double    m_Gamma;
   double    m_C;
   bool      m_DetectBrightSheets;
+
+  // 1 / ( 2 x^2 ) for each of the normalization terms.
+  double    m_SheetnessFactor;
+  double    m_BloobinessFactor;
+  double    m_NoiseFactor;
 }; 
 }
 
 template <class TInputImage, class TOutputImage>
 class ITK_EXPORT DescoteauxSheetnessImageFilter :
     public
-UnaryFunctorImageFilter<TInputImage,TOutputImage, 
+EigenvalueFunctorImageFilter<TInputImage,TOutputImage, 
                         Function::Sheetness< typename TInputImage::PixelType, 
                                        typename TOutputImage::PixelType>   >
 {
 public:
   /** Standard class typedefs. */
   typedef DescoteauxSheetnessImageFilter    Self;
-  typedef UnaryFunctorImageFilter<
+  typedef EigenvalueFunctorImageFilter<
     TInputImage,TOutputImage, 
     Function::Sheetness< 
       typename TInputImage::PixelType, 
@@ -193,7 +258,7 @@ public:
 
   /** Runtime information support. */
   itkTypeMacro(DescoteauxSheetnessImageFilter, 
-               UnaryFunctorImageFilter);
+               EigenvalueFunctorImageFilter);
 
   /** Set the normalization term for sheetness */
   void SetSheetnessNormalization( double value )
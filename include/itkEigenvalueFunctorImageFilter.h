@@ -0,0 +1,106 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkEigenvalueFunctorImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkEigenvalueFunctorImageFilter_h
+#define __itkEigenvalueFunctorImageFilter_h
+
+#include "itkUnaryFunctorImageFilter.h"
+
+namespace itk
+{
+
+/** \class EigenvalueFunctorImageFilter
+ *
+ * \brief Evaluates a functor of the three Hessian eigenvalues on whole
+ * scanlines at a time.
+ *
+ * Instead of calling the functor once per pixel, every scanline of the
+ * region assigned to a thread is gathered into three contiguous arrays
+ * (one per eigenvalue) and handed to the Evaluate() method of the functor,
+ * which must provide
+ *
+ * \code
+ *   template< class TReal >
+ *   void Evaluate( const TReal * a1, const TReal * a2, const TReal * a3,
+ *                  TReal * output, SizeValueType length ) const;
+ * \endcode
+ *
+ * The functors implement Evaluate() as branch free loops with their
+ * normalization constants precomputed, so the compiler is able to
+ * vectorize the exponentials and square roots.
+ *
+ * By default the computation is done in double precision. UseSinglePrecision
+ * switches the scanline buffers, and therefore the whole evaluation, to
+ * float.
+ *
+ * \ingroup IntensityImageFilters  Multithreaded
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TInputImage, class TOutputImage, class TFunction>
+class ITK_EXPORT EigenvalueFunctorImageFilter :
+    public UnaryFunctorImageFilter<TInputImage,TOutputImage,TFunction>
+{
+public:
+  /** Standard class typedefs. */
+  typedef EigenvalueFunctorImageFilter                  Self;
+  typedef UnaryFunctorImageFilter<
+    TInputImage,TOutputImage,TFunction>                 Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(EigenvalueFunctorImageFilter, UnaryFunctorImageFilter);
+
+  typedef typename Superclass::FunctorType              FunctorType;
+  typedef typename Superclass::InputImageType           InputImageType;
+  typedef typename Superclass::InputImageRegionType     InputImageRegionType;
+  typedef typename Superclass::InputImagePixelType      InputImagePixelType;
+  typedef typename Superclass::OutputImageType          OutputImageType;
+  typedef typename Superclass::OutputImageRegionType    OutputImageRegionType;
+  typedef typename Superclass::OutputImagePixelType     OutputImagePixelType;
+
+  /** Evaluate the functor in single precision. Off by default. */
+  itkSetMacro( UseSinglePrecision, bool );
+  itkGetConstMacro( UseSinglePrecision, bool );
+  itkBooleanMacro( UseSinglePrecision );
+
+protected:
+  EigenvalueFunctorImageFilter();
+  virtual ~EigenvalueFunctorImageFilter() {}
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Evaluates the functor over the scanlines of the region. */
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                            ThreadIdType threadId );
+
+private:
+  EigenvalueFunctorImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  template< class TReal >
+  void EvaluateScanlines(const OutputImageRegionType& outputRegionForThread,
+                         ThreadIdType threadId, TReal );
+
+  bool    m_UseSinglePrecision;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkEigenvalueFunctorImageFilter.hxx"
+#endif
+
+#endif
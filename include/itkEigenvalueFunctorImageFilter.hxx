@@ -0,0 +1,149 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkEigenvalueFunctorImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkEigenvalueFunctorImageFilter_hxx
+#define __itkEigenvalueFunctorImageFilter_hxx
+
+#include "itkEigenvalueFunctorImageFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage, class TOutputImage, class TFunction>
+EigenvalueFunctorImageFilter<TInputImage, TOutputImage, TFunction>
+::EigenvalueFunctorImageFilter()
+{
+  this->m_UseSinglePrecision = false;
+}
+
+
+template <class TInputImage, class TOutputImage, class TFunction>
+void
+EigenvalueFunctorImageFilter<TInputImage, TOutputImage, TFunction>
+::ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  if( this->m_UseSinglePrecision )
+    {
+    this->EvaluateScanlines( outputRegionForThread, threadId, float() );
+    }
+  else
+    {
+    this->EvaluateScanlines( outputRegionForThread, threadId, double() );
+    }
+}
+
+
+/**
+ * Gathers each scanline of the input into one array per eigenvalue, lets
+ * the functor process the whole run and scatters the results to the output.
+ * Scanlines are contiguous in both buffers, so they are addressed directly.
+ */
+template <class TInputImage, class TOutputImage, class TFunction>
+template <class TReal>
+void
+EigenvalueFunctorImageFilter<TInputImage, TOutputImage, TFunction>
+::EvaluateScanlines( const OutputImageRegionType& outputRegionForThread,
+                     ThreadIdType threadId, TReal )
+{
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType * outputPtr = this->GetOutput(0);
+
+  InputImageRegionType inputRegionForThread;
+  this->CallCopyOutputRegionToInputRegion( inputRegionForThread, outputRegionForThread );
+
+  const SizeValueType length = outputRegionForThread.GetSize()[0];
+
+  if( length == 0 )
+    {
+    return;
+    }
+
+  const SizeValueType numberOfLines =
+    outputRegionForThread.GetNumberOfPixels() / length;
+
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  std::vector< TReal > a1( length );
+  std::vector< TReal > a2( length );
+  std::vector< TReal > a3( length );
+  std::vector< TReal > values( length );
+
+  const FunctorType & functor = this->GetFunctor();
+
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > LineIteratorType;
+
+  LineIteratorType lit( inputPtr, inputRegionForThread );
+  lit.SetDirection( 0 );
+  lit.GoToBegin();
+
+  typename OutputImageRegionType::IndexType outputIndex = outputRegionForThread.GetIndex();
+
+  while( !lit.IsAtEnd() )
+    {
+    const typename InputImageRegionType::IndexType & inputIndex = lit.GetIndex();
+
+    for( unsigned int d = 1; d < InputImageType::ImageDimension; d++ )
+      {
+      outputIndex[d] = outputRegionForThread.GetIndex()[d] +
+        ( inputIndex[d] - inputRegionForThread.GetIndex()[d] );
+      }
+
+    const InputImagePixelType * in =
+      inputPtr->GetBufferPointer() + inputPtr->ComputeOffset( inputIndex );
+
+    OutputImagePixelType * out =
+      outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( outputIndex );
+
+    for( SizeValueType i = 0; i < length; i++ )
+      {
+      a1[i] = static_cast< TReal >( in[i][0] );
+      a2[i] = static_cast< TReal >( in[i][1] );
+      a3[i] = static_cast< TReal >( in[i][2] );
+      }
+
+    functor.Evaluate( &a1[0], &a2[0], &a3[0], &values[0], length );
+
+    for( SizeValueType i = 0; i < length; i++ )
+      {
+      out[i] = static_cast< OutputImagePixelType >( values[i] );
+      }
+
+    lit.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage, class TFunction>
+void
+EigenvalueFunctorImageFilter<TInputImage, TOutputImage, TFunction>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseSinglePrecision: " << this->m_UseSinglePrecision << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -20,6 +20,7 @@
 #include "itkSinglePhaseLevelSetSegmentationModule.h"
 #include "itkFastMarchingSegmentationModule.h"
 #include "itkGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkParallelGeodesicActiveContourLevelSetSegmentationModule.h"
 #include "itkLandmarkSpatialObject.h"
 
 namespace itk
@@ -84,6 +85,33 @@ public:
   virtual double GetDistanceFromSeeds() const
     { return m_FastMarchingModule->GetDistanceFromSeeds(); }
 
+  /** Solve the fast marching with the bucket queue solver. */
+  virtual void SetUseBucketQueue( bool b )
+    { m_FastMarchingModule->SetUseBucketQueue( b ); }
+  virtual bool GetUseBucketQueue() const
+    { return m_FastMarchingModule->GetUseBucketQueue(); }
+  itkBooleanMacro( UseBucketQueue );
+
+  /** Evolve the geodesic active contour with the multithreaded sparse
+   * field solver instead of the serial one. Off by default. */
+  itkSetMacro( UseParallelGeodesicActiveContour, bool );
+  itkGetConstMacro( UseParallelGeodesicActiveContour, bool );
+  itkBooleanMacro( UseParallelGeodesicActiveContour );
+
+  /** Run the geodesic active contour only over the bounding box of the
+   * pixels reached by the fast marching, padded by ReachedRegionMargin
+   * pixels. The front cannot leave that box, so the margin must leave room
+   * for the level set to grow. The feature cache is not used for the
+   * cropped feature image. Off by default. */
+  itkSetMacro( CropToReachedRegion, bool );
+  itkGetConstMacro( CropToReachedRegion, bool );
+  itkBooleanMacro( CropToReachedRegion );
+
+  /** Number of pixels added on each side of the region reached by the fast
+   * marching when CropToReachedRegion is on. Defaults to 10. */
+  itkSetMacro( ReachedRegionMargin, unsigned int );
+  itkGetConstMacro( ReachedRegionMargin, unsigned int );
+
 protected:
   FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule();
   virtual ~FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule();
@@ -97,10 +125,16 @@ protected:
   typename FastMarchingModuleType::Pointer m_FastMarchingModule;
   typedef  GeodesicActiveContourLevelSetSegmentationModule< Dimension > GeodesicActiveContourLevelSetModuleType;
   typename GeodesicActiveContourLevelSetModuleType::Pointer m_GeodesicActiveContourLevelSetModule;
+  typedef  ParallelGeodesicActiveContourLevelSetSegmentationModule< Dimension > ParallelGeodesicActiveContourLevelSetModuleType;
+  typename ParallelGeodesicActiveContourLevelSetModuleType::Pointer m_ParallelGeodesicActiveContourLevelSetModule;
 
 private:
   FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
+
+  bool m_UseParallelGeodesicActiveContour;
+  bool m_CropToReachedRegion;
+  unsigned int m_ReachedRegionMargin;
 };
 
 } // end namespace itk
@@ -19,6 +19,8 @@
 
 #include "itkFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h"
 #include "itkGeodesicActiveContourLevelSetImageFilter.h"
+#include "itkExtractImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
 #include "itkProgressAccumulator.h"
 
 
@@ -39,6 +41,11 @@ FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
   this->m_FastMarchingModule->InvertOutputIntensitiesOff();
   this->m_GeodesicActiveContourLevelSetModule = GeodesicActiveContourLevelSetModuleType::New();
   this->m_GeodesicActiveContourLevelSetModule->InvertOutputIntensitiesOff();
+  this->m_ParallelGeodesicActiveContourLevelSetModule = ParallelGeodesicActiveContourLevelSetModuleType::New();
+  this->m_ParallelGeodesicActiveContourLevelSetModule->InvertOutputIntensitiesOff();
+  this->m_UseParallelGeodesicActiveContour = false;
+  this->m_CropToReachedRegion = false;
+  this->m_ReachedRegionMargin = 10;
 }
 
 
@@ -61,6 +68,9 @@ FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf( os, indent );
+  os << indent << "UseParallelGeodesicActiveContour: " << this->m_UseParallelGeodesicActiveContour << std::endl;
+  os << indent << "CropToReachedRegion: " << this->m_CropToReachedRegion << std::endl;
+  os << indent << "ReachedRegionMargin: " << this->m_ReachedRegionMargin << std::endl;
 }
 
 
@@ -72,29 +82,105 @@ void
 FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
 ::GenerateData()
 {
+  // Both solvers share the same interface, pick the one in use.
+  Superclass * levelSetModule = this->m_GeodesicActiveContourLevelSetModule;
+  if( this->m_UseParallelGeodesicActiveContour )
+    {
+    this->m_ParallelGeodesicActiveContourLevelSetModule->SetNumberOfThreads( this->GetNumberOfThreads() );
+    levelSetModule = this->m_ParallelGeodesicActiveContourLevelSetModule;
+    }
+
   // Report progress.
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
   progress->RegisterInternalFilter( this->m_FastMarchingModule, 0.3 );
-  progress->RegisterInternalFilter( 
-      this->m_GeodesicActiveContourLevelSetModule, 0.7 );
+  progress->RegisterInternalFilter( levelSetModule, 0.7 );
 
   this->m_FastMarchingModule->SetInput( this->GetInput() );
   this->m_FastMarchingModule->SetFeature( this->GetFeature() );
+  this->m_FastMarchingModule->SetCropOutputToReachedRegion( this->m_CropToReachedRegion );
+  if( this->m_CropToReachedRegion )
+    {
+    this->m_FastMarchingModule->SetReachedRegionMargin( this->m_ReachedRegionMargin );
+    }
   this->m_FastMarchingModule->Update();
 
-  m_GeodesicActiveContourLevelSetModule->SetInput( m_FastMarchingModule->GetOutput() );
-  m_GeodesicActiveContourLevelSetModule->SetFeature( this->GetFeature() );
-  m_GeodesicActiveContourLevelSetModule->SetMaximumRMSError( this->GetMaximumRMSError() );
-  m_GeodesicActiveContourLevelSetModule->SetMaximumNumberOfIterations( this->GetMaximumNumberOfIterations() );
-  m_GeodesicActiveContourLevelSetModule->SetPropagationScaling( this->GetPropagationScaling() );
-  m_GeodesicActiveContourLevelSetModule->SetCurvatureScaling( this->GetCurvatureScaling() );
-  m_GeodesicActiveContourLevelSetModule->SetAdvectionScaling( this->GetAdvectionScaling() );
-  m_GeodesicActiveContourLevelSetModule->Update();
-
-  this->PackOutputImageInOutputSpatialObject( const_cast< OutputImageType * >(
+  const OutputImageType * initialLevelSet =
+    dynamic_cast< const OutputSpatialObjectType * >(
+      this->m_FastMarchingModule->GetOutput() )->GetImage();
+
+  // The level set and the feature image must share the same grid, crop the
+  // feature image to the region of the fast marching output.
+  typename FeatureSpatialObjectType::Pointer croppedFeatureObject;
+
+  if( this->m_CropToReachedRegion )
+    {
+    typedef ExtractImageFilter< FeatureImageType, FeatureImageType > ExtractFilterType;
+    typename ExtractFilterType::Pointer extractor = ExtractFilterType::New();
+    extractor->SetInput( this->GetInternalFeatureImage() );
+    extractor->SetExtractionRegion( initialLevelSet->GetLargestPossibleRegion() );
+    extractor->SetDirectionCollapseToSubmatrix();
+    extractor->Update();
+
+    croppedFeatureObject = FeatureSpatialObjectType::New();
+    croppedFeatureObject->SetImage( extractor->GetOutput() );
+    }
+
+  levelSetModule->SetInput( m_FastMarchingModule->GetOutput() );
+  if( this->m_CropToReachedRegion )
+    {
+    levelSetModule->SetFeature( croppedFeatureObject );
+    }
+  else
+    {
+    levelSetModule->SetFeature( this->GetFeature() );
+    }
+  // The cropped feature image is new at every update, so the shared cache
+  // would never hold it, and would drop the entry of the full feature image.
+  if( this->m_CropToReachedRegion )
+    {
+    levelSetModule->SetFeatureCache( NULL );
+    }
+  else
+    {
+    levelSetModule->SetFeatureCache( this->GetFeatureCache() );
+    }
+  levelSetModule->SetMaximumRMSError( this->GetMaximumRMSError() );
+  levelSetModule->SetMaximumNumberOfIterations( this->GetMaximumNumberOfIterations() );
+  levelSetModule->SetPropagationScaling( this->GetPropagationScaling() );
+  levelSetModule->SetCurvatureScaling( this->GetCurvatureScaling() );
+  levelSetModule->SetAdvectionScaling( this->GetAdvectionScaling() );
+  levelSetModule->SetVolumeConvergenceTolerance( this->GetVolumeConvergenceTolerance() );
+  levelSetModule->SetVolumeConvergenceInterval( this->GetVolumeConvergenceInterval() );
+  levelSetModule->Update();
+
+  this->CopyLevelSetResults( levelSetModule );
+
+  this->AddIntensityPassCounts( this->m_FastMarchingModule );
+  this->AddIntensityPassCounts( levelSetModule );
+
+  OutputImageType * levelSet = const_cast< OutputImageType * >(
         dynamic_cast< const OutputSpatialObjectType * >(
-        m_GeodesicActiveContourLevelSetModule->GetOutput())->GetImage()) );
+        levelSetModule->GetOutput())->GetImage());
+
+  if( this->m_CropToReachedRegion )
+    {
+    // Pixels outside of the box are far outside of the zero set, and take
+    // the largest value of the level set. A single scan gives both the
+    // background and the window of the inversion.
+    typedef MinimumMaximumImageCalculator< OutputImageType > CalculatorType;
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage( levelSet );
+    calculator->Compute();
+    this->CountIntensityScan();
+
+    this->PackOutputRegionInOutputSpatialObject( levelSet, calculator->GetMaximum(),
+      calculator->GetMinimum(), calculator->GetMaximum() );
+    }
+  else
+    {
+    this->PackOutputImageInOutputSpatialObject( levelSet );
+    }
 }
 
 } // end namespace itk
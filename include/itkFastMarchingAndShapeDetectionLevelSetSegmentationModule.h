@@ -84,6 +84,13 @@ public:
   virtual double GetDistanceFromSeeds() const
     { return m_FastMarchingModule->GetDistanceFromSeeds(); }
 
+  /** Solve the fast marching with the bucket queue solver. */
+  virtual void SetUseBucketQueue( bool b )
+    { m_FastMarchingModule->SetUseBucketQueue( b ); }
+  virtual bool GetUseBucketQueue() const
+    { return m_FastMarchingModule->GetUseBucketQueue(); }
+  itkBooleanMacro( UseBucketQueue );
+
 protected:
   FastMarchingAndShapeDetectionLevelSetSegmentationModule();
   virtual ~FastMarchingAndShapeDetectionLevelSetSegmentationModule();
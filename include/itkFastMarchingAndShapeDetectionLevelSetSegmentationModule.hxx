@@ -85,12 +85,20 @@ FastMarchingAndShapeDetectionLevelSetSegmentationModule<NDimension>
 
   m_ShapeDetectionLevelSetModule->SetInput( m_FastMarchingModule->GetOutput() );
   m_ShapeDetectionLevelSetModule->SetFeature( this->GetFeature() );
+  m_ShapeDetectionLevelSetModule->SetFeatureCache( this->GetFeatureCache() );
   m_ShapeDetectionLevelSetModule->SetMaximumRMSError( this->GetMaximumRMSError() );
   m_ShapeDetectionLevelSetModule->SetMaximumNumberOfIterations( this->GetMaximumNumberOfIterations() );
   m_ShapeDetectionLevelSetModule->SetPropagationScaling( this->GetPropagationScaling() );
   m_ShapeDetectionLevelSetModule->SetCurvatureScaling( this->GetCurvatureScaling() );
+  m_ShapeDetectionLevelSetModule->SetVolumeConvergenceTolerance( this->GetVolumeConvergenceTolerance() );
+  m_ShapeDetectionLevelSetModule->SetVolumeConvergenceInterval( this->GetVolumeConvergenceInterval() );
   m_ShapeDetectionLevelSetModule->Update();
 
+  this->CopyLevelSetResults( m_ShapeDetectionLevelSetModule );
+
+  this->AddIntensityPassCounts( this->m_FastMarchingModule );
+  this->AddIntensityPassCounts( m_ShapeDetectionLevelSetModule );
+
   this->PackOutputImageInOutputSpatialObject( const_cast< OutputImageType * >(
         dynamic_cast< const OutputSpatialObjectType * >(
         m_ShapeDetectionLevelSetModule->GetOutput())->GetImage()) );
@@ -20,6 +20,9 @@
 #include "itkSinglePhaseLevelSetSegmentationModule.h"
 #include "itkImageSpatialObject.h"
 #include "itkLandmarkSpatialObject.h"
+#include "itkProgressAccumulator.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +34,11 @@ namespace itk
  * output a segmentation of the output level set. Threshold this at 0 and you
  * will get the zero set. 
  *
+ * The arrival times of the front are kept between updates. Changing the
+ * stopping value or the distance from seeds only rescales them again, as
+ * long as the seeds, the feature and the solver are unchanged and the new
+ * values do not take the front further than the cached solve.
+ *
  * \ingroup SpatialObjectFilters
  * \ingroup ITKLesionSizingToolkit
  */
@@ -81,6 +89,53 @@ public:
   itkSetMacro( DistanceFromSeeds, double );
   itkGetMacro( DistanceFromSeeds, double );
 
+  typedef typename FeatureImageType::RegionType          RegionType;
+
+  /** Bounding box of the pixels reached by the front before the stopping
+   * value, seeds included. Available after the module has been updated. */
+  itkGetConstReferenceMacro( ReachedRegion, RegionType );
+
+  /** Number of pixels added on each side of the reached region. The output
+   * is only rescaled over the padded region, every other pixel is set to
+   * the outside value. Defaults to 2. */
+  itkSetMacro( ReachedRegionMargin, unsigned int );
+  itkGetConstMacro( ReachedRegionMargin, unsigned int );
+
+  /** Produce an output image that only covers the padded reached region,
+   * instead of the whole feature image. This lets a subsequent level set
+   * run on the neighborhood of the lesion only. Off by default. */
+  itkSetMacro( CropOutputToReachedRegion, bool );
+  itkGetConstMacro( CropOutputToReachedRegion, bool );
+  itkBooleanMacro( CropOutputToReachedRegion );
+
+  /** Solve the Eikonal equation with BucketQueueFastMarchingImageFilter
+   * instead of FastMarchingImageFilter. Off by default. */
+  itkSetMacro( UseBucketQueue, bool );
+  itkGetConstMacro( UseBucketQueue, bool );
+  itkBooleanMacro( UseBucketQueue );
+
+  /** Keep the arrival times between updates, so that changing the stopping
+   * value or the distance from seeds does not solve the Eikonal equation
+   * again. On by default. */
+  itkSetMacro( CacheArrivalTimes, bool );
+  itkGetConstMacro( CacheArrivalTimes, bool );
+  itkBooleanMacro( CacheArrivalTimes );
+
+  /** Free the cached arrival times. */
+  void ReleaseArrivalTimes();
+
+  typedef std::vector< double >                                     StoppingValueListType;
+  typedef typename OutputSpatialObjectType::Pointer                 OutputSpatialObjectPointer;
+  typedef std::vector< OutputSpatialObjectPointer >                 OutputSpatialObjectListType;
+
+  /** Segment the seeds at each of the stopping values, with the current
+   * distance from seeds. The front is propagated once, up to the largest
+   * value, and each output is derived from the same arrival times. The
+   * inputs must be up to date. The outputs are returned in the order of the
+   * values, and the output of the module is left with the last one. */
+  void GenerateStoppingValueSweep( const StoppingValueListType & stoppingValues,
+                                   OutputSpatialObjectListType & outputs );
+
 protected:
   FastMarchingSegmentationModule();
   virtual ~FastMarchingSegmentationModule();
@@ -93,9 +148,35 @@ protected:
   /** Extract the input set of landmark points to be used as seeds. */
   const InputSpatialObjectType * GetInternalInputLandmarks() const;
 
+  /** Make sure the cached arrival times, computed from seeds at zero, are
+   * valid up to the given arrival time. Solves the Eikonal equation again
+   * otherwise. */
+  void UpdateArrivalTimes( double arrivalTime, ProgressAccumulator * progress );
+
+  /** Rescale the cached arrival times for a stopping value and a distance
+   * from seeds, and pack them in the output. */
+  void RescaleArrivalTimes( double stoppingValue, double distanceFromSeeds,
+                            ProgressAccumulator * progress );
+
   double m_StoppingValue;
   double m_DistanceFromSeeds;
 
+  RegionType    m_ReachedRegion;
+  unsigned int  m_ReachedRegionMargin;
+  bool          m_CropOutputToReachedRegion;
+  bool          m_UseBucketQueue;
+  bool          m_CacheArrivalTimes;
+
+  /** Arrival times from seeds at zero, valid up to m_ArrivalTimesLimit,
+   * and the bounding box of the points below that limit. */
+  typename OutputImageType::Pointer       m_ArrivalTimes;
+  double                                  m_ArrivalTimesLimit;
+  RegionType                              m_ArrivalTimesRegion;
+  bool                                    m_ArrivalTimesUseBucketQueue;
+  const FeatureImageType *                m_ArrivalTimesFeature;
+  const InputSpatialObjectType *          m_ArrivalTimesSeeds;
+  TimeStamp                               m_ArrivalTimesTime;
+
 private:
   FastMarchingSegmentationModule(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
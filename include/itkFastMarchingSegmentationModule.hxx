@@ -19,8 +19,10 @@
 
 #include "itkFastMarchingSegmentationModule.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkFastMarchingImageFilter.h"
-#include "itkIntensityWindowingImageFilter.h"
+#include "itkBucketQueueFastMarchingImageFilter.h"
 #include "itkProgressAccumulator.h"
 
 namespace itk
@@ -37,6 +39,16 @@ FastMarchingSegmentationModule<NDimension>
                       NumericTraits<OutputPixelType>::max() / 2.0 ) );
 
   this->m_DistanceFromSeeds = 0.0;
+
+  this->m_ReachedRegionMargin = 2;
+  this->m_CropOutputToReachedRegion = false;
+  this->m_UseBucketQueue = false;
+  this->m_CacheArrivalTimes = true;
+
+  this->m_ArrivalTimesLimit = 0.0;
+  this->m_ArrivalTimesUseBucketQueue = false;
+  this->m_ArrivalTimesFeature = NULL;
+  this->m_ArrivalTimesSeeds = NULL;
   
   this->SetNumberOfRequiredInputs( 2 );
   this->SetNumberOfRequiredOutputs( 1 );
@@ -68,6 +80,12 @@ FastMarchingSegmentationModule<NDimension>
   Superclass::PrintSelf( os, indent );
   os << indent << "Stopping Value = " << this->m_StoppingValue << std::endl;
   os << indent << "Distance from seeds = " << this->m_DistanceFromSeeds << std::endl;
+  os << indent << "Reached region = " << this->m_ReachedRegion << std::endl;
+  os << indent << "Reached region margin = " << this->m_ReachedRegionMargin << std::endl;
+  os << indent << "Crop output to reached region = " << this->m_CropOutputToReachedRegion << std::endl;
+  os << indent << "Use bucket queue = " << this->m_UseBucketQueue << std::endl;
+  os << indent << "Cache arrival times = " << this->m_CacheArrivalTimes << std::endl;
+  os << indent << "Cached arrival times limit = " << this->m_ArrivalTimesLimit << std::endl;
 }
 
 
@@ -79,29 +97,115 @@ void
 FastMarchingSegmentationModule<NDimension>
 ::GenerateData()
 {
-  typedef FastMarchingImageFilter< FeatureImageType, OutputImageType >      FilterType;
-  
-  typename FilterType::Pointer filter = FilterType::New();
+  // Progress reporting - forward events from the fast marching filter.
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
 
-  const FeatureImageType * featureImage = this->GetInternalFeatureImage();
+  // Starting the front at minus the distance from seeds shifts all the
+  // arrival times by that distance, so the arrival times from seeds at zero
+  // serve every distance.
+  this->UpdateArrivalTimes( this->m_StoppingValue + this->m_DistanceFromSeeds, progress );
 
-  filter->SetInput( featureImage );
+  this->RescaleArrivalTimes( this->m_StoppingValue, this->m_DistanceFromSeeds, progress );
 
-  filter->SetStoppingValue( this->m_StoppingValue );
+  if( !this->m_CacheArrivalTimes )
+    {
+    this->ReleaseArrivalTimes();
+    }
+}
 
-  // Progress reporting - forward events from the fast marching filter.
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
-  progress->RegisterInternalFilter( filter, 0.9 );
-  
+
+/**
+ * Segment the seeds for a list of stopping values from a single solve.
+ */
+template <unsigned int NDimension>
+void
+FastMarchingSegmentationModule<NDimension>
+::GenerateStoppingValueSweep( const StoppingValueListType & stoppingValues,
+                              OutputSpatialObjectListType & outputs )
+{
+  outputs.clear();
+  this->ResetIntensityPassCounts();
+
+  if( stoppingValues.empty() )
+    {
+    return;
+    }
+
+  double largestStoppingValue = stoppingValues[0];
+  for( unsigned int i = 1; i < stoppingValues.size(); i++ )
+    {
+    largestStoppingValue = vnl_math_max( largestStoppingValue, stoppingValues[i] );
+    }
+
+  this->UpdateArrivalTimes( largestStoppingValue + this->m_DistanceFromSeeds, NULL );
+
+  const OutputSpatialObjectType * outputObject =
+    dynamic_cast< const OutputSpatialObjectType * >( this->GetOutput() );
+
+  for( unsigned int i = 0; i < stoppingValues.size(); i++ )
+    {
+    this->RescaleArrivalTimes( stoppingValues[i], this->m_DistanceFromSeeds, NULL );
+
+    // Every rescaling packs a newly allocated image in the output.
+    OutputSpatialObjectPointer sweepObject = OutputSpatialObjectType::New();
+    sweepObject->SetImage( outputObject->GetImage() );
+    outputs.push_back( sweepObject );
+    }
+
+  if( !this->m_CacheArrivalTimes )
+    {
+    this->ReleaseArrivalTimes();
+    }
+}
+
+
+/**
+ * Free the cached arrival times.
+ */
+template <unsigned int NDimension>
+void
+FastMarchingSegmentationModule<NDimension>
+::ReleaseArrivalTimes()
+{
+  this->m_ArrivalTimes = NULL;
+  this->m_ArrivalTimesFeature = NULL;
+  this->m_ArrivalTimesSeeds = NULL;
+}
+
+
+/**
+ * Solve the Eikonal equation from the seeds, unless the cached arrival
+ * times already go far enough.
+ */
+template <unsigned int NDimension>
+void
+FastMarchingSegmentationModule<NDimension>
+::UpdateArrivalTimes( double arrivalTime, ProgressAccumulator * progress )
+{
+  typedef FastMarchingImageFilter< FeatureImageType, OutputImageType >             FilterType;
+  typedef BucketQueueFastMarchingImageFilter< OutputImageType, FeatureImageType >  BucketQueueFilterType;
+
+  const FeatureImageType * featureImage = this->GetInternalFeatureImage();
   const InputSpatialObjectType * inputSeeds = this->GetInternalInputLandmarks();
+
+  if( this->m_ArrivalTimes.IsNotNull() &&
+      this->m_ArrivalTimesLimit >= arrivalTime &&
+      this->m_ArrivalTimesUseBucketQueue == this->m_UseBucketQueue &&
+      this->m_ArrivalTimesFeature == featureImage &&
+      this->m_ArrivalTimesSeeds == inputSeeds &&
+      featureImage->GetMTime() < this->m_ArrivalTimesTime.GetMTime() &&
+      featureImage->GetUpdateMTime() < this->m_ArrivalTimesTime.GetMTime() &&
+      this->GetFeature()->GetMTime() < this->m_ArrivalTimesTime.GetMTime() &&
+      inputSeeds->GetMTime() < this->m_ArrivalTimesTime.GetMTime() )
+    {
+    return;
+    }
+
   const unsigned int numberOfPoints = inputSeeds->GetNumberOfPoints();
 
-  typedef typename InputSpatialObjectType::SpatialObjectPointType   SpatialObjectPointType;
-  typedef typename SpatialObjectPointType::PointType                PointType;
   typedef typename InputSpatialObjectType::PointListType            PointListType;
   typedef typename FeatureImageType::IndexType                      IndexType;
-  typedef typename FeatureImageType::IndexType                      IndexType;
   typedef typename FilterType::NodeContainer                        NodeContainer;
   typedef typename FilterType::NodeType                             NodeType;
 
@@ -116,34 +220,282 @@ FastMarchingSegmentationModule<NDimension>
     featureImage->TransformPhysicalPointToIndex( points[i].GetPosition(), index );
 
     NodeType node;
-
-    // By starting the FastMarching front at this value,
-    // the zero set will end up being placed at distance
-    // = value from the seeds. That can be seen as computing
-    // a distance map from the seeds.
-    node.SetValue( -this->m_DistanceFromSeeds );
-    
+    node.SetValue( 0.0 );
     node.SetIndex( index );
     trialPoints->InsertElement( i, node );  
     }
 
-  filter->SetTrialPoints( trialPoints );
-  filter->Update();
+  const RegionType & largestRegion = featureImage->GetLargestPossibleRegion();
+
+  if( this->m_UseBucketQueue )
+    {
+    typename BucketQueueFilterType::Pointer filter = BucketQueueFilterType::New();
+    filter->SetInput( featureImage );
+    filter->SetStoppingValue( arrivalTime );
+    filter->SetTrialPoints( trialPoints );
+    if( progress )
+      {
+      progress->RegisterInternalFilter( filter, 0.9 );
+      }
+    filter->Update();
+
+    this->m_ArrivalTimes = filter->GetOutput();
+
+    if( filter->GetNumberOfProcessedPoints() > 0 )
+      {
+      this->m_ArrivalTimesRegion = filter->GetReachedRegion();
+      }
+    else
+      {
+      this->m_ArrivalTimesRegion = largestRegion;
+      }
+    }
+  else
+    {
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( featureImage );
+    filter->SetStoppingValue( arrivalTime );
+    filter->SetTrialPoints( trialPoints );
+    filter->CollectPointsOn();
+    if( progress )
+      {
+      progress->RegisterInternalFilter( filter, 0.9 );
+      }
+    filter->Update();
+
+    this->m_ArrivalTimes = filter->GetOutput();
+
+    // Bounding box of the alive points. The seeds become alive first, and
+    // every pixel outside of the box is either far or a trial point above
+    // the stopping value.
+    typedef typename FilterType::NodeContainerPointer  NodeContainerPointer;
+    NodeContainerPointer processedPoints = filter->GetProcessedPoints();
+
+    IndexType lower;
+    IndexType upper;
+    lower.Fill( 0 );
+    upper.Fill( 0 );
+    bool empty = true;
+
+    if( processedPoints )
+      {
+      typename NodeContainer::ConstIterator pointItr = processedPoints->Begin();
+      while( pointItr != processedPoints->End() )
+        {
+        const IndexType & pointIndex = pointItr.Value().GetIndex();
+        for( unsigned int d = 0; d < NDimension; d++ )
+          {
+          if( empty || pointIndex[d] < lower[d] )
+            {
+            lower[d] = pointIndex[d];
+            }
+          if( empty || pointIndex[d] > upper[d] )
+            {
+            upper[d] = pointIndex[d];
+            }
+          }
+        empty = false;
+        ++pointItr;
+        }
+      }
+
+    if( empty )
+      {
+      this->m_ArrivalTimesRegion = largestRegion;
+      }
+    else
+      {
+      typename RegionType::SizeType size;
+      for( unsigned int d = 0; d < NDimension; d++ )
+        {
+        size[d] = upper[d] - lower[d] + 1;
+        }
+      this->m_ArrivalTimesRegion.SetIndex( lower );
+      this->m_ArrivalTimesRegion.SetSize( size );
+      }
+    }
+
+  this->m_ArrivalTimes->DisconnectPipeline();
+  this->m_ArrivalTimesRegion.Crop( largestRegion );
+
+  this->m_ArrivalTimesLimit = arrivalTime;
+  this->m_ArrivalTimesUseBucketQueue = this->m_UseBucketQueue;
+  this->m_ArrivalTimesFeature = featureImage;
+  this->m_ArrivalTimesSeeds = inputSeeds;
+  this->m_ArrivalTimesTime.Modified();
+}
+
+
+/**
+ * Window the cached arrival times between the seeds and the stopping value,
+ * in a single pass over the output region.
+ */
+template <unsigned int NDimension>
+void
+FastMarchingSegmentationModule<NDimension>
+::RescaleArrivalTimes( double stoppingValue, double distanceFromSeeds,
+                       ProgressAccumulator * progress )
+{
+  const RegionType & largestRegion = this->m_ArrivalTimes->GetLargestPossibleRegion();
+
+  const double arrivalTime = stoppingValue + distanceFromSeeds;
+
+  if( arrivalTime >= this->m_ArrivalTimesLimit )
+    {
+    this->m_ReachedRegion = this->m_ArrivalTimesRegion;
+    }
+  else
+    {
+    // Bounding box of the points the front would have made alive before
+    // stopping, found within the box of the cached solve.
+    typedef typename FeatureImageType::IndexType  IndexType;
+    typedef ImageRegionConstIteratorWithIndex< OutputImageType > IteratorType;
+
+    IteratorType itr( this->m_ArrivalTimes, this->m_ArrivalTimesRegion );
+
+    IndexType lower;
+    IndexType upper;
+    lower.Fill( 0 );
+    upper.Fill( 0 );
+    bool empty = true;
+
+    for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+      {
+      if( itr.Get() <= arrivalTime )
+        {
+        const IndexType & pointIndex = itr.GetIndex();
+        for( unsigned int d = 0; d < NDimension; d++ )
+          {
+          if( empty || pointIndex[d] < lower[d] )
+            {
+            lower[d] = pointIndex[d];
+            }
+          if( empty || pointIndex[d] > upper[d] )
+            {
+            upper[d] = pointIndex[d];
+            }
+          }
+        empty = false;
+        }
+      }
+
+    if( empty )
+      {
+      this->m_ReachedRegion = largestRegion;
+      }
+    else
+      {
+      typename RegionType::SizeType size;
+      for( unsigned int d = 0; d < NDimension; d++ )
+        {
+        size[d] = upper[d] - lower[d] + 1;
+        }
+      this->m_ReachedRegion.SetIndex( lower );
+      this->m_ReachedRegion.SetSize( size );
+      }
+    }
+
+  RegionType outputRegion = this->m_ReachedRegion;
+  outputRegion.PadByRadius( this->m_ReachedRegionMargin );
+  outputRegion.Crop( largestRegion );
+
+  // The output is written once, straight from the arrival times, in the
+  // convention of the module: arrival times from seeds at zero are windowed
+  // from [0:arrivalTime] to the expected range of [-4:4], and inverted when
+  // the intensities are inverted. Pixels outside of the region are above the
+  // stopping value.
+  typename OutputImageType::Pointer outputImage = OutputImageType::New();
+
+  if( this->m_CropOutputToReachedRegion )
+    {
+    outputImage->CopyInformation( this->m_ArrivalTimes );
+    outputImage->SetRegions( outputRegion );
+    }
+  else
+    {
+    const FeatureImageType * featureImage = this->GetInternalFeatureImage();
+    outputImage->CopyInformation( featureImage );
+    outputImage->SetRegions( featureImage->GetLargestPossibleRegion() );
+    }
+  outputImage->Allocate();
+
+  const bool invert = this->GetInvertOutputIntensities();
+  const OutputPixelType background = invert ? -4.0 : 4.0;
+
+  // Range of the windowed values, background included.
+  double minimum = 4.0;
+  double maximum = -4.0;
+
+  if( outputRegion != outputImage->GetLargestPossibleRegion() )
+    {
+    outputImage->FillBuffer( background );
+    maximum = 4.0;
+    }
+
+  // Same mapping as IntensityWindowingImageFilter.
+  const double factor = ( arrivalTime > 0.0 ) ? 8.0 / arrivalTime : 0.0;
+
+  typedef ImageRegionConstIterator< OutputImageType > ConstIteratorType;
+  typedef ImageRegionIterator< OutputImageType >      IteratorType;
+
+  ConstIteratorType itr( this->m_ArrivalTimes, outputRegion );
+  IteratorType otr( outputImage, outputRegion );
+
+  for( itr.GoToBegin(), otr.GoToBegin(); !itr.IsAtEnd(); ++itr, ++otr )
+    {
+    const double time = itr.Get();
+
+    OutputPixelType value;
+    if( time < 0.0 )
+      {
+      value = -4.0;
+      }
+    else if( time > arrivalTime )
+      {
+      value = 4.0;
+      }
+    else
+      {
+      value = static_cast< OutputPixelType >( time * factor - 4.0 );
+      }
+
+    if( value < minimum )
+      {
+      minimum = value;
+      }
+    if( value > maximum )
+      {
+      maximum = value;
+      }
+
+    otr.Set( invert ? -value : value );
+    }
+  this->CountIntensityRescaling();
+
+  // The inversion maps the range of the windowed values to [4:-4]. The seeds
+  // and the pixels beyond the stopping value give it [-4:4], where it is a
+  // plain negation. Otherwise, map the negated values again.
+  if( invert && ( minimum != -4.0 || maximum != 4.0 ) )
+    {
+    const double scale = ( maximum > minimum ) ? -8.0 / ( maximum - minimum ) : 0.0;
+
+    IteratorType rtr( outputImage, outputImage->GetBufferedRegion() );
+    for( rtr.GoToBegin(); !rtr.IsAtEnd(); ++rtr )
+      {
+      rtr.Set( static_cast< OutputPixelType >( 4.0 + ( -rtr.Get() - minimum ) * scale ) );
+      }
+    this->CountIntensityRescaling();
+    }
+
+  if( progress )
+    {
+    this->UpdateProgress( 1.0 );
+    }
 
-  // Rescale the values to make the output intensity fit in the expected
-  // range of [-4:4]
-  typedef itk::IntensityWindowingImageFilter<  OutputImageType, OutputImageType > WindowingFilterType;
-  typename WindowingFilterType::Pointer windowing = WindowingFilterType::New();
-  windowing->SetInput( filter->GetOutput() );
-  windowing->SetWindowMinimum( -this->m_DistanceFromSeeds );
-  windowing->SetWindowMaximum(  this->m_StoppingValue );
-  windowing->SetOutputMinimum( -4.0 );
-  windowing->SetOutputMaximum(  4.0 );
-  windowing->InPlaceOn();
-  progress->RegisterInternalFilter( windowing, 0.1 );  
-  windowing->Update();
+  OutputSpatialObjectType * outputObject =
+    dynamic_cast< OutputSpatialObjectType * >( this->ProcessObject::GetOutput(0) );
 
-  this->PackOutputImageInOutputSpatialObject( windowing->GetOutput() );
+  outputObject->SetImage( outputImage );
 }
 
 
@@ -17,7 +17,7 @@
 #ifndef __itkFrangiTubularnessImageFilter_h
 #define __itkFrangiTubularnessImageFilter_h
 
-#include "itkUnaryFunctorImageFilter.h"
+#include "itkEigenvalueFunctorImageFilter.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -40,9 +40,9 @@ class Tubularness
 public:
   Tubularness() 
     {
-    m_Alpha  = 0.5; // suggested value in the paper
-    m_Beta   = 0.5; // suggested value in the paper;
-    m_Gamma  = 1.0; // suggested value in the paper;
+    this->SetAlpha( 0.5 ); // suggested value in the paper
+    this->SetBeta( 0.5 );  // suggested value in the paper;
+    this->SetGamma( 1.0 ); // suggested value in the paper;
     m_BrigthForeground = true;
     }
   ~Tubularness() {}
@@ -52,6 +52,9 @@ public:
     this->m_Beta = one.m_Beta;
     this->m_Gamma = one.m_Gamma;
     this->m_BrigthForeground = one.m_BrigthForeground;
+    this->m_SheetnessFactor = one.m_SheetnessFactor;
+    this->m_BloobinessFactor = one.m_BloobinessFactor;
+    this->m_NoiseFactor = one.m_NoiseFactor;
     }
   const Tubularness & operator=( const Tubularness & one )
     {
@@ -59,6 +62,9 @@ public:
     this->m_Beta = one.m_Beta;
     this->m_Gamma = one.m_Gamma;
     this->m_BrigthForeground = one.m_BrigthForeground;
+    this->m_SheetnessFactor = one.m_SheetnessFactor;
+    this->m_BloobinessFactor = one.m_BloobinessFactor;
+    this->m_NoiseFactor = one.m_NoiseFactor;
     return *this;
     }
   bool operator!=( const Tubularness & ) const
@@ -142,27 +148,89 @@ public:
       }
 
     const double Rs = l2 / l3;
-    const double Rb = l1 / vcl_sqrt( l2 * l3 );
-    const double Rn = vcl_sqrt( l3*l3 + l2*l2 + l1*l1 );
+    const double Rb2 = ( l1 * l1 ) / ( l2 * l3 );
+    const double Rn2 = l3*l3 + l2*l2 + l1*l1;
 
-    tubularness  = ( 1.0 - vcl_exp( - ( Rs * Rs ) / ( 2.0 * m_Alpha * m_Alpha ) ) ); 
-    tubularness *= (       vcl_exp( - ( Rb * Rb ) / ( 2.0 * m_Beta  * m_Beta  ) ) ); 
-    tubularness *= ( 1.0 - vcl_exp( - ( Rn * Rn ) / ( 2.0 * m_Gamma * m_Gamma ) ) ); 
+    tubularness  = ( 1.0 - vcl_exp( - ( Rs * Rs ) * m_SheetnessFactor ) ); 
+    tubularness *= (       vcl_exp( - Rb2 * m_BloobinessFactor ) ); 
+    tubularness *= ( 1.0 - vcl_exp( - Rn2 * m_NoiseFactor ) ); 
 
     return static_cast<TOutput>( tubularness );
     }
 
+  /** Evaluates the tubularness of a run of eigenvalue triples. Same
+   *  computation as operator(), written without branches so that the loop
+   *  can be vectorized. Rejected pixels are computed with unit divisors and
+   *  masked at the end. */
+  template< class TReal >
+  void Evaluate( const TReal * A1, const TReal * A2, const TReal * A3,
+                 TReal * output, SizeValueType length ) const
+    {
+    const TReal sheetnessFactor  = static_cast< TReal >( m_SheetnessFactor );
+    const TReal bloobinessFactor = static_cast< TReal >( m_BloobinessFactor );
+    const TReal noiseFactor      = static_cast< TReal >( m_NoiseFactor );
+    const TReal eps  = static_cast< TReal >( vnl_math::eps );
+    const TReal zero = static_cast< TReal >( 0.0 );
+    const TReal one  = static_cast< TReal >( 1.0 );
+    const bool  bright = m_BrigthForeground;
+
+    for( SizeValueType i = 0; i < length; i++ )
+      {
+      TReal a1 = A1[i];
+      TReal a2 = A2[i];
+      TReal a3 = A3[i];
+
+      TReal l1 = ( a1 < zero ) ? -a1 : a1;
+      TReal l2 = ( a2 < zero ) ? -a2 : a2;
+      TReal l3 = ( a3 < zero ) ? -a3 : a3;
+
+      // Sorting network on the absolute values, l1 <= l2 <= l3.
+      TReal tl, ta;
+      bool swap = l2 > l3;
+      tl = swap ? l3 : l2; l3 = swap ? l2 : l3; l2 = tl;
+      ta = swap ? a3 : a2; a3 = swap ? a2 : a3; a2 = ta;
+
+      swap = l1 > l2;
+      tl = swap ? l2 : l1; l2 = swap ? l1 : l2; l1 = tl;
+      ta = swap ? a2 : a1; a2 = swap ? a1 : a2; a1 = ta;
+
+      swap = l2 > l3;
+      tl = swap ? l3 : l2; l3 = swap ? l2 : l3; l2 = tl;
+      ta = swap ? a3 : a2; a3 = swap ? a2 : a3; a2 = ta;
+
+      const bool reject = ( bright ? ( a3 > zero ) : ( a3 < zero ) ) ||
+                          ( l2 < eps ) || ( l3 < eps );
+
+      const TReal d2 = reject ? one : l2;
+      const TReal d3 = reject ? one : l3;
+      const TReal inverseL3 = one / d3;
+
+      const TReal Rs  = l2 * inverseL3;
+      const TReal Rb2 = ( l1 * l1 ) / ( d2 * d3 );
+      const TReal Rn2 = l3*l3 + l2*l2 + l1*l1;
+
+      TReal tubularness  = ( one - vcl_exp( - ( Rs * Rs ) * sheetnessFactor ) );
+      tubularness *= (       vcl_exp( - Rb2 * bloobinessFactor ) );
+      tubularness *= ( one - vcl_exp( - Rn2 * noiseFactor ) );
+
+      output[i] = reject ? zero : tubularness;
+      }
+    }
+
   void SetAlpha( double value )
     {
     this->m_Alpha = value;
+    this->m_SheetnessFactor = 1.0 / ( 2.0 * value * value );
     }
   void SetBeta( double value )
     {
     this->m_Beta = value;
+    this->m_BloobinessFactor = 1.0 / ( 2.0 * value * value );
     }
   void SetGamma( double value )
     {
     this->m_Gamma = value;
+    this->m_NoiseFactor = 1.0 / ( 2.0 * value * value );
     }
   void SetBrightBackground( bool value )
     {
@@ -175,20 +243,25 @@ private:
   double m_Beta;
   double m_Gamma;
   bool   m_BrigthForeground;
+
+  // 1 / ( 2 x^2 ) for each of the normalization terms.
+  double m_SheetnessFactor;
+  double m_BloobinessFactor;
+  double m_NoiseFactor;
 }; 
 }
 
 template <class TInputImage, class TOutputImage>
 class ITK_EXPORT FrangiTubularnessImageFilter :
     public
-UnaryFunctorImageFilter<TInputImage,TOutputImage, 
+EigenvalueFunctorImageFilter<TInputImage,TOutputImage, 
                         Function::Tubularness< typename TInputImage::PixelType, 
                                        typename TOutputImage::PixelType>   >
 {
 public:
   /** Standard class typedefs. */
   typedef FrangiTubularnessImageFilter          Self;
-  typedef UnaryFunctorImageFilter<
+  typedef EigenvalueFunctorImageFilter<
     TInputImage,TOutputImage, 
     Function::Tubularness< 
       typename TInputImage::PixelType, 
@@ -201,7 +274,7 @@ public:
 
   /** Runtime information support. */
   itkTypeMacro(FrangiTubularnessImageFilter, 
-               UnaryFunctorImageFilter);
+               EigenvalueFunctorImageFilter);
 
   /** Set the normalization term for sheetness */
   void SetSheetnessNormalization( double value )
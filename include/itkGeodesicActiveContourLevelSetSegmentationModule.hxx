@@ -80,20 +80,19 @@ GeodesicActiveContourLevelSetSegmentationModule<NDimension>
   filter->SetCurvatureScaling( this->GetCurvatureScaling() );
   filter->SetAdvectionScaling( this->GetAdvectionScaling() );
   filter->UseImageSpacingOn();
+  filter->SetAutoGenerateSpeedAdvection(
+    !this->SetCachedFeatureImages( filter->GetSegmentationFunction() ) );
 
   // Progress reporting - forward events from the fast marching filter.
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
   progress->RegisterInternalFilter( filter, 1.0 );  
 
+  this->MonitorLevelSetFilter( filter );
+
   filter->Update();
 
-  std::cout << std::endl;
-  std::cout << "Max. no. iterations: " << filter->GetNumberOfIterations() << std::endl;
-  std::cout << "Max. RMS error: " << filter->GetMaximumRMSError() << std::endl;
-  std::cout << std::endl;
-  std::cout << "No. elpased iterations: " << filter->GetElapsedIterations() << std::endl;
-  std::cout << "RMS change: " << filter->GetRMSChange() << std::endl;
+  this->RecordLevelSetFilterResults( filter );
 
   this->PackOutputImageInOutputSpatialObject( filter->GetOutput() );
 }
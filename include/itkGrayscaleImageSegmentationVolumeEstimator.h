@@ -18,6 +18,7 @@
 #define __itkGrayscaleImageSegmentationVolumeEstimator_h
 
 #include "itkSegmentationVolumeEstimator.h"
+#include "itkRunLengthSegmentation.h"
 
 namespace itk
 {
@@ -36,6 +37,10 @@ namespace itk
  *
  * The pixels size is, of course, taken into account.
  *
+ * The segmentation can also be given in the compact form of a
+ * RunLengthSegmentation, whose volume is computed from the runs and the
+ * narrow band values without decoding the image.
+ *
  * \ingroup SpatialObjectFilters
  * \ingroup ITKLesionSizingToolkit
  */
@@ -71,6 +76,13 @@ public:
   typedef ImageSpatialObject< NDimension, InputPixelType >    InputImageSpatialObjectType;
   typedef Image< InputPixelType, NDimension >                 InputImageType;
 
+  /** Compact form of the segmentation, that can replace the input spatial
+   * object. */
+  typedef RunLengthSegmentation< NDimension >                 RunLengthSegmentationType;
+
+  using Superclass::SetInput;
+  void SetInput( const RunLengthSegmentationType * segmentation );
+
 protected:
   GrayscaleImageSegmentationVolumeEstimator();
   virtual ~GrayscaleImageSegmentationVolumeEstimator();
@@ -85,6 +97,8 @@ private:
   GrayscaleImageSegmentationVolumeEstimator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
+  double EstimateVolume( const RunLengthSegmentationType * segmentation ) const;
+
 };
 
 } // end namespace itk
@@ -57,6 +57,63 @@ GrayscaleImageSegmentationVolumeEstimator<NDimension>
 }
 
 
+template <unsigned int NDimension>
+void
+GrayscaleImageSegmentationVolumeEstimator<NDimension>
+::SetInput( const RunLengthSegmentationType * segmentation )
+{
+  this->SetNthInput(0, const_cast<RunLengthSegmentationType *>( segmentation ));
+}
+
+
+/**
+ * The pixels of the high plateau contribute one pixel volume each, and the
+ * pixels of the narrow band their rescaled value, as when the image is
+ * estimated pixel by pixel.
+ */
+template <unsigned int NDimension>
+double
+GrayscaleImageSegmentationVolumeEstimator<NDimension>
+::EstimateVolume( const RunLengthSegmentationType * segmentation ) const
+{
+  const double minimumIntensity = segmentation->GetLowValue();
+  const double maximumIntensity = segmentation->GetHighValue();
+
+  const double intensityRange =  (maximumIntensity - minimumIntensity);
+
+  if( intensityRange <= 1e-6 )
+    {
+    return 0.0;
+    }
+
+  double sumOfIntensities =
+    segmentation->GetNumberOfPixels( RunLengthSegmentationType::HighRun ) * intensityRange;
+
+  typedef typename RunLengthSegmentationType::BandValueArrayType  BandValueArrayType;
+
+  const BandValueArrayType & bandValues = segmentation->GetBandValues();
+
+  typename BandValueArrayType::const_iterator bandItr = bandValues.begin();
+
+  while( bandItr != bandValues.end() )
+    {
+    sumOfIntensities += *bandItr - minimumIntensity;
+    ++bandItr;
+    }
+
+  const typename RunLengthSegmentationType::SpacingType & spacing = segmentation->GetSpacing();
+
+  double pixelVolume = spacing[0] * spacing[1] * spacing[2];
+
+  if( pixelVolume < 0.0 )
+    {
+    pixelVolume = -pixelVolume;
+    }
+
+  return pixelVolume * sumOfIntensities / intensityRange;
+}
+
+
 /*
  * Generate Data
  */
@@ -65,6 +122,18 @@ void
 GrayscaleImageSegmentationVolumeEstimator<NDimension>
 ::GenerateData()
 {
+  const RunLengthSegmentationType * segmentation =
+    dynamic_cast<const RunLengthSegmentationType * >( this->ProcessObject::GetInput(0) );
+
+  if( segmentation )
+    {
+    RealObjectType * outputCarrier =
+      static_cast<RealObjectType*>(this->ProcessObject::GetOutput(0));
+
+    outputCarrier->Set( this->EstimateVolume( segmentation ) );
+    return;
+    }
+
   typename InputImageSpatialObjectType::ConstPointer inputObject =
     dynamic_cast<const InputImageSpatialObjectType * >( this->ProcessObject::GetInput(0) );
 
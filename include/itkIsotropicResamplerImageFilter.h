@@ -20,6 +20,9 @@
 #include "itkResampleImageFilter.h"
 #include "itkImage.h"
 #include "itkBSplineInterpolateImageFunction.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +34,21 @@ namespace itk
  * This class resamples an image using BSplineInterpolator and produces
  * an isotropic image.
  *
+ * The output shares the origin and the direction of the input, only the
+ * spacing changes, so that the cubic B-spline interpolation is separable.
+ * By default the B-spline coefficients of the input are computed once and
+ * the image is interpolated along one axis at a time, with weights computed
+ * once per output position along that axis, and with the lines of each axis
+ * shared among the threads. Axes whose spacing does not change are neither
+ * decomposed nor interpolated, their samples are copied, so that thick
+ * slice data is only upsampled along the slices. The result is the one of ResampleImageFilter
+ * with an identity transform and BSplineInterpolateImageFunction, up to the
+ * rounding of the sums, and that path can still be selected.
+ *
+ * An input region may be set to resample a region of interest without
+ * cropping the input first. Only the region and a halo around it are read,
+ * so that the pipeline upstream need not produce the rest of the input.
+ *
  *\ingroup ITKLesionSizingToolkit
  * \ingroup ITKLesionSizingToolkit
  */
@@ -57,6 +75,7 @@ public:
   typedef typename InputImageType::SizeType       SizeType;
   typedef typename SizeType::SizeValueType        SizeValueType;
   typedef typename InputImageType::SpacingType    SpacingType;
+  typedef typename InputImageType::RegionType     InputRegionType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -77,6 +96,33 @@ public:
   itkSetMacro( DefaultPixelValue, OutputImagePixelType );
   itkGetMacro( DefaultPixelValue, OutputImagePixelType );
 
+  /** Interpolate along one axis at a time instead of running
+   * ResampleImageFilter. On by default. */
+  itkSetMacro( UseSeparableInterpolation, bool );
+  itkGetConstMacro( UseSeparableInterpolation, bool );
+  itkBooleanMacro( UseSeparableInterpolation );
+
+  /** Region of the input to resample, as if the input had been cropped to
+   * it by RegionOfInterestImageFilter: the output starts at index zero on
+   * the first pixel of the region. The input is read in place, and the
+   * pixels around the region that the interpolation needs are taken from
+   * the input instead of mirroring the region at its borders. An empty
+   * region, the default, stands for the whole input. */
+  itkSetMacro( InputRegion, InputRegionType );
+  itkGetConstReferenceMacro( InputRegion, InputRegionType );
+
+  /** Number of pixels read around the input region along the interpolated
+   * axes, from which the B-spline coefficients of the region are computed.
+   * The error made at the border of the halo decays as 0.27 to the power
+   * of the distance. Defaults to 8, and never less than 2, the support of
+   * the spline. */
+  itkSetMacro( HaloRadius, unsigned int );
+  itkGetConstMacro( HaloRadius, unsigned int );
+
+  /** Number of axes whose spacing changed in the last separable
+   * interpolation. */
+  itkGetConstMacro( NumberOfInterpolatedAxes, unsigned int );
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   /** End concept checking */
@@ -93,12 +139,22 @@ public:
    * below. \sa ProcessObject::GenerateOutputInformaton() */
   virtual void GenerateOutputInformation( void );
 
+  /** The input region and its halo are needed to compute the B-spline
+   * coefficients, the whole input when running ResampleImageFilter. */
+  virtual void GenerateInputRequestedRegion();
+
+  /** The whole output is produced. */
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
 protected:
   IsotropicResamplerImageFilter();
   void PrintSelf(std::ostream& os, Indent indent) const;
 
   void GenerateData();
 
+  /** Separable interpolation of the whole output. */
+  void GenerateSeparableData();
+
 private:
   virtual ~IsotropicResamplerImageFilter();
   IsotropicResamplerImageFilter(const Self&); //purposely not implemented
@@ -110,6 +166,57 @@ private:
 
   ResampleFilterPointer     m_ResampleFilter;
   OutputImagePixelType      m_DefaultPixelValue;
+  bool                      m_UseSeparableInterpolation;
+  unsigned int              m_NumberOfInterpolatedAxes;
+  InputRegionType           m_InputRegion;
+  unsigned int              m_HaloRadius;
+
+  /** Input region cropped by the input, or the whole input. */
+  InputRegionType GetResampledRegion() const;
+
+  /** Resampled region padded by the halo along the interpolated axes and
+   * cropped by the input. */
+  InputRegionType GetSupportRegion() const;
+
+  typedef double                              CoefficientType;
+  typedef std::vector< CoefficientType >      CoefficientBufferType;
+
+  /** Positions of the output along one axis that fall inside the input,
+   * with the four input indices, mirrored at the borders, and the four
+   * weights of each of them. Along an axis that is not interpolated, the
+   * weights pick the input sample. */
+  struct AxisWeightsType
+    {
+    bool                            Interpolated;
+    OffsetValueType                 Begin;
+    OffsetValueType                 End;
+    std::vector< OffsetValueType >  Indices;
+    std::vector< double >           Weights;
+    };
+
+  /** Cubic B-spline weights of the output positions along an axis, as in
+   * BSplineInterpolateImageFunction, with the indices of the support
+   * region. */
+  void ComputeAxisWeights( unsigned int axis, const InputRegionType & supportRegion,
+                           AxisWeightsType & weights );
+
+  /** Interpolate the lines of the pass buffer along the pass axis. */
+  void InterpolateLines( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  static ITK_THREAD_RETURN_TYPE InterpolateLinesThreaderCallback( void * arg );
+
+  /** Turn the lines of the pass buffer along the pass axis into cubic
+   * B-spline coefficients, in place. */
+  void DecomposeLines( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  static ITK_THREAD_RETURN_TYPE DecomposeLinesThreaderCallback( void * arg );
+
+  /** State of the pass being run. */
+  const CoefficientType *   m_PassInput;
+  CoefficientType *         m_PassOutput;
+  SizeType                  m_PassInputSize;
+  unsigned int              m_PassAxis;
+  const AxisWeightsType *   m_PassWeights;
 };
 
 } //end of namespace itk
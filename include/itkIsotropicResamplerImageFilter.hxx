@@ -19,6 +19,12 @@
 
 #include "itkIsotropicResamplerImageFilter.h"
 #include "itkProgressAccumulator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "vnl/vnl_math.h"
+#include "vcl_cmath.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -33,6 +39,15 @@ IsotropicResamplerImageFilter()
   this->m_OutputSpacing.Fill( 0.2 );  // 0.2 mm
   this->m_DefaultPixelValue = static_cast< OutputImagePixelType >(0.0);
   this->m_ResampleFilter = ResampleFilterType::New();
+  this->m_UseSeparableInterpolation = true;
+
+  this->m_PassInput = NULL;
+  this->m_PassOutput = NULL;
+  this->m_PassInputSize.Fill( 0 );
+  this->m_PassAxis = 0;
+  this->m_PassWeights = NULL;
+  this->m_NumberOfInterpolatedAxes = 0;
+  this->m_HaloRadius = 8;
 }
   
 template <class TInputImage, class TOutputImage>
@@ -64,7 +79,9 @@ IsotropicResamplerImageFilter< TInputImage, TOutputImage >
   
   const SpacingType & inputSpacing = inputImage->GetSpacing();
 
-  SizeType inputSize = inputImage->GetLargestPossibleRegion().GetSize(), finalSize;
+  const InputRegionType resampledRegion = this->GetResampledRegion();
+
+  SizeType inputSize = resampledRegion.GetSize(), finalSize;
   for (unsigned int i = 0; i < ImageDimension; i++)
     {
     const double dx = inputSize[i] * inputSpacing[i] / m_OutputSpacing[i];
@@ -78,13 +95,93 @@ IsotropicResamplerImageFilter< TInputImage, TOutputImage >
   outputLargestPossibleRegion.SetIndex( index );
   outputPtr->SetLargestPossibleRegion( outputLargestPossibleRegion );
   outputPtr->SetSpacing( m_OutputSpacing );
-  outputPtr->SetOrigin( inputImage->GetOrigin() );
+
+  // The origin of the region, as set by RegionOfInterestImageFilter.
+  typename TOutputImage::PointType origin;
+  inputImage->TransformIndexToPhysicalPoint( resampledRegion.GetIndex(), origin );
+  outputPtr->SetOrigin( origin );
 
 #if ITK_VERSION_MAJOR > 3 || (ITK_VERSION_MAJOR == 3 && ITK_VERSION_MINOR >= 10)
   outputPtr->SetDirection( inputImage->GetDirection() );
 #endif
 }
 
+template< class TInputImage, class TOutputImage >
+typename IsotropicResamplerImageFilter< TInputImage, TOutputImage >::InputRegionType
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::GetResampledRegion() const
+{
+  const InputRegionType & largestRegion = this->GetInput()->GetLargestPossibleRegion();
+
+  if( this->m_InputRegion.GetNumberOfPixels() == 0 )
+    {
+    return largestRegion;
+    }
+
+  InputRegionType region = this->m_InputRegion;
+  if( !region.Crop( largestRegion ) )
+    {
+    itkExceptionMacro("The input region " << this->m_InputRegion
+                      << " is outside of the input " << largestRegion);
+    }
+
+  return region;
+}
+
+template< class TInputImage, class TOutputImage >
+typename IsotropicResamplerImageFilter< TInputImage, TOutputImage >::InputRegionType
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::GetSupportRegion() const
+{
+  const InputImageType * inputImage = this->GetInput();
+
+  InputRegionType region = this->GetResampledRegion();
+
+  typename InputRegionType::SizeType radius;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const bool interpolated = ( this->m_OutputSpacing[d] != inputImage->GetSpacing()[d] );
+    radius[d] = interpolated ? vnl_math_max( this->m_HaloRadius, 2u ) : 0;
+    }
+
+  region.PadByRadius( radius );
+  region.Crop( inputImage->GetLargestPossibleRegion() );
+
+  return region;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * inputPtr = const_cast< InputImageType * >( this->GetInput() );
+  if( !inputPtr )
+    {
+    return;
+    }
+
+  if( this->m_UseSeparableInterpolation )
+    {
+    inputPtr->SetRequestedRegion( this->GetSupportRegion() );
+    }
+  else
+    {
+    inputPtr->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
 template< class TInputImage, class TOutputImage >
 void
 IsotropicResamplerImageFilter< TInputImage, TOutputImage >
@@ -100,7 +197,8 @@ IsotropicResamplerImageFilter< TInputImage, TOutputImage >
     itkExceptionMacro("Missing input image");
     }
 
-  if (m_OutputSpacing == inputImage->GetSpacing())
+  if (m_OutputSpacing == inputImage->GetSpacing() &&
+      this->GetResampledRegion() == inputImage->GetLargestPossibleRegion())
     {
     // No need to resample. Desiered output spacing is the same as the input 
     // spacing. Let's just graft the output and be done with it.
@@ -108,6 +206,12 @@ IsotropicResamplerImageFilter< TInputImage, TOutputImage >
     return;
     }
 
+  if( this->m_UseSeparableInterpolation )
+    {
+    this->GenerateSeparableData();
+    return;
+    }
+
   typedef itk::IdentityTransform< double, ImageDimension >  TransformType;
 
   typename TransformType::Pointer transform = TransformType::New();
@@ -122,21 +226,15 @@ IsotropicResamplerImageFilter< TInputImage, TOutputImage >
 #endif
   bsplineInterpolator->SetSplineOrder( 3 );
 
-  const SpacingType & inputSpacing = inputImage->GetSpacing();
-  SizeType inputSize = inputImage->GetLargestPossibleRegion().GetSize(), finalSize;
-  for (unsigned int i = 0; i < ImageDimension; i++)
-    {
-    const double dx = inputSize[i] * inputSpacing[i] / m_OutputSpacing[i];
-    finalSize[i] = static_cast<SizeValueType>( dx );
-    }
+  const OutputImageType * outputImage = this->GetOutput();
 
   this->m_ResampleFilter->SetTransform( transform );
   this->m_ResampleFilter->SetInterpolator( bsplineInterpolator );
   this->m_ResampleFilter->SetDefaultPixelValue( this->m_DefaultPixelValue );
   this->m_ResampleFilter->SetOutputSpacing( m_OutputSpacing );
-  this->m_ResampleFilter->SetOutputOrigin( inputImage->GetOrigin() );
+  this->m_ResampleFilter->SetOutputOrigin( outputImage->GetOrigin() );
   this->m_ResampleFilter->SetOutputDirection( inputImage->GetDirection() );
-  this->m_ResampleFilter->SetSize( finalSize );
+  this->m_ResampleFilter->SetSize( outputImage->GetLargestPossibleRegion().GetSize() );
   this->m_ResampleFilter->SetInput( inputImage );
 
   progress->RegisterInternalFilter( this->m_ResampleFilter, 1.0 );  
@@ -146,6 +244,494 @@ IsotropicResamplerImageFilter< TInputImage, TOutputImage >
   this->GraftOutput( this->m_ResampleFilter->GetOutput() );
 }
 
+/**
+ * The output index i along an axis is the continuous index
+ * start + i * outputSpacing / inputSpacing of the input, where start is the
+ * first index of the resampled region, since both images share their
+ * direction. Outside of the input, taken with the half pixel border of
+ * ImageFunction, the output is the default value. The indices of the
+ * support are relative to the support region, which the support never
+ * leaves but at the borders of the input, where it is mirrored.
+ * Along an axis whose spacing does not change, the continuous indices are
+ * integers, where the interpolating spline takes the input samples, and
+ * the samples are copied.
+ */
+template< class TInputImage, class TOutputImage >
+void
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::ComputeAxisWeights( unsigned int axis, const InputRegionType & supportRegion,
+                      AxisWeightsType & weights )
+{
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType * outputImage = this->GetOutput();
+
+  const InputRegionType & largestRegion = inputImage->GetLargestPossibleRegion();
+
+  const OffsetValueType resampledStart = this->GetResampledRegion().GetIndex()[axis];
+  const OffsetValueType largestStart = largestRegion.GetIndex()[axis];
+  const OffsetValueType largestLength = static_cast< OffsetValueType >( largestRegion.GetSize()[axis] );
+
+  const OffsetValueType inputStart = supportRegion.GetIndex()[axis];
+  const OffsetValueType inputLength = static_cast< OffsetValueType >( supportRegion.GetSize()[axis] );
+  const OffsetValueType outputLength =
+    static_cast< OffsetValueType >( outputImage->GetLargestPossibleRegion().GetSize()[axis] );
+
+  const double ratio = this->m_OutputSpacing[axis] / inputImage->GetSpacing()[axis];
+
+  const OffsetValueType dataLength2 = 2 * ( inputLength - 1 );
+
+  weights.Interpolated = ( ratio != 1.0 );
+  weights.Begin = outputLength;
+  weights.End = outputLength;
+  weights.Indices.clear();
+  weights.Weights.clear();
+
+  for( OffsetValueType i = 0; i < outputLength; i++ )
+    {
+    const double position = resampledStart + i * ratio;
+    const double x = position - inputStart;
+    const double largestX = position - largestStart;
+
+    if( !( largestX >= -0.5 && largestX < largestLength - 0.5 ) )
+      {
+      if( weights.Begin < outputLength )
+        {
+        weights.End = i;
+        break;
+        }
+      continue;
+      }
+
+    if( weights.Begin == outputLength )
+      {
+      weights.Begin = i;
+      }
+
+    if( !weights.Interpolated )
+      {
+      const OffsetValueType index = resampledStart + i - inputStart;
+      for( unsigned int k = 0; k < 4; k++ )
+        {
+        weights.Indices.push_back( index );
+        weights.Weights.push_back( ( k == 1 ) ? 1.0 : 0.0 );
+        }
+      continue;
+      }
+
+    const OffsetValueType first = static_cast< OffsetValueType >( vcl_floor( x ) ) - 1;
+
+    const double w = x - static_cast< double >( first + 1 );
+    double w3 = ( 1.0 / 6.0 ) * w * w * w;
+    double w0 = ( 1.0 / 6.0 ) + 0.5 * w * ( w - 1.0 ) - w3;
+    double w2 = w + w0 - 2.0 * w3;
+    double w1 = 1.0 - w0 - w2 - w3;
+
+    weights.Weights.push_back( w0 );
+    weights.Weights.push_back( w1 );
+    weights.Weights.push_back( w2 );
+    weights.Weights.push_back( w3 );
+
+    for( OffsetValueType k = 0; k < 4; k++ )
+      {
+      OffsetValueType index = first + k;
+
+      if( inputLength == 1 )
+        {
+        index = 0;
+        }
+      else
+        {
+        if( index < 0 )
+          {
+          index = -index - dataLength2 * ( ( -index ) / dataLength2 );
+          }
+        else
+          {
+          index = index - dataLength2 * ( index / dataLength2 );
+          }
+        if( inputLength <= index )
+          {
+          index = dataLength2 - index;
+          }
+        }
+
+      weights.Indices.push_back( index );
+      }
+    }
+}
+
+
+/**
+ * The B-spline coefficients are only computed along the axes whose spacing
+ * changes. When a single axis changes, as for thick slice data, the input
+ * is upsampled along that axis only, and the samples of the other axes are
+ * copied. The tensor product spline takes the same values at the output
+ * positions, since it goes through the input samples.
+ */
+template< class TInputImage, class TOutputImage >
+void
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::GenerateSeparableData()
+{
+  const InputImageType * inputImage = this->GetInput();
+
+  OutputImageType * outputImage = this->GetOutput();
+  outputImage->SetBufferedRegion( outputImage->GetLargestPossibleRegion() );
+  outputImage->Allocate();
+
+  // Pixels of the input the interpolation reads.
+  const InputRegionType inputRegion = this->GetSupportRegion();
+  const SizeType & inputSize = inputRegion.GetSize();
+
+  // Weights of every axis. The axes that are neither interpolated nor
+  // cropped need no pass. The others are ordered so that the ones that
+  // shrink the image come first and the ones that expand it last.
+  std::vector< AxisWeightsType > axisWeights( ImageDimension );
+  std::vector< std::pair< double, unsigned int > > axisOrder;
+
+  bool empty = false;
+
+  this->m_NumberOfInterpolatedAxes = 0;
+
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    AxisWeightsType & weights = axisWeights[d];
+
+    this->ComputeAxisWeights( d, inputRegion, weights );
+    empty = empty || ( weights.End <= weights.Begin );
+
+    if( weights.Interpolated )
+      {
+      ++this->m_NumberOfInterpolatedAxes;
+      }
+
+    if( weights.Interpolated || weights.Begin != 0 ||
+        weights.End != static_cast< OffsetValueType >( inputSize[d] ) )
+      {
+      axisOrder.push_back( std::make_pair(
+        static_cast< double >( weights.End - weights.Begin ) / inputSize[d], d ) );
+      }
+    }
+
+  std::sort( axisOrder.begin(), axisOrder.end() );
+
+  if( empty )
+    {
+    outputImage->FillBuffer( this->m_DefaultPixelValue );
+    return;
+    }
+
+  const unsigned int numberOfSteps = this->m_NumberOfInterpolatedAxes + axisOrder.size() + 1;
+  unsigned int step = 0;
+
+  CoefficientBufferType buffers[2];
+
+  // Input samples, turned in place into B-spline coefficients along the
+  // interpolated axes.
+  buffers[0].resize( inputRegion.GetNumberOfPixels() );
+
+  ImageRegionConstIterator< InputImageType > itr( inputImage, inputRegion );
+  CoefficientType * coefficient = &buffers[0][0];
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr, ++coefficient )
+    {
+    *coefficient = static_cast< CoefficientType >( itr.Get() );
+    }
+
+  this->m_PassInput = &buffers[0][0];
+  this->m_PassOutput = &buffers[0][0];
+  this->m_PassInputSize = inputSize;
+
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    if( axisWeights[d].Interpolated )
+      {
+      this->m_PassAxis = d;
+      this->GetMultiThreader()->SetSingleMethod( this->DecomposeLinesThreaderCallback, this );
+      this->GetMultiThreader()->SingleMethodExecute();
+      this->UpdateProgress( static_cast< float >( ++step ) / numberOfSteps );
+      }
+    }
+
+  for( unsigned int pass = 0; pass < axisOrder.size(); pass++ )
+    {
+    if( this->GetAbortGenerateData() )
+      {
+      ProcessAborted e( __FILE__, __LINE__ );
+      e.SetDescription( "Process aborted." );
+      e.SetLocation( ITK_LOCATION );
+      throw e;
+      }
+
+    const unsigned int axis = axisOrder[pass].second;
+    const AxisWeightsType & weights = axisWeights[axis];
+
+    SizeType passOutputSize = this->m_PassInputSize;
+    passOutputSize[axis] = weights.End - weights.Begin;
+
+    SizeValueType numberOfValues = 1;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      numberOfValues *= passOutputSize[d];
+      }
+
+    CoefficientBufferType & passBuffer = buffers[ ( pass + 1 ) % 2 ];
+    passBuffer.resize( numberOfValues );
+
+    this->m_PassOutput = &passBuffer[0];
+    this->m_PassAxis = axis;
+    this->m_PassWeights = &weights;
+
+    this->GetMultiThreader()->SetSingleMethod( this->InterpolateLinesThreaderCallback, this );
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    // The input of the pass is no longer needed.
+    CoefficientBufferType().swap( buffers[ pass % 2 ] );
+
+    this->m_PassInput = this->m_PassOutput;
+    this->m_PassInputSize = passOutputSize;
+
+    this->UpdateProgress( static_cast< float >( ++step ) / numberOfSteps );
+    }
+
+  // Copy the interpolated box in the output, casting with bounds checking
+  // as ResampleImageFilter, and set the default value around it.
+  typename OutputImageType::RegionType box;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    box.SetIndex( d, axisWeights[d].Begin );
+    box.SetSize( d, axisWeights[d].End - axisWeights[d].Begin );
+    }
+
+  if( box != outputImage->GetBufferedRegion() )
+    {
+    outputImage->FillBuffer( this->m_DefaultPixelValue );
+    }
+
+  const double minimumOutputValue = static_cast< double >( NumericTraits< OutputImagePixelType >::NonpositiveMin() );
+  const double maximumOutputValue = static_cast< double >( NumericTraits< OutputImagePixelType >::max() );
+
+  const CoefficientType * value = this->m_PassInput;
+
+  ImageRegionIterator< OutputImageType > otr( outputImage, box );
+
+  for( otr.GoToBegin(); !otr.IsAtEnd(); ++otr, ++value )
+    {
+    const double v = vnl_math_min( vnl_math_max( *value, minimumOutputValue ), maximumOutputValue );
+    otr.Set( static_cast< OutputImagePixelType >( v ) );
+    }
+
+  this->m_PassInput = NULL;
+  this->m_PassOutput = NULL;
+  this->m_PassWeights = NULL;
+}
+
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::DecomposeLinesThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+
+  Self * filter = static_cast< Self * >( info->UserData );
+
+  filter->DecomposeLines( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * Cubic B-spline coefficients of the lines of the pass buffer along the
+ * pass axis, computed in place with the recursive filter, the gain, the
+ * mirror boundary initializations and the tolerance of
+ * BSplineDecompositionImageFilter.
+ */
+template< class TInputImage, class TOutputImage >
+void
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::DecomposeLines( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const unsigned int axis = this->m_PassAxis;
+
+  SizeValueType stride = 1;
+  for( unsigned int d = 0; d < axis; d++ )
+    {
+    stride *= this->m_PassInputSize[d];
+    }
+
+  SizeValueType numberOfLines = stride;
+  for( unsigned int d = axis + 1; d < ImageDimension; d++ )
+    {
+    numberOfLines *= this->m_PassInputSize[d];
+    }
+
+  const SizeValueType length = this->m_PassInputSize[axis];
+
+  if( length == 1 )
+    {
+    return;
+    }
+
+  const double z = vcl_sqrt( 3.0 ) - 2.0;
+  const double gain = ( 1.0 - z ) * ( 1.0 - 1.0 / z );
+  const double tolerance = 1e-10;
+
+  const SizeValueType horizon =
+    static_cast< SizeValueType >( vcl_ceil( vcl_log( tolerance ) / vcl_log( vcl_fabs( z ) ) ) );
+
+  const SizeValueType lineBegin = numberOfLines * threadId / numberOfThreads;
+  const SizeValueType lineEnd = numberOfLines * ( threadId + 1 ) / numberOfThreads;
+
+  std::vector< CoefficientType > scratch( length );
+
+  for( SizeValueType line = lineBegin; line < lineEnd; line++ )
+    {
+    CoefficientType * values = this->m_PassOutput +
+      ( line % stride ) + ( line / stride ) * length * stride;
+
+    for( SizeValueType n = 0; n < length; n++ )
+      {
+      scratch[n] = values[n * stride] * gain;
+      }
+
+    // Causal initialization.
+    if( horizon < length )
+      {
+      double zn = z;
+      CoefficientType sum = scratch[0];
+      for( SizeValueType n = 1; n < horizon; n++ )
+        {
+        sum += zn * scratch[n];
+        zn *= z;
+        }
+      scratch[0] = sum;
+      }
+    else
+      {
+      double zn = z;
+      const double iz = 1.0 / z;
+      double z2n = vcl_pow( z, static_cast< double >( length - 1 ) );
+      CoefficientType sum = scratch[0] + z2n * scratch[length - 1];
+      z2n *= z2n * iz;
+      for( SizeValueType n = 1; n + 1 < length; n++ )
+        {
+        sum += ( zn + z2n ) * scratch[n];
+        zn *= z;
+        z2n *= iz;
+        }
+      scratch[0] = sum / ( 1.0 - zn * zn );
+      }
+
+    for( SizeValueType n = 1; n < length; n++ )
+      {
+      scratch[n] += z * scratch[n - 1];
+      }
+
+    // Anticausal initialization.
+    scratch[length - 1] = ( z / ( z * z - 1.0 ) ) * ( z * scratch[length - 2] + scratch[length - 1] );
+
+    for( OffsetValueType n = static_cast< OffsetValueType >( length ) - 2; n >= 0; n-- )
+      {
+      scratch[n] = z * ( scratch[n + 1] - scratch[n] );
+      }
+
+    for( SizeValueType n = 0; n < length; n++ )
+      {
+      values[n * stride] = scratch[n];
+      }
+    }
+}
+
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::InterpolateLinesThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+
+  Self * filter = static_cast< Self * >( info->UserData );
+
+  filter->InterpolateLines( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * The buffer is seen as a set of lines along the pass axis. The lines of
+ * the same outer index are interpolated together, so that the innermost
+ * loop always runs over contiguous values. The threads share the outer
+ * indices, or the inner ones when there are fewer outer indices than
+ * threads.
+ */
+template< class TInputImage, class TOutputImage >
+void
+IsotropicResamplerImageFilter< TInputImage, TOutputImage >
+::InterpolateLines( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const unsigned int axis = this->m_PassAxis;
+  const AxisWeightsType & weights = *this->m_PassWeights;
+
+  SizeValueType stride = 1;
+  for( unsigned int d = 0; d < axis; d++ )
+    {
+    stride *= this->m_PassInputSize[d];
+    }
+
+  SizeValueType numberOfOuterIndices = 1;
+  for( unsigned int d = axis + 1; d < ImageDimension; d++ )
+    {
+    numberOfOuterIndices *= this->m_PassInputSize[d];
+    }
+
+  const SizeValueType inputLength = this->m_PassInputSize[axis];
+  const SizeValueType outputLength = weights.End - weights.Begin;
+
+  SizeValueType outerBegin = 0;
+  SizeValueType outerEnd = numberOfOuterIndices;
+  SizeValueType innerBegin = 0;
+  SizeValueType innerEnd = stride;
+
+  if( numberOfOuterIndices >= numberOfThreads )
+    {
+    outerBegin = numberOfOuterIndices * threadId / numberOfThreads;
+    outerEnd = numberOfOuterIndices * ( threadId + 1 ) / numberOfThreads;
+    }
+  else
+    {
+    innerBegin = stride * threadId / numberOfThreads;
+    innerEnd = stride * ( threadId + 1 ) / numberOfThreads;
+    }
+
+  for( SizeValueType outer = outerBegin; outer < outerEnd; outer++ )
+    {
+    const CoefficientType * inputLines = this->m_PassInput + outer * inputLength * stride;
+    CoefficientType * outputLines = this->m_PassOutput + outer * outputLength * stride;
+
+    for( SizeValueType j = 0; j < outputLength; j++ )
+      {
+      const OffsetValueType * indices = &weights.Indices[4 * j];
+      const double * w = &weights.Weights[4 * j];
+
+      const CoefficientType * s0 = inputLines + indices[0] * stride;
+      const CoefficientType * s1 = inputLines + indices[1] * stride;
+      const CoefficientType * s2 = inputLines + indices[2] * stride;
+      const CoefficientType * s3 = inputLines + indices[3] * stride;
+
+      CoefficientType * target = outputLines + j * stride;
+
+      for( SizeValueType i = innerBegin; i < innerEnd; i++ )
+        {
+        target[i] = w[0] * s0[i] + w[1] * s1[i] + w[2] * s2[i] + w[3] * s3[i];
+        }
+      }
+    }
+}
+
 template <class TInputImage, class TOutputImage>
 void IsotropicResamplerImageFilter< TInputImage,TOutputImage >
 ::SetAbortGenerateData( bool abort )
@@ -161,6 +747,12 @@ IsotropicResamplerImageFilter<TInputImage,TOutputImage>
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os,indent);
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "DefaultPixelValue: " << this->m_DefaultPixelValue << std::endl;
+  os << indent << "UseSeparableInterpolation: " << this->m_UseSeparableInterpolation << std::endl;
+  os << indent << "NumberOfInterpolatedAxes: " << this->m_NumberOfInterpolatedAxes << std::endl;
+  os << indent << "InputRegion: " << this->m_InputRegion << std::endl;
+  os << indent << "HaloRadius: " << this->m_HaloRadius << std::endl;
 }
 
 }//end of itk namespace
@@ -22,6 +22,9 @@
 #include "itkLandmarkSpatialObject.h"
 #include "itkSpatialObjectReader.h"
 
+#include <string>
+#include <vector>
+
 namespace itk
 {
 
@@ -30,6 +33,14 @@ namespace itk
  *
  * A LandmarkSpatialObject is produced as output.
  *
+ * The file is parsed in a single pass, and the points of every landmark
+ * object it holds are stored directly in their point lists, so that seed
+ * files with several lesions or many seeds are read without building the
+ * scene of the file. The output holds the points of the first landmark
+ * object, and all the landmark objects of the file are available through
+ * GetLandmarkSpatialObject(). Files that hold other objects, or binary
+ * points, are read through SpatialObjectReader.
+ *
  * \ingroup SpatialObjectFilters
  * \ingroup ITKLesionSizingToolkit
  */
@@ -65,6 +76,15 @@ public:
   itkSetStringMacro( FileName );
   itkGetStringMacro( FileName );
 
+  /** Landmark objects of the file, in the order of the file. The first one
+   * is the output. */
+  unsigned int GetNumberOfLandmarkSpatialObjects() const;
+  const SpatialObjectType * GetLandmarkSpatialObject( unsigned int index ) const;
+
+  /** Whether the last update parsed the file directly, instead of reading
+   * its scene. */
+  itkGetConstMacro( IsParsedDirectly, bool );
+
 protected:
   LandmarksReader();
   virtual ~LandmarksReader();
@@ -82,8 +102,19 @@ private:
   typedef typename SpatialObjectReaderType::SceneType         SceneType;
   typedef typename SceneType::ObjectListType                  ObjectListType;
 
-  std::string                     m_FileName;
-  SpatialObjectReaderPointer      m_SpatialObjectReader;
+  /** Parses the landmark objects of the file. Returns false when the file
+   * holds objects or points that only SpatialObjectReader can read. */
+  bool ParseLandmarks();
+
+  /** Reads the landmark objects of the scene of the file. */
+  void ReadLandmarksFromScene();
+
+  static std::string GetTrimmedString( const char * begin, const char * end );
+
+  std::string                             m_FileName;
+  SpatialObjectReaderPointer              m_SpatialObjectReader;
+  std::vector< SpatialObjectPointer >     m_LandmarkSpatialObjects;
+  bool                                    m_IsParsedDirectly;
 };
 
 } // end namespace itk
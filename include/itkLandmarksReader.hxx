@@ -20,6 +20,11 @@
 #include "itkLandmarksReader.h"
 #include "itkSpatialObjectReader.h"
 
+#include <fstream>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
 
 namespace itk
 {
@@ -34,6 +39,7 @@ LandmarksReader<NDimension>
   this->SetNumberOfRequiredOutputs( 1 );
 
   this->m_SpatialObjectReader = SpatialObjectReaderType::New();
+  this->m_IsParsedDirectly = false;
 
   typename SpatialObjectType::Pointer outputObject = SpatialObjectType::New();
 
@@ -58,11 +64,246 @@ LandmarksReader<NDimension>
   return static_cast<const SpatialObjectType*>(this->ProcessObject::GetOutput(0));
 }
 
+template <unsigned int NDimension>
+unsigned int
+LandmarksReader<NDimension>
+::GetNumberOfLandmarkSpatialObjects() const
+{
+  return static_cast< unsigned int >( this->m_LandmarkSpatialObjects.size() );
+}
+
+template <unsigned int NDimension>
+const typename LandmarksReader<NDimension>::SpatialObjectType *
+LandmarksReader<NDimension>
+::GetLandmarkSpatialObject( unsigned int index ) const
+{
+  if( index >= this->m_LandmarkSpatialObjects.size() )
+    {
+    return NULL;
+    }
+  return this->m_LandmarkSpatialObjects[index].GetPointer();
+}
+
 template <unsigned int NDimension>
 void
 LandmarksReader<NDimension>
 ::GenerateData()
 {
+  this->m_IsParsedDirectly = this->ParseLandmarks();
+
+  if( !this->m_IsParsedDirectly )
+    {
+    this->ReadLandmarksFromScene();
+    }
+
+  if( this->m_LandmarkSpatialObjects.empty() )
+    {
+    itkExceptionMacro("Input file does not contain landmarks");
+    }
+}
+
+template <unsigned int NDimension>
+std::string
+LandmarksReader<NDimension>
+::GetTrimmedString( const char * begin, const char * end )
+{
+  while( begin < end && std::isspace( static_cast< unsigned char >( *begin ) ) )
+    {
+    ++begin;
+    }
+  while( end > begin && std::isspace( static_cast< unsigned char >( *( end - 1 ) ) ) )
+    {
+    --end;
+    }
+  return std::string( begin, end );
+}
+
+/**
+ * The header fields of each object hold on a line, "Key = Value". The ASCII
+ * points of a landmark object follow its Points field, as the coordinates
+ * and the four color components of each point, separated by spaces or
+ * commas. The scene and group objects that hold the landmarks are skipped.
+ */
+template <unsigned int NDimension>
+bool
+LandmarksReader<NDimension>
+::ParseLandmarks()
+{
+  this->m_LandmarkSpatialObjects.clear();
+
+  std::ifstream is( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+
+  if( !is )
+    {
+    itkExceptionMacro("Could not open " << this->m_FileName );
+    }
+
+  std::string buffer;
+
+  is.seekg( 0, std::ios::end );
+  buffer.resize( static_cast< std::string::size_type >( is.tellg() ) );
+  is.seekg( 0, std::ios::beg );
+
+  if( !buffer.empty() )
+    {
+    is.read( &buffer[0], buffer.size() );
+    }
+
+  if( !is )
+    {
+    itkExceptionMacro("Could not read " << this->m_FileName );
+    }
+
+  const char * current = buffer.c_str();
+  const char * end = current + buffer.size();
+
+  bool isLandmark = false;
+  bool binaryData = false;
+  unsigned int numberOfDimensions = NDimension;
+  unsigned long numberOfPoints = 0;
+  std::string name;
+
+  while( current < end )
+    {
+    const char * lineEnd = static_cast< const char * >( std::memchr( current, '\n', end - current ) );
+    if( !lineEnd )
+      {
+      lineEnd = end;
+      }
+
+    const char * separator = static_cast< const char * >( std::memchr( current, '=', lineEnd - current ) );
+
+    const std::string key = separator ? GetTrimmedString( current, separator ) : std::string();
+
+    if( key == "Points" && isLandmark )
+      {
+      if( binaryData )
+        {
+        return false;
+        }
+
+      if( numberOfDimensions != NDimension )
+        {
+        itkExceptionMacro("Landmark " << name << " of " << this->m_FileName
+          << " has " << numberOfDimensions << " dimensions");
+        }
+
+      // Each value takes at least two characters
+      if( numberOfPoints > static_cast< unsigned long >( end - separator ) / ( 2 * ( NDimension + 4 ) ) )
+        {
+        itkExceptionMacro("Landmark " << name << " of " << this->m_FileName
+          << " has fewer points than its " << numberOfPoints);
+        }
+
+      // The first landmark object is the output
+      SpatialObjectPointer landmarkSpatialObject;
+      if( this->m_LandmarkSpatialObjects.empty() )
+        {
+        landmarkSpatialObject = static_cast< SpatialObjectType * >( this->ProcessObject::GetOutput(0) );
+        }
+      else
+        {
+        landmarkSpatialObject = SpatialObjectType::New();
+        }
+
+      typename SpatialObjectType::PointListType & points = landmarkSpatialObject->GetPoints();
+      points.clear();
+      points.resize( numberOfPoints );
+
+      const char * value = separator + 1;
+
+      for( unsigned long i = 0; i < numberOfPoints; i++ )
+        {
+        // Values are stored as float by MetaIO
+        float values[NDimension + 4];
+
+        for( unsigned int k = 0; k < NDimension + 4; k++ )
+          {
+          while( value < end && ( std::isspace( static_cast< unsigned char >( *value ) ) || *value == ',' ) )
+            {
+            ++value;
+            }
+
+          char * valueEnd = NULL;
+          values[k] = static_cast< float >( std::strtod( value, &valueEnd ) );
+
+          if( valueEnd == value )
+            {
+            itkExceptionMacro("Could not read point " << i << " of landmark " << name
+              << " in " << this->m_FileName );
+            }
+          value = valueEnd;
+          }
+
+        typename SpatialObjectType::SpatialObjectPointType::PointType position;
+        for( unsigned int d = 0; d < NDimension; d++ )
+          {
+          position[d] = values[d];
+          }
+
+        points[i].SetPosition( position );
+        points[i].SetColor( values[NDimension], values[NDimension + 1],
+                            values[NDimension + 2], values[NDimension + 3] );
+        }
+
+      landmarkSpatialObject->GetProperty()->SetName( name );
+      landmarkSpatialObject->ComputeBoundingBox();
+      landmarkSpatialObject->Modified();
+
+      this->m_LandmarkSpatialObjects.push_back( landmarkSpatialObject );
+
+      isLandmark = false;
+      current = value;
+      continue;
+      }
+
+    if( separator )
+      {
+      const std::string value = GetTrimmedString( separator + 1, lineEnd );
+
+      if( key == "ObjectType" )
+        {
+        if( value != "Landmark" && value != "Scene" && value != "Group" )
+          {
+          return false;
+          }
+        isLandmark = ( value == "Landmark" );
+        binaryData = false;
+        numberOfDimensions = NDimension;
+        numberOfPoints = 0;
+        name.clear();
+        }
+      else if( key == "NDims" )
+        {
+        numberOfDimensions = static_cast< unsigned int >( std::atoi( value.c_str() ) );
+        }
+      else if( key == "Name" )
+        {
+        name = value;
+        }
+      else if( key == "BinaryData" )
+        {
+        binaryData = ( value == "True" || value == "true" || value == "1" );
+        }
+      else if( key == "NPoints" )
+        {
+        numberOfPoints = std::strtoul( value.c_str(), NULL, 10 );
+        }
+      }
+
+    current = ( lineEnd < end ) ? lineEnd + 1 : end;
+    }
+
+  return true;
+}
+
+template <unsigned int NDimension>
+void
+LandmarksReader<NDimension>
+::ReadLandmarksFromScene()
+{
+  this->m_LandmarkSpatialObjects.clear();
+
   this->m_SpatialObjectReader->SetFileName( this->GetFileName() );
 
   this->m_SpatialObjectReader->Update();
@@ -78,7 +319,8 @@ LandmarksReader<NDimension>
 
   typename ObjectListType::const_iterator spatialObjectItr = sceneChildren->begin();
 
-  typename SpatialObjectType::Pointer landmarkSpatialObject;
+  SpatialObjectType * outputObject =
+    dynamic_cast< SpatialObjectType * >(this->ProcessObject::GetOutput(0));
 
   while( spatialObjectItr != sceneChildren->end() ) 
     {
@@ -87,24 +329,25 @@ LandmarksReader<NDimension>
       {
       const SpatialObjectType * landmarkSpatialObjectRawPointer = 
         dynamic_cast< const SpatialObjectType * >( spatialObjectItr->GetPointer() );
-      landmarkSpatialObject =
+      SpatialObjectPointer landmarkSpatialObject =
         const_cast< SpatialObjectType * >( landmarkSpatialObjectRawPointer );
-      break;
-      }
-    spatialObjectItr++;
-    }
 
-  if( landmarkSpatialObject.IsNull() )
-    {
-    itkExceptionMacro("Input file does not contain landmarks");
-    }
- 
-  landmarkSpatialObject->DisconnectPipeline();
+      if( landmarkSpatialObject.IsNotNull() )
+        {
+        landmarkSpatialObject->DisconnectPipeline();
 
-  SpatialObjectType * outputObject =
-    dynamic_cast< SpatialObjectType * >(this->ProcessObject::GetOutput(0));
+        if( this->m_LandmarkSpatialObjects.empty() )
+          {
+          outputObject->SetPoints( landmarkSpatialObject->GetPoints() );
+          outputObject->GetProperty()->SetName( landmarkSpatialObject->GetProperty()->GetName() );
+          landmarkSpatialObject = outputObject;
+          }
 
-  outputObject->SetPoints( landmarkSpatialObject->GetPoints() );
+        this->m_LandmarkSpatialObjects.push_back( landmarkSpatialObject );
+        }
+      }
+    spatialObjectItr++;
+    }
 
   delete sceneChildren;
 }
@@ -119,6 +362,8 @@ LandmarksReader<NDimension>
 {
   Superclass::PrintSelf( os, indent );
   os << indent << this->m_FileName << std::endl;
+  os << indent << "Number of landmark objects: " << this->m_LandmarkSpatialObjects.size() << std::endl;
+  os << indent << "Parsed directly: " << this->m_IsParsedDirectly << std::endl;
 }
 
 
@@ -108,7 +108,22 @@ public:
   itkSetMacro( SigmoidBeta, double );
   itkGetMacro( SigmoidBeta, double );
 
-  /** Turn On/Off isotropic resampling prior to running the segmentation */
+  /** Relative change of the segmented volume under which the level set
+   * refinement stops. Zero, the default, disables this criterion and only
+   * the RMS change and the number of iterations are used. */
+  itkSetMacro( VolumeConvergenceTolerance, double );
+  itkGetMacro( VolumeConvergenceTolerance, double );
+
+  /** Run the level set refinement only around the region reached by the
+   * fast marching, padded by a safety margin, instead of over the whole
+   * ROI. Off by default. */
+  itkSetMacro( CropToFastMarchingRegion, bool );
+  itkGetMacro( CropToFastMarchingRegion, bool );
+  itkBooleanMacro( CropToFastMarchingRegion );
+
+  /** Turn On/Off isotropic resampling prior to running the segmentation.
+   * When On, the ROI is resampled straight from the input, without an
+   * intermediate cropped image. */
   itkSetMacro( ResampleThickSliceData, bool );
   itkGetMacro( ResampleThickSliceData, bool );
   itkBooleanMacro( ResampleThickSliceData );
@@ -181,6 +196,8 @@ private:
   double                                m_SigmoidBeta;
   double                                m_FastMarchingStoppingTime;
   double                                m_FastMarchingDistanceFromSeeds;
+  double                                m_VolumeConvergenceTolerance;
+  bool                                  m_CropToFastMarchingRegion;
 
   typename LesionSegmentationMethodType::Pointer      m_LesionSegmentationMethod;
   typename LungWallGeneratorType::Pointer             m_LungWallFeatureGenerator;
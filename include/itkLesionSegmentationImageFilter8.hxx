@@ -22,7 +22,7 @@
 #include "itkProgressReporter.h"
 #include "itkGradientMagnitudeImageFilter.h"
 #include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
+#include "itkChunkedCompressionMetaImageWriter.h"
 
 namespace itk
 {
@@ -87,6 +87,8 @@ LesionSegmentationImageFilter8()
   m_CannyEdgesFeatureGenerator->SetLowerThreshold( 75.0 );
   m_FastMarchingStoppingTime = 5.0;
   m_FastMarchingDistanceFromSeeds = 0.5;
+  m_VolumeConvergenceTolerance = 0.0;
+  m_CropToFastMarchingRegion = false;
   m_SigmoidBeta = -500.0;
   m_StatusMessage = "";
   m_SegmentationModule->SetCurvatureScaling(1.0);
@@ -140,7 +142,10 @@ LesionSegmentationImageFilter8<TInputImage,TOutputImage>
     }
 
   // Minipipeline is :
-  //   Input -> Crop -> Resample_if_too_anisotropic -> Segment
+  //   Input -> Crop -> Segment
+  // or, when resampling thick slice data, the resampler reads the ROI
+  // straight from the input, without an intermediate cropped image :
+  //   Input -> Resample_ROI_if_too_anisotropic -> Segment
 
   m_CropFilter->SetInput(inputPtr);
   m_CropFilter->SetRegionOfInterest(m_RegionOfInterest);
@@ -165,7 +170,8 @@ LesionSegmentationImageFilter8<TInputImage,TOutputImage>
 
   if (m_ResampleThickSliceData)
     {
-    m_IsotropicResampler->SetInput( m_CropFilter->GetOutput() );
+    m_IsotropicResampler->SetInput( inputPtr );
+    m_IsotropicResampler->SetInputRegion( m_RegionOfInterest );
     m_IsotropicResampler->SetOutputSpacing( outputSpacing );
     m_IsotropicResampler->GenerateOutputInformation();
     outputPtr->CopyInformation( m_IsotropicResampler->GetOutput() );
@@ -185,6 +191,8 @@ LesionSegmentationImageFilter8< TInputImage, TOutputImage >
   m_SigmoidFeatureGenerator->SetBeta( m_SigmoidBeta );
   m_SegmentationModule->SetDistanceFromSeeds(m_FastMarchingDistanceFromSeeds);
   m_SegmentationModule->SetStoppingValue(m_FastMarchingStoppingTime);
+  m_SegmentationModule->SetVolumeConvergenceTolerance(m_VolumeConvergenceTolerance);
+  m_SegmentationModule->SetCropToReachedRegion(m_CropToFastMarchingRegion);
 
   // Allocate the output
   this->GetOutput()->SetBufferedRegion( this->GetOutput()->GetRequestedRegion() );
@@ -193,9 +201,8 @@ LesionSegmentationImageFilter8< TInputImage, TOutputImage >
   // Get the input image
   typename InputImageType::ConstPointer  input  = this->GetInput();
 
-  // Crop and perform thin slice resampling (done only if necessary)
-  m_CropFilter->Update();
-
+  // Crop, or resample the ROI (which only crops it if the data is not
+  // too anisotropic)
   typename InputImageType::Pointer inputImage = NULL;
   if (m_ResampleThickSliceData)
     {
@@ -204,6 +211,7 @@ LesionSegmentationImageFilter8< TInputImage, TOutputImage >
     }
   else
     {
+    m_CropFilter->Update();
     inputImage = m_CropFilter->GetOutput();
     }
 
@@ -249,11 +257,10 @@ LesionSegmentationImageFilter8< TInputImage, TOutputImage >
   this->GraftOutput(outputImage);
 
   /* // DEBUGGING CODE
-  typedef ImageFileWriter< OutputImageType > WriterType;
+  typedef ChunkedCompressionMetaImageWriter< OutputImageType > WriterType;
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName("output.mha");
   writer->SetInput(outputImage);
-  writer->UseCompressionOn();
   writer->Write();*/
 }
 
@@ -0,0 +1,302 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLesionSegmentationParameterSweep.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLesionSegmentationParameterSweep_h
+#define __itkLesionSegmentationParameterSweep_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkCommand.h"
+#include "itkImageSpatialObject.h"
+#include "itkLandmarkSpatialObject.h"
+#include "itkLungWallFeatureGenerator.h"
+#include "itkSatoVesselnessSigmoidFeatureGenerator.h"
+#include "itkSigmoidFeatureGenerator.h"
+#include "itkCannyEdgesFeatureGenerator.h"
+#include "itkMinimumFeatureAggregator.h"
+#include "itkFastMarchingSegmentationModule.h"
+#include "itkGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkIsotropicResamplerImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace itk
+{
+
+/** \class LesionSegmentationParameterSweep
+ * \brief Runs the segmentation of LesionSegmentationImageFilter8 over a grid
+ * of parameters.
+ *
+ * The pipeline is the one of LesionSegmentationImageFilter8: cropping and
+ * resampling of the input, lung wall, vesselness, sigmoid and Canny edges
+ * features, their minimum, fast marching from the seeds and geodesic active
+ * contour refinement. The sigmoid beta, the Canny sigma, the propagation
+ * scaling and the curvature scaling can each be given a list of values, and
+ * every combination of them is segmented.
+ *
+ * Each stage of the pipeline is invalidated by the parameters it reads and
+ * by the ones of the stages it takes its inputs from. A stage is executed
+ * once for each distinct combination of the values of those parameters, and
+ * its products are shared by all the configurations that agree on them. The
+ * level set refinements, one per configuration, are then run in parallel.
+ *
+ * The volume of each configuration is the volume of the pixels above the
+ * SegmentationThreshold, -0.5 by default, in the output level set. The
+ * volumes can be written as CSV.
+ *
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TInputImage>
+class ITK_EXPORT LesionSegmentationParameterSweep : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef LesionSegmentationParameterSweep      Self;
+  typedef Object                                Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LesionSegmentationParameterSweep, Object);
+
+  /** ImageDimension constant */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TInputImage                                     InputImageType;
+  typedef typename InputImageType::PixelType              InputImagePixelType;
+  typedef typename InputImageType::RegionType             RegionType;
+  typedef typename InputImageType::SpacingType            SpacingType;
+
+  typedef LandmarkSpatialObject< ImageDimension >         SeedSpatialObjectType;
+  typedef typename SeedSpatialObjectType::PointListType   PointListType;
+
+  /** Parameters that can take a list of values. */
+  typedef enum
+    {
+    SigmoidBetaParameter = 0,
+    CannySigmaParameter,
+    PropagationScalingParameter,
+    CurvatureScalingParameter,
+    NumberOfParameters
+    } ParameterType;
+
+  /** Stages of the pipeline. */
+  typedef enum
+    {
+    PreprocessingStage = 0,
+    LungWallStage,
+    VesselnessStage,
+    SigmoidStage,
+    CannyEdgesStage,
+    AggregationStage,
+    FastMarchingStage,
+    LevelSetStage,
+    NumberOfStages
+    } StageType;
+
+  typedef std::vector< double >                           ParameterValueListType;
+
+  /** Values of the parameters of a configuration and its segmented volume,
+   * in cubic millimeters. */
+  struct ConfigurationType
+    {
+    double Parameters[NumberOfParameters];
+    double Volume;
+    };
+
+  /** Image to segment. */
+  void SetInput( const InputImageType * image );
+  const InputImageType * GetInput() const;
+
+  /** Region of the input to segment. The whole input is used if the region
+   * is empty, which is the default. */
+  itkSetMacro( RegionOfInterest, RegionType );
+  itkGetConstReferenceMacro( RegionOfInterest, RegionType );
+
+  /** Seeds of the lesion, in physical coordinates. */
+  void SetSeeds( const PointListType & seeds ) { this->m_Seeds = seeds; this->Modified(); }
+  const PointListType & GetSeeds() const { return this->m_Seeds; }
+
+  /** Resampling of thick slice data, as in LesionSegmentationImageFilter8. */
+  itkSetMacro( ResampleThickSliceData, bool );
+  itkGetConstMacro( ResampleThickSliceData, bool );
+  itkBooleanMacro( ResampleThickSliceData );
+  itkSetMacro( AnisotropyThreshold, double );
+  itkGetConstMacro( AnisotropyThreshold, double );
+
+  /** Parameters shared by all the configurations. */
+  itkSetMacro( FastMarchingStoppingTime, double );
+  itkGetConstMacro( FastMarchingStoppingTime, double );
+  itkSetMacro( FastMarchingDistanceFromSeeds, double );
+  itkGetConstMacro( FastMarchingDistanceFromSeeds, double );
+  itkSetMacro( MaximumRMSError, double );
+  itkGetConstMacro( MaximumRMSError, double );
+  itkSetMacro( MaximumNumberOfIterations, unsigned int );
+  itkGetConstMacro( MaximumNumberOfIterations, unsigned int );
+
+  /** Level set value above which a pixel is counted in the volume. */
+  itkSetMacro( SegmentationThreshold, double );
+  itkGetConstMacro( SegmentationThreshold, double );
+
+  /** Number of level set refinements run at the same time. Defaults to the
+   * global default number of threads. */
+  itkSetClampMacro( NumberOfThreads, unsigned int, 1, NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfThreads, unsigned int );
+
+  /** Values taken by a parameter. The defaults are the single values used
+   * by LesionSegmentationImageFilter8. An empty list of Canny sigmas, the
+   * default, stands for the largest spacing of the input. */
+  void SetParameterValues( ParameterType parameter, const ParameterValueListType & values );
+  const ParameterValueListType & GetParameterValues( ParameterType parameter ) const;
+
+  /** Whether a change of the parameter requires the stage to be executed
+   * again, either because the stage reads it or because one of the stages
+   * it takes its inputs from does. */
+  bool IsStageInvalidatedBy( StageType stage, ParameterType parameter ) const;
+
+  /** Segment every configuration of the grid. */
+  void Compute();
+
+  /** Configurations of the last computation, the last parameter varying
+   * fastest. */
+  unsigned int GetNumberOfConfigurations() const;
+  const ConfigurationType & GetConfiguration( unsigned int i ) const;
+
+  /** Number of executions of a stage required by the grid, and number of
+   * executions that took place during the last computation. */
+  SizeValueType GetNumberOfPlannedExecutions( StageType stage ) const;
+  SizeValueType GetNumberOfExecutions( StageType stage ) const;
+
+  static const char * GetParameterName( ParameterType parameter );
+  static const char * GetStageName( StageType stage );
+
+  /** Write one line per configuration, with the values of the parameters
+   * and the volume, after a header line. */
+  void WriteCSV( std::ostream & os ) const;
+  void WriteCSV( const std::string & fileName ) const;
+
+protected:
+  LesionSegmentationParameterSweep();
+  virtual ~LesionSegmentationParameterSweep();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  typedef float                                                   FeaturePixelType;
+  typedef Image< FeaturePixelType, ImageDimension >               FeatureImageType;
+  typedef typename FeatureImageType::ConstPointer                 FeatureImageConstPointer;
+  typedef ImageSpatialObject< ImageDimension, FeaturePixelType >  FeatureSpatialObjectType;
+  typedef ImageSpatialObject< ImageDimension, InputImagePixelType > InputImageSpatialObjectType;
+
+  typedef RegionOfInterestImageFilter< InputImageType, InputImageType >     CropFilterType;
+  typedef IsotropicResamplerImageFilter< InputImageType, InputImageType >   IsotropicResamplerType;
+  typedef LungWallFeatureGenerator< ImageDimension >                        LungWallGeneratorType;
+  typedef SatoVesselnessSigmoidFeatureGenerator< ImageDimension >           VesselnessGeneratorType;
+  typedef SigmoidFeatureGenerator< ImageDimension >                         SigmoidFeatureGeneratorType;
+  typedef CannyEdgesFeatureGenerator< ImageDimension >                      CannyEdgesFeatureGeneratorType;
+  typedef MinimumFeatureAggregator< ImageDimension >                        FeatureAggregatorType;
+  typedef FastMarchingSegmentationModule< ImageDimension >                  FastMarchingModuleType;
+  typedef GeodesicActiveContourLevelSetSegmentationModule< ImageDimension > LevelSetModuleType;
+
+  typedef typename LevelSetModuleType::OutputImageType                      LevelSetImageType;
+  typedef typename LevelSetImageType::ConstPointer                          LevelSetImageConstPointer;
+  typedef typename LevelSetModuleType::OutputSpatialObjectType              LevelSetSpatialObjectType;
+  typedef typename LevelSetModuleType::InputSpatialObjectType               InitialLevelSetSpatialObjectType;
+
+  typedef MemberCommand< Self >                                             CommandType;
+
+  /** Count the start of the execution of a stage. */
+  void CountExecution( Object * caller, const EventObject & event );
+
+  /** Cartesian product of the parameter values. */
+  void BuildConfigurations( const InputImageType * input );
+
+  /** Number the distinct products of each stage over the configurations. */
+  void PlanStages();
+
+  /** Refine the level set of a configuration and return its volume. */
+  double ComputeLevelSetVolume( unsigned int configuration );
+
+  /** Pick the level set refinements left to run, until none remain. */
+  void ThreadedComputeLevelSetVolumes();
+  static ITK_THREAD_RETURN_TYPE LevelSetThreaderCallback( void * arg );
+
+  /** New image sharing the pixel buffer of another one, so that threads
+   * do not modify the meta data of a shared image. */
+  template< class TImage >
+  static typename TImage::Pointer ShallowCopy( const TImage * image )
+    {
+    typename TImage::Pointer copy = TImage::New();
+    copy->CopyInformation( image );
+    copy->SetBufferedRegion( image->GetBufferedRegion() );
+    copy->SetRequestedRegion( image->GetBufferedRegion() );
+    copy->SetPixelContainer( const_cast< typename TImage::PixelContainer * >(
+      image->GetPixelContainer() ) );
+    return copy;
+    }
+
+private:
+  LesionSegmentationParameterSweep(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  typename InputImageType::ConstPointer     m_Input;
+  RegionType                                m_RegionOfInterest;
+  PointListType                             m_Seeds;
+  bool                                      m_ResampleThickSliceData;
+  double                                    m_AnisotropyThreshold;
+  double                                    m_FastMarchingStoppingTime;
+  double                                    m_FastMarchingDistanceFromSeeds;
+  double                                    m_MaximumRMSError;
+  unsigned int                              m_MaximumNumberOfIterations;
+  double                                    m_SegmentationThreshold;
+  unsigned int                              m_NumberOfThreads;
+
+  ParameterValueListType                    m_ParameterValues[NumberOfParameters];
+  unsigned int                              m_InvalidatingParameters[NumberOfStages];
+
+  std::vector< ConfigurationType >          m_Configurations;
+
+  /** For each stage, the product used by each configuration, and the first
+   * configuration using each product. */
+  std::vector< unsigned int >               m_ProductIds[NumberOfStages];
+  std::vector< unsigned int >               m_Representatives[NumberOfStages];
+
+  SizeValueType                             m_NumberOfExecutions[NumberOfStages];
+
+  typename CommandType::Pointer             m_ExecutionObserver;
+
+  /** Shared state of the level set threads. */
+  std::vector< FeatureImageConstPointer >   m_Features;
+  std::vector< LevelSetImageConstPointer >  m_InitialLevelSets;
+  std::vector< double >                     m_LevelSetVolumes;
+  unsigned int                              m_NextLevelSet;
+  std::string                               m_ThreadErrorMessage;
+  SimpleFastMutexLock                       m_Lock;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLesionSegmentationParameterSweep.hxx"
+#endif
+
+#endif
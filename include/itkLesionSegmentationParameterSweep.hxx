@@ -0,0 +1,768 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLesionSegmentationParameterSweep.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLesionSegmentationParameterSweep_hxx
+#define __itkLesionSegmentationParameterSweep_hxx
+
+#include "itkLesionSegmentationParameterSweep.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <map>
+#include <fstream>
+#include <typeinfo>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage>
+LesionSegmentationParameterSweep<TInputImage>
+::LesionSegmentationParameterSweep()
+{
+  // Defaults of LesionSegmentationImageFilter8.
+  this->m_ResampleThickSliceData = true;
+  this->m_AnisotropyThreshold = 1.0;
+  this->m_FastMarchingStoppingTime = 5.0;
+  this->m_FastMarchingDistanceFromSeeds = 0.5;
+  this->m_MaximumRMSError = 0.0002;
+  this->m_MaximumNumberOfIterations = 300;
+  this->m_SegmentationThreshold = -0.5;
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  this->m_ParameterValues[SigmoidBetaParameter].push_back( -500.0 );
+  this->m_ParameterValues[PropagationScalingParameter].push_back( 500.0 );
+  this->m_ParameterValues[CurvatureScalingParameter].push_back( 1.0 );
+
+  // Parameters read by each stage, together with the ones of the stages
+  // whose products it takes as inputs.
+  unsigned int * invalidating = this->m_InvalidatingParameters;
+  invalidating[PreprocessingStage] = 0;
+  invalidating[LungWallStage] = invalidating[PreprocessingStage];
+  invalidating[VesselnessStage] = invalidating[PreprocessingStage];
+  invalidating[SigmoidStage] = invalidating[PreprocessingStage] | ( 1 << SigmoidBetaParameter );
+  invalidating[CannyEdgesStage] = invalidating[PreprocessingStage] | ( 1 << CannySigmaParameter );
+  invalidating[AggregationStage] = invalidating[LungWallStage] | invalidating[VesselnessStage] |
+    invalidating[SigmoidStage] | invalidating[CannyEdgesStage];
+  invalidating[FastMarchingStage] = invalidating[AggregationStage];
+  invalidating[LevelSetStage] = invalidating[FastMarchingStage] | invalidating[AggregationStage] |
+    ( 1 << PropagationScalingParameter ) | ( 1 << CurvatureScalingParameter );
+
+  for( unsigned int s = 0; s < NumberOfStages; s++ )
+    {
+    this->m_NumberOfExecutions[s] = 0;
+    }
+
+  this->m_NextLevelSet = 0;
+
+  this->m_ExecutionObserver = CommandType::New();
+  this->m_ExecutionObserver->SetCallbackFunction( this, &Self::CountExecution );
+}
+
+
+/**
+ * Destructor
+ */
+template <class TInputImage>
+LesionSegmentationParameterSweep<TInputImage>
+::~LesionSegmentationParameterSweep()
+{
+}
+
+
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::SetInput( const InputImageType * image )
+{
+  if( this->m_Input.GetPointer() != image )
+    {
+    this->m_Input = image;
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage>
+const typename LesionSegmentationParameterSweep<TInputImage>::InputImageType *
+LesionSegmentationParameterSweep<TInputImage>
+::GetInput() const
+{
+  return this->m_Input.GetPointer();
+}
+
+
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::SetParameterValues( ParameterType parameter, const ParameterValueListType & values )
+{
+  if( parameter >= NumberOfParameters )
+    {
+    itkExceptionMacro("Parameter " << parameter << " doesn't exist");
+    }
+  this->m_ParameterValues[parameter] = values;
+  this->Modified();
+}
+
+
+template <class TInputImage>
+const typename LesionSegmentationParameterSweep<TInputImage>::ParameterValueListType &
+LesionSegmentationParameterSweep<TInputImage>
+::GetParameterValues( ParameterType parameter ) const
+{
+  if( parameter >= NumberOfParameters )
+    {
+    itkExceptionMacro("Parameter " << parameter << " doesn't exist");
+    }
+  return this->m_ParameterValues[parameter];
+}
+
+
+template <class TInputImage>
+bool
+LesionSegmentationParameterSweep<TInputImage>
+::IsStageInvalidatedBy( StageType stage, ParameterType parameter ) const
+{
+  return ( this->m_InvalidatingParameters[stage] & ( 1 << parameter ) ) != 0;
+}
+
+
+template <class TInputImage>
+unsigned int
+LesionSegmentationParameterSweep<TInputImage>
+::GetNumberOfConfigurations() const
+{
+  return this->m_Configurations.size();
+}
+
+
+template <class TInputImage>
+const typename LesionSegmentationParameterSweep<TInputImage>::ConfigurationType &
+LesionSegmentationParameterSweep<TInputImage>
+::GetConfiguration( unsigned int i ) const
+{
+  if( i >= this->m_Configurations.size() )
+    {
+    itkExceptionMacro("Configuration " << i << " doesn't exist");
+    }
+  return this->m_Configurations[i];
+}
+
+
+template <class TInputImage>
+SizeValueType
+LesionSegmentationParameterSweep<TInputImage>
+::GetNumberOfPlannedExecutions( StageType stage ) const
+{
+  return this->m_Representatives[stage].size();
+}
+
+
+template <class TInputImage>
+SizeValueType
+LesionSegmentationParameterSweep<TInputImage>
+::GetNumberOfExecutions( StageType stage ) const
+{
+  return this->m_NumberOfExecutions[stage];
+}
+
+
+template <class TInputImage>
+const char *
+LesionSegmentationParameterSweep<TInputImage>
+::GetParameterName( ParameterType parameter )
+{
+  static const char * names[NumberOfParameters] =
+    { "SigmoidBeta", "CannySigma", "PropagationScaling", "CurvatureScaling" };
+  return ( parameter < NumberOfParameters ) ? names[parameter] : "";
+}
+
+
+template <class TInputImage>
+const char *
+LesionSegmentationParameterSweep<TInputImage>
+::GetStageName( StageType stage )
+{
+  static const char * names[NumberOfStages] =
+    { "Preprocessing", "LungWall", "Vesselness", "Sigmoid", "CannyEdges",
+      "Aggregation", "FastMarching", "LevelSet" };
+  return ( stage < NumberOfStages ) ? names[stage] : "";
+}
+
+
+/**
+ * Count the executions of the stages, from the start events of their
+ * filters. The level set stage runs in several threads.
+ */
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::CountExecution( Object * caller, const EventObject & event )
+{
+  if( typeid( StartEvent ) != typeid( event ) )
+    {
+    return;
+    }
+
+  StageType stage;
+
+  if( dynamic_cast< CropFilterType * >( caller ) )
+    {
+    stage = PreprocessingStage;
+    }
+  else if( dynamic_cast< LungWallGeneratorType * >( caller ) )
+    {
+    stage = LungWallStage;
+    }
+  else if( dynamic_cast< VesselnessGeneratorType * >( caller ) )
+    {
+    stage = VesselnessStage;
+    }
+  else if( dynamic_cast< SigmoidFeatureGeneratorType * >( caller ) )
+    {
+    stage = SigmoidStage;
+    }
+  else if( dynamic_cast< CannyEdgesFeatureGeneratorType * >( caller ) )
+    {
+    stage = CannyEdgesStage;
+    }
+  else if( dynamic_cast< FeatureAggregatorType * >( caller ) )
+    {
+    stage = AggregationStage;
+    }
+  else if( dynamic_cast< FastMarchingModuleType * >( caller ) )
+    {
+    stage = FastMarchingStage;
+    }
+  else if( dynamic_cast< LevelSetModuleType * >( caller ) )
+    {
+    stage = LevelSetStage;
+    }
+  else
+    {
+    return;
+    }
+
+  this->m_Lock.Lock();
+  ++this->m_NumberOfExecutions[stage];
+  this->m_Lock.Unlock();
+}
+
+
+/**
+ * Cartesian product of the values of the parameters, the last parameter
+ * varying fastest.
+ */
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::BuildConfigurations( const InputImageType * input )
+{
+  ParameterValueListType values[NumberOfParameters];
+
+  unsigned int numberOfConfigurations = 1;
+
+  for( unsigned int p = 0; p < NumberOfParameters; p++ )
+    {
+    values[p] = this->m_ParameterValues[p];
+
+    // Sigma for the canny is the max spacing of the original input (before
+    // resampling), as in LesionSegmentationImageFilter8.
+    if( p == CannySigmaParameter && values[p].empty() )
+      {
+      double maxSpacing = NumericTraits< double >::min();
+      for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        maxSpacing = vnl_math_max( maxSpacing, static_cast< double >( input->GetSpacing()[i] ) );
+        }
+      values[p].push_back( maxSpacing );
+      }
+
+    if( values[p].empty() )
+      {
+      itkExceptionMacro("No value given for " << GetParameterName( static_cast< ParameterType >( p ) ) );
+      }
+
+    numberOfConfigurations *= values[p].size();
+    }
+
+  this->m_Configurations.resize( numberOfConfigurations );
+
+  for( unsigned int c = 0; c < numberOfConfigurations; c++ )
+    {
+    unsigned int remainder = c;
+    for( int p = NumberOfParameters - 1; p >= 0; p-- )
+      {
+      this->m_Configurations[c].Parameters[p] = values[p][ remainder % values[p].size() ];
+      remainder /= values[p].size();
+      }
+    this->m_Configurations[c].Volume = 0.0;
+    }
+}
+
+
+/**
+ * Two configurations share the product of a stage when they agree on all
+ * the parameters invalidating it.
+ */
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::PlanStages()
+{
+  const unsigned int numberOfConfigurations = this->m_Configurations.size();
+
+  for( unsigned int s = 0; s < NumberOfStages; s++ )
+    {
+    typedef std::map< std::vector< double >, unsigned int > ProductMapType;
+    ProductMapType products;
+
+    this->m_ProductIds[s].resize( numberOfConfigurations );
+    this->m_Representatives[s].clear();
+
+    for( unsigned int c = 0; c < numberOfConfigurations; c++ )
+      {
+      std::vector< double > key;
+      for( unsigned int p = 0; p < NumberOfParameters; p++ )
+        {
+        if( this->m_InvalidatingParameters[s] & ( 1 << p ) )
+          {
+          key.push_back( this->m_Configurations[c].Parameters[p] );
+          }
+        }
+
+      typename ProductMapType::const_iterator found = products.find( key );
+      if( found == products.end() )
+        {
+        const unsigned int productId = this->m_Representatives[s].size();
+        products[key] = productId;
+        this->m_Representatives[s].push_back( c );
+        this->m_ProductIds[s][c] = productId;
+        }
+      else
+        {
+        this->m_ProductIds[s][c] = found->second;
+        }
+      }
+    }
+}
+
+
+/**
+ * Segment every configuration.
+ */
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::Compute()
+{
+  if( this->m_Input.IsNull() )
+    {
+    itkExceptionMacro("The input image is not set");
+    }
+
+  if( this->m_Seeds.empty() )
+    {
+    itkExceptionMacro("No seeds were given");
+    }
+
+  for( unsigned int s = 0; s < NumberOfStages; s++ )
+    {
+    this->m_NumberOfExecutions[s] = 0;
+    }
+
+  this->BuildConfigurations( this->m_Input );
+  this->PlanStages();
+
+  //
+  // Crop and perform thin slice resampling (done only if necessary)
+  //
+  RegionType region = this->m_RegionOfInterest;
+  if( region.GetNumberOfPixels() == 0 )
+    {
+    region = this->m_Input->GetLargestPossibleRegion();
+    }
+
+  typename CropFilterType::Pointer cropFilter = CropFilterType::New();
+  cropFilter->SetInput( this->m_Input );
+  cropFilter->SetRegionOfInterest( region );
+  cropFilter->AddObserver( StartEvent(), this->m_ExecutionObserver );
+
+  typename InputImageType::Pointer inputImage;
+
+  if( this->m_ResampleThickSliceData )
+    {
+    double minSpacing = NumericTraits< double >::max();
+    for( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      minSpacing = vnl_math_min( minSpacing, static_cast< double >( this->m_Input->GetSpacing()[i] ) );
+      }
+
+    SpacingType outputSpacing = this->m_Input->GetSpacing();
+    for( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      if( outputSpacing[i] / minSpacing > this->m_AnisotropyThreshold )
+        {
+        outputSpacing[i] = minSpacing * this->m_AnisotropyThreshold;
+        }
+      }
+
+    typename IsotropicResamplerType::Pointer resampler = IsotropicResamplerType::New();
+    resampler->SetInput( cropFilter->GetOutput() );
+    resampler->SetOutputSpacing( outputSpacing );
+    resampler->Update();
+    inputImage = resampler->GetOutput();
+    }
+  else
+    {
+    cropFilter->Update();
+    inputImage = cropFilter->GetOutput();
+    }
+
+  inputImage->DisconnectPipeline();
+
+  typename InputImageSpatialObjectType::Pointer inputObject = InputImageSpatialObjectType::New();
+  inputObject->SetImage( inputImage );
+
+  //
+  // Features that no parameter of the grid invalidates.
+  //
+  typename LungWallGeneratorType::Pointer lungWallGenerator = LungWallGeneratorType::New();
+  lungWallGenerator->SetInput( inputObject );
+  lungWallGenerator->SetLungThreshold( -400 );
+  lungWallGenerator->AddObserver( StartEvent(), this->m_ExecutionObserver );
+
+  typename VesselnessGeneratorType::Pointer vesselnessGenerator = VesselnessGeneratorType::New();
+  vesselnessGenerator->SetInput( inputObject );
+  vesselnessGenerator->SetSigma( 1.0 );
+  vesselnessGenerator->SetAlpha1( 0.1 );
+  vesselnessGenerator->SetAlpha2( 2.0 );
+  vesselnessGenerator->SetSigmoidAlpha( -10.0 );
+  vesselnessGenerator->SetSigmoidBeta( 40.0 );
+  vesselnessGenerator->AddObserver( StartEvent(), this->m_ExecutionObserver );
+
+  //
+  // One generator per distinct product of the sigmoid and Canny stages. Each
+  // generator executes once, the aggregators find it up to date afterwards.
+  //
+  std::vector< typename SigmoidFeatureGeneratorType::Pointer >
+    sigmoidGenerators( this->m_Representatives[SigmoidStage].size() );
+
+  for( unsigned int p = 0; p < sigmoidGenerators.size(); p++ )
+    {
+    const ConfigurationType & configuration =
+      this->m_Configurations[ this->m_Representatives[SigmoidStage][p] ];
+
+    sigmoidGenerators[p] = SigmoidFeatureGeneratorType::New();
+    sigmoidGenerators[p]->SetInput( inputObject );
+    sigmoidGenerators[p]->SetAlpha( 100.0 );
+    sigmoidGenerators[p]->SetBeta( configuration.Parameters[SigmoidBetaParameter] );
+    sigmoidGenerators[p]->AddObserver( StartEvent(), this->m_ExecutionObserver );
+    }
+
+  std::vector< typename CannyEdgesFeatureGeneratorType::Pointer >
+    cannyGenerators( this->m_Representatives[CannyEdgesStage].size() );
+
+  for( unsigned int p = 0; p < cannyGenerators.size(); p++ )
+    {
+    const ConfigurationType & configuration =
+      this->m_Configurations[ this->m_Representatives[CannyEdgesStage][p] ];
+
+    cannyGenerators[p] = CannyEdgesFeatureGeneratorType::New();
+    cannyGenerators[p]->SetInput( inputObject );
+    cannyGenerators[p]->SetSigma( configuration.Parameters[CannySigmaParameter] );
+    cannyGenerators[p]->SetUpperThreshold( 150.0 );
+    cannyGenerators[p]->SetLowerThreshold( 75.0 );
+    cannyGenerators[p]->AddObserver( StartEvent(), this->m_ExecutionObserver );
+    }
+
+  //
+  // Minimum of the features.
+  //
+  this->m_Features.clear();
+  this->m_Features.resize( this->m_Representatives[AggregationStage].size() );
+
+  for( unsigned int p = 0; p < this->m_Features.size(); p++ )
+    {
+    const unsigned int c = this->m_Representatives[AggregationStage][p];
+
+    typename FeatureAggregatorType::Pointer featureAggregator = FeatureAggregatorType::New();
+    featureAggregator->AddFeatureGenerator( lungWallGenerator );
+    featureAggregator->AddFeatureGenerator( vesselnessGenerator );
+    featureAggregator->AddFeatureGenerator( sigmoidGenerators[ this->m_ProductIds[SigmoidStage][c] ] );
+    featureAggregator->AddFeatureGenerator( cannyGenerators[ this->m_ProductIds[CannyEdgesStage][c] ] );
+    featureAggregator->AddObserver( StartEvent(), this->m_ExecutionObserver );
+    featureAggregator->Update();
+
+    this->m_Features[p] =
+      dynamic_cast< const FeatureSpatialObjectType * >( featureAggregator->GetFeature() )->GetImage();
+    }
+
+  sigmoidGenerators.clear();
+  cannyGenerators.clear();
+
+  //
+  // Fast marching from the seeds.
+  //
+  typename SeedSpatialObjectType::Pointer seedSpatialObject = SeedSpatialObjectType::New();
+  seedSpatialObject->SetPoints( this->m_Seeds );
+
+  this->m_InitialLevelSets.clear();
+  this->m_InitialLevelSets.resize( this->m_Representatives[FastMarchingStage].size() );
+
+  for( unsigned int p = 0; p < this->m_InitialLevelSets.size(); p++ )
+    {
+    const unsigned int c = this->m_Representatives[FastMarchingStage][p];
+
+    typename FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+    featureObject->SetImage( this->m_Features[ this->m_ProductIds[AggregationStage][c] ] );
+
+    typename FastMarchingModuleType::Pointer fastMarchingModule = FastMarchingModuleType::New();
+    fastMarchingModule->InvertOutputIntensitiesOff();
+    fastMarchingModule->SetDistanceFromSeeds( this->m_FastMarchingDistanceFromSeeds );
+    fastMarchingModule->SetStoppingValue( this->m_FastMarchingStoppingTime );
+    fastMarchingModule->SetInput( seedSpatialObject );
+    fastMarchingModule->SetFeature( featureObject );
+    fastMarchingModule->CacheArrivalTimesOff();
+    fastMarchingModule->AddObserver( StartEvent(), this->m_ExecutionObserver );
+    fastMarchingModule->Update();
+
+    this->m_InitialLevelSets[p] =
+      dynamic_cast< const LevelSetSpatialObjectType * >( fastMarchingModule->GetOutput() )->GetImage();
+    }
+
+  //
+  // Level set refinement of each configuration, in parallel.
+  //
+  const unsigned int numberOfLevelSets = this->m_Representatives[LevelSetStage].size();
+
+  this->m_LevelSetVolumes.assign( numberOfLevelSets, 0.0 );
+  this->m_NextLevelSet = 0;
+  this->m_ThreadErrorMessage = "";
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( vnl_math_min( this->m_NumberOfThreads, numberOfLevelSets ) );
+  threader->SetSingleMethod( Self::LevelSetThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  this->m_Features.clear();
+  this->m_InitialLevelSets.clear();
+
+  if( !this->m_ThreadErrorMessage.empty() )
+    {
+    itkExceptionMacro("Level set refinement failed: " << this->m_ThreadErrorMessage);
+    }
+
+  for( unsigned int c = 0; c < this->m_Configurations.size(); c++ )
+    {
+    this->m_Configurations[c].Volume =
+      this->m_LevelSetVolumes[ this->m_ProductIds[LevelSetStage][c] ];
+    }
+}
+
+
+template <class TInputImage>
+ITK_THREAD_RETURN_TYPE
+LesionSegmentationParameterSweep<TInputImage>
+::LevelSetThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self * self = static_cast< Self * >( info->UserData );
+
+  self->ThreadedComputeLevelSetVolumes();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::ThreadedComputeLevelSetVolumes()
+{
+  const unsigned int numberOfLevelSets = this->m_LevelSetVolumes.size();
+
+  while( true )
+    {
+    this->m_Lock.Lock();
+    const unsigned int p = this->m_NextLevelSet++;
+    const bool failed = !this->m_ThreadErrorMessage.empty();
+    this->m_Lock.Unlock();
+
+    if( failed || p >= numberOfLevelSets )
+      {
+      return;
+      }
+
+    try
+      {
+      // Each thread writes its own entries.
+      this->m_LevelSetVolumes[p] =
+        this->ComputeLevelSetVolume( this->m_Representatives[LevelSetStage][p] );
+      }
+    catch( ExceptionObject & excp )
+      {
+      this->m_Lock.Lock();
+      if( this->m_ThreadErrorMessage.empty() )
+        {
+        this->m_ThreadErrorMessage = excp.what();
+        }
+      this->m_Lock.Unlock();
+      return;
+      }
+    }
+}
+
+
+/**
+ * Refine the fast marching level set of a configuration and measure the
+ * volume inside of the zero set.
+ */
+template <class TInputImage>
+double
+LesionSegmentationParameterSweep<TInputImage>
+::ComputeLevelSetVolume( unsigned int c )
+{
+  const ConfigurationType & configuration = this->m_Configurations[c];
+
+  typename FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+  featureObject->SetImage( ShallowCopy( this->m_Features[ this->m_ProductIds[AggregationStage][c] ].GetPointer() ) );
+
+  typename InitialLevelSetSpatialObjectType::Pointer initialObject = InitialLevelSetSpatialObjectType::New();
+  initialObject->SetImage( ShallowCopy( this->m_InitialLevelSets[ this->m_ProductIds[FastMarchingStage][c] ].GetPointer() ) );
+
+  // Same output as the fast marching and geodesic active contour module of
+  // LesionSegmentationImageFilter8, with the intensities inverted.
+  typename LevelSetModuleType::Pointer levelSetModule = LevelSetModuleType::New();
+  levelSetModule->SetInput( initialObject );
+  levelSetModule->SetFeature( featureObject );
+  levelSetModule->SetMaximumRMSError( this->m_MaximumRMSError );
+  levelSetModule->SetMaximumNumberOfIterations( this->m_MaximumNumberOfIterations );
+  levelSetModule->SetPropagationScaling( configuration.Parameters[PropagationScalingParameter] );
+  levelSetModule->SetCurvatureScaling( configuration.Parameters[CurvatureScalingParameter] );
+  levelSetModule->SetAdvectionScaling( 0.0 );
+  levelSetModule->SetNumberOfThreads( 1 );
+  levelSetModule->AddObserver( StartEvent(), this->m_ExecutionObserver );
+  levelSetModule->Update();
+
+  const LevelSetImageType * levelSet =
+    dynamic_cast< const LevelSetSpatialObjectType * >( levelSetModule->GetOutput() )->GetImage();
+
+  typedef ImageRegionConstIterator< LevelSetImageType > IteratorType;
+  IteratorType itr( levelSet, levelSet->GetBufferedRegion() );
+
+  SizeValueType numberOfPixels = 0;
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    if( itr.Get() > this->m_SegmentationThreshold )
+      {
+      ++numberOfPixels;
+      }
+    }
+
+  double pixelVolume = 1.0;
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    pixelVolume *= levelSet->GetSpacing()[i];
+    }
+
+  return numberOfPixels * pixelVolume;
+}
+
+
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::WriteCSV( std::ostream & os ) const
+{
+  for( unsigned int p = 0; p < NumberOfParameters; p++ )
+    {
+    os << GetParameterName( static_cast< ParameterType >( p ) ) << ",";
+    }
+  os << "Volume" << std::endl;
+
+  for( unsigned int c = 0; c < this->m_Configurations.size(); c++ )
+    {
+    for( unsigned int p = 0; p < NumberOfParameters; p++ )
+      {
+      os << this->m_Configurations[c].Parameters[p] << ",";
+      }
+    os << this->m_Configurations[c].Volume << std::endl;
+    }
+}
+
+
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::WriteCSV( const std::string & fileName ) const
+{
+  std::ofstream outputFile( fileName.c_str() );
+
+  if( outputFile.fail() )
+    {
+    itkExceptionMacro("Unable to open file " << fileName);
+    }
+
+  outputFile.precision( 10 );
+
+  this->WriteCSV( outputFile );
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TInputImage>
+void
+LesionSegmentationParameterSweep<TInputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Region of interest = " << this->m_RegionOfInterest << std::endl;
+  os << indent << "Number of seeds = " << this->m_Seeds.size() << std::endl;
+  os << indent << "Resample thick slice data = " << this->m_ResampleThickSliceData << std::endl;
+  os << indent << "Anisotropy threshold = " << this->m_AnisotropyThreshold << std::endl;
+  os << indent << "Fast marching stopping time = " << this->m_FastMarchingStoppingTime << std::endl;
+  os << indent << "Fast marching distance from seeds = " << this->m_FastMarchingDistanceFromSeeds << std::endl;
+  os << indent << "Maximum RMS error = " << this->m_MaximumRMSError << std::endl;
+  os << indent << "Maximum number of iterations = " << this->m_MaximumNumberOfIterations << std::endl;
+  os << indent << "Segmentation threshold = " << this->m_SegmentationThreshold << std::endl;
+  os << indent << "Number of threads = " << this->m_NumberOfThreads << std::endl;
+
+  for( unsigned int p = 0; p < NumberOfParameters; p++ )
+    {
+    os << indent << GetParameterName( static_cast< ParameterType >( p ) ) << " values =";
+    for( unsigned int i = 0; i < this->m_ParameterValues[p].size(); i++ )
+      {
+      os << " " << this->m_ParameterValues[p][i];
+      }
+    os << std::endl;
+    }
+
+  for( unsigned int s = 0; s < NumberOfStages; s++ )
+    {
+    os << indent << GetStageName( static_cast< StageType >( s ) ) << " executions = ";
+    os << this->m_NumberOfExecutions[s] << " of " << this->m_Representatives[s].size() << std::endl;
+    }
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLevelSetFeatureCache.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLevelSetFeatureCache_h
+#define __itkLevelSetFeatureCache_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkGeodesicActiveContourLevelSetFunction.h"
+#include "itkSimpleFastMutexLock.h"
+
+namespace itk
+{
+
+/** \class LevelSetFeatureCache
+ * \brief Speed and advection images computed once from a feature image.
+ *
+ * The geodesic active contour and shape detection level set filters compute
+ * their speed image, and the geodesic active contour its advection image,
+ * from the feature image every time they run. This class keeps the images
+ * of the last feature image it was asked for, and computes them again only
+ * when another feature image is given or when the feature image has been
+ * modified since. The images are computed by the same level set function
+ * as in the filters.
+ *
+ * Segmentation modules holding the same cache share its images, and so
+ * does a module updated again with the same feature image. The images are
+ * only read by the level set filters. Requests from several threads are
+ * serialized.
+ *
+ * \ingroup SpatialObjectFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <unsigned int NDimension>
+class ITK_EXPORT LevelSetFeatureCache : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef LevelSetFeatureCache          Self;
+  typedef Object                        Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LevelSetFeatureCache, Object);
+
+  /** Dimension of the space */
+  itkStaticConstMacro(Dimension, unsigned int, NDimension);
+
+  /** Types of the feature image and of the level set. */
+  typedef float                                         FeaturePixelType;
+  typedef Image< FeaturePixelType, NDimension >         FeatureImageType;
+  typedef Image< float, NDimension >                    SpeedImageType;
+
+  typedef GeodesicActiveContourLevelSetFunction<
+    SpeedImageType, FeatureImageType >                  FunctionType;
+  typedef typename FunctionType::VectorImageType        AdvectionImageType;
+
+  /** Speed image of the feature image: the feature image itself, copied
+   * with the pixel type of the level set. */
+  SpeedImageType * GetSpeedImage( const FeatureImageType * feature );
+
+  /** Advection image of the feature image: its gradient, computed with
+   * Gaussian derivatives of the given sigma. */
+  AdvectionImageType * GetAdvectionImage( const FeatureImageType * feature, double derivativeSigma );
+
+  /** Free the images. */
+  void ReleaseImages();
+
+  /** Number of times each image has been computed. */
+  itkGetConstMacro( NumberOfSpeedImageComputations, SizeValueType );
+  itkGetConstMacro( NumberOfAdvectionImageComputations, SizeValueType );
+
+protected:
+  LevelSetFeatureCache();
+  virtual ~LevelSetFeatureCache();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  LevelSetFeatureCache(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** Whether an image computed from a feature image at a given time is
+   * still valid for a feature image. */
+  bool IsUpToDate( const FeatureImageType * cachedFeature, const TimeStamp & cachedTime,
+                   const FeatureImageType * feature ) const;
+
+  typename SpeedImageType::Pointer       m_SpeedImage;
+  const FeatureImageType *               m_SpeedFeature;
+  TimeStamp                              m_SpeedTime;
+  SizeValueType                          m_NumberOfSpeedImageComputations;
+
+  typename AdvectionImageType::Pointer   m_AdvectionImage;
+  const FeatureImageType *               m_AdvectionFeature;
+  double                                 m_AdvectionDerivativeSigma;
+  TimeStamp                              m_AdvectionTime;
+  SizeValueType                          m_NumberOfAdvectionImageComputations;
+
+  SimpleFastMutexLock                    m_Lock;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkLevelSetFeatureCache.hxx"
+#endif
+
+#endif
@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLevelSetFeatureCache.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLevelSetFeatureCache_hxx
+#define __itkLevelSetFeatureCache_hxx
+
+#include "itkLevelSetFeatureCache.h"
+
+
+namespace itk
+{
+
+
+/**
+ * Constructor
+ */
+template <unsigned int NDimension>
+LevelSetFeatureCache<NDimension>
+::LevelSetFeatureCache()
+{
+  this->m_SpeedFeature = NULL;
+  this->m_NumberOfSpeedImageComputations = 0;
+
+  this->m_AdvectionFeature = NULL;
+  this->m_AdvectionDerivativeSigma = 0.0;
+  this->m_NumberOfAdvectionImageComputations = 0;
+}
+
+
+/**
+ * Destructor
+ */
+template <unsigned int NDimension>
+LevelSetFeatureCache<NDimension>
+::~LevelSetFeatureCache()
+{
+}
+
+
+/**
+ * PrintSelf
+ */
+template <unsigned int NDimension>
+void
+LevelSetFeatureCache<NDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Speed image: " << this->m_SpeedImage.GetPointer() << std::endl;
+  os << indent << "Number of speed image computations: " << this->m_NumberOfSpeedImageComputations << std::endl;
+  os << indent << "Advection image: " << this->m_AdvectionImage.GetPointer() << std::endl;
+  os << indent << "Advection derivative sigma: " << this->m_AdvectionDerivativeSigma << std::endl;
+  os << indent << "Number of advection image computations: " << this->m_NumberOfAdvectionImageComputations << std::endl;
+}
+
+
+/**
+ * The feature image must be the same object, and neither its meta data nor
+ * its pixels may have been changed or generated again since the image was
+ * computed.
+ */
+template <unsigned int NDimension>
+bool
+LevelSetFeatureCache<NDimension>
+::IsUpToDate( const FeatureImageType * cachedFeature, const TimeStamp & cachedTime,
+              const FeatureImageType * feature ) const
+{
+  return cachedFeature == feature &&
+         feature->GetMTime() < cachedTime.GetMTime() &&
+         feature->GetUpdateMTime() < cachedTime.GetMTime() &&
+         feature->GetPixelContainer()->GetMTime() < cachedTime.GetMTime();
+}
+
+
+template <unsigned int NDimension>
+typename LevelSetFeatureCache<NDimension>::SpeedImageType *
+LevelSetFeatureCache<NDimension>
+::GetSpeedImage( const FeatureImageType * feature )
+{
+  if( !feature )
+    {
+    itkExceptionMacro("Feature image has not been set");
+    }
+
+  this->m_Lock.Lock();
+
+  if( this->m_SpeedImage.IsNull() ||
+      !this->IsUpToDate( this->m_SpeedFeature, this->m_SpeedTime, feature ) )
+    {
+    typename FunctionType::Pointer function = FunctionType::New();
+    function->SetFeatureImage( feature );
+
+    try
+      {
+      function->AllocateSpeedImage();
+      function->CalculateSpeedImage();
+      }
+    catch( ... )
+      {
+      this->m_Lock.Unlock();
+      throw;
+      }
+
+    this->m_SpeedImage = function->GetSpeedImage();
+    this->m_SpeedFeature = feature;
+    this->m_SpeedTime.Modified();
+    ++this->m_NumberOfSpeedImageComputations;
+    }
+
+  SpeedImageType * speedImage = this->m_SpeedImage;
+
+  this->m_Lock.Unlock();
+
+  return speedImage;
+}
+
+
+template <unsigned int NDimension>
+typename LevelSetFeatureCache<NDimension>::AdvectionImageType *
+LevelSetFeatureCache<NDimension>
+::GetAdvectionImage( const FeatureImageType * feature, double derivativeSigma )
+{
+  if( !feature )
+    {
+    itkExceptionMacro("Feature image has not been set");
+    }
+
+  this->m_Lock.Lock();
+
+  if( this->m_AdvectionImage.IsNull() ||
+      this->m_AdvectionDerivativeSigma != derivativeSigma ||
+      !this->IsUpToDate( this->m_AdvectionFeature, this->m_AdvectionTime, feature ) )
+    {
+    typename FunctionType::Pointer function = FunctionType::New();
+    function->SetFeatureImage( feature );
+    function->SetDerivativeSigma( derivativeSigma );
+
+    try
+      {
+      function->AllocateAdvectionImage();
+      function->CalculateAdvectionImage();
+      }
+    catch( ... )
+      {
+      this->m_Lock.Unlock();
+      throw;
+      }
+
+    this->m_AdvectionImage = function->GetAdvectionImage();
+    this->m_AdvectionFeature = feature;
+    this->m_AdvectionDerivativeSigma = derivativeSigma;
+    this->m_AdvectionTime.Modified();
+    ++this->m_NumberOfAdvectionImageComputations;
+    }
+
+  AdvectionImageType * advectionImage = this->m_AdvectionImage;
+
+  this->m_Lock.Unlock();
+
+  return advectionImage;
+}
+
+
+template <unsigned int NDimension>
+void
+LevelSetFeatureCache<NDimension>
+::ReleaseImages()
+{
+  this->m_Lock.Lock();
+
+  this->m_SpeedImage = NULL;
+  this->m_SpeedFeature = NULL;
+  this->m_AdvectionImage = NULL;
+  this->m_AdvectionFeature = NULL;
+
+  this->m_Lock.Unlock();
+}
+
+} // end namespace itk
+
+#endif
@@ -17,7 +17,7 @@
 #ifndef __itkLocalStructureImageFilter_h
 #define __itkLocalStructureImageFilter_h
 
-#include "itkUnaryFunctorImageFilter.h"
+#include "itkEigenvalueFunctorImageFilter.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -123,14 +123,77 @@ public:
 
     return static_cast<TOutput>( sheetness );
     }
+
+  /** Evaluates the local structure measure of a run of eigenvalue triples.
+   *  Same computation as operator(), written without branches so that the
+   *  loop can be vectorized. */
+  template< class TReal >
+  void Evaluate( const TReal * A1, const TReal * A2, const TReal * A3,
+                 TReal * output, SizeValueType length ) const
+    {
+    const TReal alpha = static_cast< TReal >( m_Alpha );
+    const TReal gamma = static_cast< TReal >( m_Gamma );
+    const TReal eps  = static_cast< TReal >( vnl_math::eps );
+    const TReal zero = static_cast< TReal >( 0.0 );
+    const TReal one  = static_cast< TReal >( 1.0 );
+
+    for( SizeValueType i = 0; i < length; i++ )
+      {
+      TReal a1 = A1[i];
+      TReal a2 = A2[i];
+      TReal a3 = A3[i];
+
+      TReal l1 = ( a1 < zero ) ? -a1 : a1;
+      TReal l2 = ( a2 < zero ) ? -a2 : a2;
+      TReal l3 = ( a3 < zero ) ? -a3 : a3;
+
+      // Sorting network on the absolute values, l1 <= l2 <= l3.
+      TReal tl, ta;
+      bool swap = l2 > l3;
+      tl = swap ? l3 : l2; l3 = swap ? l2 : l3; l2 = tl;
+      ta = swap ? a3 : a2; a3 = swap ? a2 : a3; a2 = ta;
+
+      swap = l1 > l2;
+      tl = swap ? l2 : l1; l2 = swap ? l1 : l2; l1 = tl;
+      ta = swap ? a2 : a1; a2 = swap ? a1 : a2; a1 = ta;
+
+      swap = l2 > l3;
+      tl = swap ? l3 : l2; l3 = swap ? l2 : l3; l2 = tl;
+      ta = swap ? a3 : a2; a3 = swap ? a2 : a3; a2 = ta;
+
+      const bool reject = ( l3 < eps );
+
+      const TReal inverseL3 = one / ( reject ? one : l3 );
+
+      // Omega weights of a2 and a1 with respect to a3, as in
+      // WeightFunctionOmega().
+      const TReal r2 = a2 * inverseL3;
+      const bool negative2 = ( a2 <= zero ) && ( a3 <= a2 );
+      const bool positive2 = ( a2 > zero ) && ( l3 > alpha * a2 );
+      const TReal base2 = negative2 ? ( one + r2 ) : ( one - alpha * r2 );
+
+      const TReal r1 = a1 * inverseL3;
+      const bool negative1 = ( a1 <= zero ) && ( a3 <= a1 );
+      const bool positive1 = ( a1 > zero ) && ( l3 > alpha * a1 );
+      const TReal base1 = negative1 ? ( one + r1 ) : ( one - alpha * r1 );
+
+      const TReal W = vcl_pow( ( base2 > zero ) ? base2 : zero, gamma );
+      const TReal F = vcl_pow( ( base1 > zero ) ? base1 : zero, gamma );
+
+      const bool accept = !reject && ( negative2 || positive2 ) && ( negative1 || positive1 );
+
+      output[i] = accept ? l3 * W * F : zero;
+      }
+    }
+
   inline double WeightFunctionOmega( double ls, double lt ) const
     {
     if( ls <= 0.0 && lt <= ls )
       {
-      return ( 1 + vcl_pow( ls / vnl_math_abs( lt ), m_Gamma ) );
+      return vcl_pow( 1 + ls / vnl_math_abs( lt ), m_Gamma );
       }
     const double abslt = vnl_math_abs( lt );
-    if( ls > 0.0  &&  abslt / m_Gamma > ls )
+    if( ls > 0.0  &&  abslt / m_Alpha > ls )
       {
       return vcl_pow( 1 - m_Alpha * ls / vnl_math_abs( lt ), m_Gamma );
       }
@@ -164,14 +227,14 @@ private:
 template <class TInputImage, class TOutputImage>
 class ITK_EXPORT LocalStructureImageFilter :
     public
-UnaryFunctorImageFilter<TInputImage,TOutputImage,
+EigenvalueFunctorImageFilter<TInputImage,TOutputImage,
                         Function::LocalStructure< typename TInputImage::PixelType,
                                        typename TOutputImage::PixelType>   >
 {
 public:
   /** Standard class typedefs. */
   typedef LocalStructureImageFilter           Self;
-  typedef UnaryFunctorImageFilter<
+  typedef EigenvalueFunctorImageFilter<
     TInputImage,TOutputImage,
     Function::LocalStructure<
       typename TInputImage::PixelType,
@@ -184,7 +247,7 @@ public:
 
   /** Runtime information support. */
   itkTypeMacro(LocalStructureImageFilter,
-               UnaryFunctorImageFilter);
+               EigenvalueFunctorImageFilter);
 
   /** Set the normalization term for sheetness */
   void SetAlpha( double value )
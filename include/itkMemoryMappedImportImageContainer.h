@@ -0,0 +1,93 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedImportImageContainer.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMemoryMappedImportImageContainer_h
+#define __itkMemoryMappedImportImageContainer_h
+
+#include "itkImportImageContainer.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class MemoryMappedImportImageContainer
+ * \brief Pixel container whose elements are the bytes of a file, mapped
+ * in memory.
+ *
+ * The file is mapped privately: the pages are read from the file the first
+ * time they are accessed, and shared with the page cache and with the other
+ * processes that map the same file until they are written. The pixels
+ * written are not written back to the file. The mapping is released with
+ * the container.
+ *
+ * Files are only mapped on POSIX systems. MapFile() returns false on other
+ * systems, or when the file cannot be mapped, and the container is then
+ * left empty.
+ *
+ * \ingroup ImageObjects
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <typename TElementIdentifier, typename TElement>
+class ITK_EXPORT MemoryMappedImportImageContainer :
+  public ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedImportImageContainer                      Self;
+  typedef ImportImageContainer< TElementIdentifier, TElement >  Superclass;
+  typedef SmartPointer<Self>                                    Pointer;
+  typedef SmartPointer<const Self>                              ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedImportImageContainer, ImportImageContainer);
+
+  typedef TElementIdentifier  ElementIdentifier;
+  typedef TElement            Element;
+
+  /** Maps the elements of the file that start at the byte offset. The
+   * offset must be a multiple of the size of the elements. */
+  bool MapFile( const std::string & fileName, unsigned long offset, ElementIdentifier size );
+
+  /** Whether the elements are those of a mapped file. */
+  bool IsMapped() const
+    { return this->m_MappedAddress != NULL; }
+
+protected:
+  MemoryMappedImportImageContainer();
+  virtual ~MemoryMappedImportImageContainer();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  MemoryMappedImportImageContainer(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  void UnmapFile();
+
+  void *              m_MappedAddress;
+  unsigned long       m_MappedLength;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkMemoryMappedImportImageContainer.hxx"
+#endif
+
+#endif
@@ -0,0 +1,156 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedImportImageContainer.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMemoryMappedImportImageContainer_hxx
+#define __itkMemoryMappedImportImageContainer_hxx
+
+#include "itkMemoryMappedImportImageContainer.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <typename TElementIdentifier, typename TElement>
+MemoryMappedImportImageContainer<TElementIdentifier, TElement>
+::MemoryMappedImportImageContainer()
+{
+  this->m_MappedAddress = NULL;
+  this->m_MappedLength = 0;
+}
+
+
+/**
+ * Destructor
+ */
+template <typename TElementIdentifier, typename TElement>
+MemoryMappedImportImageContainer<TElementIdentifier, TElement>
+::~MemoryMappedImportImageContainer()
+{
+  this->UnmapFile();
+}
+
+
+/**
+ * The mapping starts at the page that holds the offset, and the elements
+ * start at the offset in that page. The container does not manage the
+ * memory of the elements, so that the superclass never frees it.
+ */
+template <typename TElementIdentifier, typename TElement>
+bool
+MemoryMappedImportImageContainer<TElementIdentifier, TElement>
+::MapFile( const std::string & fileName, unsigned long offset, ElementIdentifier size )
+{
+  this->UnmapFile();
+
+  if( size == 0 || offset % sizeof( Element ) != 0 )
+    {
+    return false;
+    }
+
+#if defined(_WIN32)
+  (void)fileName;
+  return false;
+#else
+  const int fileDescriptor = open( fileName.c_str(), O_RDONLY );
+  if( fileDescriptor < 0 )
+    {
+    return false;
+    }
+
+  const unsigned long dataLength = static_cast< unsigned long >( size ) * sizeof( Element );
+
+  struct stat fileStatus;
+  if( fstat( fileDescriptor, &fileStatus ) != 0 ||
+      static_cast< unsigned long >( fileStatus.st_size ) < offset + dataLength )
+    {
+    close( fileDescriptor );
+    return false;
+    }
+
+  const unsigned long pageSize = static_cast< unsigned long >( sysconf( _SC_PAGESIZE ) );
+  const unsigned long pageOffset = offset - offset % pageSize;
+  const unsigned long mappedLength = dataLength + offset % pageSize;
+
+  void * address = mmap( NULL, mappedLength, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         fileDescriptor, static_cast< off_t >( pageOffset ) );
+
+  // The mapping holds its own reference to the file
+  close( fileDescriptor );
+
+  if( address == MAP_FAILED )
+    {
+    return false;
+    }
+
+  this->m_MappedAddress = address;
+  this->m_MappedLength = mappedLength;
+
+  Element * elements = reinterpret_cast< Element * >(
+    static_cast< char * >( address ) + offset % pageSize );
+
+  this->SetImportPointer( elements, size, false );
+
+  return true;
+#endif
+}
+
+
+template <typename TElementIdentifier, typename TElement>
+void
+MemoryMappedImportImageContainer<TElementIdentifier, TElement>
+::UnmapFile()
+{
+  if( this->m_MappedAddress == NULL )
+    {
+    return;
+    }
+
+#if !defined(_WIN32)
+  munmap( this->m_MappedAddress, this->m_MappedLength );
+#endif
+
+  this->m_MappedAddress = NULL;
+  this->m_MappedLength = 0;
+
+  this->SetImportPointer( NULL, 0, false );
+}
+
+
+/**
+ * PrintSelf
+ */
+template <typename TElementIdentifier, typename TElement>
+void
+MemoryMappedImportImageContainer<TElementIdentifier, TElement>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Mapped: " << this->IsMapped() << std::endl;
+  os << indent << "Mapped length: " << this->m_MappedLength << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,122 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedMetaImageReader.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMemoryMappedMetaImageReader_h
+#define __itkMemoryMappedMetaImageReader_h
+
+#include "itkImageSource.h"
+#include "itkImageFileReader.h"
+#include "itkMemoryMappedImportImageContainer.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class MemoryMappedMetaImageReader
+ * \brief Reads an image, mapping the pixels of uncompressed MetaImage files
+ * in memory instead of copying them.
+ *
+ * When the file is a MetaImage (.mha or .mhd) whose pixel data is a single
+ * uncompressed block, of the pixel type of the output, in the byte order of
+ * the system, the buffer of the output points into a private mapping of the
+ * file. No pixel is read until it is accessed, so that filters that only
+ * access a region of interest only read the pages of that region. The
+ * processes that read the same file share its pages in the page cache.
+ *
+ * The pixels must also be aligned in the file: their offset must be a
+ * multiple of the pixel size. This is always the case for a .mhd header
+ * with a separate raw file. In a .mha file the pixels follow the text
+ * header, and MetaImage writers do not pad it, so a .mha file is only
+ * mapped when the length of its header is a multiple of the pixel size.
+ * This depends on the header fields and values, for instance on the
+ * number of digits of the spacing. Other files are read, and their pixels
+ * converted, by ImageFileReader.
+ *
+ * The output is the whole image: it is either mapped or read at once.
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TOutputImage>
+class ITK_EXPORT MemoryMappedMetaImageReader : public ImageSource< TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedMetaImageReader    Self;
+  typedef ImageSource< TOutputImage >    Superclass;
+  typedef SmartPointer<Self>             Pointer;
+  typedef SmartPointer<const Self>       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedMetaImageReader, ImageSource);
+
+  /** Output image typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputImagePixelType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::PixelContainer    PixelContainerType;
+
+  typedef MemoryMappedImportImageContainer<
+    typename PixelContainerType::ElementIdentifier,
+    typename PixelContainerType::Element >            MappedPixelContainerType;
+
+  typedef ImageFileReader< OutputImageType >          FileReaderType;
+
+  /** File of the image. */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Whether the pixels of the last update are mapped from the file. */
+  itkGetConstMacro( IsMemoryMapped, bool );
+
+protected:
+  MemoryMappedMetaImageReader();
+  virtual ~MemoryMappedMetaImageReader();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Reads the header of the file. */
+  virtual void GenerateOutputInformation();
+
+  /** The whole image is produced. */
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Maps the pixels of the file, or reads them. */
+  virtual void GenerateData();
+
+private:
+  MemoryMappedMetaImageReader(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** File that holds the pixels of a MetaImage header, and their offset in
+   * that file, when the pixels can be mapped. */
+  bool GetMappablePixelData( std::string & dataFileName, unsigned long & offset ) const;
+
+  std::string                           m_FileName;
+  typename FileReaderType::Pointer      m_FileReader;
+  bool                                  m_IsMemoryMapped;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkMemoryMappedMetaImageReader.hxx"
+#endif
+
+#endif
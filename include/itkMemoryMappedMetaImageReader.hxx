@@ -0,0 +1,214 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMemoryMappedMetaImageReader.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMemoryMappedMetaImageReader_hxx
+#define __itkMemoryMappedMetaImageReader_hxx
+
+#include "itkMemoryMappedMetaImageReader.h"
+#include "itkMetaImageIO.h"
+#include "itkByteSwapper.h"
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TOutputImage>
+MemoryMappedMetaImageReader<TOutputImage>
+::MemoryMappedMetaImageReader()
+{
+  this->m_FileReader = FileReaderType::New();
+  this->m_IsMemoryMapped = false;
+}
+
+
+/**
+ * Destructor
+ */
+template <class TOutputImage>
+MemoryMappedMetaImageReader<TOutputImage>
+::~MemoryMappedMetaImageReader()
+{
+}
+
+
+template <class TOutputImage>
+void
+MemoryMappedMetaImageReader<TOutputImage>
+::GenerateOutputInformation()
+{
+  OutputImageType * output = this->GetOutput();
+
+  this->m_FileReader->SetFileName( this->m_FileName );
+  this->m_FileReader->UpdateOutputInformation();
+
+  output->CopyInformation( this->m_FileReader->GetOutput() );
+  output->SetMetaDataDictionary( this->m_FileReader->GetMetaDataDictionary() );
+}
+
+
+template <class TOutputImage>
+void
+MemoryMappedMetaImageReader<TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+/**
+ * The pixel data of a MetaImage follows the ElementDataFile entry, which
+ * ends the header, or is in the file named by that entry. A file list, a
+ * file name pattern, compressed data or pixels that would have to be
+ * converted cannot be mapped.
+ */
+template <class TOutputImage>
+bool
+MemoryMappedMetaImageReader<TOutputImage>
+::GetMappablePixelData( std::string & dataFileName, unsigned long & offset ) const
+{
+  MetaImageIO * io = dynamic_cast< MetaImageIO * >( this->m_FileReader->GetImageIO() );
+
+  if( !io ||
+      io->GetNumberOfDimensions() != OutputImageType::ImageDimension ||
+      io->GetNumberOfComponents() != 1 ||
+      io->GetComponentType() != ImageIOBase::MapPixelType< OutputImagePixelType >::CType )
+    {
+    return false;
+    }
+
+  const ImageIOBase::ByteOrder systemByteOrder =
+    ByteSwapper< int >::SystemIsBigEndian() ? ImageIOBase::BigEndian : ImageIOBase::LittleEndian;
+
+  MetaImage * metaImage = io->GetMetaImagePointer();
+
+  if( io->GetByteOrder() != systemByteOrder || metaImage->CompressedData() )
+    {
+    return false;
+    }
+
+  const std::string elementDataFile = metaImage->ElementDataFileName();
+
+  if( elementDataFile == "LOCAL" )
+    {
+    std::ifstream is( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+
+    std::string line;
+    while( std::getline( is, line ) )
+      {
+      const std::string::size_type start = line.find_first_not_of( " \t" );
+      if( start != std::string::npos && line.compare( start, 15, "ElementDataFile" ) == 0 )
+        {
+        dataFileName = this->m_FileName;
+        offset = static_cast< unsigned long >( is.tellg() );
+        return true;
+        }
+      }
+    return false;
+    }
+
+  if( elementDataFile == "LIST" || elementDataFile.find( '%' ) != std::string::npos )
+    {
+    return false;
+    }
+
+  dataFileName = elementDataFile;
+  if( !itksys::SystemTools::FileIsFullPath( dataFileName.c_str() ) )
+    {
+    const std::string path = itksys::SystemTools::GetFilenamePath( this->m_FileName );
+    if( !path.empty() )
+      {
+      dataFileName = path + "/" + elementDataFile;
+      }
+    }
+
+  // A header size of -1 places the pixels at the end of the file
+  const int headerSize = metaImage->HeaderSize();
+  const unsigned long dataLength = static_cast< unsigned long >( io->GetImageSizeInBytes() );
+  const unsigned long fileLength = itksys::SystemTools::FileLength( dataFileName.c_str() );
+
+  if( headerSize == -1 )
+    {
+    if( fileLength < dataLength )
+      {
+      return false;
+      }
+    offset = fileLength - dataLength;
+    }
+  else
+    {
+    offset = ( headerSize > 0 ) ? static_cast< unsigned long >( headerSize ) : 0;
+    }
+
+  return true;
+}
+
+
+template <class TOutputImage>
+void
+MemoryMappedMetaImageReader<TOutputImage>
+::GenerateData()
+{
+  OutputImageType * output = this->GetOutput();
+
+  this->m_IsMemoryMapped = false;
+
+  std::string dataFileName;
+  unsigned long offset = 0;
+
+  if( this->GetMappablePixelData( dataFileName, offset ) )
+    {
+    const OutputImageRegionType & largestRegion = output->GetLargestPossibleRegion();
+
+    typename MappedPixelContainerType::Pointer container = MappedPixelContainerType::New();
+
+    if( container->MapFile( dataFileName, offset, largestRegion.GetNumberOfPixels() ) )
+      {
+      output->SetBufferedRegion( largestRegion );
+      output->SetPixelContainer( container );
+      this->m_IsMemoryMapped = true;
+      return;
+      }
+    }
+
+  this->m_FileReader->GetOutput()->SetRequestedRegion( output->GetRequestedRegion() );
+  this->m_FileReader->Update();
+
+  this->GraftOutput( this->m_FileReader->GetOutput() );
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TOutputImage>
+void
+MemoryMappedMetaImageReader<TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "File name: " << this->m_FileName << std::endl;
+  os << indent << "Memory mapped: " << this->m_IsMemoryMapped << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule_h
+#define __itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule_h
+
+#include "itkSinglePhaseLevelSetSegmentationModule.h"
+#include "itkFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkLandmarkSpatialObject.h"
+
+namespace itk
+{
+
+/** \class MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule
+ * \brief This class applies the fast marching and geodesic active contour
+ * segmentation coarse to fine.
+ *
+ * A pyramid of the feature image is built by Gaussian smoothing and
+ * resampling with a shrink factor of two between levels. The fast marching
+ * and geodesic active contour segmentation runs on the coarsest level with
+ * the maximum number of iterations. The resulting level set is then
+ * upsampled to each finer level and refined with RefinementIterations
+ * iterations of the geodesic active contour.
+ *
+ * Most of the travel of the front away from the seeds then happens on the
+ * coarse grids, and the full resolution evolution only has to adjust the
+ * contour.
+ *
+ * SpatialObjects are used as inputs and outputs of this class.
+ *
+ * \ingroup SpatialObjectFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <unsigned int NDimension>
+class ITK_EXPORT MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule :
+  public SinglePhaseLevelSetSegmentationModule<NDimension>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule  Self;
+  typedef SinglePhaseLevelSetSegmentationModule<NDimension>       Superclass;
+  typedef SmartPointer<Self>                                      Pointer;
+  typedef SmartPointer<const Self>                                ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule, SinglePhaseLevelSetSegmentationModule);
+
+  /** Dimension of the space */
+  itkStaticConstMacro(Dimension, unsigned int, NDimension);
+
+  /** Type of spatialObject that will be passed as input and output of this
+   * segmentation method. */
+  typedef typename Superclass::SpatialObjectType         SpatialObjectType;
+  typedef typename Superclass::SpatialObjectPointer      SpatialObjectPointer;
+
+  /** Types of images and spatial objects inherited from the superclass. */
+  typedef typename Superclass::OutputPixelType           OutputPixelType;
+  typedef typename Superclass::InputImageType            InputImageType;
+  typedef typename Superclass::FeatureImageType          FeatureImageType;
+  typedef typename Superclass::OutputImageType           OutputImageType;
+  typedef typename Superclass::FeatureSpatialObjectType  FeatureSpatialObjectType;
+  typedef typename Superclass::OutputSpatialObjectType   OutputSpatialObjectType;
+
+  /** Type of the input set of seed points. They are stored in a Landmark Spatial Object. */
+  typedef LandmarkSpatialObject< NDimension >                  InputSpatialObjectType;
+
+  /** Set the Fast Marching algorithm Stopping Value. */
+  virtual void SetStoppingValue( double d )
+    { m_CoarseModule->SetStoppingValue( d ); }
+  virtual double GetStoppingValue() const
+    { return m_CoarseModule->GetStoppingValue(); }
+
+  /** Set the Fast Marching algorithm distance from seeds. */
+  virtual void SetDistanceFromSeeds( double d )
+    { m_CoarseModule->SetDistanceFromSeeds( d ); }
+  virtual double GetDistanceFromSeeds() const
+    { return m_CoarseModule->GetDistanceFromSeeds(); }
+
+  /** Solve the fast marching with the bucket queue solver. */
+  virtual void SetUseBucketQueue( bool b )
+    { m_CoarseModule->SetUseBucketQueue( b ); }
+  virtual bool GetUseBucketQueue() const
+    { return m_CoarseModule->GetUseBucketQueue(); }
+  itkBooleanMacro( UseBucketQueue );
+
+  /** Number of levels of the pyramid, including the full resolution one.
+   * A value of one runs the plain fast marching and geodesic active contour
+   * segmentation. Defaults to 3. */
+  itkSetClampMacro( NumberOfLevels, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( NumberOfLevels, unsigned int );
+
+  /** Maximum number of geodesic active contour iterations on each level
+   * finer than the coarsest one. Defaults to 20. */
+  itkSetMacro( RefinementIterations, unsigned int );
+  itkGetConstMacro( RefinementIterations, unsigned int );
+
+protected:
+  MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule();
+  virtual ~MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Method invoked by the pipeline in order to trigger the computation of
+   * the segmentation. */
+  void  GenerateData ();
+
+  typedef typename FeatureImageType::Pointer       FeatureImagePointer;
+  typedef typename OutputImageType::Pointer        OutputImagePointer;
+
+  /** Feature image smoothed and resampled on a grid coarser by the given
+   * factor. */
+  FeatureImagePointer ShrinkFeatureImage( const FeatureImageType * feature,
+                                          unsigned int factor ) const;
+
+  /** Level set linearly interpolated on the grid of the reference image. */
+  OutputImagePointer ExpandLevelSet( const OutputImageType * levelSet,
+                                     const FeatureImageType * reference ) const;
+
+  typedef  FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule< Dimension > CoarseModuleType;
+  typename CoarseModuleType::Pointer m_CoarseModule;
+  typedef  GeodesicActiveContourLevelSetSegmentationModule< Dimension > RefinementModuleType;
+
+private:
+  MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  unsigned int    m_NumberOfLevels;
+  unsigned int    m_RefinementIterations;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.hxx"
+#endif
+
+#endif
@@ -0,0 +1,276 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule_hxx
+#define __itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule_hxx
+
+#include "itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkResampleImageFilter.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkIdentityTransform.h"
+#include "itkContinuousIndex.h"
+#include "itkProgressAccumulator.h"
+
+#include <vector>
+
+namespace itk
+{
+
+
+/**
+ * Constructor
+ */
+template <unsigned int NDimension>
+MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule()
+{
+  this->m_CoarseModule = CoarseModuleType::New();
+  this->m_CoarseModule->SetDistanceFromSeeds(1.0);
+  this->m_CoarseModule->SetStoppingValue( 100.0 );
+  this->m_CoarseModule->InvertOutputIntensitiesOff();
+
+  this->m_NumberOfLevels = 3;
+  this->m_RefinementIterations = 20;
+}
+
+
+/**
+ * Destructor
+ */
+template <unsigned int NDimension>
+MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::~MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule()
+{
+}
+
+
+/**
+ * PrintSelf
+ */
+template <unsigned int NDimension>
+void
+MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfLevels = " << this->m_NumberOfLevels << std::endl;
+  os << indent << "RefinementIterations = " << this->m_RefinementIterations << std::endl;
+}
+
+
+/**
+ * Smooth the feature image with a Gaussian of half the shrink factor (in
+ * pixels) and resample it on a grid covering the same physical extent.
+ */
+template <unsigned int NDimension>
+typename MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>::FeatureImagePointer
+MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::ShrinkFeatureImage( const FeatureImageType * feature, unsigned int factor ) const
+{
+  typedef SmoothingRecursiveGaussianImageFilter< FeatureImageType, FeatureImageType > SmoothingFilterType;
+  typedef ResampleImageFilter< FeatureImageType, FeatureImageType >                   ResampleFilterType;
+  typedef LinearInterpolateImageFunction< FeatureImageType, double >                   InterpolatorType;
+  typedef IdentityTransform< double, NDimension >                                     TransformType;
+
+  const typename FeatureImageType::SpacingType & spacing = feature->GetSpacing();
+  const typename FeatureImageType::RegionType & region = feature->GetLargestPossibleRegion();
+
+  double minimumSpacing = spacing[0];
+  for( unsigned int i = 1; i < NDimension; i++ )
+    {
+    if( spacing[i] < minimumSpacing )
+      {
+      minimumSpacing = spacing[i];
+      }
+    }
+
+  typename SmoothingFilterType::Pointer smoother = SmoothingFilterType::New();
+  smoother->SetInput( feature );
+  smoother->SetSigma( 0.5 * factor * minimumSpacing );
+  smoother->SetNumberOfThreads( this->GetNumberOfThreads() );
+
+  typename FeatureImageType::SpacingType outputSpacing;
+  typename FeatureImageType::SizeType outputSize;
+  ContinuousIndex< double, NDimension > firstCenter;
+
+  for( unsigned int i = 0; i < NDimension; i++ )
+    {
+    outputSpacing[i] = spacing[i] * factor;
+    outputSize[i] = region.GetSize()[i] / factor;
+    if( outputSize[i] < 1 )
+      {
+      outputSize[i] = 1;
+      }
+    // The first coarse pixel is centered on the first block of factor
+    // fine pixels.
+    firstCenter[i] = region.GetIndex()[i] + 0.5 * ( factor - 1.0 );
+    }
+
+  typename FeatureImageType::PointType outputOrigin;
+  feature->TransformContinuousIndexToPhysicalPoint( firstCenter, outputOrigin );
+
+  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+  resampler->SetInput( smoother->GetOutput() );
+  resampler->SetTransform( TransformType::New() );
+  resampler->SetInterpolator( InterpolatorType::New() );
+  resampler->SetOutputSpacing( outputSpacing );
+  resampler->SetOutputOrigin( outputOrigin );
+  resampler->SetOutputDirection( feature->GetDirection() );
+  resampler->SetSize( outputSize );
+  resampler->SetDefaultPixelValue( 0.0 );
+  resampler->SetNumberOfThreads( this->GetNumberOfThreads() );
+  resampler->Update();
+
+  FeatureImagePointer shrunk = resampler->GetOutput();
+  shrunk->DisconnectPipeline();
+
+  return shrunk;
+}
+
+
+/**
+ * Linearly interpolate the level set on the grid of the reference image.
+ * Pixels outside of the coarse grid are set outside of the contour.
+ */
+template <unsigned int NDimension>
+typename MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>::OutputImagePointer
+MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::ExpandLevelSet( const OutputImageType * levelSet, const FeatureImageType * reference ) const
+{
+  typedef ResampleImageFilter< OutputImageType, OutputImageType >    ResampleFilterType;
+  typedef LinearInterpolateImageFunction< OutputImageType, double >  InterpolatorType;
+  typedef IdentityTransform< double, NDimension >                    TransformType;
+
+  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+  resampler->SetInput( levelSet );
+  resampler->SetTransform( TransformType::New() );
+  resampler->SetInterpolator( InterpolatorType::New() );
+  resampler->SetOutputSpacing( reference->GetSpacing() );
+  resampler->SetOutputOrigin( reference->GetOrigin() );
+  resampler->SetOutputDirection( reference->GetDirection() );
+  resampler->SetOutputStartIndex( reference->GetLargestPossibleRegion().GetIndex() );
+  resampler->SetSize( reference->GetLargestPossibleRegion().GetSize() );
+  resampler->SetDefaultPixelValue( 4.0 );
+  resampler->SetNumberOfThreads( this->GetNumberOfThreads() );
+  resampler->Update();
+
+  OutputImagePointer expanded = resampler->GetOutput();
+  expanded->DisconnectPipeline();
+
+  return expanded;
+}
+
+
+/**
+ * Generate Data
+ */
+template <unsigned int NDimension>
+void
+MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::GenerateData()
+{
+  const FeatureImageType * feature = this->GetInternalFeatureImage();
+
+  const unsigned int numberOfLevels = this->m_NumberOfLevels;
+
+  // Feature pyramid, from the coarsest level to the full resolution one.
+  std::vector< typename FeatureImageType::ConstPointer > pyramid( numberOfLevels );
+
+  pyramid[numberOfLevels - 1] = feature;
+
+  unsigned int factor = 1;
+  for( int level = numberOfLevels - 2; level >= 0; level-- )
+    {
+    factor *= 2;
+    pyramid[level] = this->ShrinkFeatureImage( feature, factor ).GetPointer();
+    }
+
+  // Report progress.
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+
+  const float coarseWeight = ( numberOfLevels > 1 ) ? 0.5 : 1.0;
+  const float refinementWeight = ( numberOfLevels > 1 ) ? 0.5 / ( numberOfLevels - 1 ) : 0.0;
+
+  progress->RegisterInternalFilter( this->m_CoarseModule, coarseWeight );
+
+  // Fast marching and geodesic active contour on the coarsest level.
+  typename FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+  featureObject->SetImage( pyramid[0] );
+
+  this->m_CoarseModule->SetInput( this->GetInput() );
+  this->m_CoarseModule->SetFeature( featureObject );
+  this->m_CoarseModule->SetMaximumRMSError( this->GetMaximumRMSError() );
+  this->m_CoarseModule->SetMaximumNumberOfIterations( this->GetMaximumNumberOfIterations() );
+  this->m_CoarseModule->SetPropagationScaling( this->GetPropagationScaling() );
+  this->m_CoarseModule->SetCurvatureScaling( this->GetCurvatureScaling() );
+  this->m_CoarseModule->SetAdvectionScaling( this->GetAdvectionScaling() );
+  this->m_CoarseModule->SetVolumeConvergenceTolerance( this->GetVolumeConvergenceTolerance() );
+  this->m_CoarseModule->SetVolumeConvergenceInterval( this->GetVolumeConvergenceInterval() );
+  this->m_CoarseModule->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->m_CoarseModule->Update();
+
+  this->CopyLevelSetResults( this->m_CoarseModule );
+  this->AddIntensityPassCounts( this->m_CoarseModule );
+
+  OutputImagePointer levelSet = const_cast< OutputImageType * >(
+    dynamic_cast< const OutputSpatialObjectType * >(
+      this->m_CoarseModule->GetOutput() )->GetImage() );
+
+  // Upsample and refine on each finer level.
+  for( unsigned int level = 1; level < numberOfLevels; level++ )
+    {
+    typename InputImageType::Pointer initialLevelSet =
+      this->ExpandLevelSet( levelSet, pyramid[level] );
+
+    typename Superclass::InputSpatialObjectType::Pointer initialObject =
+      Superclass::InputSpatialObjectType::New();
+    initialObject->SetImage( initialLevelSet );
+
+    typename FeatureSpatialObjectType::Pointer levelFeatureObject = FeatureSpatialObjectType::New();
+    levelFeatureObject->SetImage( pyramid[level] );
+
+    typename RefinementModuleType::Pointer refinementModule = RefinementModuleType::New();
+    refinementModule->InvertOutputIntensitiesOff();
+    refinementModule->SetInput( initialObject );
+    refinementModule->SetFeature( levelFeatureObject );
+    refinementModule->SetMaximumRMSError( this->GetMaximumRMSError() );
+    refinementModule->SetMaximumNumberOfIterations( this->m_RefinementIterations );
+    refinementModule->SetPropagationScaling( this->GetPropagationScaling() );
+    refinementModule->SetCurvatureScaling( this->GetCurvatureScaling() );
+    refinementModule->SetAdvectionScaling( this->GetAdvectionScaling() );
+    refinementModule->SetVolumeConvergenceTolerance( this->GetVolumeConvergenceTolerance() );
+    refinementModule->SetVolumeConvergenceInterval( this->GetVolumeConvergenceInterval() );
+
+    progress->RegisterInternalFilter( refinementModule, refinementWeight );
+
+    refinementModule->Update();
+
+    this->CopyLevelSetResults( refinementModule );
+    this->AddIntensityPassCounts( refinementModule );
+
+    levelSet = const_cast< OutputImageType * >(
+      dynamic_cast< const OutputSpatialObjectType * >(
+        refinementModule->GetOutput() )->GetImage() );
+    }
+
+  this->PackOutputImageInOutputSpatialObject( levelSet );
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,133 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelGeodesicActiveContourLevelSetImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkParallelGeodesicActiveContourLevelSetImageFilter_h
+#define __itkParallelGeodesicActiveContourLevelSetImageFilter_h
+
+#include "itkParallelSparseFieldLevelSetImageFilter.h"
+#include "itkGeodesicActiveContourLevelSetFunction.h"
+
+namespace itk
+{
+
+/** \class ParallelGeodesicActiveContourLevelSetImageFilter
+ *
+ * \brief Evolves the geodesic active contour equation with the
+ * multithreaded sparse field solver.
+ *
+ * Same equation and parameters as GeodesicActiveContourLevelSetImageFilter,
+ * but the level set is updated by ParallelSparseFieldLevelSetImageFilter.
+ * The image is split into slabs along the last dimension, each thread owns
+ * the sparse field layers of its slab, and the threads synchronize once per
+ * iteration to exchange the layer nodes that cross slab boundaries and to
+ * agree on the time step. The slab boundaries are rebalanced as the active
+ * layer moves.
+ *
+ * The speed and advection images are computed from the feature image before
+ * the evolution starts, unless AutoGenerateSpeedAdvection is off.
+ *
+ * \ingroup LevelSetSegmentation  Multithreaded
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TInputImage, class TFeatureImage, class TOutputPixelType = float>
+class ITK_EXPORT ParallelGeodesicActiveContourLevelSetImageFilter :
+  public ParallelSparseFieldLevelSetImageFilter< TInputImage,
+           Image< TOutputPixelType, ::itk::GetImageDimension< TInputImage >::ImageDimension > >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelGeodesicActiveContourLevelSetImageFilter    Self;
+  typedef ParallelSparseFieldLevelSetImageFilter< TInputImage,
+    Image< TOutputPixelType,
+      ::itk::GetImageDimension< TInputImage >::ImageDimension > >   Superclass;
+  typedef SmartPointer<Self>                                  Pointer;
+  typedef SmartPointer<const Self>                            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ParallelGeodesicActiveContourLevelSetImageFilter, ParallelSparseFieldLevelSetImageFilter);
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TInputImage                                   InputImageType;
+  typedef TFeatureImage                                 FeatureImageType;
+  typedef typename Superclass::OutputImageType          OutputImageType;
+  typedef typename Superclass::ValueType                ValueType;
+
+  typedef GeodesicActiveContourLevelSetFunction<
+    OutputImageType, FeatureImageType >                 GeodesicActiveContourFunctionType;
+  typedef typename GeodesicActiveContourFunctionType::Pointer
+                                                        GeodesicActiveContourFunctionPointer;
+
+  /** Feature image from which the speed and advection images are computed. */
+  void SetFeatureImage( const FeatureImageType * feature );
+  const FeatureImageType * GetFeatureImage() const;
+
+  /** Weights of the propagation, curvature and advection terms. */
+  void SetPropagationScaling( ValueType value );
+  ValueType GetPropagationScaling() const;
+  void SetCurvatureScaling( ValueType value );
+  ValueType GetCurvatureScaling() const;
+  void SetAdvectionScaling( ValueType value );
+  ValueType GetAdvectionScaling() const;
+
+  /** Sigma of the Gaussian derivatives used to compute the advection
+   * image. */
+  void SetDerivativeSigma( double value );
+  double GetDerivativeSigma() const;
+
+  /** Compute the speed and advection images from the feature image before
+   * the evolution. Turn off when they have been set on the function, as
+   * with SegmentationLevelSetImageFilter. Defaults to true. */
+  itkSetMacro( AutoGenerateSpeedAdvection, bool );
+  itkGetConstMacro( AutoGenerateSpeedAdvection, bool );
+  itkBooleanMacro( AutoGenerateSpeedAdvection );
+
+  /** Level set while it is being evolved. The solver works on an internal
+   * copy of the input and only writes the output once it has finished. */
+  const OutputImageType * GetEvolvingLevelSet() const
+    { return this->m_ShiftedImage.GetPointer(); }
+
+  /** Equation solved by the filter. */
+  GeodesicActiveContourFunctionType * GetGeodesicActiveContourFunction()
+    { return this->m_GeodesicActiveContourFunction.GetPointer(); }
+
+protected:
+  ParallelGeodesicActiveContourLevelSetImageFilter();
+  virtual ~ParallelGeodesicActiveContourLevelSetImageFilter() {}
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Computes the speed and advection images and runs the solver. */
+  void GenerateData();
+
+private:
+  ParallelGeodesicActiveContourLevelSetImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  GeodesicActiveContourFunctionPointer    m_GeodesicActiveContourFunction;
+  bool                                    m_AutoGenerateSpeedAdvection;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelGeodesicActiveContourLevelSetImageFilter.hxx"
+#endif
+
+#endif
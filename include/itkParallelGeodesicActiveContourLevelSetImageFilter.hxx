@@ -0,0 +1,207 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelGeodesicActiveContourLevelSetImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkParallelGeodesicActiveContourLevelSetImageFilter_hxx
+#define __itkParallelGeodesicActiveContourLevelSetImageFilter_hxx
+
+#include "itkParallelGeodesicActiveContourLevelSetImageFilter.h"
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::ParallelGeodesicActiveContourLevelSetImageFilter()
+{
+  this->m_GeodesicActiveContourFunction = GeodesicActiveContourFunctionType::New();
+
+  typename GeodesicActiveContourFunctionType::RadiusType radius;
+  radius.Fill( 1 );
+  this->m_GeodesicActiveContourFunction->Initialize( radius );
+
+  this->SetDifferenceFunction( this->m_GeodesicActiveContourFunction );
+
+  this->m_AutoGenerateSpeedAdvection = true;
+
+  // Same defaults as the serial GeodesicActiveContourLevelSetImageFilter.
+  this->SetNumberOfLayers( ImageDimension );
+  this->SetIsoSurfaceValue( NumericTraits< ValueType >::Zero );
+  this->SetNumberOfRequiredInputs( 2 );
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::SetFeatureImage( const FeatureImageType * feature )
+{
+  this->ProcessObject::SetNthInput( 1, const_cast< FeatureImageType * >( feature ) );
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+const typename ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::FeatureImageType *
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::GetFeatureImage() const
+{
+  return static_cast< const FeatureImageType * >( this->ProcessObject::GetInput( 1 ) );
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::SetPropagationScaling( ValueType value )
+{
+  if( this->m_GeodesicActiveContourFunction->GetPropagationWeight() != value )
+    {
+    this->m_GeodesicActiveContourFunction->SetPropagationWeight( value );
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+typename ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::ValueType
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::GetPropagationScaling() const
+{
+  return this->m_GeodesicActiveContourFunction->GetPropagationWeight();
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::SetCurvatureScaling( ValueType value )
+{
+  if( this->m_GeodesicActiveContourFunction->GetCurvatureWeight() != value )
+    {
+    this->m_GeodesicActiveContourFunction->SetCurvatureWeight( value );
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+typename ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::ValueType
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::GetCurvatureScaling() const
+{
+  return this->m_GeodesicActiveContourFunction->GetCurvatureWeight();
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::SetAdvectionScaling( ValueType value )
+{
+  if( this->m_GeodesicActiveContourFunction->GetAdvectionWeight() != value )
+    {
+    this->m_GeodesicActiveContourFunction->SetAdvectionWeight( value );
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+typename ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::ValueType
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::GetAdvectionScaling() const
+{
+  return this->m_GeodesicActiveContourFunction->GetAdvectionWeight();
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::SetDerivativeSigma( double value )
+{
+  if( this->m_GeodesicActiveContourFunction->GetDerivativeSigma() != value )
+    {
+    this->m_GeodesicActiveContourFunction->SetDerivativeSigma( value );
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+double
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::GetDerivativeSigma() const
+{
+  return this->m_GeodesicActiveContourFunction->GetDerivativeSigma();
+}
+
+
+/**
+ * Generate Data
+ */
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::GenerateData()
+{
+  const FeatureImageType * feature = this->GetFeatureImage();
+
+  if( !feature )
+    {
+    itkExceptionMacro("Feature image has not been set");
+    }
+
+  // The speed and advection images are sampled by all the threads, so they
+  // are computed once, up front, exactly as SegmentationLevelSetImageFilter
+  // does for the serial solver.
+  this->m_GeodesicActiveContourFunction->SetFeatureImage( feature );
+
+  if( this->GetState() == Superclass::UNINITIALIZED && this->m_AutoGenerateSpeedAdvection )
+    {
+    this->m_GeodesicActiveContourFunction->AllocateSpeedImage();
+    this->m_GeodesicActiveContourFunction->CalculateSpeedImage();
+
+    if( this->m_GeodesicActiveContourFunction->GetAdvectionWeight() != NumericTraits< ValueType >::Zero )
+      {
+      this->m_GeodesicActiveContourFunction->AllocateAdvectionImage();
+      this->m_GeodesicActiveContourFunction->CalculateAdvectionImage();
+      }
+    }
+
+  this->Superclass::GenerateData();
+}
+
+
+template <class TInputImage, class TFeatureImage, class TOutputPixelType>
+void
+ParallelGeodesicActiveContourLevelSetImageFilter<TInputImage, TFeatureImage, TOutputPixelType>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "GeodesicActiveContourFunction: " << this->m_GeodesicActiveContourFunction.GetPointer() << std::endl;
+  os << indent << "AutoGenerateSpeedAdvection: " << this->m_AutoGenerateSpeedAdvection << std::endl;
+}
+
+} // end namespace itk
+
+#endif
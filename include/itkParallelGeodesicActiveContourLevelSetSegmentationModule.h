@@ -0,0 +1,103 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelGeodesicActiveContourLevelSetSegmentationModule.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkParallelGeodesicActiveContourLevelSetSegmentationModule_h
+#define __itkParallelGeodesicActiveContourLevelSetSegmentationModule_h
+
+#include "itkSinglePhaseLevelSetSegmentationModule.h"
+#include "itkParallelGeodesicActiveContourLevelSetImageFilter.h"
+
+namespace itk
+{
+
+/** \class ParallelGeodesicActiveContourLevelSetSegmentationModule
+ * \brief This class applies the GeodesicActiveContourLevelSet segmentation
+ * method using the multithreaded sparse field solver.
+ *
+ * It is a drop-in alternative to GeodesicActiveContourLevelSetSegmentationModule.
+ * The level set is evolved by ParallelGeodesicActiveContourLevelSetImageFilter
+ * with the number of threads of this module.
+ *
+ * SpatialObjects are used as inputs and outputs of this class.
+ *
+ * \ingroup SpatialObjectFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <unsigned int NDimension>
+class ITK_EXPORT ParallelGeodesicActiveContourLevelSetSegmentationModule : 
+  public SinglePhaseLevelSetSegmentationModule<NDimension>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelGeodesicActiveContourLevelSetSegmentationModule         Self;
+  typedef SinglePhaseLevelSetSegmentationModule<NDimension>       Superclass;
+  typedef SmartPointer<Self>                                      Pointer;
+  typedef SmartPointer<const Self>                                ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ParallelGeodesicActiveContourLevelSetSegmentationModule, SinglePhaseLevelSetSegmentationModule);
+
+  /** Dimension of the space */
+  itkStaticConstMacro(Dimension, unsigned int, NDimension);
+
+  /** Type of spatialObject that will be passed as input and output of this
+   * segmentation method. */
+  typedef typename Superclass::SpatialObjectType         SpatialObjectType;
+  typedef typename Superclass::SpatialObjectPointer      SpatialObjectPointer;
+
+  /** Types of images and spatial objects inherited from the superclass. */
+  typedef typename Superclass::OutputPixelType           OutputPixelType;
+  typedef typename Superclass::InputImageType            InputImageType;
+  typedef typename Superclass::FeatureImageType          FeatureImageType;
+  typedef typename Superclass::OutputImageType           OutputImageType;
+  typedef typename Superclass::InputSpatialObjectType    InputSpatialObjectType;
+  typedef typename Superclass::FeatureSpatialObjectType  FeatureSpatialObjectType;
+  typedef typename Superclass::OutputSpatialObjectType   OutputSpatialObjectType;
+
+
+protected:
+  ParallelGeodesicActiveContourLevelSetSegmentationModule();
+  virtual ~ParallelGeodesicActiveContourLevelSetSegmentationModule();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Method invoked by the pipeline in order to trigger the computation of
+   * the segmentation. */
+  void  GenerateData ();
+
+  typedef ParallelGeodesicActiveContourLevelSetImageFilter<
+    InputImageType, FeatureImageType, OutputPixelType > FilterType;
+
+  typedef typename Superclass::LevelSetFilterType        LevelSetFilterType;
+
+  /** The parallel solver does not evolve its output in place. */
+  const OutputImageType * GetEvolvingLevelSet( LevelSetFilterType * filter ) const;
+
+private:
+  ParallelGeodesicActiveContourLevelSetSegmentationModule(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkParallelGeodesicActiveContourLevelSetSegmentationModule.hxx"
+#endif
+
+#endif
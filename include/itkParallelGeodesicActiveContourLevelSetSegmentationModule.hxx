@@ -0,0 +1,114 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelGeodesicActiveContourLevelSetSegmentationModule.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkParallelGeodesicActiveContourLevelSetSegmentationModule_hxx
+#define __itkParallelGeodesicActiveContourLevelSetSegmentationModule_hxx
+
+#include "itkParallelGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkParallelGeodesicActiveContourLevelSetImageFilter.h"
+#include "itkProgressAccumulator.h"
+
+
+namespace itk
+{
+
+
+/**
+ * Constructor
+ */
+template <unsigned int NDimension>
+ParallelGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::ParallelGeodesicActiveContourLevelSetSegmentationModule()
+{
+}
+
+
+/**
+ * Destructor
+ */
+template <unsigned int NDimension>
+ParallelGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::~ParallelGeodesicActiveContourLevelSetSegmentationModule()
+{
+}
+
+
+/**
+ * PrintSelf
+ */
+template <unsigned int NDimension>
+void
+ParallelGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+}
+
+
+template <unsigned int NDimension>
+const typename ParallelGeodesicActiveContourLevelSetSegmentationModule<NDimension>::OutputImageType *
+ParallelGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::GetEvolvingLevelSet( LevelSetFilterType * filter ) const
+{
+  const FilterType * parallelFilter = dynamic_cast< const FilterType * >( filter );
+  if( parallelFilter )
+    {
+    return parallelFilter->GetEvolvingLevelSet();
+    }
+  return this->Superclass::GetEvolvingLevelSet( filter );
+}
+
+
+/**
+ * Generate Data
+ */
+template <unsigned int NDimension>
+void
+ParallelGeodesicActiveContourLevelSetSegmentationModule<NDimension>
+::GenerateData()
+{
+  typename FilterType::Pointer filter = FilterType::New();
+
+  filter->SetInput( this->GetInternalInputImage() );
+  filter->SetFeatureImage( this->GetInternalFeatureImage() );
+
+  filter->SetMaximumRMSError( this->GetMaximumRMSError() );
+  filter->SetNumberOfIterations( this->GetMaximumNumberOfIterations() );
+  filter->SetPropagationScaling( this->GetPropagationScaling() );
+  filter->SetCurvatureScaling( this->GetCurvatureScaling() );
+  filter->SetAdvectionScaling( this->GetAdvectionScaling() );
+  filter->UseImageSpacingOn();
+  filter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  filter->SetAutoGenerateSpeedAdvection(
+    !this->SetCachedFeatureImages( filter->GetGeodesicActiveContourFunction() ) );
+
+  // Progress reporting - forward events from the fast marching filter.
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+  progress->RegisterInternalFilter( filter, 1.0 );  
+
+  this->MonitorLevelSetFilter( filter );
+
+  filter->Update();
+
+  this->RecordLevelSetFilterResults( filter );
+
+  this->PackOutputImageInOutputSpatialObject( filter->GetOutput() );
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunLengthSegmentation.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkRunLengthSegmentation_h
+#define __itkRunLengthSegmentation_h
+
+#include "itkDataObject.h"
+#include "itkImage.h"
+#include "itkIntTypes.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class RunLengthSegmentation
+ * \brief Compact form of a segmentation level set: a run-length encoded
+ * mask, plus the level set values of a narrow band around the contour.
+ *
+ * The segmentation level sets are made of two plateaus, the low value
+ * outside and the high value inside the lesion, separated by a narrow
+ * transition region. The pixels, in the order of the image buffer, are
+ * grouped in runs of pixels of the low plateau, of the high plateau, and of
+ * the narrow band. Only the level set values of the narrow band are stored.
+ *
+ * A pixel belongs to the narrow band when it is on neither plateau and its
+ * value is within NarrowBandWidth of IsoValue. The other pixels are assigned
+ * to the plateau on their side of IsoValue. With the default width, every
+ * pixel off the plateaus is in the narrow band and the image is encoded
+ * without loss. Without narrow band, the segmentation is a binary mask at
+ * IsoValue.
+ *
+ * \sa RunLengthSegmentationFileWriter
+ * \sa RunLengthSegmentationFileReader
+ *
+ * \ingroup SpatialObjectFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <unsigned int NDimension>
+class ITK_EXPORT RunLengthSegmentation : public DataObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthSegmentation         Self;
+  typedef DataObject                    Superclass;
+  typedef SmartPointer<Self>            Pointer;
+  typedef SmartPointer<const Self>      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RunLengthSegmentation, DataObject);
+
+  /** Dimension of the space */
+  itkStaticConstMacro(Dimension, unsigned int, NDimension);
+
+  /** Type of the level set images that are encoded and decoded. */
+  typedef float                                 PixelType;
+  typedef Image< PixelType, NDimension >        ImageType;
+  typedef typename ImageType::Pointer           ImagePointer;
+  typedef typename ImageType::RegionType        RegionType;
+  typedef typename ImageType::SpacingType       SpacingType;
+  typedef typename ImageType::PointType         PointType;
+  typedef typename ImageType::DirectionType     DirectionType;
+
+  /** A run is stored as its length, shifted by RunTypeBits, and its type in
+   * the low bits. */
+  typedef uint32_t                              RunType;
+  typedef std::vector< RunType >                RunArrayType;
+  typedef std::vector< PixelType >              BandValueArrayType;
+
+  enum RunCategoryType { LowRun = 0, HighRun = 1, BandRun = 2 };
+
+  itkStaticConstMacro(RunTypeBits, unsigned int, 2);
+
+  static RunType MakeRun( RunCategoryType category, SizeValueType length )
+    { return static_cast< RunType >( ( length << RunTypeBits ) | category ); }
+  static RunCategoryType GetRunCategory( RunType run )
+    { return static_cast< RunCategoryType >( run & ( ( 1 << RunTypeBits ) - 1 ) ); }
+  static SizeValueType GetRunLength( RunType run )
+    { return static_cast< SizeValueType >( run >> RunTypeBits ); }
+
+  /** Longest run that fits in a RunType. */
+  static SizeValueType GetMaximumRunLength()
+    { return static_cast< SizeValueType >( NumericTraits< RunType >::max() >> RunTypeBits ); }
+
+  /** Level of the contour of the segmentation. */
+  itkSetMacro( IsoValue, PixelType );
+  itkGetConstMacro( IsoValue, PixelType );
+
+  /** Largest distance to IsoValue of the level set values kept in the narrow
+   * band. */
+  itkSetMacro( NarrowBandWidth, PixelType );
+  itkGetConstMacro( NarrowBandWidth, PixelType );
+
+  /** Whether level set values are kept around the contour. When off, the
+   * segmentation is a binary mask. */
+  itkSetMacro( UseNarrowBand, bool );
+  itkGetConstMacro( UseNarrowBand, bool );
+  itkBooleanMacro( UseNarrowBand );
+
+  /** Values of the plateaus outside and inside the segmentation. */
+  itkSetMacro( LowValue, PixelType );
+  itkGetConstMacro( LowValue, PixelType );
+  itkSetMacro( HighValue, PixelType );
+  itkGetConstMacro( HighValue, PixelType );
+
+  /** Geometry of the encoded image. */
+  itkSetMacro( Region, RegionType );
+  itkGetConstReferenceMacro( Region, RegionType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+
+  /** Runs that cover the pixels of the region, in the order of the image
+   * buffer, and values of the pixels of the narrow band, in the same
+   * order. */
+  RunArrayType & GetRuns()
+    { return this->m_Runs; }
+  const RunArrayType & GetRuns() const
+    { return this->m_Runs; }
+  BandValueArrayType & GetBandValues()
+    { return this->m_BandValues; }
+  const BandValueArrayType & GetBandValues() const
+    { return this->m_BandValues; }
+
+  /** Encodes the buffered region of the image. */
+  void EncodeImage( const ImageType * image );
+
+  /** Image of the level set values of the runs. The pixels of the plateaus
+   * take the low and high values. */
+  ImagePointer DecodeImage() const;
+
+  /** Number of pixels of the runs of the given category. */
+  SizeValueType GetNumberOfPixels( RunCategoryType category ) const;
+
+  /** Whether the runs cover the region and match the band values. */
+  bool IsConsistent() const;
+
+  /** Releases the runs and the band values. */
+  virtual void Initialize();
+
+protected:
+  RunLengthSegmentation();
+  virtual ~RunLengthSegmentation();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  RunLengthSegmentation(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  void AppendRun( RunCategoryType category, SizeValueType length );
+
+  PixelType             m_IsoValue;
+  PixelType             m_NarrowBandWidth;
+  bool                  m_UseNarrowBand;
+  PixelType             m_LowValue;
+  PixelType             m_HighValue;
+
+  RegionType            m_Region;
+  SpacingType           m_Spacing;
+  PointType             m_Origin;
+  DirectionType         m_Direction;
+
+  RunArrayType          m_Runs;
+  BandValueArrayType    m_BandValues;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkRunLengthSegmentation.hxx"
+#endif
+
+#endif
@@ -0,0 +1,321 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunLengthSegmentation.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkRunLengthSegmentation_hxx
+#define __itkRunLengthSegmentation_hxx
+
+#include "itkRunLengthSegmentation.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <unsigned int NDimension>
+RunLengthSegmentation<NDimension>
+::RunLengthSegmentation()
+{
+  this->m_IsoValue = -0.5;
+  this->m_NarrowBandWidth = NumericTraits< PixelType >::max();
+  this->m_UseNarrowBand = true;
+  this->m_LowValue = NumericTraits< PixelType >::Zero;
+  this->m_HighValue = NumericTraits< PixelType >::Zero;
+
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Origin.Fill( 0.0 );
+  this->m_Direction.SetIdentity();
+}
+
+
+/**
+ * Destructor
+ */
+template <unsigned int NDimension>
+RunLengthSegmentation<NDimension>
+::~RunLengthSegmentation()
+{
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentation<NDimension>
+::Initialize()
+{
+  Superclass::Initialize();
+
+  RunArrayType().swap( this->m_Runs );
+  BandValueArrayType().swap( this->m_BandValues );
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentation<NDimension>
+::AppendRun( RunCategoryType category, SizeValueType length )
+{
+  const SizeValueType maximumRunLength = GetMaximumRunLength();
+
+  while( length > maximumRunLength )
+    {
+    this->m_Runs.push_back( MakeRun( category, maximumRunLength ) );
+    length -= maximumRunLength;
+    }
+
+  this->m_Runs.push_back( MakeRun( category, length ) );
+}
+
+
+/**
+ * The plateaus are the extreme values of the image, as in the
+ * GrayscaleImageSegmentationVolumeEstimator.
+ */
+template <unsigned int NDimension>
+void
+RunLengthSegmentation<NDimension>
+::EncodeImage( const ImageType * image )
+{
+  if( !image )
+    {
+    itkExceptionMacro("Missing image to encode");
+    }
+
+  const RegionType region = image->GetBufferedRegion();
+
+  this->m_Region = region;
+  this->m_Spacing = image->GetSpacing();
+  this->m_Origin = image->GetOrigin();
+  this->m_Direction = image->GetDirection();
+
+  this->m_Runs.clear();
+  this->m_BandValues.clear();
+
+  typedef ImageRegionConstIterator< ImageType >  IteratorType;
+
+  IteratorType itr( image, region );
+
+  PixelType lowValue = NumericTraits< PixelType >::max();
+  PixelType highValue = NumericTraits< PixelType >::NonpositiveMin();
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const PixelType value = itr.Get();
+    if( value < lowValue )
+      {
+      lowValue = value;
+      }
+    if( value > highValue )
+      {
+      highValue = value;
+      }
+    }
+
+  if( region.GetNumberOfPixels() == 0 )
+    {
+    lowValue = NumericTraits< PixelType >::Zero;
+    highValue = NumericTraits< PixelType >::Zero;
+    }
+
+  this->m_LowValue = lowValue;
+  this->m_HighValue = highValue;
+
+  const double isoValue = this->m_IsoValue;
+  const double narrowBandWidth = this->m_NarrowBandWidth;
+
+  RunCategoryType runCategory = LowRun;
+  SizeValueType runLength = 0;
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const PixelType value = itr.Get();
+
+    RunCategoryType category;
+
+    if( value == lowValue )
+      {
+      category = LowRun;
+      }
+    else if( value == highValue )
+      {
+      category = HighRun;
+      }
+    else if( this->m_UseNarrowBand && vcl_abs( value - isoValue ) <= narrowBandWidth )
+      {
+      category = BandRun;
+      this->m_BandValues.push_back( value );
+      }
+    else
+      {
+      category = ( value >= isoValue ) ? HighRun : LowRun;
+      }
+
+    if( runLength > 0 && category != runCategory )
+      {
+      this->AppendRun( runCategory, runLength );
+      runLength = 0;
+      }
+
+    runCategory = category;
+    ++runLength;
+    }
+
+  if( runLength > 0 )
+    {
+    this->AppendRun( runCategory, runLength );
+    }
+
+  this->Modified();
+}
+
+
+template <unsigned int NDimension>
+typename RunLengthSegmentation<NDimension>::ImagePointer
+RunLengthSegmentation<NDimension>
+::DecodeImage() const
+{
+  if( !this->IsConsistent() )
+    {
+    itkExceptionMacro("The runs do not cover the region of the segmentation");
+    }
+
+  ImagePointer image = ImageType::New();
+  image->SetRegions( this->m_Region );
+  image->SetSpacing( this->m_Spacing );
+  image->SetOrigin( this->m_Origin );
+  image->SetDirection( this->m_Direction );
+  image->Allocate();
+
+  typedef ImageRegionIterator< ImageType >  IteratorType;
+
+  IteratorType itr( image, this->m_Region );
+  itr.GoToBegin();
+
+  typename BandValueArrayType::const_iterator bandItr = this->m_BandValues.begin();
+
+  typename RunArrayType::const_iterator runItr = this->m_Runs.begin();
+
+  while( runItr != this->m_Runs.end() )
+    {
+    const RunCategoryType category = GetRunCategory( *runItr );
+    const SizeValueType length = GetRunLength( *runItr );
+
+    if( category == BandRun )
+      {
+      for( SizeValueType i = 0; i < length; ++i, ++itr, ++bandItr )
+        {
+        itr.Set( *bandItr );
+        }
+      }
+    else
+      {
+      const PixelType value = ( category == HighRun ) ? this->m_HighValue : this->m_LowValue;
+      for( SizeValueType i = 0; i < length; ++i, ++itr )
+        {
+        itr.Set( value );
+        }
+      }
+
+    ++runItr;
+    }
+
+  return image;
+}
+
+
+template <unsigned int NDimension>
+SizeValueType
+RunLengthSegmentation<NDimension>
+::GetNumberOfPixels( RunCategoryType category ) const
+{
+  SizeValueType numberOfPixels = 0;
+
+  typename RunArrayType::const_iterator runItr = this->m_Runs.begin();
+
+  while( runItr != this->m_Runs.end() )
+    {
+    if( GetRunCategory( *runItr ) == category )
+      {
+      numberOfPixels += GetRunLength( *runItr );
+      }
+    ++runItr;
+    }
+
+  return numberOfPixels;
+}
+
+
+template <unsigned int NDimension>
+bool
+RunLengthSegmentation<NDimension>
+::IsConsistent() const
+{
+  SizeValueType numberOfPixels = 0;
+  SizeValueType numberOfBandPixels = 0;
+
+  typename RunArrayType::const_iterator runItr = this->m_Runs.begin();
+
+  while( runItr != this->m_Runs.end() )
+    {
+    const RunCategoryType category = GetRunCategory( *runItr );
+
+    if( category != LowRun && category != HighRun && category != BandRun )
+      {
+      return false;
+      }
+
+    numberOfPixels += GetRunLength( *runItr );
+
+    if( category == BandRun )
+      {
+      numberOfBandPixels += GetRunLength( *runItr );
+      }
+
+    ++runItr;
+    }
+
+  return numberOfPixels == this->m_Region.GetNumberOfPixels() &&
+         numberOfBandPixels == this->m_BandValues.size();
+}
+
+
+/**
+ * PrintSelf
+ */
+template <unsigned int NDimension>
+void
+RunLengthSegmentation<NDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Iso value: " << this->m_IsoValue << std::endl;
+  os << indent << "Narrow band width: " << this->m_NarrowBandWidth << std::endl;
+  os << indent << "Use narrow band: " << this->m_UseNarrowBand << std::endl;
+  os << indent << "Low value: " << this->m_LowValue << std::endl;
+  os << indent << "High value: " << this->m_HighValue << std::endl;
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "Spacing: " << this->m_Spacing << std::endl;
+  os << indent << "Origin: " << this->m_Origin << std::endl;
+  os << indent << "Direction: " << this->m_Direction << std::endl;
+  os << indent << "Number of runs: " << this->m_Runs.size() << std::endl;
+  os << indent << "Number of band values: " << this->m_BandValues.size() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
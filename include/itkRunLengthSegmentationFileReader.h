@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunLengthSegmentationFileReader.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkRunLengthSegmentationFileReader_h
+#define __itkRunLengthSegmentationFileReader_h
+
+#include "itkProcessObject.h"
+#include "itkRunLengthSegmentation.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class RunLengthSegmentationFileReader
+ * \brief Reads a file written by RunLengthSegmentationFileWriter.
+ *
+ * A RunLengthSegmentation is produced as output. Its volume can be estimated
+ * by the GrayscaleImageSegmentationVolumeEstimator without decoding it, and
+ * its level set image is rebuilt by RunLengthSegmentation::DecodeImage().
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <unsigned int NDimension>
+class ITK_EXPORT RunLengthSegmentationFileReader : public ProcessObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthSegmentationFileReader   Self;
+  typedef ProcessObject                     Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RunLengthSegmentationFileReader, ProcessObject);
+
+  /** Dimension of the space */
+  itkStaticConstMacro(Dimension, unsigned int, NDimension);
+
+  typedef RunLengthSegmentation< NDimension >   SegmentationType;
+
+  /** Segmentation read from the file. */
+  const SegmentationType * GetOutput() const;
+
+  /** Set / Get the input filename */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+protected:
+  RunLengthSegmentationFileReader();
+  virtual ~RunLengthSegmentationFileReader();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void GenerateData();
+
+private:
+  RunLengthSegmentationFileReader(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  std::string                     m_FileName;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkRunLengthSegmentationFileReader.hxx"
+#endif
+
+#endif
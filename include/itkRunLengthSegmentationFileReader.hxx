@@ -0,0 +1,288 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunLengthSegmentationFileReader.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkRunLengthSegmentationFileReader_hxx
+#define __itkRunLengthSegmentationFileReader_hxx
+
+#include "itkRunLengthSegmentationFileReader.h"
+#include "itkRunLengthSegmentationFileWriter.h"
+#include "itkByteSwapper.h"
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+#include <sstream>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <unsigned int NDimension>
+RunLengthSegmentationFileReader<NDimension>
+::RunLengthSegmentationFileReader()
+{
+  this->SetNumberOfRequiredOutputs( 1 );
+
+  typename SegmentationType::Pointer outputObject = SegmentationType::New();
+
+  this->ProcessObject::SetNthOutput( 0, outputObject );
+}
+
+
+/**
+ * Destructor
+ */
+template <unsigned int NDimension>
+RunLengthSegmentationFileReader<NDimension>
+::~RunLengthSegmentationFileReader()
+{
+}
+
+
+template <unsigned int NDimension>
+const typename RunLengthSegmentationFileReader<NDimension>::SegmentationType *
+RunLengthSegmentationFileReader<NDimension>
+::GetOutput() const
+{
+  return static_cast<const SegmentationType*>(this->ProcessObject::GetOutput(0));
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileReader<NDimension>
+::GenerateData()
+{
+  SegmentationType * outputObject =
+    static_cast< SegmentationType * >( this->ProcessObject::GetOutput(0) );
+
+  outputObject->Initialize();
+
+  std::ifstream is( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+
+  if( !is )
+    {
+    itkExceptionMacro("Could not open " << this->m_FileName );
+    }
+
+  std::string line;
+
+  if( !std::getline( is, line ) ||
+      line != RunLengthSegmentationFileWriter< NDimension >::GetFileSignature() )
+    {
+    itkExceptionMacro( << this->m_FileName << " is not a run-length segmentation file" );
+    }
+
+  typedef typename SegmentationType::RunType        RunType;
+  typedef typename SegmentationType::PixelType      PixelType;
+  typedef typename SegmentationType::RegionType     RegionType;
+  typedef typename SegmentationType::SpacingType    SpacingType;
+  typedef typename SegmentationType::PointType      PointType;
+  typedef typename SegmentationType::DirectionType  DirectionType;
+
+  RegionType    region;
+  SpacingType   spacing;
+  PointType     origin;
+  DirectionType direction;
+
+  spacing.Fill( 1.0 );
+  origin.Fill( 0.0 );
+  direction.SetIdentity();
+
+  unsigned long numberOfRuns = 0;
+  unsigned long numberOfBandValues = 0;
+
+  bool elementDataFound = false;
+
+  while( !elementDataFound && std::getline( is, line ) )
+    {
+    std::istringstream ls( line );
+
+    std::string key;
+    ls >> key;
+
+    // Plateau and band values are read as double, so that the largest float
+    // written as the default narrow band width reads back
+    double value = 0.0;
+
+    if( key == "Dimension" )
+      {
+      unsigned int dimension = 0;
+      ls >> dimension;
+      if( dimension != NDimension )
+        {
+        itkExceptionMacro( << this->m_FileName << " holds a segmentation of dimension " << dimension );
+        }
+      }
+    else if( key == "Index" )
+      {
+      typename RegionType::IndexType index;
+      for( unsigned int i = 0; i < NDimension; i++ )
+        {
+        ls >> index[i];
+        }
+      region.SetIndex( index );
+      }
+    else if( key == "Size" )
+      {
+      typename RegionType::SizeType size;
+      for( unsigned int i = 0; i < NDimension; i++ )
+        {
+        ls >> size[i];
+        }
+      region.SetSize( size );
+      }
+    else if( key == "Spacing" )
+      {
+      for( unsigned int i = 0; i < NDimension; i++ )
+        {
+        ls >> spacing[i];
+        }
+      }
+    else if( key == "Origin" )
+      {
+      for( unsigned int i = 0; i < NDimension; i++ )
+        {
+        ls >> origin[i];
+        }
+      }
+    else if( key == "Direction" )
+      {
+      for( unsigned int i = 0; i < NDimension; i++ )
+        {
+        for( unsigned int j = 0; j < NDimension; j++ )
+          {
+          ls >> direction[i][j];
+          }
+        }
+      }
+    else if( key == "IsoValue" )
+      {
+      ls >> value;
+      outputObject->SetIsoValue( static_cast< PixelType >( value ) );
+      }
+    else if( key == "NarrowBandWidth" )
+      {
+      ls >> value;
+      outputObject->SetNarrowBandWidth( static_cast< PixelType >( value ) );
+      }
+    else if( key == "UseNarrowBand" )
+      {
+      bool useNarrowBand = true;
+      ls >> useNarrowBand;
+      outputObject->SetUseNarrowBand( useNarrowBand );
+      }
+    else if( key == "LowValue" )
+      {
+      ls >> value;
+      outputObject->SetLowValue( static_cast< PixelType >( value ) );
+      }
+    else if( key == "HighValue" )
+      {
+      ls >> value;
+      outputObject->SetHighValue( static_cast< PixelType >( value ) );
+      }
+    else if( key == "NumberOfRuns" )
+      {
+      ls >> numberOfRuns;
+      }
+    else if( key == "NumberOfBandValues" )
+      {
+      ls >> numberOfBandValues;
+      }
+    else if( key == "ElementData" )
+      {
+      std::string byteOrder;
+      ls >> byteOrder;
+      if( byteOrder != "LittleEndian" )
+        {
+        itkExceptionMacro("Unsupported byte order " << byteOrder << " in " << this->m_FileName );
+        }
+      elementDataFound = true;
+      }
+
+    if( ls.fail() )
+      {
+      itkExceptionMacro("Invalid line \"" << line << "\" in " << this->m_FileName );
+      }
+    }
+
+  if( !elementDataFound )
+    {
+    itkExceptionMacro("Missing ElementData in " << this->m_FileName );
+    }
+
+  // Check the counts against the file before allocating the arrays
+  const unsigned long dataOffset = static_cast< unsigned long >( is.tellg() );
+  const unsigned long fileLength = itksys::SystemTools::FileLength( this->m_FileName.c_str() );
+
+  if( fileLength < dataOffset ||
+      fileLength - dataOffset != numberOfRuns * sizeof( RunType ) + numberOfBandValues * sizeof( PixelType ) )
+    {
+    itkExceptionMacro("The size of " << this->m_FileName << " does not match its header");
+    }
+
+  typename SegmentationType::RunArrayType & runs = outputObject->GetRuns();
+  typename SegmentationType::BandValueArrayType & bandValues = outputObject->GetBandValues();
+
+  runs.resize( numberOfRuns );
+  bandValues.resize( numberOfBandValues );
+
+  if( numberOfRuns > 0 )
+    {
+    is.read( reinterpret_cast< char * >( &runs[0] ), numberOfRuns * sizeof( RunType ) );
+    ByteSwapper< RunType >::SwapRangeFromSystemToLittleEndian( &runs[0], numberOfRuns );
+    }
+
+  if( numberOfBandValues > 0 )
+    {
+    is.read( reinterpret_cast< char * >( &bandValues[0] ), numberOfBandValues * sizeof( PixelType ) );
+    ByteSwapper< PixelType >::SwapRangeFromSystemToLittleEndian( &bandValues[0], numberOfBandValues );
+    }
+
+  if( !is )
+    {
+    itkExceptionMacro("Could not read the runs of " << this->m_FileName );
+    }
+
+  outputObject->SetRegion( region );
+  outputObject->SetSpacing( spacing );
+  outputObject->SetOrigin( origin );
+  outputObject->SetDirection( direction );
+
+  if( !outputObject->IsConsistent() )
+    {
+    itkExceptionMacro("The runs of " << this->m_FileName << " do not cover its region");
+    }
+}
+
+
+/**
+ * PrintSelf
+ */
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileReader<NDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "File name: " << this->m_FileName << std::endl;
+}
+
+} // end namespace itk
+
+#endif
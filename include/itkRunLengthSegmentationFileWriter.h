@@ -0,0 +1,132 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunLengthSegmentationFileWriter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkRunLengthSegmentationFileWriter_h
+#define __itkRunLengthSegmentationFileWriter_h
+
+#include "itkProcessObject.h"
+#include "itkRunLengthSegmentation.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class RunLengthSegmentationFileWriter
+ * \brief Writes a segmentation level set in the compact run-length form of
+ * RunLengthSegmentation.
+ *
+ * The file starts with a text header, that holds the geometry of the image,
+ * the iso value, the values of the plateaus and the number of runs and of
+ * band values. The header ends with the line "ElementData LittleEndian",
+ * followed by the runs, as 32 bits unsigned integers, and the band values,
+ * as 32 bits floats, in little endian byte order.
+ *
+ * The runs take a few bytes per line of the image that crosses the contour,
+ * so that the file of a lesion segmentation is a small fraction of the size
+ * of the float image, unless the narrow band is wide.
+ *
+ * \sa RunLengthSegmentationFileReader
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <unsigned int NDimension>
+class ITK_EXPORT RunLengthSegmentationFileWriter : public ProcessObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthSegmentationFileWriter   Self;
+  typedef ProcessObject                     Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RunLengthSegmentationFileWriter, ProcessObject);
+
+  /** Dimension of the space */
+  itkStaticConstMacro(Dimension, unsigned int, NDimension);
+
+  typedef RunLengthSegmentation< NDimension >       SegmentationType;
+  typedef typename SegmentationType::PixelType      PixelType;
+  typedef typename SegmentationType::ImageType      InputImageType;
+
+  /** Level set image to write. */
+  using ProcessObject::SetInput;
+  void SetInput( const InputImageType * image );
+  const InputImageType * GetInput() const;
+
+  /** Set / Get the output filename */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Encoding of the level set, see RunLengthSegmentation. */
+  itkSetMacro( IsoValue, PixelType );
+  itkGetConstMacro( IsoValue, PixelType );
+  itkSetMacro( NarrowBandWidth, PixelType );
+  itkGetConstMacro( NarrowBandWidth, PixelType );
+  itkSetMacro( UseNarrowBand, bool );
+  itkGetConstMacro( UseNarrowBand, bool );
+  itkBooleanMacro( UseNarrowBand );
+
+  /** Segmentation written by the last update. */
+  const SegmentationType * GetSegmentation() const
+    { return this->m_Segmentation.GetPointer(); }
+
+  /** Encodes the input and writes the file. */
+  virtual void Write();
+
+  /** Writers are updated by writing. */
+  virtual void Update()
+    { this->Write(); }
+
+  /** Writes the segmentation to the file, throwing an exception when the
+   * file cannot be written. */
+  static void WriteSegmentation( const SegmentationType * segmentation,
+                                 const std::string & fileName );
+
+  /** First line of the files. */
+  static const char * GetFileSignature()
+    { return "LesionSizingToolkit run-length segmentation 1"; }
+
+protected:
+  RunLengthSegmentationFileWriter();
+  virtual ~RunLengthSegmentationFileWriter();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void GenerateData();
+
+private:
+  RunLengthSegmentationFileWriter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  std::string                           m_FileName;
+  PixelType                             m_IsoValue;
+  PixelType                             m_NarrowBandWidth;
+  bool                                  m_UseNarrowBand;
+  typename SegmentationType::Pointer    m_Segmentation;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+# include "itkRunLengthSegmentationFileWriter.hxx"
+#endif
+
+#endif
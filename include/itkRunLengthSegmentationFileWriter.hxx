@@ -0,0 +1,229 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunLengthSegmentationFileWriter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkRunLengthSegmentationFileWriter_hxx
+#define __itkRunLengthSegmentationFileWriter_hxx
+
+#include "itkRunLengthSegmentationFileWriter.h"
+#include "itkByteSwapper.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <unsigned int NDimension>
+RunLengthSegmentationFileWriter<NDimension>
+::RunLengthSegmentationFileWriter()
+{
+  this->SetNumberOfRequiredInputs( 1 );
+
+  this->m_Segmentation = SegmentationType::New();
+
+  this->m_IsoValue = this->m_Segmentation->GetIsoValue();
+  this->m_NarrowBandWidth = this->m_Segmentation->GetNarrowBandWidth();
+  this->m_UseNarrowBand = this->m_Segmentation->GetUseNarrowBand();
+}
+
+
+/**
+ * Destructor
+ */
+template <unsigned int NDimension>
+RunLengthSegmentationFileWriter<NDimension>
+::~RunLengthSegmentationFileWriter()
+{
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileWriter<NDimension>
+::SetInput( const InputImageType * image )
+{
+  this->SetNthInput( 0, const_cast< InputImageType * >( image ) );
+}
+
+
+template <unsigned int NDimension>
+const typename RunLengthSegmentationFileWriter<NDimension>::InputImageType *
+RunLengthSegmentationFileWriter<NDimension>
+::GetInput() const
+{
+  return static_cast< const InputImageType * >( this->ProcessObject::GetInput(0) );
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileWriter<NDimension>
+::Write()
+{
+  InputImageType * input = const_cast< InputImageType * >( this->GetInput() );
+
+  if( !input )
+    {
+    itkExceptionMacro("Missing input image");
+    }
+
+  if( this->m_FileName.empty() )
+    {
+    itkExceptionMacro("Missing output file name");
+    }
+
+  this->InvokeEvent( StartEvent() );
+
+  input->UpdateOutputInformation();
+  input->SetRequestedRegionToLargestPossibleRegion();
+  input->Update();
+
+  this->GenerateData();
+
+  this->InvokeEvent( EndEvent() );
+
+  if( input->ShouldIReleaseData() )
+    {
+    input->ReleaseData();
+    }
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileWriter<NDimension>
+::GenerateData()
+{
+  this->m_Segmentation->SetIsoValue( this->m_IsoValue );
+  this->m_Segmentation->SetNarrowBandWidth( this->m_NarrowBandWidth );
+  this->m_Segmentation->SetUseNarrowBand( this->m_UseNarrowBand );
+  this->m_Segmentation->EncodeImage( this->GetInput() );
+
+  WriteSegmentation( this->m_Segmentation, this->m_FileName );
+}
+
+
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileWriter<NDimension>
+::WriteSegmentation( const SegmentationType * segmentation, const std::string & fileName )
+{
+  std::ofstream os( fileName.c_str(), std::ios::out | std::ios::binary );
+
+  if( !os )
+    {
+    ExceptionObject excp( __FILE__, __LINE__ );
+    excp.SetDescription( "Could not open " + fileName + " for writing" );
+    throw excp;
+    }
+
+  typedef typename SegmentationType::RunType  RunType;
+
+  const typename SegmentationType::RegionType & region = segmentation->GetRegion();
+  const typename SegmentationType::DirectionType & direction = segmentation->GetDirection();
+
+  os << GetFileSignature() << "\n";
+  os << "Dimension " << NDimension << "\n";
+
+  os << "Index";
+  for( unsigned int i = 0; i < NDimension; i++ )
+    {
+    os << " " << region.GetIndex()[i];
+    }
+  os << "\nSize";
+  for( unsigned int i = 0; i < NDimension; i++ )
+    {
+    os << " " << region.GetSize()[i];
+    }
+
+  os << std::setprecision( 17 );
+
+  os << "\nSpacing";
+  for( unsigned int i = 0; i < NDimension; i++ )
+    {
+    os << " " << segmentation->GetSpacing()[i];
+    }
+  os << "\nOrigin";
+  for( unsigned int i = 0; i < NDimension; i++ )
+    {
+    os << " " << segmentation->GetOrigin()[i];
+    }
+  os << "\nDirection";
+  for( unsigned int i = 0; i < NDimension; i++ )
+    {
+    for( unsigned int j = 0; j < NDimension; j++ )
+      {
+      os << " " << direction[i][j];
+      }
+    }
+
+  os << std::setprecision( 9 );
+
+  os << "\nIsoValue " << segmentation->GetIsoValue();
+  os << "\nNarrowBandWidth " << segmentation->GetNarrowBandWidth();
+  os << "\nUseNarrowBand " << segmentation->GetUseNarrowBand();
+  os << "\nLowValue " << segmentation->GetLowValue();
+  os << "\nHighValue " << segmentation->GetHighValue();
+  os << "\nNumberOfRuns " << segmentation->GetRuns().size();
+  os << "\nNumberOfBandValues " << segmentation->GetBandValues().size();
+  os << "\nElementData LittleEndian\n";
+
+  if( !segmentation->GetRuns().empty() )
+    {
+    ByteSwapper< RunType >::SwapWriteRangeFromSystemToLittleEndian(
+      const_cast< RunType * >( &segmentation->GetRuns()[0] ),
+      static_cast< int >( segmentation->GetRuns().size() ), &os );
+    }
+
+  if( !segmentation->GetBandValues().empty() )
+    {
+    ByteSwapper< PixelType >::SwapWriteRangeFromSystemToLittleEndian(
+      const_cast< PixelType * >( &segmentation->GetBandValues()[0] ),
+      static_cast< int >( segmentation->GetBandValues().size() ), &os );
+    }
+
+  os.close();
+
+  if( os.fail() )
+    {
+    ExceptionObject excp( __FILE__, __LINE__ );
+    excp.SetDescription( "Could not write " + fileName );
+    throw excp;
+    }
+}
+
+
+/**
+ * PrintSelf
+ */
+template <unsigned int NDimension>
+void
+RunLengthSegmentationFileWriter<NDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "File name: " << this->m_FileName << std::endl;
+  os << indent << "Iso value: " << this->m_IsoValue << std::endl;
+  os << indent << "Narrow band width: " << this->m_NarrowBandWidth << std::endl;
+  os << indent << "Use narrow band: " << this->m_UseNarrowBand << std::endl;
+}
+
+} // end namespace itk
+
+#endif
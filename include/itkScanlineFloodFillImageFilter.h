@@ -0,0 +1,223 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkScanlineFloodFillImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkScanlineFloodFillImageFilter_h
+#define __itkScanlineFloodFillImageFilter_h
+
+#include "itkImage.h"
+#include "itkImageToImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ScanlineFloodFillImageFilter
+ *
+ * \brief Multithreaded flood fill of the pixels connected to a set of seeds
+ * within an intensity interval.
+ *
+ * Produces the same output as ConnectedThresholdImageFilter, with face
+ * connectivity, or, when UseConfidenceThresholds is on, as
+ * ConfidenceConnectedImageFilter. Pixels of the region are set to the
+ * ReplaceValue and all the others to zero.
+ *
+ * The fill proceeds by spans: a seed is extended into the longest run of
+ * accepted pixels along the first dimension, and the lines next to the run
+ * are scanned for new seeds. The image is split along its last dimension in
+ * one slab per thread, and every thread fills its own slab. Seeds that fall
+ * in a neighbor slab are exchanged between rounds, until no slab has seeds
+ * left.
+ *
+ * In the confidence mode the mean and variance of the region are kept as
+ * running sums over the filled pixels. When the interval of an iteration
+ * contains the interval of the previous one, the region can only grow, and
+ * the fill restarts from the rejected pixels on the border of the region
+ * instead of from the seeds. The pixels already in the region are neither
+ * visited again nor summed again.
+ *
+ * \ingroup RegionGrowingSegmentation
+ * \ingroup ITKLesionSizingToolkit
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT ScanlineFloodFillImageFilter :
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ScanlineFloodFillImageFilter                       Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >    Superclass;
+  typedef SmartPointer<Self>                                 Pointer;
+  typedef SmartPointer<const Self>                           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ScanlineFloodFillImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TInputImage                                   InputImageType;
+  typedef typename InputImageType::PixelType            InputImagePixelType;
+  typedef TOutputImage                                  OutputImageType;
+  typedef typename OutputImageType::PixelType           OutputImagePixelType;
+
+  typedef typename InputImageType::IndexType            IndexType;
+  typedef typename InputImageType::RegionType           RegionType;
+  typedef typename InputImageType::OffsetValueType      OffsetValueType;
+
+  typedef std::vector< IndexType >                      SeedListType;
+
+  /** Seeds of the region. Seeds outside of the image are ignored. */
+  void AddSeed( const IndexType & seed );
+  void ClearSeeds();
+  const SeedListType & GetSeeds() const
+    { return this->m_Seeds; }
+
+  /** Interval of intensities, bounds included, used when
+   * UseConfidenceThresholds is off. */
+  itkSetMacro( Lower, double );
+  itkGetConstMacro( Lower, double );
+  itkSetMacro( Upper, double );
+  itkGetConstMacro( Upper, double );
+
+  /** Value of the pixels of the region. */
+  itkSetMacro( ReplaceValue, OutputImagePixelType );
+  itkGetConstMacro( ReplaceValue, OutputImagePixelType );
+
+  /** Compute the interval as the mean plus or minus Multiplier standard
+   * deviations, first over the neighborhoods of the seeds and then over the
+   * region, for NumberOfIterations iterations. */
+  itkSetMacro( UseConfidenceThresholds, bool );
+  itkGetConstMacro( UseConfidenceThresholds, bool );
+  itkBooleanMacro( UseConfidenceThresholds );
+
+  itkSetMacro( Multiplier, double );
+  itkGetConstMacro( Multiplier, double );
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+  itkSetMacro( InitialNeighborhoodRadius, unsigned int );
+  itkGetConstMacro( InitialNeighborhoodRadius, unsigned int );
+
+  /** Statistics from which the last interval was computed, in the
+   * confidence mode. */
+  itkGetConstMacro( Mean, double );
+  itkGetConstMacro( Variance, double );
+
+  /** Number of pixels in the region after the last update. */
+  itkGetConstMacro( NumberOfPixelsInRegion, SizeValueType );
+
+  /** Number of rounds of seed exchanges between the slabs during the last
+   * update. */
+  itkGetConstMacro( NumberOfRounds, SizeValueType );
+
+protected:
+  ScanlineFloodFillImageFilter();
+  ~ScanlineFloodFillImageFilter() {}
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The whole input is needed and the whole output is produced. */
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion( DataObject * output );
+
+  void GenerateData();
+
+private:
+  ScanlineFloodFillImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  typedef std::vector< OffsetValueType >    OffsetListType;
+
+  /** Part of the image filled by one thread, between two planes of the last
+   * dimension. */
+  struct SlabType
+    {
+    OffsetValueType    Begin;
+    OffsetValueType    End;
+    OffsetListType     Seeds;
+    OffsetListType     Stack;
+    OffsetListType     SeedsToPrevious;
+    OffsetListType     SeedsToNext;
+    OffsetListType     Border;
+    double             Sum;
+    double             SumOfSquares;
+    SizeValueType      NumberOfPixels;
+    };
+
+  /** Split the image in slabs and clear the region. */
+  void InitializeSlabs();
+
+  /** Clear the region and its statistics, keeping the slabs. */
+  void ResetRegion();
+
+  /** Hand the seeds to the slabs that contain them. */
+  void DistributeSeeds( const OffsetListType & seeds );
+
+  /** Fill the slabs from their seeds, exchanging seeds until none is
+   * left. */
+  void FillSlabs();
+
+  /** Fill one slab from its seeds. */
+  void FillSlab( SlabType & slab );
+
+  static ITK_THREAD_RETURN_TYPE FillSlabsThreaderCallback( void * arg );
+
+  /** Mean of the means and of the variances of the neighborhoods of the
+   * seeds, as ConfidenceConnectedImageFilter. */
+  void ComputeInitialStatistics();
+
+  /** Interval from the current mean and variance. */
+  void ComputeConfidenceInterval( double & lower, double & upper ) const;
+
+  bool IsAccepted( OffsetValueType offset ) const
+    {
+    const double value = static_cast< double >( this->m_InputBuffer[offset] );
+    return this->m_CurrentLower <= value && value <= this->m_CurrentUpper;
+    }
+
+  SeedListType                 m_Seeds;
+  double                       m_Lower;
+  double                       m_Upper;
+  OutputImagePixelType         m_ReplaceValue;
+  bool                         m_UseConfidenceThresholds;
+  double                       m_Multiplier;
+  unsigned int                 m_NumberOfIterations;
+  unsigned int                 m_InitialNeighborhoodRadius;
+  double                       m_Mean;
+  double                       m_Variance;
+  SizeValueType                m_NumberOfPixelsInRegion;
+  SizeValueType                m_NumberOfRounds;
+
+  /** State of the fill in progress. */
+  const InputImagePixelType *  m_InputBuffer;
+  RegionType                   m_BufferRegion;
+  OffsetValueType              m_Stride[ImageDimension];
+  std::vector< unsigned char > m_InRegion;
+  std::vector< SlabType >      m_Slabs;
+  OffsetListType               m_SeedOffsets;
+  double                       m_CurrentLower;
+  double                       m_CurrentUpper;
+  bool                         m_RecordBorder;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkScanlineFloodFillImageFilter.hxx"
+#endif
+
+#endif
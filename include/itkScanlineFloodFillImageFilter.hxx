@@ -0,0 +1,687 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkScanlineFloodFillImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkScanlineFloodFillImageFilter_hxx
+#define __itkScanlineFloodFillImageFilter_hxx
+
+#include "itkScanlineFloodFillImageFilter.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage, class TOutputImage>
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::ScanlineFloodFillImageFilter()
+{
+  this->m_Lower = NumericTraits< InputImagePixelType >::NonpositiveMin();
+  this->m_Upper = NumericTraits< InputImagePixelType >::max();
+  this->m_ReplaceValue = NumericTraits< OutputImagePixelType >::One;
+  this->m_UseConfidenceThresholds = false;
+  this->m_Multiplier = 2.5;
+  this->m_NumberOfIterations = 4;
+  this->m_InitialNeighborhoodRadius = 1;
+  this->m_Mean = 0.0;
+  this->m_Variance = 0.0;
+  this->m_NumberOfPixelsInRegion = 0;
+  this->m_NumberOfRounds = 0;
+
+  this->m_InputBuffer = NULL;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    this->m_Stride[d] = 0;
+    }
+  this->m_CurrentLower = this->m_Lower;
+  this->m_CurrentUpper = this->m_Upper;
+  this->m_RecordBorder = false;
+}
+
+
+/**
+ * PrintSelf
+ */
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Number of seeds: " << this->m_Seeds.size() << std::endl;
+  os << indent << "Lower: " << this->m_Lower << std::endl;
+  os << indent << "Upper: " << this->m_Upper << std::endl;
+  os << indent << "Replace value: "
+     << static_cast< typename NumericTraits< OutputImagePixelType >::PrintType >( this->m_ReplaceValue )
+     << std::endl;
+  os << indent << "Use confidence thresholds: " << this->m_UseConfidenceThresholds << std::endl;
+  os << indent << "Multiplier: " << this->m_Multiplier << std::endl;
+  os << indent << "Number of iterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "Initial neighborhood radius: " << this->m_InitialNeighborhoodRadius << std::endl;
+  os << indent << "Mean: " << this->m_Mean << std::endl;
+  os << indent << "Variance: " << this->m_Variance << std::endl;
+  os << indent << "Number of pixels in region: " << this->m_NumberOfPixelsInRegion << std::endl;
+  os << indent << "Number of rounds: " << this->m_NumberOfRounds << std::endl;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::AddSeed( const IndexType & seed )
+{
+  this->m_Seeds.push_back( seed );
+  this->Modified();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::ClearSeeds()
+{
+  if( !this->m_Seeds.empty() )
+    {
+    this->m_Seeds.clear();
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * inputImage = const_cast< InputImageType * >( this->GetInput() );
+
+  if( inputImage )
+    {
+    inputImage->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+/**
+ * Splits the last dimension in one slab per thread. A one dimensional image
+ * is a single line, and is filled by a single slab.
+ */
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::InitializeSlabs()
+{
+  const InputImageType * inputImage = this->GetInput();
+
+  this->m_InputBuffer = inputImage->GetBufferPointer();
+  this->m_BufferRegion = inputImage->GetBufferedRegion();
+
+  const typename RegionType::SizeType & size = this->m_BufferRegion.GetSize();
+
+  this->m_Stride[0] = 1;
+  for( unsigned int d = 1; d < ImageDimension; d++ )
+    {
+    this->m_Stride[d] = this->m_Stride[d-1] * size[d-1];
+    }
+
+  this->m_InRegion.assign( this->m_BufferRegion.GetNumberOfPixels(), 0 );
+
+  const unsigned int slabDimension = ImageDimension - 1;
+  const OffsetValueType extent = size[slabDimension];
+
+  OffsetValueType numberOfSlabs = 1;
+  if( ImageDimension > 1 && this->GetNumberOfThreads() > 1 )
+    {
+    numberOfSlabs = vnl_math_min( static_cast< OffsetValueType >( this->GetNumberOfThreads() ), extent );
+    }
+
+  this->m_Slabs.resize( numberOfSlabs );
+
+  for( OffsetValueType i = 0; i < numberOfSlabs; i++ )
+    {
+    this->m_Slabs[i].Begin = ( ImageDimension > 1 ) ? extent * i / numberOfSlabs : 0;
+    this->m_Slabs[i].End = ( ImageDimension > 1 ) ? extent * ( i + 1 ) / numberOfSlabs : 1;
+    }
+
+  this->ResetRegion();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::ResetRegion()
+{
+  std::fill( this->m_InRegion.begin(), this->m_InRegion.end(), 0 );
+
+  for( unsigned int i = 0; i < this->m_Slabs.size(); i++ )
+    {
+    SlabType & slab = this->m_Slabs[i];
+    slab.Seeds.clear();
+    slab.Stack.clear();
+    slab.SeedsToPrevious.clear();
+    slab.SeedsToNext.clear();
+    slab.Border.clear();
+    slab.Sum = 0.0;
+    slab.SumOfSquares = 0.0;
+    slab.NumberOfPixels = 0;
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::DistributeSeeds( const OffsetListType & seeds )
+{
+  const unsigned int slabDimension = ImageDimension - 1;
+
+  for( typename OffsetListType::const_iterator itr = seeds.begin(); itr != seeds.end(); ++itr )
+    {
+    const OffsetValueType coordinate =
+      ( ImageDimension > 1 ) ? *itr / this->m_Stride[slabDimension] : 0;
+
+    unsigned int s = 0;
+    while( coordinate >= this->m_Slabs[s].End )
+      {
+      ++s;
+      }
+
+    this->m_Slabs[s].Seeds.push_back( *itr );
+    }
+}
+
+
+/**
+ * Rounds of parallel fills of the slabs. After each round the seeds that
+ * each slab found in its neighbors are handed to them.
+ */
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::FillSlabs()
+{
+  const unsigned int numberOfSlabs = this->m_Slabs.size();
+
+  while( true )
+    {
+    bool hasSeeds = false;
+    for( unsigned int i = 0; i < numberOfSlabs; i++ )
+      {
+      if( !this->m_Slabs[i].Seeds.empty() )
+        {
+        hasSeeds = true;
+        break;
+        }
+      }
+
+    if( !hasSeeds )
+      {
+      break;
+      }
+
+    if( numberOfSlabs == 1 )
+      {
+      this->FillSlab( this->m_Slabs[0] );
+      }
+    else
+      {
+      this->GetMultiThreader()->SetNumberOfThreads( numberOfSlabs );
+      this->GetMultiThreader()->SetSingleMethod( this->FillSlabsThreaderCallback, this );
+      this->GetMultiThreader()->SingleMethodExecute();
+      }
+
+    ++this->m_NumberOfRounds;
+
+    for( unsigned int i = 0; i < numberOfSlabs; i++ )
+      {
+      SlabType & slab = this->m_Slabs[i];
+      if( i > 0 )
+        {
+        OffsetListType & seeds = this->m_Slabs[i-1].Seeds;
+        seeds.insert( seeds.end(), slab.SeedsToPrevious.begin(), slab.SeedsToPrevious.end() );
+        }
+      if( i + 1 < numberOfSlabs )
+        {
+        OffsetListType & seeds = this->m_Slabs[i+1].Seeds;
+        seeds.insert( seeds.end(), slab.SeedsToNext.begin(), slab.SeedsToNext.end() );
+        }
+      slab.SeedsToPrevious.clear();
+      slab.SeedsToNext.clear();
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::FillSlabsThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+
+  Self * filter = static_cast< Self * >( info->UserData );
+
+  // The threader may run fewer threads than there are slabs.
+  for( unsigned int i = info->ThreadID; i < filter->m_Slabs.size(); i += info->NumberOfThreads )
+    {
+    filter->FillSlab( filter->m_Slabs[i] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/**
+ * Fills the spans of a slab. Only the thread of the slab writes the region
+ * flags of its pixels. The lines of the neighbor slabs are only tested
+ * against the interval, and the first pixel of each run of accepted pixels
+ * is sent to them as a seed.
+ */
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::FillSlab( SlabType & slab )
+{
+  const typename RegionType::SizeType & size = this->m_BufferRegion.GetSize();
+  const OffsetValueType lineLength = size[0];
+  const unsigned int slabDimension = ImageDimension - 1;
+
+  OffsetListType & stack = slab.Stack;
+  stack.swap( slab.Seeds );
+  slab.Seeds.clear();
+
+  while( !stack.empty() )
+    {
+    const OffsetValueType seed = stack.back();
+    stack.pop_back();
+
+    if( this->m_InRegion[seed] )
+      {
+      continue;
+      }
+
+    if( !this->IsAccepted( seed ) )
+      {
+      if( this->m_RecordBorder )
+        {
+        slab.Border.push_back( seed );
+        }
+      continue;
+      }
+
+    // Longest run of accepted pixels through the seed.
+    const OffsetValueType lineBegin = seed - seed % lineLength;
+    const OffsetValueType lineEnd = lineBegin + lineLength;
+
+    OffsetValueType first = seed;
+    while( first > lineBegin && !this->m_InRegion[first-1] && this->IsAccepted( first - 1 ) )
+      {
+      --first;
+      }
+
+    OffsetValueType last = seed;
+    while( last + 1 < lineEnd && !this->m_InRegion[last+1] && this->IsAccepted( last + 1 ) )
+      {
+      ++last;
+      }
+
+    if( this->m_RecordBorder )
+      {
+      if( first > lineBegin && !this->m_InRegion[first-1] )
+        {
+        slab.Border.push_back( first - 1 );
+        }
+      if( last + 1 < lineEnd && !this->m_InRegion[last+1] )
+        {
+        slab.Border.push_back( last + 1 );
+        }
+      }
+
+    for( OffsetValueType offset = first; offset <= last; ++offset )
+      {
+      this->m_InRegion[offset] = 1;
+      const double value = static_cast< double >( this->m_InputBuffer[offset] );
+      slab.Sum += value;
+      slab.SumOfSquares += value * value;
+      }
+    slab.NumberOfPixels += last - first + 1;
+
+    // Seeds in the lines next to the run.
+    for( unsigned int d = 1; d < ImageDimension; d++ )
+      {
+      const OffsetValueType coordinate = ( lineBegin / this->m_Stride[d] ) % size[d];
+
+      for( int side = -1; side <= 1; side += 2 )
+        {
+        const OffsetValueType neighborCoordinate = coordinate + side;
+
+        if( neighborCoordinate < 0 || neighborCoordinate >= static_cast< OffsetValueType >( size[d] ) )
+          {
+          continue;
+          }
+
+        OffsetListType * seeds = &stack;
+        bool isLocal = true;
+
+        if( d == slabDimension )
+          {
+          if( neighborCoordinate < slab.Begin )
+            {
+            seeds = &slab.SeedsToPrevious;
+            isLocal = false;
+            }
+          else if( neighborCoordinate >= slab.End )
+            {
+            seeds = &slab.SeedsToNext;
+            isLocal = false;
+            }
+          }
+
+        const OffsetValueType shift = side * this->m_Stride[d];
+
+        bool inRun = false;
+
+        for( OffsetValueType offset = first + shift; offset <= last + shift; ++offset )
+          {
+          if( isLocal && this->m_InRegion[offset] )
+            {
+            inRun = false;
+            }
+          else if( this->IsAccepted( offset ) )
+            {
+            if( !inRun )
+              {
+              seeds->push_back( offset );
+              inRun = true;
+              }
+            }
+          else
+            {
+            inRun = false;
+            if( this->m_RecordBorder )
+              {
+              slab.Border.push_back( offset );
+              }
+            }
+          }
+        }
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::ComputeInitialStatistics()
+{
+  const InputImageType * inputImage = this->GetInput();
+
+  this->m_Mean = 0.0;
+  this->m_Variance = 0.0;
+
+  if( this->m_Seeds.empty() )
+    {
+    return;
+    }
+
+  if( this->m_InitialNeighborhoodRadius > 0 )
+    {
+    typedef ConstNeighborhoodIterator< InputImageType >  NeighborhoodIteratorType;
+
+    typename NeighborhoodIteratorType::RadiusType radius;
+    radius.Fill( this->m_InitialNeighborhoodRadius );
+
+    NeighborhoodIteratorType nit( radius, inputImage, this->m_BufferRegion );
+
+    unsigned int numberOfSeeds = 0;
+
+    for( typename SeedListType::const_iterator itr = this->m_Seeds.begin();
+         itr != this->m_Seeds.end(); ++itr )
+      {
+      if( !this->m_BufferRegion.IsInside( *itr ) )
+        {
+        continue;
+        }
+
+      nit.SetLocation( *itr );
+
+      double sum = 0.0;
+      double sumOfSquares = 0.0;
+      const unsigned int numberOfPixels = nit.Size();
+
+      for( unsigned int i = 0; i < numberOfPixels; i++ )
+        {
+        const double value = static_cast< double >( nit.GetPixel( i ) );
+        sum += value;
+        sumOfSquares += value * value;
+        }
+
+      this->m_Mean += sum / numberOfPixels;
+      this->m_Variance += ( sumOfSquares - ( sum * sum / numberOfPixels ) ) / ( numberOfPixels - 1.0 );
+      ++numberOfSeeds;
+      }
+
+    if( numberOfSeeds > 0 )
+      {
+      this->m_Mean /= numberOfSeeds;
+      this->m_Variance /= numberOfSeeds;
+      }
+    }
+  else
+    {
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    const unsigned int numberOfSeeds = this->m_SeedOffsets.size();
+
+    for( unsigned int i = 0; i < numberOfSeeds; i++ )
+      {
+      const double value = static_cast< double >( this->m_InputBuffer[ this->m_SeedOffsets[i] ] );
+      sum += value;
+      sumOfSquares += value * value;
+      }
+
+    if( numberOfSeeds > 0 )
+      {
+      this->m_Mean = sum / numberOfSeeds;
+      }
+    if( numberOfSeeds > 1 )
+      {
+      this->m_Variance = ( sumOfSquares - ( sum * sum / numberOfSeeds ) ) / ( numberOfSeeds - 1.0 );
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::ComputeConfidenceInterval( double & lower, double & upper ) const
+{
+  const double deviation = ( this->m_Variance > 0.0 ) ? vcl_sqrt( this->m_Variance ) : 0.0;
+
+  lower = vnl_math_max( this->m_Mean - this->m_Multiplier * deviation,
+    static_cast< double >( NumericTraits< InputImagePixelType >::NonpositiveMin() ) );
+  upper = vnl_math_min( this->m_Mean + this->m_Multiplier * deviation,
+    static_cast< double >( NumericTraits< InputImagePixelType >::max() ) );
+
+  // The interval always contains the seeds, otherwise the region would be
+  // empty.
+  for( typename OffsetListType::const_iterator itr = this->m_SeedOffsets.begin();
+       itr != this->m_SeedOffsets.end(); ++itr )
+    {
+    const double value = static_cast< double >( this->m_InputBuffer[*itr] );
+    lower = vnl_math_min( lower, value );
+    upper = vnl_math_max( upper, value );
+    }
+}
+
+
+/**
+ * Generate Data
+ */
+template <class TInputImage, class TOutputImage>
+void
+ScanlineFloodFillImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  this->InitializeSlabs();
+
+  this->m_SeedOffsets.clear();
+  for( typename SeedListType::const_iterator itr = this->m_Seeds.begin();
+       itr != this->m_Seeds.end(); ++itr )
+    {
+    if( this->m_BufferRegion.IsInside( *itr ) )
+      {
+      OffsetValueType offset = 0;
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        offset += ( (*itr)[d] - this->m_BufferRegion.GetIndex()[d] ) * this->m_Stride[d];
+        }
+      this->m_SeedOffsets.push_back( offset );
+      }
+    }
+
+  this->m_NumberOfRounds = 0;
+
+  const unsigned int numberOfIterations =
+    this->m_UseConfidenceThresholds ? this->m_NumberOfIterations : 0;
+
+  if( this->m_UseConfidenceThresholds )
+    {
+    this->ComputeInitialStatistics();
+    this->ComputeConfidenceInterval( this->m_CurrentLower, this->m_CurrentUpper );
+    }
+  else
+    {
+    this->m_CurrentLower = this->m_Lower;
+    this->m_CurrentUpper = this->m_Upper;
+    }
+
+  this->m_RecordBorder = ( numberOfIterations > 0 );
+
+  this->DistributeSeeds( this->m_SeedOffsets );
+  this->FillSlabs();
+
+  this->UpdateProgress( 1.0 / ( numberOfIterations + 1.0 ) );
+
+  for( unsigned int iteration = 0; iteration < numberOfIterations; iteration++ )
+    {
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    SizeValueType numberOfPixels = 0;
+
+    for( unsigned int i = 0; i < this->m_Slabs.size(); i++ )
+      {
+      sum += this->m_Slabs[i].Sum;
+      sumOfSquares += this->m_Slabs[i].SumOfSquares;
+      numberOfPixels += this->m_Slabs[i].NumberOfPixels;
+      }
+
+    if( numberOfPixels < 2 )
+      {
+      break;
+      }
+
+    this->m_Mean = sum / numberOfPixels;
+    this->m_Variance = ( sumOfSquares - ( sum * sum / numberOfPixels ) ) / ( numberOfPixels - 1.0 );
+
+    double lower;
+    double upper;
+    this->ComputeConfidenceInterval( lower, upper );
+
+    // The same interval would fill the same region.
+    if( lower == this->m_CurrentLower && upper == this->m_CurrentUpper )
+      {
+      break;
+      }
+
+    const bool regionGrows = ( lower <= this->m_CurrentLower && upper >= this->m_CurrentUpper );
+
+    this->m_CurrentLower = lower;
+    this->m_CurrentUpper = upper;
+    this->m_RecordBorder = ( iteration + 1 < numberOfIterations );
+
+    if( regionGrows )
+      {
+      // Every pixel next to the region was rejected by the previous
+      // interval, and recorded on the border.
+      for( unsigned int i = 0; i < this->m_Slabs.size(); i++ )
+        {
+        OffsetListType border;
+        border.swap( this->m_Slabs[i].Border );
+        this->DistributeSeeds( border );
+        }
+      }
+    else
+      {
+      this->ResetRegion();
+      this->DistributeSeeds( this->m_SeedOffsets );
+      }
+
+    this->FillSlabs();
+
+    this->UpdateProgress( ( iteration + 2.0 ) / ( numberOfIterations + 1.0 ) );
+    }
+
+  this->m_NumberOfPixelsInRegion = 0;
+  for( unsigned int i = 0; i < this->m_Slabs.size(); i++ )
+    {
+    this->m_NumberOfPixelsInRegion += this->m_Slabs[i].NumberOfPixels;
+    }
+
+  OutputImageType * outputImage = this->GetOutput();
+
+  typedef ImageRegionIterator< OutputImageType > OutputIteratorType;
+  OutputIteratorType oit( outputImage, this->m_BufferRegion );
+
+  const OutputImagePixelType outsideValue = NumericTraits< OutputImagePixelType >::Zero;
+
+  OffsetValueType offset = 0;
+  for( oit.GoToBegin(); !oit.IsAtEnd(); ++oit, ++offset )
+    {
+    oit.Set( this->m_InRegion[offset] ? this->m_ReplaceValue : outsideValue );
+    }
+
+  // Release the working buffers.
+  std::vector< unsigned char >().swap( this->m_InRegion );
+  std::vector< SlabType >().swap( this->m_Slabs );
+  this->m_InputBuffer = NULL;
+}
+
+} // end namespace itk
+
+#endif
@@ -80,16 +80,14 @@ ShapeDetectionLevelSetSegmentationModule<NDimension>
   filter->SetCurvatureScaling( this->GetCurvatureScaling() );
   filter->SetAdvectionScaling( 0.0 );
   filter->UseImageSpacingOn();
+  filter->SetAutoGenerateSpeedAdvection(
+    !this->SetCachedFeatureImages( filter->GetSegmentationFunction() ) );
 
-  std::cout << "Propagation Scaling = " << this->GetPropagationScaling() << std::endl;
-  std::cout << "Curvature Scaling = " << this->GetCurvatureScaling() << std::endl;
+  this->MonitorLevelSetFilter( filter );
 
   filter->Update();
 
-  std::cout << "Max. no. iterations: " << filter->GetNumberOfIterations() << std::endl;
-  std::cout << "Max. RMS error: " << filter->GetMaximumRMSError() << std::endl;
-  std::cout << "No. elpased iterations: " << filter->GetElapsedIterations() << std::endl;
-  std::cout << "RMS change: " << filter->GetRMSChange() << std::endl;
+  this->RecordLevelSetFilterResults( filter );
 
   this->PackOutputImageInOutputSpatialObject( filter->GetOutput() );
 }
@@ -19,6 +19,9 @@
 
 #include "itkSegmentationModule.h"
 #include "itkImageSpatialObject.h"
+#include "itkFiniteDifferenceImageFilter.h"
+#include "itkSegmentationLevelSetFunction.h"
+#include "itkLevelSetFeatureCache.h"
 
 namespace itk
 {
@@ -102,7 +105,54 @@ public:
   itkSetMacro( InvertOutputIntensities, bool );
   itkGetMacro( InvertOutputIntensities, bool );
   itkBooleanMacro( InvertOutputIntensities );
-  
+
+  /** Relative change of the segmented volume under which the level set
+   * propagation will stop. The volume is the number of pixels inside the
+   * zero set, measured every VolumeConvergenceInterval iterations. A value
+   * of zero, the default, disables this criterion. */
+  itkSetMacro( VolumeConvergenceTolerance, double );
+  itkGetMacro( VolumeConvergenceTolerance, double );
+
+  /** Number of iterations between two measures of the segmented volume.
+   * Defaults to 10. */
+  itkSetMacro( VolumeConvergenceInterval, unsigned int );
+  itkGetMacro( VolumeConvergenceInterval, unsigned int );
+
+  /** Cache of the speed and advection images computed from the feature
+   * image. Every module creates its own, so that an update with the same
+   * feature image reuses the images of the previous update. Modules
+   * consuming the same feature image may share a cache. Without a cache,
+   * the level set filters compute the images on every update. */
+  typedef LevelSetFeatureCache< NDimension >            FeatureCacheType;
+  itkSetObjectMacro( FeatureCache, FeatureCacheType );
+  itkGetObjectMacro( FeatureCache, FeatureCacheType );
+
+  /** Criterion that terminated the last level set propagation. */
+  typedef enum
+    {
+    NotStopped,
+    MaximumNumberOfIterationsReached,
+    MaximumRMSErrorReached,
+    VolumeConverged
+    } StoppingReasonType;
+
+  /** Number of iterations, RMS change and stopping criterion of the last
+   * level set propagation. */
+  itkGetConstMacro( ElapsedIterations, unsigned int );
+  itkGetConstMacro( RMSChange, double );
+  itkGetConstMacro( StoppingReason, StoppingReasonType );
+
+  /** Human readable version of the stopping reason. */
+  const char * GetStoppingReasonAsString() const;
+
+  /** Number of passes over the output pixels made by the last update to
+   * find the range of the intensities, and to write rescaled or inverted
+   * intensities. Composite modules include the passes of the modules they
+   * run. A module producing its output already in the final convention
+   * makes a single rescaling pass and no scan. */
+  itkGetConstMacro( NumberOfIntensityScans, unsigned int );
+  itkGetConstMacro( NumberOfIntensityRescalings, unsigned int );
+
 protected:
   SinglePhaseLevelSetSegmentationModule();
   virtual ~SinglePhaseLevelSetSegmentationModule();
@@ -115,12 +165,64 @@ protected:
   /** Set the output image as cargo of the output SpatialObject. */
   void PackOutputImageInOutputSpatialObject( OutputImageType * outputImage );
 
+  /** Set as cargo of the output SpatialObject an image with the geometry of
+   * the feature image, holding the values of the region image over its
+   * buffered region and the background value elsewhere. Only the region is
+   * visited when inverting the intensities. */
+  void PackOutputRegionInOutputSpatialObject( const OutputImageType * regionImage,
+                                              OutputPixelType backgroundValue );
+
+  /** Same as above, with the range of the intensities of the whole output,
+   * background included, already known. The region image is not scanned. */
+  void PackOutputRegionInOutputSpatialObject( const OutputImageType * regionImage,
+                                              OutputPixelType backgroundValue,
+                                              double minimum, double maximum );
+
+  /** Reset the pass counts before the outputs are generated. */
+  void PrepareOutputs();
+
+  /** Record a scan of the output intensities, or a pass writing rescaled
+   * intensities. */
+  void CountIntensityScan() { ++this->m_NumberOfIntensityScans; }
+  void CountIntensityRescaling() { ++this->m_NumberOfIntensityRescalings; }
+
+  /** Reset the pass counts, or add those of a module run internally. */
+  void ResetIntensityPassCounts();
+  void AddIntensityPassCounts( const Self * module );
+
   /** Extract the input image from the input spatial object. */
   const InputImageType * GetInternalInputImage() const;
 
   /** Extract the input feature image from the input feature spatial object. */
   const FeatureImageType * GetInternalFeatureImage() const;
 
+  /** Type of the level set filters run by the subclasses. */
+  typedef FiniteDifferenceImageFilter< InputImageType, OutputImageType >  LevelSetFilterType;
+
+  /** Observe the iterations of the level set filter in order to apply the
+   * volume convergence criterion. Must be called before updating the
+   * filter. */
+  void MonitorLevelSetFilter( LevelSetFilterType * filter );
+
+  /** Record the number of iterations, RMS change and stopping reason of the
+   * level set filter once it has been updated. */
+  void RecordLevelSetFilterResults( LevelSetFilterType * filter );
+
+  /** Copy the results of a level set module run internally. */
+  void CopyLevelSetResults( const Self * module );
+
+  /** Function of the level set filters run by the subclasses. */
+  typedef SegmentationLevelSetFunction< OutputImageType, FeatureImageType > SegmentationFunctionType;
+
+  /** Hand the speed image, and the advection image when the function has
+   * an advection term, from the feature cache to the function of a level
+   * set filter. Returns false when the filter must compute them itself. */
+  bool SetCachedFeatureImages( SegmentationFunctionType * function );
+
+  /** Image where the filter evolves the level set. By default, the output of
+   * the filter. */
+  virtual const OutputImageType * GetEvolvingLevelSet( LevelSetFilterType * filter ) const;
+
 private:
   SinglePhaseLevelSetSegmentationModule(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
@@ -134,8 +236,27 @@ private:
 
   bool          m_InvertOutputIntensities;
 
+  double        m_VolumeConvergenceTolerance;
+  unsigned int  m_VolumeConvergenceInterval;
+
+  unsigned int        m_ElapsedIterations;
+  double              m_RMSChange;
+  StoppingReasonType  m_StoppingReason;
+
+  unsigned int  m_NumberOfIntensityScans;
+  unsigned int  m_NumberOfIntensityRescalings;
+
+  /** Called at every iteration of the monitored level set filter. */
+  void CheckVolumeConvergence( Object * caller, const EventObject & event );
+
+  LevelSetFilterType *  m_MonitoredFilter;
+  SizeValueType         m_PreviousVolume;
+  bool                  m_PreviousVolumeIsValid;
+
   typedef typename InputImageType::ConstPointer  ImageConstPointer;
   mutable ImageConstPointer m_ZeroSetInputImage;
+
+  typename FeatureCacheType::Pointer  m_FeatureCache;
 };
 
 } // end namespace itk
@@ -20,6 +20,11 @@
 #include "itkSinglePhaseLevelSetSegmentationModule.h"
 #include "itkLandmarkSpatialObject.h"
 #include "itkIntensityWindowingImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkCommand.h"
+#include "vnl/vnl_math.h"
 
 namespace itk
 {
@@ -46,6 +51,22 @@ SinglePhaseLevelSetSegmentationModule<NDimension>
   this->m_PropagationScaling = 100.0;
   this->m_ZeroSetInputImage = NULL;
   this->m_InvertOutputIntensities = true;
+
+  this->m_VolumeConvergenceTolerance = 0.0;
+  this->m_VolumeConvergenceInterval = 10;
+
+  this->m_ElapsedIterations = 0;
+  this->m_RMSChange = 0.0;
+  this->m_StoppingReason = NotStopped;
+
+  this->m_NumberOfIntensityScans = 0;
+  this->m_NumberOfIntensityRescalings = 0;
+
+  this->m_MonitoredFilter = NULL;
+  this->m_PreviousVolume = 0;
+  this->m_PreviousVolumeIsValid = false;
+
+  this->m_FeatureCache = FeatureCacheType::New();
 }
 
 
@@ -73,6 +94,245 @@ SinglePhaseLevelSetSegmentationModule<NDimension>
   os << indent << "AdvectionScaling = " << this->m_AdvectionScaling << std::endl;
   os << indent << "MaximumRMSError = " << this->m_MaximumRMSError << std::endl;
   os << indent << "MaximumNumberOfIterations = " << this->m_MaximumNumberOfIterations << std::endl;
+  os << indent << "VolumeConvergenceTolerance = " << this->m_VolumeConvergenceTolerance << std::endl;
+  os << indent << "VolumeConvergenceInterval = " << this->m_VolumeConvergenceInterval << std::endl;
+  os << indent << "ElapsedIterations = " << this->m_ElapsedIterations << std::endl;
+  os << indent << "RMSChange = " << this->m_RMSChange << std::endl;
+  os << indent << "StoppingReason = " << this->GetStoppingReasonAsString() << std::endl;
+  os << indent << "FeatureCache = " << this->m_FeatureCache.GetPointer() << std::endl;
+  os << indent << "NumberOfIntensityScans = " << this->m_NumberOfIntensityScans << std::endl;
+  os << indent << "NumberOfIntensityRescalings = " << this->m_NumberOfIntensityRescalings << std::endl;
+}
+
+
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::PrepareOutputs()
+{
+  Superclass::PrepareOutputs();
+  this->ResetIntensityPassCounts();
+}
+
+
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::ResetIntensityPassCounts()
+{
+  this->m_NumberOfIntensityScans = 0;
+  this->m_NumberOfIntensityRescalings = 0;
+}
+
+
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::AddIntensityPassCounts( const Self * module )
+{
+  this->m_NumberOfIntensityScans += module->m_NumberOfIntensityScans;
+  this->m_NumberOfIntensityRescalings += module->m_NumberOfIntensityRescalings;
+}
+
+
+template <unsigned int NDimension>
+const char *
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::GetStoppingReasonAsString() const
+{
+  switch( this->m_StoppingReason )
+    {
+    case MaximumNumberOfIterationsReached:
+      return "Maximum number of iterations";
+    case MaximumRMSErrorReached:
+      return "Maximum RMS error";
+    case VolumeConverged:
+      return "Volume convergence";
+    default:
+      return "Not stopped";
+    }
+}
+
+
+/**
+ * Resets the results of the previous run and adds an observer of the
+ * iterations when the volume criterion is enabled.
+ */
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::MonitorLevelSetFilter( LevelSetFilterType * filter )
+{
+  this->m_ElapsedIterations = 0;
+  this->m_RMSChange = 0.0;
+  this->m_StoppingReason = NotStopped;
+
+  this->m_MonitoredFilter = filter;
+  this->m_PreviousVolume = 0;
+  this->m_PreviousVolumeIsValid = false;
+
+  if( this->m_VolumeConvergenceTolerance > 0.0 && this->m_VolumeConvergenceInterval > 0 )
+    {
+    typedef MemberCommand< Self > CommandType;
+    typename CommandType::Pointer command = CommandType::New();
+    command->SetCallbackFunction( this, &Self::CheckVolumeConvergence );
+    filter->AddObserver( IterationEvent(), command );
+    }
+}
+
+
+/**
+ * Counts the pixels inside the zero set every VolumeConvergenceInterval
+ * iterations, and stops the filter when the count changed by less than
+ * VolumeConvergenceTolerance since the previous measure.
+ */
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::CheckVolumeConvergence( Object *, const EventObject & )
+{
+  LevelSetFilterType * filter = this->m_MonitoredFilter;
+
+  const unsigned int elapsedIterations = filter->GetElapsedIterations();
+
+  if( elapsedIterations == 0 ||
+      elapsedIterations % this->m_VolumeConvergenceInterval != 0 )
+    {
+    return;
+    }
+
+  const OutputImageType * levelSet = this->GetEvolvingLevelSet( filter );
+
+  if( !levelSet )
+    {
+    return;
+    }
+
+  SizeValueType volume = 0;
+
+  typedef ImageRegionConstIterator< OutputImageType > IteratorType;
+  IteratorType itr( levelSet, levelSet->GetBufferedRegion() );
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    if( itr.Get() < NumericTraits< OutputPixelType >::Zero )
+      {
+      ++volume;
+      }
+    }
+
+  if( this->m_PreviousVolumeIsValid )
+    {
+    const double previous = ( this->m_PreviousVolume > 0 ) ?
+      static_cast< double >( this->m_PreviousVolume ) : 1.0;
+
+    const double change = vnl_math_abs(
+      static_cast< double >( volume ) - static_cast< double >( this->m_PreviousVolume ) );
+
+    itkDebugMacro("Iteration " << elapsedIterations << " volume " << volume
+                  << " relative change " << change / previous );
+
+    if( change / previous < this->m_VolumeConvergenceTolerance )
+      {
+      this->m_StoppingReason = VolumeConverged;
+      filter->SetNumberOfIterations( elapsedIterations );
+      }
+    }
+
+  this->m_PreviousVolume = volume;
+  this->m_PreviousVolumeIsValid = true;
+}
+
+
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::RecordLevelSetFilterResults( LevelSetFilterType * filter )
+{
+  this->m_ElapsedIterations = filter->GetElapsedIterations();
+  this->m_RMSChange = filter->GetRMSChange();
+
+  if( this->m_StoppingReason != VolumeConverged )
+    {
+    if( this->m_ElapsedIterations >= this->m_MaximumNumberOfIterations )
+      {
+      this->m_StoppingReason = MaximumNumberOfIterationsReached;
+      }
+    else
+      {
+      this->m_StoppingReason = MaximumRMSErrorReached;
+      }
+    }
+
+  this->m_MonitoredFilter = NULL;
+
+  itkDebugMacro("Max. no. iterations: " << this->m_MaximumNumberOfIterations
+                << " Max. RMS error: " << this->m_MaximumRMSError
+                << " No. elapsed iterations: " << this->m_ElapsedIterations
+                << " RMS change: " << this->m_RMSChange
+                << " Stopped by: " << this->GetStoppingReasonAsString() );
+}
+
+
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::CopyLevelSetResults( const Self * module )
+{
+  this->m_ElapsedIterations = module->m_ElapsedIterations;
+  this->m_RMSChange = module->m_RMSChange;
+  this->m_StoppingReason = module->m_StoppingReason;
+}
+
+
+/**
+ * The advection image is only set when the function has an advection term,
+ * as in SegmentationLevelSetImageFilter, and is computed with the derivative
+ * sigma of the geodesic active contour function. The filters do not agree
+ * on the speed image of a function without propagation term, which is left
+ * to them.
+ */
+template <unsigned int NDimension>
+bool
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::SetCachedFeatureImages( SegmentationFunctionType * function )
+{
+  if( this->m_FeatureCache.IsNull() )
+    {
+    return false;
+    }
+
+  typedef typename FeatureCacheType::FunctionType  GeodesicActiveContourFunctionType;
+
+  GeodesicActiveContourFunctionType * geodesicFunction =
+    dynamic_cast< GeodesicActiveContourFunctionType * >( function );
+
+  if( function->GetPropagationWeight() == 0.0 ||
+      ( function->GetAdvectionWeight() != 0.0 && !geodesicFunction ) )
+    {
+    return false;
+    }
+
+  const FeatureImageType * featureImage = this->GetInternalFeatureImage();
+
+  function->SetSpeedImage( this->m_FeatureCache->GetSpeedImage( featureImage ) );
+
+  if( function->GetAdvectionWeight() != 0.0 )
+    {
+    function->SetAdvectionImage( this->m_FeatureCache->GetAdvectionImage(
+      featureImage, geodesicFunction->GetDerivativeSigma() ) );
+    }
+
+  return true;
+}
+
+
+template <unsigned int NDimension>
+const typename SinglePhaseLevelSetSegmentationModule<NDimension>::OutputImageType *
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::GetEvolvingLevelSet( LevelSetFilterType * filter ) const
+{
+  return filter->GetOutput();
 }
 
 
@@ -138,6 +398,7 @@ SinglePhaseLevelSetSegmentationModule<NDimension>
     typename CalculatorType::Pointer calculator = CalculatorType::New();
     calculator->SetImage( outputImage );
     calculator->Compute();
+    this->CountIntensityScan();
     typedef IntensityWindowingImageFilter< OutputImageType, OutputImageType > RescaleFilterType;
     typename RescaleFilterType::Pointer rescaler = RescaleFilterType::New();
     rescaler->SetInput( outputImage );
@@ -147,6 +408,7 @@ SinglePhaseLevelSetSegmentationModule<NDimension>
     rescaler->SetOutputMaximum( -4.0 ); // make sure that we invert and not just rescale.
     rescaler->InPlaceOn();
     rescaler->Update();
+    this->CountIntensityRescaling();
     outputImage = rescaler->GetOutput();
     }
 
@@ -159,6 +421,111 @@ SinglePhaseLevelSetSegmentationModule<NDimension>
 }
 
 
+/**
+ * When the intensities are inverted, the window is computed from the region
+ * image and the background value only, which gives the same result as
+ * inverting the whole image.
+ */
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::PackOutputRegionInOutputSpatialObject( const OutputImageType * regionImage,
+                                         OutputPixelType backgroundValue )
+{
+  double minimum = backgroundValue;
+  double maximum = backgroundValue;
+
+  if( this->m_InvertOutputIntensities )
+    {
+    const FeatureImageType * featureImage = this->GetInternalFeatureImage();
+
+    typename OutputImageType::RegionType region = regionImage->GetBufferedRegion();
+    region.Crop( featureImage->GetLargestPossibleRegion() );
+
+    typedef MinimumMaximumImageCalculator< OutputImageType > CalculatorType;
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage( regionImage );
+    calculator->SetRegion( region );
+    calculator->Compute();
+    this->CountIntensityScan();
+
+    minimum = calculator->GetMinimum();
+    maximum = calculator->GetMaximum();
+
+    // The background only takes part in the window if some pixel is
+    // outside of the region.
+    if( region != featureImage->GetLargestPossibleRegion() )
+      {
+      minimum = vnl_math_min( minimum, static_cast< double >( backgroundValue ) );
+      maximum = vnl_math_max( maximum, static_cast< double >( backgroundValue ) );
+      }
+    }
+
+  this->PackOutputRegionInOutputSpatialObject( regionImage, backgroundValue, minimum, maximum );
+}
+
+
+/**
+ * Allocates the output on the grid of the feature image, fills it with the
+ * background value and copies the region image in it. When the intensities
+ * are inverted, they are mapped from [minimum:maximum] to [4:-4] while
+ * being copied.
+ */
+template <unsigned int NDimension>
+void
+SinglePhaseLevelSetSegmentationModule<NDimension>
+::PackOutputRegionInOutputSpatialObject( const OutputImageType * regionImage,
+                                         OutputPixelType backgroundValue,
+                                         double minimum, double maximum )
+{
+  const FeatureImageType * featureImage = this->GetInternalFeatureImage();
+
+  typename OutputImageType::Pointer outputImage = OutputImageType::New();
+  outputImage->CopyInformation( featureImage );
+  outputImage->SetRegions( featureImage->GetLargestPossibleRegion() );
+  outputImage->Allocate();
+
+  typename OutputImageType::RegionType region = regionImage->GetBufferedRegion();
+  region.Crop( outputImage->GetLargestPossibleRegion() );
+
+  typedef ImageRegionConstIterator< OutputImageType > ConstIteratorType;
+  typedef ImageRegionIterator< OutputImageType >      IteratorType;
+
+  ConstIteratorType itr( regionImage, region );
+  IteratorType otr( outputImage, region );
+
+  if( this->m_InvertOutputIntensities )
+    {
+    // Same mapping of [minimum:maximum] to [4:-4] as in
+    // PackOutputImageInOutputSpatialObject().
+    const double scale = ( maximum > minimum ) ? -8.0 / ( maximum - minimum ) : 0.0;
+
+    outputImage->FillBuffer( static_cast< OutputPixelType >(
+      4.0 + ( backgroundValue - minimum ) * scale ) );
+
+    for( itr.GoToBegin(), otr.GoToBegin(); !itr.IsAtEnd(); ++itr, ++otr )
+      {
+      otr.Set( static_cast< OutputPixelType >( 4.0 + ( itr.Get() - minimum ) * scale ) );
+      }
+    this->CountIntensityRescaling();
+    }
+  else
+    {
+    outputImage->FillBuffer( backgroundValue );
+
+    for( itr.GoToBegin(), otr.GoToBegin(); !itr.IsAtEnd(); ++itr, ++otr )
+      {
+      otr.Set( itr.Get() );
+      }
+    }
+
+  OutputSpatialObjectType * outputObject =
+    dynamic_cast< OutputSpatialObjectType * >(this->ProcessObject::GetOutput(0));
+
+  outputObject->SetImage( outputImage );
+}
+
+
 /**
  * Generate Data
  */
@@ -20,19 +20,18 @@
 #include "itkVesselEnhancingDiffusion3DImageFilter.h"
 
 #include "itkCastImageFilter.h"
-#include "itkConstShapedNeighborhoodIterator.h"
 #include "itkHessianRecursiveGaussianImageFilter.h"
-#include "itkImageRegionConstIterator.h"
-#include "itkImageRegionIterator.h"
 #include "itkMinimumMaximumImageFilter.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkNumericTraits.h"
-#include "itkZeroFluxNeumannBoundaryCondition.h"
+#include "itkRegionOfInterestImageFilter.h"
 
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_matrix.h>
 #include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <vcl_cmath.h>
 
+#include<algorithm>
 #include<iostream>
 
 namespace itk
@@ -48,7 +47,12 @@ VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
     m_Epsilon(0.0),
     m_Omega(0.0),
     m_Sensitivity(0.0),
-    m_DarkObjectLightBackground(false)
+    m_DarkObjectLightBackground(false),
+    m_UseAdditiveOperatorSplitting(false),
+    m_RecalculationTolerance(0.0),
+    m_RecalculationBlockSize(16),
+    m_NumberOfRecalculatedBlocks(0),
+    m_NumberOfIncrementalBlocks(0)
 {
   this->SetNumberOfRequiredInputs(1);
 }
@@ -72,11 +76,17 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
   os << indent << "Omega                   : " << m_Omega << std::endl;
   os << indent << "Sensitivity             : " << m_Sensitivity << std::endl;
  os << indent << "DarkObjectLightBackground  : " << m_DarkObjectLightBackground << std::endl;
+  os << indent << "UseAdditiveOperatorSplitting : " << m_UseAdditiveOperatorSplitting << std::endl;
+  os << indent << "RecalculationTolerance  : " << m_RecalculationTolerance << std::endl;
+  os << indent << "RecalculationBlockSize  : " << m_RecalculationBlockSize << std::endl;
+  os << indent << "NumberOfRecalculatedBlocks : " << m_NumberOfRecalculatedBlocks << std::endl;
+  os << indent << "NumberOfIncrementalBlocks  : " << m_NumberOfIncrementalBlocks << std::endl;
 }
 // singleiter
 template <class PixelType, unsigned int NDimension>
 void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
-::VED3DSingleIteration(typename PrecisionImageType::Pointer ci)
+::VED3DSingleIteration(typename PrecisionImageType::Pointer & ci,
+                       typename PrecisionImageType::Pointer & d)
 {
   bool rec(false);
   if (    (m_CurrentIteration == 1) ||
@@ -90,8 +100,30 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
       std::cout << "v ";
       std::cout.flush();
       }
-    MaxVesselResponse (ci);
-    DiffusionTensor ();
+    if ( m_RecalculationTolerance > NumericTraits<Precision>::Zero &&
+         m_CurrentIteration > 1 && m_LastRecalculatedImage )
+      {
+      IncrementalMaxVesselResponse (ci);
+      }
+    else
+      {
+      MaxVesselResponse (ci);
+      DiffusionTensor ();
+
+      if ( m_RecalculationTolerance > NumericTraits<Precision>::Zero )
+        {
+        // remember the image the tensor was calculated from
+        m_LastRecalculatedImage = PrecisionImageType::New();
+        m_LastRecalculatedImage->SetOrigin(ci->GetOrigin());
+        m_LastRecalculatedImage->SetSpacing(ci->GetSpacing());
+        m_LastRecalculatedImage->SetDirection(ci->GetDirection());
+        m_LastRecalculatedImage->SetRegions(ci->GetLargestPossibleRegion());
+        m_LastRecalculatedImage->Allocate();
+        std::copy(ci->GetBufferPointer(),
+          ci->GetBufferPointer() + ci->GetBufferedRegion().GetNumberOfPixels(),
+          m_LastRecalculatedImage->GetBufferPointer());
+        }
+      }
     }
   if (m_Verbose)
     {
@@ -102,315 +134,425 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
       }
     }
 
-
   // calculate d = nonlineardiffusion(ci)
-  // using 3x3x3 stencil, afterwards copy
-  // result from d back to ci
-  typename PrecisionImageType::Pointer d = PrecisionImageType::New();
-  d->SetOrigin(ci->GetOrigin());
-  d->SetSpacing(ci->GetSpacing());
-  d->SetDirection(ci->GetDirection());
-  d->SetRegions(ci->GetLargestPossibleRegion());
-  d->Allocate();
-  d->FillBuffer(NumericTraits<Precision>::Zero);
+  // using 3x3x3 stencil, every pixel of d is
+  // written, afterwards swap the buffers
+  VEDThreadStruct str;
+  str.Filter = this;
+  str.Image = ci;
+  str.Update = d;
+
+  if (!m_UseAdditiveOperatorSplitting)
+    {
+    this->ExecuteThreaded(this->VED3DSingleIterationThreaderCallback, &str);
+    }
+  else
+    {
+    // explicit mixed terms into the right hand side, then
+    // d = 1/3 sum_l (I - 3 tau A_l)^-1 rhs
+    str.Update = m_RightHandSide;
+    this->ExecuteThreaded(this->VED3DSingleIterationThreaderCallback, &str);
+
+    str.Image = m_RightHandSide;
+    str.Update = d;
+    for (unsigned int axis=0; axis<3; ++axis)
+      {
+      str.Axis = axis;
+      this->ExecuteThreaded(this->AdditiveOperatorSplittingAxisThreaderCallback, &str);
+      }
+    }
+
+  typename PrecisionImageType::Pointer tmp = ci;
+  ci = d;
+  d = tmp;
+}
+
+// stencil
+template <class PixelType, unsigned int NDimension>
+inline typename VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>::Precision
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::DiffusionStencil(const Precision * ci, const OffsetValueType c,
+                   const OffsetValueType * n, const Precision * r) const
+{
+  // neighbours n: xp xm yp ym zp zm,
+  // xpyp xmym xpym xmyp, xpzp xmzm xpzm xmzp, ypzp ymzm ypzm ymzp
+  // tensor components: xx xy xz yy yz zz
+  const Precision * t  = &(m_Tensor[0]);
+  const Precision * tc = t + 6 * c;
+
+  // weights
+  const Precision xp = t[6 * n[0]    ] + tc[0];
+  const Precision xm = t[6 * n[1]    ] + tc[0];
+  const Precision yp = t[6 * n[2] + 3] + tc[3];
+  const Precision ym = t[6 * n[3] + 3] + tc[3];
+  const Precision zp = t[6 * n[4] + 5] + tc[5];
+  const Precision zm = t[6 * n[5] + 5] + tc[5];
+
+  const Precision xpyp =   t[6 * n[6] + 1] + tc[1];
+  const Precision xmym =   t[6 * n[7] + 1] + tc[1];
+  const Precision xpym = - t[6 * n[8] + 1] - tc[1];
+  const Precision xmyp = - t[6 * n[9] + 1] - tc[1];
+
+  const Precision xpzp =   t[6 * n[10] + 2] + tc[2];
+  const Precision xmzm =   t[6 * n[11] + 2] + tc[2];
+  const Precision xpzm = - t[6 * n[12] + 2] - tc[2];
+  const Precision xmzp = - t[6 * n[13] + 2] - tc[2];
+
+  const Precision ypzp =   t[6 * n[14] + 4] + tc[4];
+  const Precision ymzm =   t[6 * n[15] + 4] + tc[4];
+  const Precision ypzm = - t[6 * n[16] + 4] - tc[4];
+  const Precision ymzp = - t[6 * n[17] + 4] - tc[4];
+
+  // evolution
+  const Precision cv = ci[c];
+  return cv
+    + r[0] * ( xp * (ci[n[0]] - cv)
+             + xm * (ci[n[1]] - cv) )
+    + r[1] * ( yp * (ci[n[2]] - cv)
+             + ym * (ci[n[3]] - cv) )
+    + r[2] * ( zp * (ci[n[4]] - cv)
+             + zm * (ci[n[5]] - cv) )
+    + r[3] * ( xpyp * (ci[n[6]] - cv)
+             + xmym * (ci[n[7]] - cv)
+             + xpym * (ci[n[8]] - cv)
+             + xmyp * (ci[n[9]] - cv) )
+    + r[4] * ( xpzp * (ci[n[10]] - cv)
+             + xmzm * (ci[n[11]] - cv)
+             + xpzm * (ci[n[12]] - cv)
+             + xmzp * (ci[n[13]] - cv) )
+    + r[5] * ( ypzp * (ci[n[14]] - cv)
+             + ymzm * (ci[n[15]] - cv)
+             + ypzm * (ci[n[16]] - cv)
+             + ymzp * (ci[n[17]] - cv) );
+}
 
-  // shapedneighborhood iter, zeroflux boundary condition
-  // division into faces and inner region
-  typedef ZeroFluxNeumannBoundaryCondition<PrecisionImageType>    BT;
-  typedef ConstShapedNeighborhoodIterator<PrecisionImageType,BT>  NT;
+// threaded singleiter
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::ThreadedVED3DSingleIteration(const OutputImageRegionType & region,
+  ThreadIdType itkNotUsed(threadId),
+  const PrecisionImageType * ci, PrecisionImageType * d)
+{
   typedef typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<PrecisionImageType>
                                                                   FT;
-  BT                      b;
-  typename NT::RadiusType r;
+  typename FT::RadiusType r;
   r.Fill(1);
 
+  // fixed weights (timers): xx yy zz xy xz yz
+  const typename PrecisionImageType::SpacingType ispacing = ci->GetSpacing();
+  Precision w[6];
+  w[0] = m_TimeStep / (2.0 * ispacing[0] * ispacing[0]);
+  w[1] = m_TimeStep / (2.0 * ispacing[1] * ispacing[1]);
+  w[2] = m_TimeStep / (2.0 * ispacing[2] * ispacing[2]);
+  w[3] = m_TimeStep / (4.0 * ispacing[0] * ispacing[1]);
+  w[4] = m_TimeStep / (4.0 * ispacing[0] * ispacing[2]);
+  w[5] = m_TimeStep / (4.0 * ispacing[1] * ispacing[2]);
+
+  // with aos the axial terms are solved implicitly
+  if (m_UseAdditiveOperatorSplitting)
+    {
+    w[0] = w[1] = w[2] = NumericTraits<Precision>::Zero;
+    }
+
+  const Precision * cbuf = ci->GetBufferPointer();
+  Precision       * dbuf = d->GetBufferPointer();
+
+  // strides and extent of the buffer
+  const typename PrecisionImageType::RegionType buffer = ci->GetBufferedRegion();
+  const OffsetValueType sy = ci->GetOffsetTable()[1];
+  const OffsetValueType sz = ci->GetOffsetTable()[2];
+  const IndexValueType  nx = static_cast<IndexValueType>(buffer.GetSize()[0]);
+  const IndexValueType  ny = static_cast<IndexValueType>(buffer.GetSize()[1]);
+  const IndexValueType  nz = static_cast<IndexValueType>(buffer.GetSize()[2]);
+
+  // linear offsets of the neighbours used by the stencil
+  const OffsetValueType delta[18] = {
+     1,       -1,       sy,      -sy,      sz,      -sz,
+     1 + sy,  -1 - sy,   1 - sy, -1 + sy,
+     1 + sz,  -1 - sz,   1 - sz, -1 + sz,
+     sy + sz, -sy - sz,  sy - sz, -sy + sz };
+
+  // faces, the interior region where the whole stencil lies
+  // inside the buffer runs directly on the buffers
+  typename PrecisionImageType::RegionType inner = buffer;
+  typename PrecisionImageType::IndexType  innerIndex = buffer.GetIndex();
+  typename PrecisionImageType::SizeType   innerSize  = buffer.GetSize();
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    innerIndex[i] += 1;
+    innerSize[i] = ( innerSize[i] > 2 ) ? innerSize[i] - 2 : 0;
+    }
+  inner.SetIndex(innerIndex);
+  inner.SetSize(innerSize);
+
+  FT                            fc;
+  typename FT::FaceListType     faces = fc(ci,region,r);
 
-  // offsets
-  const typename NT::OffsetType oxp = {{1,0,0}};
-  const typename NT::OffsetType oxm = {{-1,0,0}};
-  const typename NT::OffsetType oyp = {{0,1,0}};
-  const typename NT::OffsetType oym = {{0,-1,0}};
-  const typename NT::OffsetType ozp = {{0,0,1}};
-  const typename NT::OffsetType ozm = {{0,0,-1}};
+  OffsetValueType n[18];
 
-  const typename NT::OffsetType oxpyp = {{1,1,0}};
-  const typename NT::OffsetType oxmym = {{-1,-1,0}};
-  const typename NT::OffsetType oxpym = {{1,-1,0}};
-  const typename NT::OffsetType oxmyp = {{-1,1,0}};
+  for (typename FT::FaceListType::iterator fit = faces.begin(); fit != faces.end(); ++fit)
+    {
+    const typename PrecisionImageType::IndexType start = fit->GetIndex();
+    const typename PrecisionImageType::SizeType  size  = fit->GetSize();
 
-  const typename NT::OffsetType oxpzp = {{1,0,1}};
-  const typename NT::OffsetType oxmzm = {{-1,0,-1}};
-  const typename NT::OffsetType oxpzm = {{1,0,-1}};
-  const typename NT::OffsetType oxmzp = {{-1,0,1}};
+    if ( fit->GetNumberOfPixels() == 0 )
+      {
+      continue;
+      }
 
-  const typename NT::OffsetType oypzp = {{0,1,1}};
-  const typename NT::OffsetType oymzm = {{0,-1,-1}};
-  const typename NT::OffsetType oypzm = {{0,1,-1}};
-  const typename NT::OffsetType oymzp = {{0,-1,1}};
+    if ( inner.IsInside(*fit) )
+      {
+      typename PrecisionImageType::IndexType idx = start;
+      for (idx[2] = start[2]; idx[2] < start[2] + static_cast<IndexValueType>(size[2]); ++idx[2])
+        {
+        for (idx[1] = start[1]; idx[1] < start[1] + static_cast<IndexValueType>(size[1]); ++idx[1])
+          {
+          idx[0] = start[0];
+          OffsetValueType c = ci->ComputeOffset(idx);
+          for (SizeValueType x = 0; x < size[0]; ++x, ++c)
+            {
+            for (unsigned int k = 0; k < 18; ++k)
+              {
+              n[k] = c + delta[k];
+              }
+            dbuf[c] = DiffusionStencil(cbuf, c, n, w);
+            }
+          }
+        }
+      continue;
+      }
 
-  // fixed weights (timers)
-  const typename PrecisionImageType::SpacingType ispacing = ci->GetSpacing();
-  const Precision rxx = m_TimeStep / (2.0 * ispacing[0] * ispacing[0]);
-  const Precision ryy = m_TimeStep / (2.0 * ispacing[1] * ispacing[1]);
-  const Precision rzz = m_TimeStep / (2.0 * ispacing[2] * ispacing[2]);
-  const Precision rxy = m_TimeStep / (4.0 * ispacing[0] * ispacing[1]);
-  const Precision rxz = m_TimeStep / (4.0 * ispacing[0] * ispacing[2]);
-  const Precision ryz = m_TimeStep / (4.0 * ispacing[1] * ispacing[2]);
-
-  // faces
-  FT                            fc;
-  typename FT::FaceListType     fci = fc(ci,d->GetLargestPossibleRegion(),r);
-  typename FT::FaceListType     fxx = fc(m_Dxx,d->GetLargestPossibleRegion(),r);
-  typename FT::FaceListType     fxy = fc(m_Dxy,d->GetLargestPossibleRegion(),r);
-  typename FT::FaceListType     fxz = fc(m_Dxz,d->GetLargestPossibleRegion(),r);
-  typename FT::FaceListType     fyy = fc(m_Dyy,d->GetLargestPossibleRegion(),r);
-  typename FT::FaceListType     fyz = fc(m_Dyz,d->GetLargestPossibleRegion(),r);
-  typename FT::FaceListType     fzz = fc(m_Dzz,d->GetLargestPossibleRegion(),r);
-
-  typename FT::FaceListType::iterator fitci,fitxx,fitxy,fitxz,fityy,fityz,fitzz;
-
-  for ( fitci = fci.begin(),
-        fitxx = fxx.begin(), fitxy = fxy.begin(), fitxz = fxz.begin(),
-        fityy = fyy.begin(), fityz = fyz.begin(), fitzz = fzz.begin();
-        fitci != fci.end();
-        ++fitci, ++fitxx, ++fitxy, ++fitxz, ++fityy, ++fityz, ++fitzz)
-    {
-    // output iter
-    ImageRegionIterator<PrecisionImageType> dit(d,*fitci);
-
-    // input iters
-    NT itci (r,ci,*fitci);
-    NT itxx (r,m_Dxx,*fitxx);
-    NT itxy (r,m_Dxy,*fitxy);
-    NT itxz (r,m_Dxz,*fitxz);
-    NT ityy (r,m_Dyy,*fityy);
-    NT ityz (r,m_Dyz,*fityz);
-    NT itzz (r,m_Dzz,*fitzz);
-
-    itci.OverrideBoundaryCondition(&b);
-    itxx.OverrideBoundaryCondition(&b);
-    itxy.OverrideBoundaryCondition(&b);
-    itxz.OverrideBoundaryCondition(&b);
-    ityy.OverrideBoundaryCondition(&b);
-    ityz.OverrideBoundaryCondition(&b);
-    itzz.OverrideBoundaryCondition(&b);
-
-    // setting active offsets (yeah there must
-    // be some smarter way of doing this)
-    itci.ClearActiveList();
-    itxx.ClearActiveList();
-    itxy.ClearActiveList();
-    itxz.ClearActiveList();
-    ityy.ClearActiveList();
-    ityz.ClearActiveList();
-    itzz.ClearActiveList();
-
-    itci.ActivateOffset(oxp);
-    itxx.ActivateOffset(oxp);
-    itxy.ActivateOffset(oxp);
-    itxz.ActivateOffset(oxp);
-    ityy.ActivateOffset(oxp);
-    ityz.ActivateOffset(oxp);
-    itzz.ActivateOffset(oxp);
-
-    itci.ActivateOffset(oxm);
-    itxx.ActivateOffset(oxm);
-    itxy.ActivateOffset(oxm);
-    itxz.ActivateOffset(oxm);
-    ityy.ActivateOffset(oxm);
-    ityz.ActivateOffset(oxm);
-    itzz.ActivateOffset(oxm);
-
-    itci.ActivateOffset(oyp);
-    itxx.ActivateOffset(oyp);
-    itxy.ActivateOffset(oyp);
-    itxz.ActivateOffset(oyp);
-    ityy.ActivateOffset(oyp);
-    ityz.ActivateOffset(oyp);
-    itzz.ActivateOffset(oyp);
-
-    itci.ActivateOffset(oym);
-    itxx.ActivateOffset(oym);
-    itxy.ActivateOffset(oym);
-    itxz.ActivateOffset(oym);
-    ityy.ActivateOffset(oym);
-    ityz.ActivateOffset(oym);
-    itzz.ActivateOffset(oym);
-
-    itci.ActivateOffset(ozp);
-    itxx.ActivateOffset(ozp);
-    itxy.ActivateOffset(ozp);
-    itxz.ActivateOffset(ozp);
-    ityy.ActivateOffset(ozp);
-    ityz.ActivateOffset(ozp);
-    itzz.ActivateOffset(ozp);
-
-    itci.ActivateOffset(ozm);
-    itxx.ActivateOffset(ozm);
-    itxy.ActivateOffset(ozm);
-    itxz.ActivateOffset(ozm);
-    ityy.ActivateOffset(ozm);
-    ityz.ActivateOffset(ozm);
-    itzz.ActivateOffset(ozm);
-
-    itci.ActivateOffset(oxpyp);
-    itxx.ActivateOffset(oxpyp);
-    itxy.ActivateOffset(oxpyp);
-    itxz.ActivateOffset(oxpyp);
-    ityy.ActivateOffset(oxpyp);
-    ityz.ActivateOffset(oxpyp);
-    itzz.ActivateOffset(oxpyp);
-
-    itci.ActivateOffset(oxmym);
-    itxx.ActivateOffset(oxmym);
-    itxy.ActivateOffset(oxmym);
-    itxz.ActivateOffset(oxmym);
-    ityy.ActivateOffset(oxmym);
-    ityz.ActivateOffset(oxmym);
-    itzz.ActivateOffset(oxmym);
-
-    itci.ActivateOffset(oxpym);
-    itxx.ActivateOffset(oxpym);
-    itxy.ActivateOffset(oxpym);
-    itxz.ActivateOffset(oxpym);
-    ityy.ActivateOffset(oxpym);
-    ityz.ActivateOffset(oxpym);
-    itzz.ActivateOffset(oxpym);
-
-    itci.ActivateOffset(oxmyp);
-    itxx.ActivateOffset(oxmyp);
-    itxy.ActivateOffset(oxmyp);
-    itxz.ActivateOffset(oxmyp);
-    ityy.ActivateOffset(oxmyp);
-    ityz.ActivateOffset(oxmyp);
-    itzz.ActivateOffset(oxmyp);
-
-    itci.ActivateOffset(oxpzp);
-    itxx.ActivateOffset(oxpzp);
-    itxy.ActivateOffset(oxpzp);
-    itxz.ActivateOffset(oxpzp);
-    ityy.ActivateOffset(oxpzp);
-    ityz.ActivateOffset(oxpzp);
-    itzz.ActivateOffset(oxpzp);
-
-    itci.ActivateOffset(oxmzm);
-    itxx.ActivateOffset(oxmzm);
-    itxy.ActivateOffset(oxmzm);
-    itxz.ActivateOffset(oxmzm);
-    ityy.ActivateOffset(oxmzm);
-    ityz.ActivateOffset(oxmzm);
-    itzz.ActivateOffset(oxmzm);
-
-    itci.ActivateOffset(oxpzm);
-    itxx.ActivateOffset(oxpzm);
-    itxy.ActivateOffset(oxpzm);
-    itxz.ActivateOffset(oxpzm);
-    ityy.ActivateOffset(oxpzm);
-    ityz.ActivateOffset(oxpzm);
-    itzz.ActivateOffset(oxpzm);
-
-    itci.ActivateOffset(oxmzp);
-    itxx.ActivateOffset(oxmzp);
-    itxy.ActivateOffset(oxmzp);
-    itxz.ActivateOffset(oxmzp);
-    ityy.ActivateOffset(oxmzp);
-    ityz.ActivateOffset(oxmzp);
-    itzz.ActivateOffset(oxmzp);
-
-    itci.ActivateOffset(oypzp);
-    itxx.ActivateOffset(oypzp);
-    itxy.ActivateOffset(oypzp);
-    itxz.ActivateOffset(oypzp);
-    ityy.ActivateOffset(oypzp);
-    ityz.ActivateOffset(oypzp);
-    itzz.ActivateOffset(oypzp);
-
-    itci.ActivateOffset(oymzm);
-    itxx.ActivateOffset(oymzm);
-    itxy.ActivateOffset(oymzm);
-    itxz.ActivateOffset(oymzm);
-    ityy.ActivateOffset(oymzm);
-    ityz.ActivateOffset(oymzm);
-    itzz.ActivateOffset(oymzm);
-
-    itci.ActivateOffset(oypzm);
-    itxx.ActivateOffset(oypzm);
-    itxy.ActivateOffset(oypzm);
-    itxz.ActivateOffset(oypzm);
-    ityy.ActivateOffset(oypzm);
-    ityz.ActivateOffset(oypzm);
-    itzz.ActivateOffset(oypzm);
-
-    itci.ActivateOffset(oymzp);
-    itxx.ActivateOffset(oymzp);
-    itxy.ActivateOffset(oymzp);
-    itxz.ActivateOffset(oymzp);
-    ityy.ActivateOffset(oymzp);
-    ityz.ActivateOffset(oymzp);
-    itzz.ActivateOffset(oymzp);
-
-    // run for each face diffusion
-    for (itci.GoToBegin(), dit.GoToBegin(),
-            itxx.GoToBegin(),itxy.GoToBegin(), itxz.GoToBegin(),
-            ityy.GoToBegin(),ityz.GoToBegin(), itzz.GoToBegin();
-            !itci.IsAtEnd();
-            ++itci, ++dit, ++itxx, ++itxy, ++itxz, ++ityy, ++ityz, ++itzz)
+    // boundary faces, zero flux neumann boundary condition
+    // by clamping the neighbour coordinates to the buffer
+    for (IndexValueType k = 0; k < static_cast<IndexValueType>(size[2]); ++k)
       {
-      // weights
-      const Precision xp = itxx.GetPixel(oxp) + itxx.GetCenterPixel();
-      const Precision xm = itxx.GetPixel(oxm) + itxx.GetCenterPixel();
-      const Precision yp = ityy.GetPixel(oyp) + ityy.GetCenterPixel();
-      const Precision ym = ityy.GetPixel(oym) + ityy.GetCenterPixel();
-      const Precision zp = itzz.GetPixel(ozp) + itzz.GetCenterPixel();
-      const Precision zm = itzz.GetPixel(ozm) + itzz.GetCenterPixel();
-
-      const Precision xpyp = itxy.GetPixel(oxpyp) + itxy.GetCenterPixel();
-      const Precision xmym = itxy.GetPixel(oxmym) + itxy.GetCenterPixel();
-      const Precision xpym = - itxy.GetPixel(oxpym) - itxy.GetCenterPixel();
-      const Precision xmyp = - itxy.GetPixel(oxmyp) - itxy.GetCenterPixel();
-
-      const Precision xpzp =   itxz.GetPixel(oxpzp) + itxz.GetCenterPixel();
-      const Precision xmzm =   itxz.GetPixel(oxmzm) + itxz.GetCenterPixel();
-      const Precision xpzm = - itxz.GetPixel(oxpzm) - itxz.GetCenterPixel();
-      const Precision xmzp = - itxz.GetPixel(oxmzp) - itxz.GetCenterPixel();
-
-      const Precision ypzp =   ityz.GetPixel(oypzp) + ityz.GetCenterPixel();
-      const Precision ymzm =   ityz.GetPixel(oymzm) + ityz.GetCenterPixel();
-      const Precision ypzm = - ityz.GetPixel(oypzm) - ityz.GetCenterPixel();
-      const Precision ymzp = - ityz.GetPixel(oymzp) - ityz.GetCenterPixel();
-
-      // evolution
-      const Precision cv = itci.GetCenterPixel();
-      dit.Value() = cv +
-          + rxx * ( xp * (itci.GetPixel(oxp) - cv)
-                  + xm * (itci.GetPixel(oxm) - cv) )
-          + ryy * ( yp * (itci.GetPixel(oyp) - cv)
-                  + ym * (itci.GetPixel(oym) - cv) )
-          + rzz * ( zp * (itci.GetPixel(ozp) - cv)
-                  + zm * (itci.GetPixel(ozm) - cv) )
-          + rxy * ( xpyp * (itci.GetPixel(oxpyp) - cv)
-                  + xmym * (itci.GetPixel(oxmym) - cv)
-                  + xpym * (itci.GetPixel(oxpym) - cv)
-                  + xmyp * (itci.GetPixel(oxmyp) - cv) )
-          + rxz * ( xpzp * (itci.GetPixel(oxpzp) - cv)
-                  + xmzm * (itci.GetPixel(oxmzm) - cv)
-                  + xpzm * (itci.GetPixel(oxpzm) - cv)
-                  + xmzp * (itci.GetPixel(oxmzp) - cv) )
-          + ryz * ( ypzp * (itci.GetPixel(oypzp) - cv)
-                  + ymzm * (itci.GetPixel(oymzm) - cv)
-                  + ypzm * (itci.GetPixel(oypzm) - cv)
-                  + ymzp * (itci.GetPixel(oymzp) - cv) );
+      const IndexValueType z  = start[2] - buffer.GetIndex()[2] + k;
+      const OffsetValueType zc = z * sz;
+      const OffsetValueType zp = (z + 1 < nz ? z + 1 : nz - 1) * sz;
+      const OffsetValueType zm = (z > 0 ? z - 1 : 0) * sz;
+      for (IndexValueType j = 0; j < static_cast<IndexValueType>(size[1]); ++j)
+        {
+        const IndexValueType y  = start[1] - buffer.GetIndex()[1] + j;
+        const OffsetValueType yc = y * sy;
+        const OffsetValueType yp = (y + 1 < ny ? y + 1 : ny - 1) * sy;
+        const OffsetValueType ym = (y > 0 ? y - 1 : 0) * sy;
+        for (IndexValueType i = 0; i < static_cast<IndexValueType>(size[0]); ++i)
+          {
+          const OffsetValueType x  = start[0] - buffer.GetIndex()[0] + i;
+          const OffsetValueType xp = (x + 1 < nx ? x + 1 : nx - 1);
+          const OffsetValueType xm = (x > 0 ? x - 1 : 0);
+
+          const OffsetValueType c = x + yc + zc;
+          n[0]  = xp + yc + zc;
+          n[1]  = xm + yc + zc;
+          n[2]  = x  + yp + zc;
+          n[3]  = x  + ym + zc;
+          n[4]  = x  + yc + zp;
+          n[5]  = x  + yc + zm;
+          n[6]  = xp + yp + zc;
+          n[7]  = xm + ym + zc;
+          n[8]  = xp + ym + zc;
+          n[9]  = xm + yp + zc;
+          n[10] = xp + yc + zp;
+          n[11] = xm + yc + zm;
+          n[12] = xp + yc + zm;
+          n[13] = xm + yc + zp;
+          n[14] = x  + yp + zp;
+          n[15] = x  + ym + zm;
+          n[16] = x  + yp + zm;
+          n[17] = x  + ym + zp;
+
+          dbuf[c] = DiffusionStencil(cbuf, c, n, w);
+          }
+        }
+      }
+    }
+}
+
+template <class PixelType, unsigned int NDimension>
+ITK_THREAD_RETURN_TYPE
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::VED3DSingleIterationThreaderCallback( void * arg )
+{
+  const ThreadIdType threadId =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  const ThreadIdType threadCount =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+
+  VEDThreadStruct * str =
+    (VEDThreadStruct *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // Using the SplitRequestedRegion method from itk::ImageSource.
+  OutputImageRegionType splitRegion;
+  const ThreadIdType total =
+    str->Filter->SplitRequestedRegion(threadId, threadCount, splitRegion);
+
+  if (threadId < total)
+    {
+    str->Filter->ThreadedVED3DSingleIteration(splitRegion, threadId,
+                                              str->Image, str->Update);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// aos along one axis
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::ThreadedAdditiveOperatorSplittingAxis(const OutputImageRegionType & region,
+  ThreadIdType itkNotUsed(threadId), unsigned int axis,
+  const PrecisionImageType * rhs, PrecisionImageType * d)
+{
+  const Precision * rbuf = rhs->GetBufferPointer();
+  Precision       * dbuf = d->GetBufferPointer();
+  const Precision * t    = &(m_Tensor[0]);
+
+  // diagonal tensor component of the axis
+  const unsigned int component = ( axis == 0 ) ? 0 : ( ( axis == 1 ) ? 3 : 5 );
+
+  const typename PrecisionImageType::SpacingType ispacing = rhs->GetSpacing();
+  const Precision weight = 3.0 * m_TimeStep / (2.0 * ispacing[axis] * ispacing[axis]);
+  const Precision third  = 1.0 / 3.0;
+
+  const OffsetValueType stride = rhs->GetOffsetTable()[axis];
+  const SizeValueType   length = region.GetSize()[axis];
+
+  std::vector<Precision> sup(length);
+  std::vector<Precision> sol(length);
 
+  // visit the first voxel of every line of the region
+  OutputImageRegionType lines = region;
+  typename OutputImageRegionType::SizeType lineStarts = region.GetSize();
+  lineStarts[axis] = 1;
+  lines.SetSize(lineStarts);
+
+  const typename PrecisionImageType::IndexType start = lines.GetIndex();
+  typename PrecisionImageType::IndexType       idx   = start;
+
+  for (idx[2] = start[2]; idx[2] < start[2] + static_cast<IndexValueType>(lineStarts[2]); ++idx[2])
+    {
+    for (idx[1] = start[1]; idx[1] < start[1] + static_cast<IndexValueType>(lineStarts[1]); ++idx[1])
+      {
+      for (idx[0] = start[0]; idx[0] < start[0] + static_cast<IndexValueType>(lineStarts[0]); ++idx[0])
+        {
+        const OffsetValueType base = rhs->ComputeOffset(idx);
+
+        // thomas algorithm, forward sweep. The system is
+        // -a_{k-1/2} u_{k-1} + (1 + a_{k-1/2} + a_{k+1/2}) u_k - a_{k+1/2} u_{k+1} = rhs_k
+        // with a_{k+1/2} = 3 tau (D_k + D_{k+1}) / (2 h^2), zero outside the line
+        Precision left = NumericTraits<Precision>::Zero;
+        Precision previousSup = NumericTraits<Precision>::Zero;
+        Precision previousSol = NumericTraits<Precision>::Zero;
+        OffsetValueType c = base;
+        for (SizeValueType k = 0; k < length; ++k, c += stride)
+          {
+          const Precision right = ( k + 1 < length ) ?
+            weight * ( t[6 * c + component] + t[6 * (c + stride) + component] ) :
+            NumericTraits<Precision>::Zero;
+          const Precision diag = 1.0 + left + right - ( - left ) * previousSup;
+          sup[k] = - right / diag;
+          sol[k] = ( rbuf[c] + left * previousSol ) / diag;
+          previousSup = sup[k];
+          previousSol = sol[k];
+          left = right;
+          }
+
+        // back substitution, accumulating the average of the axes
+        Precision next = NumericTraits<Precision>::Zero;
+        c = base + static_cast<OffsetValueType>(length - 1) * stride;
+        for (SizeValueType k = length; k > 0; --k, c -= stride)
+          {
+          const Precision u = sol[k-1] - sup[k-1] * next;
+          next = u;
+          if (axis == 0)
+            {
+            dbuf[c] = third * u;
+            }
+          else
+            {
+            dbuf[c] += third * u;
+            }
+          }
+        }
       }
     }
+}
+
+template <class PixelType, unsigned int NDimension>
+ITK_THREAD_RETURN_TYPE
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::AdditiveOperatorSplittingAxisThreaderCallback( void * arg )
+{
+  const ThreadIdType threadId =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  const ThreadIdType threadCount =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+
+  VEDThreadStruct * str =
+    (VEDThreadStruct *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  OutputImageRegionType splitRegion;
+  const ThreadIdType total = str->Filter->SplitRequestedRegionAlongLines(
+    threadId, threadCount, str->Axis, splitRegion);
+
+  if (threadId < total)
+    {
+    str->Filter->ThreadedAdditiveOperatorSplittingAxis(splitRegion, threadId,
+      str->Axis, str->Image, str->Update);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 
-  // copying
-  ImageRegionConstIterator<PrecisionImageType> iti (d,d->GetLargestPossibleRegion());
-  ImageRegionIterator<PrecisionImageType>      ito (ci,ci->GetLargestPossibleRegion());
-  for (iti.GoToBegin(), ito.GoToBegin(); !iti.IsAtEnd(); ++iti,++ito)
+// split keeping whole lines along axis
+template <class PixelType, unsigned int NDimension>
+ThreadIdType
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::SplitRequestedRegionAlongLines(ThreadIdType i, ThreadIdType num,
+  unsigned int axis, OutputImageRegionType & splitRegion)
+{
+  const OutputImageRegionType & requestedRegion =
+    this->GetOutput()->GetRequestedRegion();
+
+  splitRegion = requestedRegion;
+
+  // split along the outermost axis that is not the line axis
+  const unsigned int splitAxis = ( axis == 2 ) ? 1 : 2;
+  const SizeValueType range = requestedRegion.GetSize()[splitAxis];
+
+  const SizeValueType valuesPerThread =
+    static_cast<SizeValueType>( vcl_ceil( range / static_cast<double>(num) ) );
+  const ThreadIdType maxThreadIdUsed =
+    static_cast<ThreadIdType>( vcl_ceil( range / static_cast<double>(valuesPerThread) ) ) - 1;
+
+  typename OutputImageRegionType::IndexType splitIndex = splitRegion.GetIndex();
+  typename OutputImageRegionType::SizeType  splitSize  = splitRegion.GetSize();
+
+  if (i < maxThreadIdUsed)
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+    }
+  if (i == maxThreadIdUsed)
     {
-    ito.Value() = iti.Value();
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
     }
+
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  return maxThreadIdUsed + 1;
+}
+
+// run a threaded pass
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::ExecuteThreaded(ThreadFunctionType callback, VEDThreadStruct * str)
+{
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(callback, str);
+  this->GetMultiThreader()->SingleMethodExecute();
 }
 
 // maxvesselresponse
@@ -419,55 +561,21 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
 ::MaxVesselResponse(const typename PrecisionImageType::Pointer im)
 {
 
-  // alloc memory for hessian/tensor
-  m_Dxx = PrecisionImageType::New();
-  m_Dxx->SetOrigin(im->GetOrigin());
-  m_Dxx->SetSpacing(im->GetSpacing());
-  m_Dxx->SetDirection(im->GetDirection());
-  m_Dxx->SetRegions(im->GetLargestPossibleRegion());
-  m_Dxx->Allocate();
-  m_Dxx->FillBuffer(NumericTraits<Precision>::One);
-
-  m_Dxy = PrecisionImageType::New();
-  m_Dxy->SetOrigin(im->GetOrigin());
-  m_Dxy->SetSpacing(im->GetSpacing());
-  m_Dxy->SetDirection(im->GetDirection());
-  m_Dxy->SetRegions(im->GetLargestPossibleRegion());
-  m_Dxy->Allocate();
-  m_Dxy->FillBuffer(NumericTraits<Precision>::Zero);
-
-  m_Dxz = PrecisionImageType::New();
-  m_Dxz->SetOrigin(im->GetOrigin());
-  m_Dxz->SetSpacing(im->GetSpacing());
-  m_Dxz->SetDirection(im->GetDirection());
-  m_Dxz->SetRegions(im->GetLargestPossibleRegion());
-  m_Dxz->Allocate();
-  m_Dxz->FillBuffer(NumericTraits<Precision>::Zero);
-
-  m_Dyy = PrecisionImageType::New();
-  m_Dyy->SetOrigin(im->GetOrigin());
-  m_Dyy->SetSpacing(im->GetSpacing());
-  m_Dyy->SetDirection(im->GetDirection());
-  m_Dyy->SetRegions(im->GetLargestPossibleRegion());
-  m_Dyy->Allocate();
-  m_Dyy->FillBuffer(NumericTraits<Precision>::One);
-
-  m_Dyz = PrecisionImageType::New();
-  m_Dyz->SetOrigin(im->GetOrigin());
-  m_Dyz->SetSpacing(im->GetSpacing());
-  m_Dyz->SetDirection(im->GetDirection());
-  m_Dyz->SetRegions(im->GetLargestPossibleRegion());
-  m_Dyz->Allocate();
-  m_Dyz->FillBuffer(NumericTraits<Precision>::Zero);
-
-  m_Dzz = PrecisionImageType::New();
-  m_Dzz->SetOrigin(im->GetOrigin());
-  m_Dzz->SetSpacing(im->GetSpacing());
-  m_Dzz->SetDirection(im->GetDirection());
-  m_Dzz->SetRegions(im->GetLargestPossibleRegion());
-  m_Dzz->Allocate();
-  m_Dzz->FillBuffer(NumericTraits<Precision>::One);
-
+  // alloc memory for hessian/tensor, initialized
+  // to the identity
+  m_TensorRegion = im->GetLargestPossibleRegion();
+  const SizeValueType numberOfPixels = m_TensorRegion.GetNumberOfPixels();
+  m_Tensor.resize(6 * numberOfPixels);
+  for (SizeValueType i=0; i<numberOfPixels; ++i)
+    {
+    Precision * t = &(m_Tensor[6 * i]);
+    t[0] = NumericTraits<Precision>::One;
+    t[1] = NumericTraits<Precision>::Zero;
+    t[2] = NumericTraits<Precision>::Zero;
+    t[3] = NumericTraits<Precision>::One;
+    t[4] = NumericTraits<Precision>::Zero;
+    t[5] = NumericTraits<Precision>::One;
+    }
 
   // create temp vesselness image to store maxvessel
   typename PrecisionImageType::Pointer vi = PrecisionImageType::New();
@@ -480,63 +588,384 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
   vi->FillBuffer(NumericTraits<Precision>::Zero);
 
 
+  VEDThreadStruct str;
+  str.Filter = this;
+  str.Image = im;
+  str.Vesselness = vi;
+
   for (unsigned int i=0; i< m_Scales.size(); ++i)
     {
-    typedef HessianRecursiveGaussianImageFilter<PrecisionImageType> HessianType;
-    typename HessianType::Pointer hessian = HessianType::New();
+    typename HessianFilterType::Pointer hessian = HessianFilterType::New();
     hessian->SetInput(im);
     hessian->SetNormalizeAcrossScale(true);
     hessian->SetSigma(m_Scales[i]);
+    hessian->SetNumberOfThreads(this->GetNumberOfThreads());
     hessian->Update();
 
-    ImageRegionIterator<PrecisionImageType> itxx (m_Dxx, m_Dxx->GetLargestPossibleRegion());
-    ImageRegionIterator<PrecisionImageType> itxy (m_Dxy, m_Dxy->GetLargestPossibleRegion());
-    ImageRegionIterator<PrecisionImageType> itxz (m_Dxz, m_Dxz->GetLargestPossibleRegion());
-    ImageRegionIterator<PrecisionImageType> ityy (m_Dyy, m_Dyy->GetLargestPossibleRegion());
-    ImageRegionIterator<PrecisionImageType> ityz (m_Dyz, m_Dyz->GetLargestPossibleRegion());
-    ImageRegionIterator<PrecisionImageType> itzz (m_Dzz, m_Dzz->GetLargestPossibleRegion());
-    ImageRegionIterator<PrecisionImageType> vit(vi, vi->GetLargestPossibleRegion());
-
-    ImageRegionConstIterator<typename HessianType::OutputImageType> hit
-        (hessian->GetOutput(), hessian->GetOutput()->GetLargestPossibleRegion());
-
-    for (itxx.GoToBegin(), itxy.GoToBegin(), itxz.GoToBegin(),
-            ityy.GoToBegin(), ityz.GoToBegin(), itzz.GoToBegin(),
-            vit.GoToBegin(), hit.GoToBegin(); !vit.IsAtEnd();
-            ++itxx, ++itxy, ++itxz, ++ityy, ++ityz, ++itzz, ++hit, ++vit)
+    str.Hessian = hessian->GetOutput();
+    this->ExecuteThreaded(this->MaxVesselResponseThreaderCallback, &str);
+    }
+}
+
+// threaded maxvesselresponse
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::ThreadedMaxVesselResponse(const OutputImageRegionType & region,
+  ThreadIdType itkNotUsed(threadId),
+  const HessianImageType * hessian, PrecisionImageType * vi,
+  const typename PrecisionImageType::OffsetType & shift)
+{
+  typedef typename HessianImageType::PixelType HessianPixelType;
+
+  const HessianPixelType * hbuf = hessian->GetBufferPointer();
+  Precision              * vbuf = vi->GetBufferPointer();
+
+  const typename PrecisionImageType::IndexType start = region.GetIndex();
+  const typename PrecisionImageType::SizeType  size  = region.GetSize();
+  typename PrecisionImageType::IndexType       idx   = start;
+
+  vnl_matrix<Precision> H(3,3);
+  vnl_vector<Precision> ev(3);
+
+  for (idx[2] = start[2]; idx[2] < start[2] + static_cast<IndexValueType>(size[2]); ++idx[2])
+    {
+    for (idx[1] = start[1]; idx[1] < start[1] + static_cast<IndexValueType>(size[1]); ++idx[1])
+      {
+      idx[0] = start[0];
+      OffsetValueType c = vi->ComputeOffset(idx);
+      OffsetValueType hc = hessian->ComputeOffset(idx - shift);
+      for (SizeValueType x = 0; x < size[0]; ++x, ++c, ++hc)
+        {
+        const HessianPixelType & h = hbuf[hc];
+
+        H(0,0) = h(0,0);
+        H(0,1) = H(1,0) = h(0,1);
+        H(0,2) = H(2,0) = h(0,2);
+        H(1,1) = h(1,1);
+        H(1,2) = H(2,1) = h(1,2);
+        H(2,2) = h(2,2);
+
+        vnl_symmetric_eigensystem<Precision> ES(H);
+
+        ev[0] = ES.get_eigenvalue(0);
+        ev[1] = ES.get_eigenvalue(1);
+        ev[2] = ES.get_eigenvalue(2);
+
+        if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
+        if ( vcl_abs(ev[1]) > vcl_abs(ev[2])  ) std::swap(ev[1], ev[2]);
+        if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
+
+        const Precision vesselness = VesselnessFunction3D(ev[0],ev[1],ev[2]);
+
+        if ( vesselness > 0 && vesselness > vbuf[c] )
+          {
+          vbuf[c] = vesselness;
+
+          Precision * t = &(m_Tensor[6 * c]);
+          t[0] = h(0,0);
+          t[1] = h(0,1);
+          t[2] = h(0,2);
+          t[3] = h(1,1);
+          t[4] = h(1,2);
+          t[5] = h(2,2);
+          }
+        }
+      }
+    }
+}
+
+template <class PixelType, unsigned int NDimension>
+ITK_THREAD_RETURN_TYPE
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::MaxVesselResponseThreaderCallback( void * arg )
+{
+  const ThreadIdType threadId =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  const ThreadIdType threadCount =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+
+  VEDThreadStruct * str =
+    (VEDThreadStruct *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  if (str->Blocks)
+    {
+    for (SizeValueType b = threadId; b < str->Blocks->size(); b += threadCount)
+      {
+      str->Filter->ThreadedMaxVesselResponse((*str->Blocks)[b], threadId,
+        str->Hessian, str->Vesselness, str->HessianShift);
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  OutputImageRegionType splitRegion;
+  const ThreadIdType total =
+    str->Filter->SplitRequestedRegion(threadId, threadCount, splitRegion);
+
+  if (threadId < total)
+    {
+    str->Filter->ThreadedMaxVesselResponse(splitRegion, threadId,
+      str->Hessian, str->Vesselness, str->HessianShift);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// incremental maxvesselresponse and diffusiontensor
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::IncrementalMaxVesselResponse(const typename PrecisionImageType::Pointer im)
+{
+  const typename PrecisionImageType::RegionType buffer = im->GetBufferedRegion();
+  const typename PrecisionImageType::IndexType  bufferIndex = buffer.GetIndex();
+  const typename PrecisionImageType::SizeType   bufferSize = buffer.GetSize();
+  const SizeValueType B = ( m_RecalculationBlockSize > 0 ) ? m_RecalculationBlockSize : 1;
+
+  SizeValueType nb[3];
+  for (unsigned int i=0; i<3; ++i)
+    {
+    nb[i] = ( bufferSize[i] + B - 1 ) / B;
+    }
+
+  // maximum intensity change of each block
+  // since the last recalculation
+  std::vector<Precision> change(nb[0] * nb[1] * nb[2], NumericTraits<Precision>::Zero);
+
+  const Precision * cbuf = im->GetBufferPointer();
+  const Precision * lbuf = m_LastRecalculatedImage->GetBufferPointer();
+  OffsetValueType c = 0;
+  for (SizeValueType z=0; z<bufferSize[2]; ++z)
+    {
+    for (SizeValueType y=0; y<bufferSize[1]; ++y)
+      {
+      Precision * row = &(change[ nb[0] * ( y / B + nb[1] * ( z / B ) ) ]);
+      for (SizeValueType x=0; x<bufferSize[0]; ++x, ++c)
+        {
+        const Precision diff = vcl_abs( cbuf[c] - lbuf[c] );
+        if ( diff > row[x / B] )
+          {
+          row[x / B] = diff;
+          }
+        }
+      }
+    }
+
+  // the hessian at scale s depends on the voxels up to 4s away, so the
+  // blocks within that distance of a changed block are recalculated too
+  std::vector<unsigned char> recalculate(change.size(), 0);
+  for (SizeValueType b=0; b<change.size(); ++b)
+    {
+    recalculate[b] = ( change[b] > m_RecalculationTolerance ) ? 1 : 0;
+    }
+
+  const Precision maxScale = m_Scales.empty() ? NumericTraits<Precision>::Zero :
+    *std::max_element( m_Scales.begin(), m_Scales.end() );
+  const typename PrecisionImageType::SpacingType bspacing = im->GetSpacing();
+  const SizeValueType stride[3] = { 1, nb[0], nb[0] * nb[1] };
+
+  for (unsigned int k=0; k<3; ++k)
+    {
+    const SizeValueType reach =
+      static_cast<SizeValueType>( vcl_ceil( 4.0 * maxScale / bspacing[k] ) );
+    const SizeValueType dilation = ( reach + B - 1 ) / B;
+    if ( dilation == 0 )
+      {
+      continue;
+      }
+
+    // separable dilation of the block mask along axis k
+    std::vector<unsigned char> dilated(recalculate.size(), 0);
+    for (SizeValueType b=0; b<recalculate.size(); ++b)
+      {
+      if ( !recalculate[b] )
+        {
+        continue;
+        }
+      const SizeValueType bk = ( b / stride[k] ) % nb[k];
+      const SizeValueType first = ( bk > dilation ) ? bk - dilation : 0;
+      const SizeValueType last = std::min( bk + dilation, nb[k] - 1 );
+      for (SizeValueType j=first; j<=last; ++j)
+        {
+        dilated[ b - bk * stride[k] + j * stride[k] ] = 1;
+        }
+      }
+    recalculate.swap(dilated);
+    }
+
+  // blocks to recalculate, grouped by slab of blocks along z
+  std::vector< BlockContainerType > slabs(nb[2]);
+  BlockContainerType blocks;
+  for (SizeValueType bz=0; bz<nb[2]; ++bz)
+    {
+    for (SizeValueType by=0; by<nb[1]; ++by)
+      {
+      for (SizeValueType bx=0; bx<nb[0]; ++bx)
+        {
+        if ( !recalculate[ bx + nb[0] * ( by + nb[1] * bz ) ] )
+          {
+          continue;
+          }
+        typename PrecisionImageType::IndexType blockIndex;
+        typename PrecisionImageType::SizeType  blockSize;
+        const SizeValueType b[3] = { bx, by, bz };
+        for (unsigned int i=0; i<3; ++i)
+          {
+          blockIndex[i] = bufferIndex[i] + static_cast<IndexValueType>( b[i] * B );
+          blockSize[i] = std::min( B, bufferSize[i] - b[i] * B );
+          }
+        OutputImageRegionType block(blockIndex, blockSize);
+        slabs[bz].push_back(block);
+        blocks.push_back(block);
+        }
+      }
+    }
+
+  m_NumberOfRecalculatedBlocks += blocks.size();
+  m_NumberOfIncrementalBlocks += change.size();
+
+  if (m_Verbose)
+    {
+    std::cout << "(" << blocks.size() << "/" << change.size() << ") ";
+    std::cout.flush();
+    }
+
+  if ( blocks.empty() )
+    {
+    return;
+    }
+
+  // reset the tensor of the recalculated blocks to the identity
+  for (SizeValueType b=0; b<blocks.size(); ++b)
+    {
+    const typename PrecisionImageType::IndexType start = blocks[b].GetIndex();
+    const typename PrecisionImageType::SizeType  size  = blocks[b].GetSize();
+    typename PrecisionImageType::IndexType       idx   = start;
+    for (idx[2] = start[2]; idx[2] < start[2] + static_cast<IndexValueType>(size[2]); ++idx[2])
+      {
+      for (idx[1] = start[1]; idx[1] < start[1] + static_cast<IndexValueType>(size[1]); ++idx[1])
+        {
+        idx[0] = start[0];
+        OffsetValueType o = this->ComputeTensorOffset(idx);
+        for (SizeValueType x = 0; x < size[0]; ++x, ++o)
+          {
+          Precision * t = &(m_Tensor[6 * o]);
+          t[0] = NumericTraits<Precision>::One;
+          t[1] = NumericTraits<Precision>::Zero;
+          t[2] = NumericTraits<Precision>::Zero;
+          t[3] = NumericTraits<Precision>::One;
+          t[4] = NumericTraits<Precision>::Zero;
+          t[5] = NumericTraits<Precision>::One;
+          }
+        }
+      }
+    }
+
+  // temp vesselness image to store maxvessel
+  typename PrecisionImageType::Pointer vi = PrecisionImageType::New();
+  vi->SetOrigin(im->GetOrigin());
+  vi->SetSpacing(im->GetSpacing());
+  vi->SetDirection(im->GetDirection());
+  vi->SetRegions(im->GetLargestPossibleRegion());
+  vi->Allocate();
+  vi->FillBuffer(NumericTraits<Precision>::Zero);
+
+  VEDThreadStruct str;
+  str.Filter = this;
+  str.Image = im;
+  str.Vesselness = vi;
+
+  const typename PrecisionImageType::SpacingType ispacing = im->GetSpacing();
+
+  typedef RegionOfInterestImageFilter<PrecisionImageType,PrecisionImageType> ROIType;
+
+  for (unsigned int i=0; i< m_Scales.size(); ++i)
+    {
+    // margin the recursive gaussian needs around the blocks
+    typename PrecisionImageType::SizeType margin;
+    for (unsigned int k=0; k<3; ++k)
       {
-      vnl_matrix<Precision> H(3,3);
+      margin[k] = static_cast<SizeValueType>( vcl_ceil( 4.0 * m_Scales[i] / ispacing[k] ) ) + 1;
+      }
 
-      H(0,0) = hit.Value()(0,0);
-      H(0,1) = H(1,0) = hit.Value()(0,1);
-      H(0,2) = H(2,0) = hit.Value()(0,2);
-      H(1,1) = hit.Value()(1,1);
-      H(1,2) = H(2,1) = hit.Value()(1,2);
-      H(2,2) = hit.Value()(2,2);
+    for (SizeValueType bz=0; bz<nb[2]; ++bz)
+      {
+      if ( slabs[bz].empty() )
+        {
+        continue;
+        }
 
-      vnl_symmetric_eigensystem<Precision> ES(H);
-      vnl_vector<Precision> ev(3);
+      // bounding box of the changed blocks of the slab, plus margin
+      typename PrecisionImageType::IndexType lower = slabs[bz][0].GetIndex();
+      typename PrecisionImageType::IndexType upper = slabs[bz][0].GetUpperIndex();
+      for (SizeValueType b=1; b<slabs[bz].size(); ++b)
+        {
+        for (unsigned int k=0; k<3; ++k)
+          {
+          lower[k] = std::min( lower[k], slabs[bz][b].GetIndex()[k] );
+          upper[k] = std::max( upper[k], slabs[bz][b].GetUpperIndex()[k] );
+          }
+        }
+      typename PrecisionImageType::IndexType cropIndex;
+      typename PrecisionImageType::SizeType  cropSize;
+      for (unsigned int k=0; k<3; ++k)
+        {
+        const IndexValueType first = std::max( lower[k] - static_cast<IndexValueType>(margin[k]), bufferIndex[k] );
+        const IndexValueType last  = std::min( upper[k] + static_cast<IndexValueType>(margin[k]),
+          bufferIndex[k] + static_cast<IndexValueType>(bufferSize[k]) - 1 );
+        cropIndex[k] = first;
+        cropSize[k] = static_cast<SizeValueType>( last - first + 1 );
+        }
+      OutputImageRegionType crop(cropIndex, cropSize);
+
+      typename ROIType::Pointer roi = ROIType::New();
+      roi->SetInput(im);
+      roi->SetRegionOfInterest(crop);
+
+      typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+      hessian->SetInput(roi->GetOutput());
+      hessian->SetNormalizeAcrossScale(true);
+      hessian->SetSigma(m_Scales[i]);
+      hessian->SetNumberOfThreads(this->GetNumberOfThreads());
+      hessian->Update();
+
+      // the region of interest starts at index zero
+      str.Hessian = hessian->GetOutput();
+      str.Blocks = &(slabs[bz]);
+      for (unsigned int k=0; k<3; ++k)
+        {
+        str.HessianShift[k] = cropIndex[k] - hessian->GetOutput()->GetBufferedRegion().GetIndex()[k];
+        }
+      this->ExecuteThreaded(this->MaxVesselResponseThreaderCallback, &str);
+      }
+    }
 
-      ev[0] = ES.get_eigenvalue(0);
-      ev[1] = ES.get_eigenvalue(1);
-      ev[2] = ES.get_eigenvalue(2);
+  // tensor of the recalculated blocks
+  str.Blocks = &blocks;
+  this->ExecuteThreaded(this->DiffusionTensorThreaderCallback, &str);
 
-      if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
-      if ( vcl_abs(ev[1]) > vcl_abs(ev[2])  ) std::swap(ev[1], ev[2]);
-      if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
+  this->CopyBlocks(im, m_LastRecalculatedImage, blocks);
+}
 
-      const Precision vesselness = VesselnessFunction3D(ev[0],ev[1],ev[2]);
+// copy blocks
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::CopyBlocks(const PrecisionImageType * source, PrecisionImageType * destination,
+  const BlockContainerType & blocks) const
+{
+  const Precision * sbuf = source->GetBufferPointer();
+  Precision       * dbuf = destination->GetBufferPointer();
 
-      if ( vesselness > 0 && vesselness > vit.Value() )
+  for (SizeValueType b=0; b<blocks.size(); ++b)
+    {
+    const typename PrecisionImageType::IndexType start = blocks[b].GetIndex();
+    const typename PrecisionImageType::SizeType  size  = blocks[b].GetSize();
+    typename PrecisionImageType::IndexType       idx   = start;
+    for (idx[2] = start[2]; idx[2] < start[2] + static_cast<IndexValueType>(size[2]); ++idx[2])
+      {
+      for (idx[1] = start[1]; idx[1] < start[1] + static_cast<IndexValueType>(size[1]); ++idx[1])
         {
-        vit.Value() = vesselness;
-
-        itxx.Value() = hit.Value()(0,0);
-        itxy.Value() = hit.Value()(0,1);
-        itxz.Value() = hit.Value()(0,2);
-        ityy.Value() = hit.Value()(1,1);
-        ityz.Value() = hit.Value()(1,2);
-        itzz.Value() = hit.Value()(2,2);
+        idx[0] = start[0];
+        const OffsetValueType o = source->ComputeOffset(idx);
+        std::copy(sbuf + o, sbuf + o + size[0], dbuf + o);
         }
       }
     }
@@ -583,68 +1012,156 @@ template <class PixelType, unsigned int NDimension>
 void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
 ::DiffusionTensor()
 {
-  ImageRegionIterator<PrecisionImageType> itxx (m_Dxx, m_Dxx->GetLargestPossibleRegion());
-  ImageRegionIterator<PrecisionImageType> itxy (m_Dxy, m_Dxy->GetLargestPossibleRegion());
-  ImageRegionIterator<PrecisionImageType> itxz (m_Dxz, m_Dxz->GetLargestPossibleRegion());
-  ImageRegionIterator<PrecisionImageType> ityy (m_Dyy, m_Dyy->GetLargestPossibleRegion());
-  ImageRegionIterator<PrecisionImageType> ityz (m_Dyz, m_Dyz->GetLargestPossibleRegion());
-  ImageRegionIterator<PrecisionImageType> itzz (m_Dzz, m_Dzz->GetLargestPossibleRegion());
-
-  for  ( itxx.GoToBegin(), itxy.GoToBegin(), itxz.GoToBegin(),
-          ityy.GoToBegin(), ityz.GoToBegin(), itzz.GoToBegin();
-          !itxx.IsAtEnd();
-          ++itxx, ++itxy, ++itxz, ++ityy, ++ityz, ++itzz)
-    {
-    vnl_matrix<Precision> H(3,3);
-    H(0,0) = itxx.Value();
-    H(0,1) = H(1,0) = itxy.Value();
-    H(0,2) = H(2,0) = itxz.Value();
-    H(1,1) = ityy.Value();
-    H(1,2) = H(2,1) = ityz.Value();
-    H(2,2) = itzz.Value();
-
-    vnl_symmetric_eigensystem<Precision> ES(H);
-
-    vnl_matrix<Precision> EV(3,3);
-    EV.set_column(0,ES.get_eigenvector(0));
-    EV.set_column(1,ES.get_eigenvector(1));
-    EV.set_column(2,ES.get_eigenvector(2));
-
-    vnl_vector<Precision> ev(3);
-    ev[0] = ES.get_eigenvalue(0);
-    ev[1] = ES.get_eigenvalue(1);
-    ev[2] = ES.get_eigenvalue(2);
-
-    if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
-    if ( vcl_abs(ev[1]) > vcl_abs(ev[2])  ) std::swap(ev[1], ev[2]);
-    if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
-
-    const Precision V=VesselnessFunction3D(ev[0],ev[1],ev[2]);
-    vnl_vector<Precision> evn(3);
-
-    // adjusting eigenvalues
-    // static_cast required to prevent error with gcc 4.1.2
-    evn[0]   = 1.0 + (m_Epsilon - 1.0) * vcl_pow(V,static_cast<Precision>(1.0/m_Sensitivity));
-    evn[1]   = 1.0 + (m_Epsilon - 1.0) * vcl_pow(V,static_cast<Precision>(1.0/m_Sensitivity));
-    evn[2]   = 1.0 + (m_Omega - 1.0 ) * vcl_pow(V,static_cast<Precision>(1.0/m_Sensitivity));
-
-    vnl_matrix<Precision> LAM(3,3);
-    LAM.fill(0);
-    LAM(0,0) = evn[0];
-    LAM(1,1) = evn[1];
-    LAM(2,2) = evn[2];
-
-    const vnl_matrix<Precision> HN = EV * LAM * EV.transpose();
-
-    itxx.Value() = HN(0,0);
-    itxy.Value() = HN(0,1);
-    itxz.Value() = HN(0,2);
-    ityy.Value() = HN(1,1);
-    ityz.Value() = HN(1,2);
-    itzz.Value() = HN(2,2);
+  VEDThreadStruct str;
+  str.Filter = this;
+  this->ExecuteThreaded(this->DiffusionTensorThreaderCallback, &str);
+}
+
+// offset of a pixel in the interleaved tensor buffer
+template <class PixelType, unsigned int NDimension>
+inline OffsetValueType
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::ComputeTensorOffset(const typename PrecisionImageType::IndexType & idx) const
+{
+  const typename PrecisionImageType::IndexType start = m_TensorRegion.GetIndex();
+  const typename PrecisionImageType::SizeType  size  = m_TensorRegion.GetSize();
+  return ( idx[0] - start[0] )
+    + static_cast<OffsetValueType>(size[0]) * ( ( idx[1] - start[1] )
+    + static_cast<OffsetValueType>(size[1]) * ( idx[2] - start[2] ) );
+}
+
+// threaded diffusiontensor
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::ThreadedDiffusionTensor(const OutputImageRegionType & region,
+  ThreadIdType itkNotUsed(threadId))
+{
+  const typename PrecisionImageType::IndexType start = region.GetIndex();
+  const typename PrecisionImageType::SizeType  size  = region.GetSize();
+  typename PrecisionImageType::IndexType       idx   = start;
+
+  vnl_matrix<Precision> H(3,3);
+  vnl_matrix<Precision> EV(3,3);
+  vnl_matrix<Precision> LAM(3,3);
+  vnl_vector<Precision> ev(3);
+  vnl_vector<Precision> evn(3);
+
+  for (idx[2] = start[2]; idx[2] < start[2] + static_cast<IndexValueType>(size[2]); ++idx[2])
+    {
+    for (idx[1] = start[1]; idx[1] < start[1] + static_cast<IndexValueType>(size[1]); ++idx[1])
+      {
+      idx[0] = start[0];
+      OffsetValueType c = this->ComputeTensorOffset(idx);
+      for (SizeValueType x = 0; x < size[0]; ++x, ++c)
+        {
+        Precision * t = &(m_Tensor[6 * c]);
+
+        H(0,0) = t[0];
+        H(0,1) = H(1,0) = t[1];
+        H(0,2) = H(2,0) = t[2];
+        H(1,1) = t[3];
+        H(1,2) = H(2,1) = t[4];
+        H(2,2) = t[5];
+
+        vnl_symmetric_eigensystem<Precision> ES(H);
+
+        EV.set_column(0,ES.get_eigenvector(0));
+        EV.set_column(1,ES.get_eigenvector(1));
+        EV.set_column(2,ES.get_eigenvector(2));
+
+        ev[0] = ES.get_eigenvalue(0);
+        ev[1] = ES.get_eigenvalue(1);
+        ev[2] = ES.get_eigenvalue(2);
+
+        if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
+        if ( vcl_abs(ev[1]) > vcl_abs(ev[2])  ) std::swap(ev[1], ev[2]);
+        if ( vcl_abs(ev[0]) > vcl_abs(ev[1])  ) std::swap(ev[0], ev[1]);
+
+        const Precision V=VesselnessFunction3D(ev[0],ev[1],ev[2]);
+
+        // adjusting eigenvalues
+        // static_cast required to prevent error with gcc 4.1.2
+        evn[0]   = 1.0 + (m_Epsilon - 1.0) * vcl_pow(V,static_cast<Precision>(1.0/m_Sensitivity));
+        evn[1]   = 1.0 + (m_Epsilon - 1.0) * vcl_pow(V,static_cast<Precision>(1.0/m_Sensitivity));
+        evn[2]   = 1.0 + (m_Omega - 1.0 ) * vcl_pow(V,static_cast<Precision>(1.0/m_Sensitivity));
+
+        LAM.fill(0);
+        LAM(0,0) = evn[0];
+        LAM(1,1) = evn[1];
+        LAM(2,2) = evn[2];
+
+        const vnl_matrix<Precision> HN = EV * LAM * EV.transpose();
+
+        t[0] = HN(0,0);
+        t[1] = HN(0,1);
+        t[2] = HN(0,2);
+        t[3] = HN(1,1);
+        t[4] = HN(1,2);
+        t[5] = HN(2,2);
+        }
+      }
+    }
+}
+
+template <class PixelType, unsigned int NDimension>
+ITK_THREAD_RETURN_TYPE
+VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::DiffusionTensorThreaderCallback( void * arg )
+{
+  const ThreadIdType threadId =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  const ThreadIdType threadCount =
+    ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+
+  VEDThreadStruct * str =
+    (VEDThreadStruct *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  if (str->Blocks)
+    {
+    for (SizeValueType b = threadId; b < str->Blocks->size(); b += threadCount)
+      {
+      str->Filter->ThreadedDiffusionTensor((*str->Blocks)[b], threadId);
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  OutputImageRegionType splitRegion;
+  const ThreadIdType total =
+    str->Filter->SplitRequestedRegion(threadId, threadCount, splitRegion);
+
+  if (threadId < total)
+    {
+    str->Filter->ThreadedDiffusionTensor(splitRegion, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// whole input is needed
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::GenerateInputRequestedRegion() throw(InvalidRequestedRegionError)
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  typename ImageType::Pointer input =
+    const_cast< ImageType * >( this->GetInput() );
+
+  if ( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
     }
 }
 
+// whole output is produced
+template <class PixelType, unsigned int NDimension>
+void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
+::EnlargeOutputRequestedRegion(DataObject *output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
 // generatedata
 template <class PixelType, unsigned int NDimension>
 void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
@@ -672,7 +1189,7 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
     m_TimeStep = htmax;
     }
 
-  if (m_TimeStep> htmax)
+  if (m_TimeStep> htmax && !m_UseAdditiveOperatorSplitting)
     {
     std::cerr << "the time step size is too large!" << std::endl;
     this->AllocateOutputs();
@@ -683,6 +1200,7 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
     {
     std::cout << "min/max             \t" << minmax->GetMinimum() << " " << minmax->GetMaximum() << std::endl;
     std::cout << "iterations/timestep \t" << m_Iterations << " " << m_TimeStep << std::endl;
+    std::cout << "aos                 \t" << m_UseAdditiveOperatorSplitting << std::endl;
     std::cout << "recalc v            \t" << m_RecalculateVesselness << std::endl;
     std::cout << "scales              \t";
     for (unsigned int i=0; i<m_Scales.size(); ++i)
@@ -698,21 +1216,48 @@ void VesselEnhancingDiffusion3DImageFilter<PixelType, NDimension>
   typedef CastImageFilter<ImageType,PrecisionImageType> CT;
   typename CT::Pointer cast = CT::New();
   cast->SetInput(this->GetInput());
+  cast->SetNumberOfThreads(this->GetNumberOfThreads());
   cast->Update();
 
   typename PrecisionImageType::Pointer ci = cast->GetOutput();
 
+  // second buffer, iterations alternate between ci and d
+  typename PrecisionImageType::Pointer d = PrecisionImageType::New();
+  d->SetOrigin(ci->GetOrigin());
+  d->SetSpacing(ci->GetSpacing());
+  d->SetDirection(ci->GetDirection());
+  d->SetRegions(ci->GetLargestPossibleRegion());
+  d->Allocate();
+
+  if (m_UseAdditiveOperatorSplitting)
+    {
+    m_RightHandSide = PrecisionImageType::New();
+    m_RightHandSide->SetOrigin(ci->GetOrigin());
+    m_RightHandSide->SetSpacing(ci->GetSpacing());
+    m_RightHandSide->SetDirection(ci->GetDirection());
+    m_RightHandSide->SetRegions(ci->GetLargestPossibleRegion());
+    m_RightHandSide->Allocate();
+    }
 
   if (m_Verbose)
     {
     std::cout << "start algorithm ... " << std::endl;
     }
 
+  m_NumberOfRecalculatedBlocks = 0;
+  m_NumberOfIncrementalBlocks = 0;
+
   for (m_CurrentIteration=1; m_CurrentIteration<=m_Iterations; m_CurrentIteration++)
     {
-    VED3DSingleIteration (ci);
+    VED3DSingleIteration (ci, d);
     }
 
+  // release the tensor and the second buffer
+  std::vector<Precision>().swap(m_Tensor);
+  m_RightHandSide = 0;
+  m_LastRecalculatedImage = 0;
+  d = 0;
+
   typedef MinimumMaximumImageFilter<PrecisionImageType> MMT;
   typename MMT::Pointer mm = MMT::New();
   mm->SetInput(ci);
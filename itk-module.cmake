@@ -16,6 +16,7 @@ itk_module(ITKLesionSizingToolkit
    ITKMathematicalMorphology
    ITKIOGDCM
    ITKIOMeta
+   ITKZLIB
    ITKVTK
    ITKTestKernel #to handle IO in src
    DESCRIPTION
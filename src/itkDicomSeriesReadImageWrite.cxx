@@ -25,9 +25,8 @@
 
 #include "itkIncludeRequiredIOFactories.h"
 #include "itkImage.h"
-#include "itkGDCMImageIO.h"
 #include "itkGDCMSeriesFileNames.h"
-#include "itkImageSeriesReader.h"
+#include "itkDICOMSeriesRegionReader.h"
 #include "itkImageFileWriter.h"
 
 int main( int argc, char* argv[] )
@@ -49,14 +48,10 @@ int main( int argc, char* argv[] )
 
   typedef itk::Image< PixelType, Dimension >         ImageType;
 
-  typedef itk::ImageSeriesReader< ImageType >        ReaderType;
+  // The slices are decoded on all the threads
+  typedef itk::DICOMSeriesRegionReader< ImageType >  ReaderType;
   ReaderType::Pointer reader = ReaderType::New();
 
-  typedef itk::GDCMImageIO       ImageIOType;
-  ImageIOType::Pointer dicomIO = ImageIOType::New();
-  
-  reader->SetImageIO( dicomIO );
-
   typedef itk::GDCMSeriesFileNames NamesGeneratorType;
   NamesGeneratorType::Pointer nameGenerator = NamesGeneratorType::New();
 
@@ -25,7 +25,7 @@
 
 #include "itkIncludeRequiredIOFactories.h"
 #include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
+#include "itkChunkedCompressionMetaImageWriter.h"
 #include "itkRegionOfInterestImageFilter.h"
 #include "itkLandmarksReader.h"
 #include "itkEllipseSpatialObject.h"
@@ -55,7 +55,7 @@ int main( int argc, char ** argv )
   typedef itk::Image< OutputPixelType, Dimension >    OutputImageType;
 
   typedef itk::ImageFileReader< InputImageType  >  ReaderType;
-  typedef itk::ImageFileWriter< OutputImageType >  WriterType;
+  typedef itk::ChunkedCompressionMetaImageWriter< OutputImageType >  WriterType;
 
   typedef itk::RegionOfInterestImageFilter< InputImageType, 
                                             OutputImageType > FilterType;
@@ -96,7 +96,6 @@ int main( int argc, char ** argv )
 
   filter->SetInput( reader->GetOutput() );
   writer->SetInput( filter->GetOutput() );
-  writer->UseCompressionOn();
 
   try 
     { 
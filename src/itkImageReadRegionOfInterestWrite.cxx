@@ -25,7 +25,7 @@
 
 #include "itkIncludeRequiredIOFactories.h"
 #include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
+#include "itkChunkedCompressionMetaImageWriter.h"
 #include "itkRegionOfInterestImageFilter.h"
 #include "itkImage.h"
 
@@ -54,7 +54,7 @@ int main( int argc, char ** argv )
   typedef itk::Image< OutputPixelType, Dimension >    OutputImageType;
 
   typedef itk::ImageFileReader< InputImageType  >  ReaderType;
-  typedef itk::ImageFileWriter< OutputImageType >  WriterType;
+  typedef itk::ChunkedCompressionMetaImageWriter< OutputImageType >  WriterType;
 
   typedef itk::RegionOfInterestImageFilter< InputImageType, 
                                             OutputImageType > FilterType;
@@ -89,7 +89,6 @@ int main( int argc, char ** argv )
 
   filter->SetInput( reader->GetOutput() );
   writer->SetInput( filter->GetOutput() );
-  writer->UseCompressionOn();
 
   try 
     { 
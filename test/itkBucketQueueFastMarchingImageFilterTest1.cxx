@@ -0,0 +1,216 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkBucketQueueFastMarchingImageFilterTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The bucket queue fast marching is run against the heap based fast
+// marching of ITK on the same speed image and seeds. The timings of both are
+// reported, and the arrival times of the points reached by both are required
+// to agree on average within a tolerance.
+
+#include "itkBucketQueueFastMarchingImageFilter.h"
+#include "itkFastMarchingImageFilter.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+#include "itkTimeProbe.h"
+
+int itkBucketQueueFastMarchingImageFilterTest1( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tspeedImage\n\toutputImage ";
+    std::cerr << "\n\t[stopping value]";
+    std::cerr << "\n\t[mean difference tolerance]";
+    std::cerr << "\n\t[number of repetitions]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+  typedef float                                   PixelType;
+  typedef itk::Image< PixelType, Dimension >      ImageType;
+
+  typedef itk::ImageFileReader< ImageType >       ReaderType;
+  typedef itk::ImageFileWriter< ImageType >       WriterType;
+
+  typedef itk::LandmarksReader< Dimension >       LandmarksReaderType;
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+
+  ReaderType::Pointer speedReader = ReaderType::New();
+  speedReader->SetFileName( argv[2] );
+
+  try
+    {
+    speedReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double stoppingValue = (argc > 4) ? atof( argv[4] ) : 100.0;
+  const double tolerance = (argc > 5) ? atof( argv[5] ) : 0.05;
+  const unsigned int numberOfRepetitions = (argc > 6) ? atoi( argv[6] ) : 3;
+
+  ImageType::Pointer speedImage = speedReader->GetOutput();
+  speedImage->DisconnectPipeline();
+
+  typedef itk::FastMarchingImageFilter< ImageType, ImageType >              HeapFilterType;
+  typedef itk::BucketQueueFastMarchingImageFilter< ImageType, ImageType >   BucketFilterType;
+
+  typedef BucketFilterType::NodeContainer   NodeContainer;
+  typedef BucketFilterType::NodeType        NodeType;
+
+  typedef LandmarksReaderType::SpatialObjectType   LandmarksType;
+  typedef LandmarksType::PointListType             PointListType;
+
+  const LandmarksType * landmarks = landmarksReader->GetOutput();
+  const PointListType & points = landmarks->GetPoints();
+
+  NodeContainer::Pointer trialPoints = NodeContainer::New();
+
+  for( unsigned int i = 0; i < landmarks->GetNumberOfPoints(); i++ )
+    {
+    ImageType::IndexType index;
+    speedImage->TransformPhysicalPointToIndex( points[i].GetPosition(), index );
+
+    NodeType node;
+    node.SetValue( 0.0 );
+    node.SetIndex( index );
+    trialPoints->InsertElement( i, node );
+    }
+
+  HeapFilterType::Pointer heapFilter = HeapFilterType::New();
+  heapFilter->SetInput( speedImage );
+  heapFilter->SetTrialPoints( trialPoints );
+  heapFilter->SetStoppingValue( stoppingValue );
+
+  BucketFilterType::Pointer bucketFilter = BucketFilterType::New();
+  bucketFilter->SetInput( speedImage );
+  bucketFilter->SetTrialPoints( trialPoints );
+  bucketFilter->SetStoppingValue( stoppingValue );
+
+  itk::TimeProbe heapProbe;
+  itk::TimeProbe bucketProbe;
+
+  try
+    {
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      heapFilter->Modified();
+      heapProbe.Start();
+      heapFilter->Update();
+      heapProbe.Stop();
+
+      bucketFilter->Modified();
+      bucketProbe.Start();
+      bucketFilter->Update();
+      bucketProbe.Stop();
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Heap fast marching         : " << heapProbe.GetMean() << " s" << std::endl;
+  std::cout << "Bucket queue fast marching : " << bucketProbe.GetMean() << " s" << std::endl;
+  std::cout << "Processed points           : " << bucketFilter->GetNumberOfProcessedPoints() << std::endl;
+  std::cout << "Reached region             : " << bucketFilter->GetReachedRegion() << std::endl;
+
+  typedef itk::ImageRegionConstIterator< ImageType > IteratorType;
+
+  IteratorType hit( heapFilter->GetOutput(), heapFilter->GetOutput()->GetBufferedRegion() );
+  IteratorType bit( bucketFilter->GetOutput(), bucketFilter->GetOutput()->GetBufferedRegion() );
+
+  unsigned long numberOfCommonPoints = 0;
+  unsigned long numberOfClassificationDifferences = 0;
+  double sumOfDifferences = 0.0;
+  double maximumDifference = 0.0;
+
+  for( hit.GoToBegin(), bit.GoToBegin(); !hit.IsAtEnd(); ++hit, ++bit )
+    {
+    const bool heapReached = ( hit.Get() <= stoppingValue );
+    const bool bucketReached = ( bit.Get() <= stoppingValue );
+
+    if( heapReached != bucketReached )
+      {
+      ++numberOfClassificationDifferences;
+      }
+    else if( heapReached )
+      {
+      const double difference = vnl_math_abs( hit.Get() - bit.Get() );
+      sumOfDifferences += difference;
+      if( difference > maximumDifference )
+        {
+        maximumDifference = difference;
+        }
+      ++numberOfCommonPoints;
+      }
+    }
+
+  if( numberOfCommonPoints == 0 )
+    {
+    std::cerr << "The front did not reach any point" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double meanDifference = sumOfDifferences / numberOfCommonPoints;
+
+  std::cout << "Points reached by both     : " << numberOfCommonPoints << std::endl;
+  std::cout << "Reached by only one        : " << numberOfClassificationDifferences << std::endl;
+  std::cout << "Mean difference            : " << meanDifference << std::endl;
+  std::cout << "Maximum difference         : " << maximumDifference << std::endl;
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[3] );
+  writer->SetInput( bucketFilter->GetOutput() );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( meanDifference > tolerance )
+    {
+    std::cerr << "The mean difference of the arrival times exceeds " << tolerance << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Points on the stopping front may fall on either side of it.
+  if( numberOfClassificationDifferences > numberOfCommonPoints / 100 )
+    {
+    std::cerr << "Too many points reached by only one of the filters" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  bucketFilter->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,332 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkChunkedCompressionMetaImageWriterTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A synthetic float volume, a sphere in noise, is written with compressed
+// chunks as a single file and with a separate data file. Both files must be
+// read back unchanged by ImageFileReader, which sees a regular compressed
+// MetaImage, and by the chunked reader, which must inflate their chunks. A
+// file compressed by ImageFileWriter must be read by the chunked reader as
+// well, and a file written with compression off must hold the raw pixels.
+// The throughput of the chunked writer and reader is compared with the
+// throughput of ImageFileWriter and ImageFileReader with compression.
+
+#include "itkChunkedCompressionMetaImageWriter.h"
+#include "itkChunkedCompressionMetaImageReader.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+#include "itksys/SystemTools.hxx"
+
+namespace
+{
+
+typedef itk::Image< float, 3 >   ImageType;
+
+unsigned long CountDifferences( const ImageType * image, const ImageType * reference )
+{
+  itk::ImageRegionConstIterator< ImageType > itr( image, image->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType > rtr( reference, reference->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+
+  for( itr.GoToBegin(), rtr.GoToBegin(); !itr.IsAtEnd(); ++itr, ++rtr )
+    {
+    if( itr.Get() != rtr.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  return numberOfDifferences;
+}
+
+}
+
+int itkChunkedCompressionMetaImageWriterTest1( int argc, char * argv [] )
+{
+
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\toutputDirectory [sizeX sizeY sizeZ] [numberOfRepetitions]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ChunkedCompressionMetaImageWriter< ImageType >   WriterType;
+  typedef itk::ChunkedCompressionMetaImageReader< ImageType >   ReaderType;
+  typedef itk::ImageFileWriter< ImageType >                     FileWriterType;
+  typedef itk::ImageFileReader< ImageType >                     FileReaderType;
+
+  ImageType::SizeType size;
+  size[0] = (argc > 4) ? atoi( argv[2] ) : 96;
+  size[1] = (argc > 4) ? atoi( argv[3] ) : 80;
+  size[2] = (argc > 4) ? atoi( argv[4] ) : 60;
+
+  const unsigned int numberOfRepetitions = (argc > 5) ? atoi( argv[5] ) : 1;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 0.7;
+  spacing[2] = 1.25;
+
+  ImageType::PointType origin;
+  origin[0] = -150.0;
+  origin[1] = -120.0;
+  origin[2] = 30.0;
+
+  ImageType::DirectionType direction;
+  direction.SetIdentity();
+  direction[0][0] = -1.0;
+  direction[1][1] = -1.0;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->SetDirection( direction );
+  image->Allocate();
+
+  // Lung-like background with a lesion, and a few bits of noise
+  unsigned int seed = 12345;
+
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const ImageType::IndexType & index = itr.GetIndex();
+
+    double distance = 0.0;
+    for( unsigned int i = 0; i < 3; i++ )
+      {
+      const double offset = ( index[i] - 0.5 * size[i] ) * spacing[i];
+      distance += offset * offset;
+      }
+
+    seed = seed * 1103515245 + 12345;
+
+    const float value = ( distance < 400.0 ) ? 40.0f : -850.0f;
+    itr.Set( value + static_cast< float >( ( seed >> 16 ) % 16 ) );
+    }
+
+  const std::string directory = argv[1];
+
+  const double megaBytes = image->GetBufferedRegion().GetNumberOfPixels() * sizeof( float ) / 1048576.0;
+
+  //
+  // Round trip of a single file and of a file with a separate data file
+  //
+  const char * fileNames[2] = {
+    "ChunkedCompressionMetaImageWriterTest1.mha",
+    "ChunkedCompressionMetaImageWriterTest1.mhd" };
+
+  for( unsigned int f = 0; f < 2; f++ )
+    {
+    const std::string fileName = directory + "/" + fileNames[f];
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( fileName );
+    writer->SetInput( image );
+    if( f == 1 )
+      {
+      writer->SetChunkSize( 100000 );
+      writer->SetCompressionLevel( 1 );
+      }
+
+    FileReaderType::Pointer fileReader = FileReaderType::New();
+    fileReader->SetFileName( fileName );
+
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName );
+
+    try
+      {
+      writer->Update();
+      fileReader->Update();
+      reader->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << fileNames[f] << ": " << writer->GetNumberOfChunks() << " chunks, chunk compressed read: ";
+    std::cout << reader->GetIsChunkCompressed() << std::endl;
+
+    if( !reader->GetIsChunkCompressed() )
+      {
+      std::cerr << "The chunks of " << fileNames[f] << " were not inflated by the chunked reader" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const ImageType * outputs[2] = { fileReader->GetOutput(), reader->GetOutput() };
+
+    for( unsigned int r = 0; r < 2; r++ )
+      {
+      if( outputs[r]->GetBufferedRegion() != image->GetBufferedRegion() ||
+          outputs[r]->GetSpacing() != image->GetSpacing() ||
+          outputs[r]->GetOrigin().EuclideanDistanceTo( image->GetOrigin() ) > 1e-6 ||
+          outputs[r]->GetDirection() != image->GetDirection() )
+        {
+        std::cerr << "The geometry of " << fileNames[f] << " read by the ";
+        std::cerr << ( r == 0 ? "file" : "chunked" ) << " reader differs from the volume written" << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      const unsigned long numberOfDifferences = CountDifferences( outputs[r], image );
+
+      if( numberOfDifferences > 0 )
+        {
+        std::cerr << numberOfDifferences << " pixels of " << fileNames[f] << " read by the ";
+        std::cerr << ( r == 0 ? "file" : "chunked" ) << " reader differ from the volume written" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    if( f == 1 )
+      {
+      reader->Print( std::cout );
+      }
+    }
+
+  //
+  // Without compression, the pixels are written as they are
+  //
+  {
+  const std::string fileName = directory + "/ChunkedCompressionMetaImageWriterTest1Uncompressed.mha";
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( image );
+  writer->UseCompressionOff();
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+
+  try
+    {
+    writer->Update();
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned long pixelDataLength = image->GetBufferedRegion().GetNumberOfPixels() * sizeof( float );
+
+  if( writer->GetNumberOfChunks() != 0 || reader->GetIsChunkCompressed() ||
+      itksys::SystemTools::FileLength( fileName.c_str() ) < pixelDataLength ||
+      CountDifferences( reader->GetOutput(), image ) > 0 )
+    {
+    std::cerr << "The image written without compression was compressed or differs from the volume" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // Throughput against the compression of ImageFileWriter
+  //
+  const std::string fileName = directory + "/ChunkedCompressionMetaImageWriterTest1Chunked.mha";
+  const std::string referenceFileName = directory + "/ChunkedCompressionMetaImageWriterTest1Compressed.mha";
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( image );
+
+  FileWriterType::Pointer fileWriter = FileWriterType::New();
+  fileWriter->SetFileName( referenceFileName );
+  fileWriter->SetInput( image );
+  fileWriter->UseCompressionOn();
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+
+  FileReaderType::Pointer fileReader = FileReaderType::New();
+  fileReader->SetFileName( referenceFileName );
+
+  ReaderType::Pointer referenceReader = ReaderType::New();
+  referenceReader->SetFileName( referenceFileName );
+
+  itk::TimeProbe writerProbe;
+  itk::TimeProbe fileWriterProbe;
+  itk::TimeProbe readerProbe;
+  itk::TimeProbe fileReaderProbe;
+
+  try
+    {
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      fileWriterProbe.Start();
+      fileWriter->Update();
+      fileWriterProbe.Stop();
+
+      writerProbe.Start();
+      writer->Update();
+      writerProbe.Stop();
+
+      fileReader->Modified();
+      fileReaderProbe.Start();
+      fileReader->Update();
+      fileReaderProbe.Stop();
+
+      reader->Modified();
+      readerProbe.Start();
+      reader->Update();
+      readerProbe.Stop();
+      }
+
+    referenceReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned long fileLength = itksys::SystemTools::FileLength( fileName.c_str() );
+  const unsigned long referenceFileLength = itksys::SystemTools::FileLength( referenceFileName.c_str() );
+
+  std::cout << "Volume                      : " << size << ", " << megaBytes << " MB" << std::endl;
+  std::cout << "Chunks                      : " << writer->GetNumberOfChunks() << " on ";
+  std::cout << writer->GetNumberOfThreads() << " threads" << std::endl;
+  std::cout << "ImageFileWriter compression : " << fileWriterProbe.GetMean() << " s, ";
+  std::cout << megaBytes / fileWriterProbe.GetMean() << " MB/s, " << referenceFileLength << " bytes" << std::endl;
+  std::cout << "Chunked compression         : " << writerProbe.GetMean() << " s, ";
+  std::cout << megaBytes / writerProbe.GetMean() << " MB/s, " << fileLength << " bytes" << std::endl;
+  std::cout << "ImageFileReader             : " << fileReaderProbe.GetMean() << " s, ";
+  std::cout << megaBytes / fileReaderProbe.GetMean() << " MB/s" << std::endl;
+  std::cout << "Chunked decompression       : " << readerProbe.GetMean() << " s, ";
+  std::cout << megaBytes / readerProbe.GetMean() << " MB/s" << std::endl;
+
+  // The file of ImageFileWriter has no chunk table, and is read as is
+  if( referenceReader->GetIsChunkCompressed() )
+    {
+    std::cerr << "The file written by ImageFileWriter should not be read as chunks" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( CountDifferences( reader->GetOutput(), image ) > 0 ||
+      CountDifferences( referenceReader->GetOutput(), image ) > 0 )
+    {
+    std::cerr << "The pixels read differ from the volume written" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,333 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkDICOMSeriesIndexTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A synthetic volume is written as a DICOM series in a directory of its own.
+// The first index of the directory scans it and reads the headers, the
+// second one must load them from the index file and set up a reader with
+// the same sorted files, geometry and headers, that decodes the same pixels.
+// The index file must not be used when written in the second the directory
+// was last modified, once a file of the series is removed, or for other
+// series restrictions.
+
+#include "itkDICOMSeriesIndex.h"
+#include "itkGDCMImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMetaDataObject.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itksys/SystemTools.hxx"
+
+#include "gdcmUIDGenerator.h"
+
+#include <sstream>
+
+namespace
+{
+
+typedef itk::Image< signed short, 3 >             ImageType;
+typedef itk::DICOMSeriesIndex< ImageType >        IndexType;
+typedef IndexType::ReaderType                     ReaderType;
+
+IndexType::Pointer CreateIndex( const std::string & directory, bool restrictSeriesNumber )
+{
+  IndexType::Pointer index = IndexType::New();
+  index->SetDirectory( directory );
+  index->AddSeriesRestriction( "0008|0021" );
+  if( restrictSeriesNumber )
+    {
+    index->AddSeriesRestriction( "0020|0011" );
+    }
+  index->Update();
+  return index;
+}
+
+std::string GetTagValue( const itk::MetaDataDictionary & dict, const std::string & tag )
+{
+  std::string value;
+  itk::ExposeMetaData< std::string >( dict, tag, value );
+  return value;
+}
+
+}
+
+int itkDICOMSeriesIndexTest1( int argc, char * argv [] )
+{
+
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\toutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileWriter< ImageType >           WriterType;
+
+  const std::string directory = std::string( argv[1] ) + "/DICOMSeriesIndexTest1";
+
+  itksys::SystemTools::RemoveADirectory( directory.c_str() );
+  itksys::SystemTools::MakeDirectory( directory.c_str() );
+
+  ImageType::SizeType size;
+  size[0] = 16;
+  size[1] = 16;
+  size[2] = 12;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 0.7;
+  spacing[2] = 1.25;
+
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = -20.0;
+  origin[2] = 30.0;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const ImageType::IndexType & index = itr.GetIndex();
+    itr.Set( static_cast< signed short >( index[0] + 20 * index[1] + 500 * index[2] - 1024 ) );
+    }
+
+  //
+  // Write the slices of one series, slice z in the file number 5 z modulo 12.
+  //
+  gdcm::UIDGenerator uidGenerator;
+  const std::string studyUID = uidGenerator.Generate();
+  const std::string seriesUID = uidGenerator.Generate();
+
+  std::vector< std::string > sopInstanceUIDs( size[2] );
+  ReaderType::FileNamesContainer sliceFileNames( size[2] );
+
+  for( unsigned int z = 0; z < size[2]; z++ )
+    {
+    const unsigned int fileNumber = ( 5 * z ) % size[2];
+
+    std::ostringstream fileName;
+    fileName << directory << "/Slice" << fileNumber << ".dcm";
+    sliceFileNames[z] = fileName.str();
+
+    ImageType::RegionType sliceRegion = image->GetBufferedRegion();
+    sliceRegion.SetIndex( 2, z );
+    sliceRegion.SetSize( 2, 1 );
+
+    typedef itk::RegionOfInterestImageFilter< ImageType, ImageType > ExtractFilterType;
+    ExtractFilterType::Pointer extractor = ExtractFilterType::New();
+    extractor->SetInput( image );
+    extractor->SetRegionOfInterest( sliceRegion );
+
+    itk::GDCMImageIO::Pointer io = itk::GDCMImageIO::New();
+    io->KeepOriginalUIDOn();
+
+    sopInstanceUIDs[z] = uidGenerator.Generate();
+
+    try
+      {
+      extractor->Update();
+      ImageType::Pointer slice = extractor->GetOutput();
+      slice->DisconnectPipeline();
+
+      itk::MetaDataDictionary & dict = slice->GetMetaDataDictionary();
+      itk::EncapsulateMetaData< std::string >( dict, "0020|000d", studyUID );
+      itk::EncapsulateMetaData< std::string >( dict, "0020|000e", seriesUID );
+      itk::EncapsulateMetaData< std::string >( dict, "0008|0018", sopInstanceUIDs[z] );
+
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetImageIO( io );
+      writer->SetInput( slice );
+      writer->SetFileName( fileName.str() );
+      writer->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  //
+  // First index: the directory is scanned and the headers are read.
+  //
+  IndexType::Pointer scannedIndex;
+  ReaderType::Pointer scannedReader;
+
+  try
+    {
+    scannedIndex = CreateIndex( directory, false );
+
+    if( scannedIndex->GetIndexFileWasLoaded() || scannedIndex->GetSeriesUIDs().size() != 1 )
+      {
+      std::cerr << "Expected the directory to be scanned and to hold one series, got ";
+      std::cerr << scannedIndex->GetSeriesUIDs().size() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // Modification times only count seconds, and creating the index file
+    // modified the directory in the second of the scan: the index file is
+    // out of date until the directory is scanned again in a later second.
+    itksys::SystemTools::Delay( 1100 );
+
+    scannedIndex->Update();
+
+    if( scannedIndex->GetIndexFileWasLoaded() || scannedIndex->GetSeriesUIDs().size() != 1 )
+      {
+      std::cerr << "Expected the index file written in the second of the scan to be out of date" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    scannedReader = scannedIndex->GetSeriesReader( scannedIndex->GetSeriesUIDs()[0] );
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( scannedReader->GetSortedFileNames() != sliceFileNames )
+    {
+    std::cerr << "The files are not sorted by slice position" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Second index: loaded from the index file.
+  //
+  IndexType::Pointer loadedIndex;
+  ReaderType::Pointer loadedReader;
+
+  try
+    {
+    loadedIndex = CreateIndex( directory, false );
+
+    if( !loadedIndex->GetIndexFileWasLoaded() )
+      {
+      std::cerr << "The index file was not loaded" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    loadedReader = loadedIndex->GetSeriesReader( loadedIndex->GetSeriesUIDs()[0] );
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const ImageType * scannedOutput = scannedReader->GetOutput();
+  const ImageType * loadedOutput = loadedReader->GetOutput();
+
+  if( loadedIndex->GetSeriesUIDs() != scannedIndex->GetSeriesUIDs() ||
+      loadedReader->GetSortedFileNames() != sliceFileNames ||
+      loadedOutput->GetLargestPossibleRegion() != scannedOutput->GetLargestPossibleRegion() ||
+      loadedOutput->GetSpacing() != scannedOutput->GetSpacing() ||
+      loadedOutput->GetOrigin() != scannedOutput->GetOrigin() ||
+      loadedOutput->GetDirection() != scannedOutput->GetDirection() )
+    {
+    std::cerr << "The loaded series differs from the scanned one" << std::endl;
+    loadedReader->Print( std::cerr );
+    scannedReader->Print( std::cerr );
+    return EXIT_FAILURE;
+    }
+
+  for( unsigned int z = 0; z < size[2]; z++ )
+    {
+    const itk::MetaDataDictionary & dict = loadedReader->GetSliceMetaDataDictionary( z );
+
+    if( GetTagValue( dict, "0008|0018" ) != sopInstanceUIDs[z] ||
+        GetTagValue( dict, "0020|0032" ) !=
+        GetTagValue( scannedReader->GetSliceMetaDataDictionary( z ), "0020|0032" ) )
+      {
+      std::cerr << "The loaded header of the slice " << z << " differs from the scanned one" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  try
+    {
+    loadedReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > otr( loadedOutput, loadedOutput->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+
+  for( otr.GoToBegin(); !otr.IsAtEnd(); ++otr )
+    {
+    if( otr.Get() != image->GetPixel( otr.GetIndex() ) )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels differ from the volume written" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Out of date index files: a slice removed, other series restrictions.
+  //
+  itksys::SystemTools::RemoveFile( sliceFileNames[3].c_str() );
+
+  try
+    {
+    IndexType::Pointer index = CreateIndex( directory, false );
+
+    if( index->GetIndexFileWasLoaded() )
+      {
+      std::cerr << "The index file was loaded after a slice was removed" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    ReaderType::Pointer reader = index->GetSeriesReader( index->GetSeriesUIDs()[0] );
+
+    if( reader->GetNumberOfSlices() != size[2] - 1 )
+      {
+      std::cerr << "Expected " << size[2] - 1 << " slices, got " << reader->GetNumberOfSlices() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    index = CreateIndex( directory, true );
+
+    if( index->GetIndexFileWasLoaded() )
+      {
+      std::cerr << "The index file was loaded for other series restrictions" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  loadedIndex->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkDICOMSeriesRegionReaderTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A synthetic volume is written as a DICOM series, one file per slice, with
+// file names that do not follow the slice order. The reader must sort the
+// files and recover the geometry from their headers without decoding any
+// slice, then decode only the slices of the requested region, whole. The
+// whole series is then decoded on one thread and on several threads.
+
+#include "itkDICOMSeriesRegionReader.h"
+#include "itkGDCMImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkRegionOfInterestImageFilter.h"
+
+#include <sstream>
+
+int itkDICOMSeriesRegionReaderTest1( int argc, char * argv [] )
+{
+
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\toutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+
+  typedef itk::Image< signed short, Dimension >       ImageType;
+  typedef itk::ImageFileWriter< ImageType >           WriterType;
+  typedef itk::DICOMSeriesRegionReader< ImageType >   ReaderType;
+
+  ImageType::SizeType size;
+  size[0] = 32;
+  size[1] = 24;
+  size[2] = 20;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 0.7;
+  spacing[2] = 2.5;
+
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = -20.0;
+  origin[2] = 30.0;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const ImageType::IndexType & index = itr.GetIndex();
+    itr.Set( static_cast< signed short >( index[0] + 40 * index[1] + 1000 * index[2] - 1024 ) );
+    }
+
+  //
+  // Write the slices, slice z in the file number 7 z modulo 20.
+  //
+  ReaderType::FileNamesContainer fileNames( size[2] );
+  ReaderType::FileNamesContainer sliceFileNames( size[2] );
+
+  for( unsigned int z = 0; z < size[2]; z++ )
+    {
+    const unsigned int fileNumber = ( 7 * z ) % size[2];
+
+    std::ostringstream fileName;
+    fileName << argv[1] << "/DICOMSeriesRegionReaderTest1_" << fileNumber << ".dcm";
+
+    fileNames[fileNumber] = fileName.str();
+    sliceFileNames[z] = fileName.str();
+
+    ImageType::RegionType sliceRegion = image->GetBufferedRegion();
+    sliceRegion.SetIndex( 2, z );
+    sliceRegion.SetSize( 2, 1 );
+
+    typedef itk::RegionOfInterestImageFilter< ImageType, ImageType > ExtractFilterType;
+    ExtractFilterType::Pointer extractor = ExtractFilterType::New();
+    extractor->SetInput( image );
+    extractor->SetRegionOfInterest( sliceRegion );
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetImageIO( itk::GDCMImageIO::New() );
+    writer->SetInput( extractor->GetOutput() );
+    writer->SetFileName( fileName.str() );
+
+    try
+      {
+      writer->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  //
+  // Headers only.
+  //
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames( fileNames );
+
+  try
+    {
+    reader->UpdateOutputInformation();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const ImageType * output = reader->GetOutput();
+
+  if( output->GetLargestPossibleRegion() != image->GetLargestPossibleRegion() )
+    {
+    std::cerr << "Expected the region " << image->GetLargestPossibleRegion();
+    std::cerr << " got " << output->GetLargestPossibleRegion() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for( unsigned int d = 0; d < Dimension; d++ )
+    {
+    if( vnl_math_abs( output->GetSpacing()[d] - spacing[d] ) > 1e-3 ||
+        vnl_math_abs( output->GetOrigin()[d] - origin[d] ) > 1e-3 )
+      {
+      std::cerr << "Expected the spacing " << spacing << " and the origin " << origin;
+      std::cerr << " got " << output->GetSpacing() << " and " << output->GetOrigin() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  if( reader->GetSortedFileNames() != sliceFileNames )
+    {
+    std::cerr << "The files are not sorted by slice position" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( reader->GetNumberOfSlicesRead() != 0 )
+    {
+    std::cerr << "Slices were decoded to read the headers" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Slices 5 to 9 of a small region. The slices are read whole.
+  //
+  ImageType::RegionType requestedRegion;
+  requestedRegion.SetIndex( 0, 4 );
+  requestedRegion.SetIndex( 1, 6 );
+  requestedRegion.SetIndex( 2, 5 );
+  requestedRegion.SetSize( 0, 8 );
+  requestedRegion.SetSize( 1, 8 );
+  requestedRegion.SetSize( 2, 5 );
+
+  ImageType::RegionType expectedRegion = image->GetLargestPossibleRegion();
+  expectedRegion.SetIndex( 2, 5 );
+  expectedRegion.SetSize( 2, 5 );
+
+  try
+    {
+    reader->GetOutput()->SetRequestedRegion( requestedRegion );
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( output->GetBufferedRegion() != expectedRegion )
+    {
+    std::cerr << "Expected the buffered region " << expectedRegion;
+    std::cerr << " got " << output->GetBufferedRegion() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( reader->GetNumberOfSlicesRead() != 5 )
+    {
+    std::cerr << "Expected 5 slices read, got " << reader->GetNumberOfSlicesRead() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > otr( output, expectedRegion );
+
+  unsigned long numberOfDifferences = 0;
+
+  for( otr.GoToBegin(); !otr.IsAtEnd(); ++otr )
+    {
+    if( otr.Get() != image->GetPixel( otr.GetIndex() ) )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels differ from the volume written" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Whole series, the slices shared among the threads or not.
+  //
+  const unsigned int numberOfThreads[2] = { 1, 4 };
+
+  for( unsigned int t = 0; t < 2; t++ )
+    {
+    ReaderType::Pointer seriesReader = ReaderType::New();
+    seriesReader->SetFileNames( fileNames );
+    seriesReader->SetNumberOfThreads( numberOfThreads[t] );
+
+    try
+      {
+      seriesReader->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const ImageType * seriesImage = seriesReader->GetOutput();
+
+    if( seriesImage->GetBufferedRegion() != image->GetBufferedRegion() ||
+        seriesReader->GetNumberOfSlicesRead() != size[2] )
+      {
+      std::cerr << "The series read on " << numberOfThreads[t] << " threads has the region ";
+      std::cerr << seriesImage->GetBufferedRegion() << " from ";
+      std::cerr << seriesReader->GetNumberOfSlicesRead() << " slices" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::ImageRegionConstIteratorWithIndex< ImageType > str( seriesImage, seriesImage->GetBufferedRegion() );
+
+    for( str.GoToBegin(); !str.IsAtEnd(); ++str )
+      {
+      if( str.Get() != image->GetPixel( str.GetIndex() ) )
+        {
+        ++numberOfDifferences;
+        }
+      }
+
+    if( numberOfDifferences > 0 )
+      {
+      std::cerr << numberOfDifferences << " pixels of the series read on " << numberOfThreads[t];
+      std::cerr << " threads differ from the volume written" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  reader->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
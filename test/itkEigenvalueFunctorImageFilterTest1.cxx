@@ -0,0 +1,248 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkEigenvalueFunctorImageFilterTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Checks the scanline evaluation of the Descoteaux, Frangi and local
+// structure filters against the per pixel operator() of their functors,
+// in double and in single precision, and reports the runtimes.
+
+#include "itkDescoteauxSheetnessImageFilter.h"
+#include "itkFrangiTubularnessImageFilter.h"
+#include "itkLocalStructureImageFilter.h"
+#include "itkHessianRecursiveGaussianImageFilter.h"
+#include "itkSymmetricEigenAnalysisImageFilter.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+
+template< class TFilter, class TEigenValueImage >
+int CompareWithFunctor( TFilter * filter, const TEigenValueImage * eigenValues,
+                        double doubleTolerance, double singleTolerance )
+{
+  typedef typename TFilter::OutputImageType       OutputImageType;
+  typedef typename TFilter::FunctorType           FunctorType;
+
+  typedef itk::ImageRegionConstIterator< TEigenValueImage >  EigenIteratorType;
+  typedef itk::ImageRegionConstIterator< OutputImageType >   OutputIteratorType;
+
+  FunctorType functor = filter->GetFunctor();
+
+  for( unsigned int precision = 0; precision < 2; precision++ )
+    {
+    const bool single = ( precision == 1 );
+
+    filter->SetUseSinglePrecision( single );
+
+    itk::TimeProbe probe;
+
+    try
+      {
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    EigenIteratorType eit( eigenValues, eigenValues->GetBufferedRegion() );
+    OutputIteratorType oit( filter->GetOutput(), filter->GetOutput()->GetBufferedRegion() );
+
+    double maximumDifference = 0.0;
+    unsigned long numberOfNaNMismatches = 0;
+
+    for( eit.GoToBegin(), oit.GoToBegin(); !eit.IsAtEnd(); ++eit, ++oit )
+      {
+      const double expected = functor( eit.Get() );
+      const double value = oit.Get();
+
+      // Both paths must produce NaN for the same pixels.
+      if( vnl_math_isnan( expected ) || vnl_math_isnan( value ) )
+        {
+        if( vnl_math_isnan( expected ) != vnl_math_isnan( value ) )
+          {
+          ++numberOfNaNMismatches;
+          }
+        continue;
+        }
+
+      const double difference = vnl_math_abs( expected - value );
+      if( difference > maximumDifference )
+        {
+        maximumDifference = difference;
+        }
+      }
+
+    const double tolerance = single ? singleTolerance : doubleTolerance;
+
+    std::cout << filter->GetNameOfClass();
+    std::cout << ( single ? " float  " : " double " );
+    std::cout << probe.GetMean() << " s  maximum difference ";
+    std::cout << maximumDifference << std::endl;
+
+    if( numberOfNaNMismatches > 0 )
+      {
+      std::cerr << filter->GetNameOfClass() << " and its functor disagree on NaN at ";
+      std::cerr << numberOfNaNMismatches << " pixels" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if( maximumDifference > tolerance )
+      {
+      std::cerr << filter->GetNameOfClass() << " differs from its functor by ";
+      std::cerr << maximumDifference << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkEigenvalueFunctorImageFilterTest1( int argc, char * argv [] )
+{
+
+  if( argc < 3 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << " inputImage outputImage [sigma doubleTolerance floatTolerance]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+
+  typedef signed short    InputPixelType;
+  typedef float           OutputPixelType;
+
+  typedef itk::Image< InputPixelType,  Dimension >   InputImageType;
+  typedef itk::Image< OutputPixelType, Dimension >   OutputImageType;
+
+  typedef itk::HessianRecursiveGaussianImageFilter< InputImageType >  HessianFilterType;
+  typedef HessianFilterType::OutputImageType                          HessianImageType;
+  typedef HessianImageType::PixelType                                 HessianPixelType;
+
+  typedef  itk::FixedArray< double, HessianPixelType::Dimension >     EigenValueArrayType;
+  typedef  itk::Image< EigenValueArrayType, Dimension >               EigenValueImageType;
+
+  typedef  itk::SymmetricEigenAnalysisImageFilter<
+    HessianImageType, EigenValueImageType >     EigenAnalysisFilterType;
+
+  typedef itk::DescoteauxSheetnessImageFilter< EigenValueImageType, OutputImageType >  SheetnessFilterType;
+  typedef itk::FrangiTubularnessImageFilter< EigenValueImageType, OutputImageType >    TubularnessFilterType;
+  typedef itk::LocalStructureImageFilter< EigenValueImageType, OutputImageType >       LocalStructureFilterType;
+
+  typedef itk::ImageFileReader< InputImageType >     ReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >    WriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( reader->GetOutput() );
+
+  EigenAnalysisFilterType::Pointer eigen = EigenAnalysisFilterType::New();
+  eigen->SetInput( hessian->GetOutput() );
+  eigen->SetDimension( Dimension );
+
+  double doubleTolerance = 1e-6;
+  double singleTolerance = 1e-3;
+
+  if( argc > 3 )
+    {
+    hessian->SetSigma( atof( argv[3] ) );
+    }
+
+  if( argc > 4 )
+    {
+    doubleTolerance = atof( argv[4] );
+    }
+
+  if( argc > 5 )
+    {
+    singleTolerance = atof( argv[5] );
+    }
+
+  try
+    {
+    eigen->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  SheetnessFilterType::Pointer sheetness = SheetnessFilterType::New();
+  sheetness->SetInput( eigen->GetOutput() );
+  sheetness->SetSheetnessNormalization( 0.5 );
+  sheetness->SetBloobinessNormalization( 2.0 );
+  sheetness->SetNoiseNormalization( 50.0 );
+
+  TubularnessFilterType::Pointer tubularness = TubularnessFilterType::New();
+  tubularness->SetInput( eigen->GetOutput() );
+  tubularness->SetSheetnessNormalization( 0.5 );
+  tubularness->SetBloobinessNormalization( 0.5 );
+  tubularness->SetNoiseNormalization( 50.0 );
+
+  LocalStructureFilterType::Pointer localStructure = LocalStructureFilterType::New();
+  localStructure->SetInput( eigen->GetOutput() );
+  localStructure->SetAlpha( 0.25 );
+  localStructure->SetGamma( 0.5 );
+
+  if( CompareWithFunctor( sheetness.GetPointer(), eigen->GetOutput(),
+                          doubleTolerance, singleTolerance ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  if( CompareWithFunctor( tubularness.GetPointer(), eigen->GetOutput(),
+                          doubleTolerance, singleTolerance ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The local structure measure is not normalized, it scales with the
+  // magnitude of the eigenvalues.
+  if( CompareWithFunctor( localStructure.GetPointer(), eigen->GetOutput(),
+                          doubleTolerance, singleTolerance * 100.0 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  localStructure->Print( std::cout );
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[2] );
+  writer->SetInput( sheetness->GetOutput() );
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,263 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkFastMarchingSegmentationModuleTest2.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The fast marching module only rescales the region reached by the front.
+// Its output is compared against fast marching followed by windowing and
+// intensity inversion over the whole image. The module is then run with a
+// cropped output, which must cover the padded reached region and hold the
+// same values.
+
+#include "itkFastMarchingSegmentationModule.h"
+#include "itkFastMarchingImageFilter.h"
+#include "itkIntensityWindowingImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImage.h"
+#include "itkSpatialObject.h"
+#include "itkImageSpatialObject.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+
+int itkFastMarchingSegmentationModuleTest2( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tfeatureImage\n\toutputImage ";
+    std::cerr << "\n\t[stopping time for fast marching]";
+    std::cerr << "\n\t[distance from seeds for fast marching]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+  typedef itk::FastMarchingSegmentationModule< Dimension >   SegmentationModuleType;
+
+  typedef SegmentationModuleType::FeatureImageType     FeatureImageType;
+  typedef SegmentationModuleType::OutputImageType      OutputImageType;
+  typedef SegmentationModuleType::RegionType           RegionType;
+
+  typedef itk::ImageFileReader< FeatureImageType >     FeatureReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >      OutputWriterType;
+
+  typedef itk::LandmarksReader< Dimension >    LandmarksReaderType;
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+
+  FeatureReaderType::Pointer featureReader = FeatureReaderType::New();
+  featureReader->SetFileName( argv[2] );
+  try
+    {
+    featureReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double stoppingTime = (argc > 4) ? atof( argv[4] ) : 10.0;
+  const double distanceFromSeeds = (argc > 5) ? atof( argv[5] ) : 5.0;
+
+  FeatureImageType::Pointer featureImage = featureReader->GetOutput();
+  featureImage->DisconnectPipeline();
+
+  //
+  // Reference: fast marching, windowing and inversion over the whole image.
+  //
+  typedef itk::FastMarchingImageFilter< FeatureImageType, OutputImageType >  FastMarchingFilterType;
+  typedef FastMarchingFilterType::NodeContainer                              NodeContainer;
+  typedef FastMarchingFilterType::NodeType                                   NodeType;
+
+  typedef SegmentationModuleType::InputSpatialObjectType   InputSpatialObjectType;
+  typedef InputSpatialObjectType::PointListType            PointListType;
+
+  const InputSpatialObjectType * landmarks = landmarksReader->GetOutput();
+  const PointListType & points = landmarks->GetPoints();
+
+  NodeContainer::Pointer trialPoints = NodeContainer::New();
+
+  for( unsigned int i = 0; i < landmarks->GetNumberOfPoints(); i++ )
+    {
+    FeatureImageType::IndexType index;
+    featureImage->TransformPhysicalPointToIndex( points[i].GetPosition(), index );
+
+    NodeType node;
+    node.SetValue( -distanceFromSeeds );
+    node.SetIndex( index );
+    trialPoints->InsertElement( i, node );
+    }
+
+  FastMarchingFilterType::Pointer fastMarching = FastMarchingFilterType::New();
+  fastMarching->SetInput( featureImage );
+  fastMarching->SetTrialPoints( trialPoints );
+  fastMarching->SetStoppingValue( stoppingTime );
+
+  typedef itk::IntensityWindowingImageFilter< OutputImageType, OutputImageType > WindowingFilterType;
+  WindowingFilterType::Pointer windowing = WindowingFilterType::New();
+  windowing->SetInput( fastMarching->GetOutput() );
+  windowing->SetWindowMinimum( -distanceFromSeeds );
+  windowing->SetWindowMaximum( stoppingTime );
+  windowing->SetOutputMinimum( -4.0 );
+  windowing->SetOutputMaximum(  4.0 );
+  windowing->Update();
+
+  typedef itk::MinimumMaximumImageCalculator< OutputImageType > CalculatorType;
+  CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage( windowing->GetOutput() );
+  calculator->Compute();
+
+  WindowingFilterType::Pointer inverter = WindowingFilterType::New();
+  inverter->SetInput( windowing->GetOutput() );
+  inverter->SetWindowMinimum( calculator->GetMinimum() );
+  inverter->SetWindowMaximum( calculator->GetMaximum() );
+  inverter->SetOutputMinimum(  4.0 );
+  inverter->SetOutputMaximum( -4.0 );
+  inverter->Update();
+
+  OutputImageType::ConstPointer reference = inverter->GetOutput();
+
+  //
+  // Module with the output rescaled over the reached region only.
+  //
+  typedef SegmentationModuleType::FeatureSpatialObjectType        FeatureSpatialObjectType;
+  typedef SegmentationModuleType::OutputSpatialObjectType         OutputSpatialObjectType;
+
+  FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+  featureObject->SetImage( featureImage );
+
+  SegmentationModuleType::Pointer  segmentationModule = SegmentationModuleType::New();
+  segmentationModule->SetFeature( featureObject );
+  segmentationModule->SetInput( landmarks );
+  segmentationModule->SetStoppingValue( stoppingTime );
+  segmentationModule->SetDistanceFromSeeds( distanceFromSeeds );
+
+  try
+    {
+    segmentationModule->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const RegionType reachedRegion = segmentationModule->GetReachedRegion();
+
+  std::cout << "Reached region " << reachedRegion << std::endl;
+
+  OutputImageType::ConstPointer outputImage =
+    dynamic_cast< const OutputSpatialObjectType * >( segmentationModule->GetOutput() )->GetImage();
+
+  if( outputImage->GetBufferedRegion() != reference->GetBufferedRegion() )
+    {
+    std::cerr << "Output region " << outputImage->GetBufferedRegion() << std::endl;
+    std::cerr << "differs from the feature image region" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageRegionConstIterator< OutputImageType > IteratorType;
+
+  const double tolerance = 1e-4;
+
+  IteratorType rit( reference, reference->GetBufferedRegion() );
+  IteratorType oit( outputImage, outputImage->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+
+  for( rit.GoToBegin(), oit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++oit )
+    {
+    if( vnl_math_abs( rit.Get() - oit.Get() ) > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels differ from the full image rescaling" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  OutputWriterType::Pointer writer = OutputWriterType::New();
+
+  writer->SetFileName( argv[3] );
+  writer->SetInput( outputImage );
+  writer->UseCompressionOn();
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Cropped output, without inversion.
+  //
+  segmentationModule->CropOutputToReachedRegionOn();
+  segmentationModule->InvertOutputIntensitiesOff();
+
+  try
+    {
+    segmentationModule->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  OutputImageType::ConstPointer croppedImage =
+    dynamic_cast< const OutputSpatialObjectType * >( segmentationModule->GetOutput() )->GetImage();
+
+  RegionType expectedRegion = reachedRegion;
+  expectedRegion.PadByRadius( segmentationModule->GetReachedRegionMargin() );
+  expectedRegion.Crop( featureImage->GetLargestPossibleRegion() );
+
+  if( croppedImage->GetBufferedRegion() != expectedRegion )
+    {
+    std::cerr << "Cropped output region " << croppedImage->GetBufferedRegion() << std::endl;
+    std::cerr << "expected " << expectedRegion << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  IteratorType wit( windowing->GetOutput(), expectedRegion );
+  IteratorType cit( croppedImage, expectedRegion );
+
+  for( wit.GoToBegin(), cit.GoToBegin(); !wit.IsAtEnd(); ++wit, ++cit )
+    {
+    if( vnl_math_abs( wit.Get() - cit.Get() ) > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels of the cropped output differ" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  segmentationModule->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,271 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkFastMarchingSegmentationModuleTest3.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The fast marching module segments the seeds for a list of stopping values
+// from a single propagation of the front. Each output is compared against a
+// module run on its own with that stopping value. The same module is then
+// updated with a smaller stopping value and distance from seeds, which only
+// rescales the cached arrival times.
+
+#include "itkFastMarchingSegmentationModule.h"
+#include "itkImage.h"
+#include "itkSpatialObject.h"
+#include "itkImageSpatialObject.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+
+typedef itk::FastMarchingSegmentationModule< 3 >   SegmentationModuleType;
+typedef SegmentationModuleType::OutputImageType      OutputImageType;
+
+unsigned long CountDifferences( const OutputImageType * image1, const OutputImageType * image2 )
+{
+  if( image1->GetBufferedRegion() != image2->GetBufferedRegion() )
+    {
+    return image1->GetBufferedRegion().GetNumberOfPixels();
+    }
+
+  typedef itk::ImageRegionConstIterator< OutputImageType > IteratorType;
+
+  IteratorType itr1( image1, image1->GetBufferedRegion() );
+  IteratorType itr2( image2, image2->GetBufferedRegion() );
+
+  const double tolerance = 1e-4;
+
+  unsigned long numberOfDifferences = 0;
+
+  for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+    {
+    if( vnl_math_abs( itr1.Get() - itr2.Get() ) > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  return numberOfDifferences;
+}
+
+}
+
+int itkFastMarchingSegmentationModuleTest3( int argc, char * argv [] )
+{
+
+  if( argc < 6 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tfeatureImage\n\toutputImage ";
+    std::cerr << "\n\tdistance from seeds for fast marching";
+    std::cerr << "\n\tstopping time for fast marching";
+    std::cerr << "\n\t[more stopping times for fast marching]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef SegmentationModuleType::FeatureImageType     FeatureImageType;
+
+  typedef itk::ImageFileReader< FeatureImageType >     FeatureReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >      OutputWriterType;
+
+  typedef itk::LandmarksReader< 3 >    LandmarksReaderType;
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+
+  FeatureReaderType::Pointer featureReader = FeatureReaderType::New();
+  featureReader->SetFileName( argv[2] );
+  try
+    {
+    featureReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double distanceFromSeeds = atof( argv[4] );
+
+  SegmentationModuleType::StoppingValueListType stoppingValues;
+  for( int i = 5; i < argc; i++ )
+    {
+    stoppingValues.push_back( atof( argv[i] ) );
+    }
+
+  typedef SegmentationModuleType::FeatureSpatialObjectType        FeatureSpatialObjectType;
+  typedef SegmentationModuleType::OutputSpatialObjectType         OutputSpatialObjectType;
+  typedef SegmentationModuleType::OutputSpatialObjectListType     OutputSpatialObjectListType;
+
+  FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+  featureObject->SetImage( featureReader->GetOutput() );
+
+  const SegmentationModuleType::InputSpatialObjectType * landmarks = landmarksReader->GetOutput();
+
+  //
+  // All the stopping values from a single propagation.
+  //
+  SegmentationModuleType::Pointer  sweepModule = SegmentationModuleType::New();
+  sweepModule->SetFeature( featureObject );
+  sweepModule->SetInput( landmarks );
+  sweepModule->SetDistanceFromSeeds( distanceFromSeeds );
+
+  OutputSpatialObjectListType sweepOutputs;
+
+  itk::TimeProbe sweepProbe;
+
+  try
+    {
+    sweepProbe.Start();
+    sweepModule->GenerateStoppingValueSweep( stoppingValues, sweepOutputs );
+    sweepProbe.Stop();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( sweepOutputs.size() != stoppingValues.size() )
+    {
+    std::cerr << "Expected " << stoppingValues.size() << " outputs, got ";
+    std::cerr << sweepOutputs.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // One module update per stopping value.
+  //
+  itk::TimeProbe separateProbe;
+
+  for( unsigned int i = 0; i < stoppingValues.size(); i++ )
+    {
+    SegmentationModuleType::Pointer  segmentationModule = SegmentationModuleType::New();
+    segmentationModule->SetFeature( featureObject );
+    segmentationModule->SetInput( landmarks );
+    segmentationModule->SetDistanceFromSeeds( distanceFromSeeds );
+    segmentationModule->SetStoppingValue( stoppingValues[i] );
+    segmentationModule->CacheArrivalTimesOff();
+
+    try
+      {
+      separateProbe.Start();
+      segmentationModule->Update();
+      separateProbe.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const OutputImageType * expected =
+      dynamic_cast< const OutputSpatialObjectType * >( segmentationModule->GetOutput() )->GetImage();
+
+    const unsigned long numberOfDifferences =
+      CountDifferences( sweepOutputs[i]->GetImage(), expected );
+
+    if( numberOfDifferences > 0 )
+      {
+      std::cerr << "Stopping value " << stoppingValues[i] << " : ";
+      std::cerr << numberOfDifferences << " pixels differ from a separate update" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Sweep over " << stoppingValues.size() << " stopping values : ";
+  std::cout << sweepProbe.GetMean() << " s" << std::endl;
+  std::cout << "Separate updates : " << separateProbe.GetTotal() << " s" << std::endl;
+
+  //
+  // Smaller stopping value and distance on the module holding the cache.
+  //
+  const double stoppingValue = 0.5 * stoppingValues[0];
+  const double smallerDistance = 0.5 * distanceFromSeeds;
+
+  sweepModule->SetStoppingValue( stoppingValue );
+  sweepModule->SetDistanceFromSeeds( smallerDistance );
+
+  SegmentationModuleType::Pointer  referenceModule = SegmentationModuleType::New();
+  referenceModule->SetFeature( featureObject );
+  referenceModule->SetInput( landmarks );
+  referenceModule->SetStoppingValue( stoppingValue );
+  referenceModule->SetDistanceFromSeeds( smallerDistance );
+
+  itk::TimeProbe cachedProbe;
+  itk::TimeProbe referenceProbe;
+
+  try
+    {
+    cachedProbe.Start();
+    sweepModule->Update();
+    cachedProbe.Stop();
+
+    referenceProbe.Start();
+    referenceModule->Update();
+    referenceProbe.Stop();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Update from the cache : " << cachedProbe.GetMean() << " s" << std::endl;
+  std::cout << "Update with a new solve : " << referenceProbe.GetMean() << " s" << std::endl;
+
+  const OutputImageType * cachedImage =
+    dynamic_cast< const OutputSpatialObjectType * >( sweepModule->GetOutput() )->GetImage();
+  const OutputImageType * referenceImage =
+    dynamic_cast< const OutputSpatialObjectType * >( referenceModule->GetOutput() )->GetImage();
+
+  const unsigned long numberOfDifferences = CountDifferences( cachedImage, referenceImage );
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels of the update from the cache differ" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( sweepModule->GetReachedRegion() != referenceModule->GetReachedRegion() )
+    {
+    std::cerr << "Reached region from the cache " << sweepModule->GetReachedRegion() << std::endl;
+    std::cerr << "differs from " << referenceModule->GetReachedRegion() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  OutputWriterType::Pointer writer = OutputWriterType::New();
+
+  writer->SetFileName( argv[3] );
+  writer->SetInput( cachedImage );
+  writer->UseCompressionOn();
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  sweepModule->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
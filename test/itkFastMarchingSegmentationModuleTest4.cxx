@@ -0,0 +1,313 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkFastMarchingSegmentationModuleTest4.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The fast marching module writes its inverted output in a single pass over
+// the pixels, with and without cropping. The output is compared against the
+// arrival times windowed, scanned and inverted by separate filters. The fast
+// marching and geodesic active contour module must rescale the fast marching
+// output once, and scan and invert the level set once.
+
+#include "itkFastMarchingSegmentationModule.h"
+#include "itkFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkFastMarchingImageFilter.h"
+#include "itkIntensityWindowingImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+
+namespace
+{
+
+typedef itk::FastMarchingSegmentationModule< 3 >   SegmentationModuleType;
+typedef SegmentationModuleType::OutputImageType      OutputImageType;
+typedef SegmentationModuleType::OutputSpatialObjectType  OutputSpatialObjectType;
+
+const OutputImageType * GetOutputImage( const itk::SegmentationModule< 3 > * module )
+{
+  return dynamic_cast< const OutputSpatialObjectType * >( module->GetOutput() )->GetImage();
+}
+
+// Compares the image over its buffered region with the same region of the
+// reference.
+unsigned long CountDifferences( const OutputImageType * image, const OutputImageType * reference )
+{
+  typedef itk::ImageRegionConstIterator< OutputImageType > IteratorType;
+
+  IteratorType itr1( image, image->GetBufferedRegion() );
+  IteratorType itr2( reference, image->GetBufferedRegion() );
+
+  const double tolerance = 1e-4;
+
+  unsigned long numberOfDifferences = 0;
+
+  for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+    {
+    if( vnl_math_abs( itr1.Get() - itr2.Get() ) > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  return numberOfDifferences;
+}
+
+bool CheckPasses( const char * name, const SegmentationModuleType::Superclass * module,
+  unsigned int expectedScans, unsigned int expectedRescalings )
+{
+  std::cout << name << " : " << module->GetNumberOfIntensityScans() << " scans, ";
+  std::cout << module->GetNumberOfIntensityRescalings() << " rescalings" << std::endl;
+
+  if( module->GetNumberOfIntensityScans() != expectedScans ||
+      module->GetNumberOfIntensityRescalings() != expectedRescalings )
+    {
+    std::cerr << name << " expected " << expectedScans << " scans and ";
+    std::cerr << expectedRescalings << " rescalings" << std::endl;
+    return false;
+    }
+
+  return true;
+}
+
+}
+
+int itkFastMarchingSegmentationModuleTest4( int argc, char * argv [] )
+{
+
+  if( argc < 6 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tfeatureImage\n\toutputImage ";
+    std::cerr << "\n\tstopping time for fast marching";
+    std::cerr << "\n\tdistance from seeds for fast marching";
+    std::cerr << "\n\t[maximum number of iterations of the level set]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef SegmentationModuleType::FeatureImageType     FeatureImageType;
+
+  typedef itk::ImageFileReader< FeatureImageType >     FeatureReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >      OutputWriterType;
+
+  typedef itk::LandmarksReader< 3 >    LandmarksReaderType;
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+
+  FeatureReaderType::Pointer featureReader = FeatureReaderType::New();
+  featureReader->SetFileName( argv[2] );
+  try
+    {
+    featureReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double stoppingValue = atof( argv[4] );
+  const double distanceFromSeeds = atof( argv[5] );
+  const unsigned int maximumNumberOfIterations = (argc > 6) ? atoi( argv[6] ) : 10;
+
+  const FeatureImageType * featureImage = featureReader->GetOutput();
+
+  typedef SegmentationModuleType::FeatureSpatialObjectType        FeatureSpatialObjectType;
+
+  FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+  featureObject->SetImage( featureImage );
+
+  const SegmentationModuleType::InputSpatialObjectType * landmarks = landmarksReader->GetOutput();
+
+  //
+  // Reference: arrival times windowed, scanned and inverted by filters.
+  //
+  typedef itk::FastMarchingImageFilter< FeatureImageType, OutputImageType >   FastMarchingFilterType;
+  typedef FastMarchingFilterType::NodeContainer                             NodeContainer;
+  typedef FastMarchingFilterType::NodeType                                  NodeType;
+
+  NodeContainer::Pointer trialPoints = NodeContainer::New();
+
+  for( unsigned int i = 0; i < landmarks->GetNumberOfPoints(); i++ )
+    {
+    FeatureImageType::IndexType index;
+    featureImage->TransformPhysicalPointToIndex( landmarks->GetPoints()[i].GetPosition(), index );
+
+    NodeType node;
+    node.SetValue( 0.0 );
+    node.SetIndex( index );
+    trialPoints->InsertElement( i, node );
+    }
+
+  const double arrivalTime = stoppingValue + distanceFromSeeds;
+
+  FastMarchingFilterType::Pointer fastMarching = FastMarchingFilterType::New();
+  fastMarching->SetInput( featureImage );
+  fastMarching->SetTrialPoints( trialPoints );
+  fastMarching->SetStoppingValue( arrivalTime );
+
+  typedef itk::IntensityWindowingImageFilter< OutputImageType, OutputImageType > WindowingFilterType;
+  WindowingFilterType::Pointer windowing = WindowingFilterType::New();
+  windowing->SetInput( fastMarching->GetOutput() );
+  windowing->SetWindowMinimum( 0.0 );
+  windowing->SetWindowMaximum( arrivalTime );
+  windowing->SetOutputMinimum( -4.0 );
+  windowing->SetOutputMaximum(  4.0 );
+
+  typedef itk::MinimumMaximumImageCalculator< OutputImageType > CalculatorType;
+  CalculatorType::Pointer calculator = CalculatorType::New();
+
+  WindowingFilterType::Pointer inverter = WindowingFilterType::New();
+  inverter->SetInput( windowing->GetOutput() );
+  inverter->SetOutputMinimum(  4.0 );
+  inverter->SetOutputMaximum( -4.0 );
+
+  try
+    {
+    windowing->Update();
+    calculator->SetImage( windowing->GetOutput() );
+    calculator->Compute();
+    inverter->SetWindowMinimum( calculator->GetMinimum() );
+    inverter->SetWindowMaximum( calculator->GetMaximum() );
+    inverter->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const OutputImageType * reference = inverter->GetOutput();
+
+  //
+  // Fast marching module, on the whole image and cropped.
+  //
+  SegmentationModuleType::Pointer  segmentationModule = SegmentationModuleType::New();
+  segmentationModule->SetFeature( featureObject );
+  segmentationModule->SetInput( landmarks );
+  segmentationModule->SetStoppingValue( stoppingValue );
+  segmentationModule->SetDistanceFromSeeds( distanceFromSeeds );
+
+  SegmentationModuleType::Pointer  croppedModule = SegmentationModuleType::New();
+  croppedModule->SetFeature( featureObject );
+  croppedModule->SetInput( landmarks );
+  croppedModule->SetStoppingValue( stoppingValue );
+  croppedModule->SetDistanceFromSeeds( distanceFromSeeds );
+  croppedModule->CropOutputToReachedRegionOn();
+
+  try
+    {
+    segmentationModule->Update();
+    croppedModule->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const OutputImageType * outputImage = GetOutputImage( segmentationModule );
+
+  if( outputImage->GetBufferedRegion() != reference->GetBufferedRegion() )
+    {
+    std::cerr << "The output region " << outputImage->GetBufferedRegion() << std::endl;
+    std::cerr << "differs from " << reference->GetBufferedRegion() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned long numberOfDifferences = CountDifferences( outputImage, reference );
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels of the output differ from the reference" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  numberOfDifferences = CountDifferences( GetOutputImage( croppedModule ), reference );
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels of the cropped output differ from the reference" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( !CheckPasses( "Fast marching", segmentationModule, 0, 1 ) ||
+      !CheckPasses( "Cropped fast marching", croppedModule, 0, 1 ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Fast marching followed by a geodesic active contour, on the whole image
+  // and cropped. The fast marching output is rescaled once, the level set
+  // is scanned and inverted once.
+  //
+  typedef itk::FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule< 3 > CompositeModuleType;
+
+  CompositeModuleType::Pointer compositeModule = CompositeModuleType::New();
+  CompositeModuleType::Pointer croppedCompositeModule = CompositeModuleType::New();
+
+  CompositeModuleType * compositeModules[2] = { compositeModule, croppedCompositeModule };
+
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    compositeModules[i]->SetFeature( featureObject );
+    compositeModules[i]->SetInput( landmarks );
+    compositeModules[i]->SetStoppingValue( stoppingValue );
+    compositeModules[i]->SetDistanceFromSeeds( distanceFromSeeds );
+    compositeModules[i]->SetMaximumNumberOfIterations( maximumNumberOfIterations );
+    }
+  croppedCompositeModule->CropToReachedRegionOn();
+
+  try
+    {
+    compositeModule->Update();
+    croppedCompositeModule->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( !CheckPasses( "Fast marching and geodesic active contour", compositeModule, 1, 2 ) ||
+      !CheckPasses( "Cropped fast marching and geodesic active contour", croppedCompositeModule, 1, 2 ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  OutputWriterType::Pointer writer = OutputWriterType::New();
+
+  writer->SetFileName( argv[3] );
+  writer->SetInput( outputImage );
+  writer->UseCompressionOn();
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  segmentationModule->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
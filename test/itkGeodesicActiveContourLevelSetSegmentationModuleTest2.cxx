@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkGeodesicActiveContourLevelSetSegmentationModuleTest2.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Volume convergence stopping criterion. The module is run once with the
+// RMS and iteration criteria only, and once with the volume criterion. The
+// second run must be stopped by the volume criterion, in fewer iterations,
+// and its segmented volume must be within a tolerance of the first one.
+
+#include "itkGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkImage.h"
+#include "itkSpatialObject.h"
+#include "itkImageSpatialObject.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+
+int itkGeodesicActiveContourLevelSetSegmentationModuleTest2( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << " inputImage featureImage outputImage [volumeConvergenceTolerance volumeConvergenceInterval maxIterations volumeTolerance]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  const unsigned int Dimension = 3;
+
+  typedef itk::GeodesicActiveContourLevelSetSegmentationModule< Dimension >   SegmentationModuleType;
+
+  typedef SegmentationModuleType::InputImageType       InputImageType;
+  typedef SegmentationModuleType::FeatureImageType     FeatureImageType;
+  typedef SegmentationModuleType::OutputImageType      OutputImageType;
+
+  typedef itk::ImageFileReader< InputImageType >       InputReaderType;
+  typedef itk::ImageFileReader< FeatureImageType >     FeatureReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >      WriterType;
+
+  InputReaderType::Pointer inputReader = InputReaderType::New();
+  FeatureReaderType::Pointer featureReader = FeatureReaderType::New();
+
+  inputReader->SetFileName( argv[1] );
+  featureReader->SetFileName( argv[2] );
+
+  try
+    {
+    inputReader->Update();
+    featureReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double volumeConvergenceTolerance = 0.001;
+  unsigned int volumeConvergenceInterval = 10;
+  unsigned int maximumNumberOfIterations = 300;
+  double volumeTolerance = 0.02;
+
+  if( argc > 4 )
+    {
+    volumeConvergenceTolerance = atof( argv[4] );
+    }
+
+  if( argc > 5 )
+    {
+    volumeConvergenceInterval = atoi( argv[5] );
+    }
+
+  if( argc > 6 )
+    {
+    maximumNumberOfIterations = atoi( argv[6] );
+    }
+
+  if( argc > 7 )
+    {
+    volumeTolerance = atof( argv[7] );
+    }
+
+  typedef SegmentationModuleType::InputSpatialObjectType          InputSpatialObjectType;
+  typedef SegmentationModuleType::FeatureSpatialObjectType        FeatureSpatialObjectType;
+  typedef SegmentationModuleType::OutputSpatialObjectType         OutputSpatialObjectType;
+
+  InputSpatialObjectType::Pointer inputObject = InputSpatialObjectType::New();
+  FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+
+  inputObject->SetImage( inputReader->GetOutput() );
+  featureObject->SetImage( featureReader->GetOutput() );
+
+  unsigned long volume[2];
+  unsigned int iterations[2];
+  SegmentationModuleType::StoppingReasonType stoppingReason[2];
+  OutputImageType::ConstPointer outputImage;
+
+  for( unsigned int run = 0; run < 2; run++ )
+    {
+    SegmentationModuleType::Pointer segmentationModule = SegmentationModuleType::New();
+
+    segmentationModule->SetInput( inputObject );
+    segmentationModule->SetFeature( featureObject );
+    segmentationModule->SetMaximumNumberOfIterations( maximumNumberOfIterations );
+    segmentationModule->SetMaximumRMSError( 0.0002 );
+    segmentationModule->InvertOutputIntensitiesOff();
+
+    if( run == 1 )
+      {
+      segmentationModule->SetVolumeConvergenceTolerance( volumeConvergenceTolerance );
+      segmentationModule->SetVolumeConvergenceInterval( volumeConvergenceInterval );
+      }
+
+    try
+      {
+      segmentationModule->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    outputImage = dynamic_cast< const OutputSpatialObjectType * >(
+      segmentationModule->GetOutput() )->GetImage();
+
+    volume[run] = 0;
+
+    itk::ImageRegionConstIterator< OutputImageType >
+      itr( outputImage, outputImage->GetBufferedRegion() );
+
+    for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+      {
+      if( itr.Get() < 0.0 )
+        {
+        ++volume[run];
+        }
+      }
+
+    iterations[run] = segmentationModule->GetElapsedIterations();
+    stoppingReason[run] = segmentationModule->GetStoppingReason();
+
+    std::cout << "Iterations " << iterations[run];
+    std::cout << " RMS change " << segmentationModule->GetRMSChange();
+    std::cout << " stopped by " << segmentationModule->GetStoppingReasonAsString();
+    std::cout << " volume " << volume[run] << " pixels" << std::endl;
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+
+  writer->SetFileName( argv[3] );
+  writer->SetInput( outputImage );
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( stoppingReason[1] != SegmentationModuleType::VolumeConverged )
+    {
+    std::cerr << "The second run was not stopped by the volume criterion" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( iterations[1] >= iterations[0] )
+    {
+    std::cerr << "The volume criterion did not reduce the number of iterations: ";
+    std::cerr << iterations[1] << " against " << iterations[0] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double reference = ( volume[0] > 0 ) ? static_cast< double >( volume[0] ) : 1.0;
+  const double volumeDifference =
+    vnl_math_abs( static_cast< double >( volume[1] ) - static_cast< double >( volume[0] ) ) / reference;
+
+  std::cout << "Relative volume difference " << volumeDifference << std::endl;
+
+  if( volumeDifference > volumeTolerance )
+    {
+    std::cerr << "The volume criterion changed the segmented volume by more than ";
+    std::cerr << volumeTolerance << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -18,6 +18,7 @@
 #include "itkSpatialObject.h"
 #include "itkImageSpatialObject.h"
 #include "itkImageFileReader.h"
+#include "itkRunLengthSegmentationFileReader.h"
 #include "itksys/SystemTools.hxx"
 
 int itkGrayscaleImageSegmentationVolumeEstimatorTest2( int argc, char * argv [] )
@@ -36,13 +37,42 @@ int itkGrayscaleImageSegmentationVolumeEstimatorTest2( int argc, char * argv []
   typedef VolumeEstimatorType::InputImageType                 InputImageType;
   typedef VolumeEstimatorType::InputImageSpatialObjectType  InputImageSpatialObjectType;
   typedef itk::ImageFileReader< InputImageType > InputImageReaderType;
+  typedef itk::RunLengthSegmentationFileReader< Dimension > SegmentationReaderType;
+
+  VolumeEstimatorType::Pointer  volumeEstimator = VolumeEstimatorType::New();
+
+  //
+  // Segmentations written by RunLengthSegmentationFileWriter are estimated
+  // without decoding their image.
+  //
+  const std::string inputFileName = argv[1];
 
   InputImageReaderType::Pointer inputImageReader = InputImageReaderType::New();
-  inputImageReader->SetFileName( argv[1] );
+  SegmentationReaderType::Pointer segmentationReader = SegmentationReaderType::New();
+
+  InputSpatialObjectType::Pointer inputImageSpatialObject = InputSpatialObjectType::New();
 
   try 
     {
-    inputImageReader->Update();
+    if( itksys::SystemTools::GetFilenameLastExtension( inputFileName ) == ".rle" )
+      {
+      segmentationReader->SetFileName( inputFileName );
+      segmentationReader->Update();
+      volumeEstimator->SetInput( segmentationReader->GetOutput() );
+      }
+    else
+      {
+      inputImageReader->SetFileName( inputFileName );
+      inputImageReader->Update();
+
+      InputImageType::Pointer inputImage = inputImageReader->GetOutput();
+      inputImage->DisconnectPipeline();
+
+      inputImageSpatialObject->SetImage( inputImage );
+      volumeEstimator->SetInput( inputImageSpatialObject );
+      }
+
+    volumeEstimator->Update();
     }
   catch( itk::ExceptionObject & excp )
     {
@@ -50,16 +80,6 @@ int itkGrayscaleImageSegmentationVolumeEstimatorTest2( int argc, char * argv []
     return EXIT_FAILURE;
     }
 
-  InputImageType::Pointer inputImage = inputImageReader->GetOutput();
-  inputImage->DisconnectPipeline();
-
-  InputSpatialObjectType::Pointer inputImageSpatialObject = InputSpatialObjectType::New();
-  inputImageSpatialObject->SetImage( inputImage );
-
-  VolumeEstimatorType::Pointer  volumeEstimator = VolumeEstimatorType::New();
-  volumeEstimator->SetInput( inputImageSpatialObject );
-  volumeEstimator->Update();
-
   const VolumeEstimatorType::RealType volume = volumeEstimator->GetVolume();
 
   //
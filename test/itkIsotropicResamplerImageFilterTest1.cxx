@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkIsotropicResamplerImageFilterTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The separable B-spline interpolation of the isotropic resampler is run
+// against the resampling through ResampleImageFilter, and the timings are
+// reported. The outputs must share their geometry and only differ by the
+// rounding of the sums.
+
+#include "itkIsotropicResamplerImageFilter.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+int itkIsotropicResamplerImageFilterTest1( int argc, char * argv [] )
+{
+
+  if( argc < 3 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tinputImage\n\toutputImage ";
+    std::cerr << "\n\t[output spacing]\n\t[tolerance]";
+    std::cerr << "\n\t[number of repetitions]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+
+  typedef itk::Image< float, Dimension >             ImageType;
+  typedef itk::ImageFileReader< ImageType >          ReaderType;
+  typedef itk::ImageFileWriter< ImageType >          WriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  try
+    {
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double outputSpacing = (argc > 3) ? atof( argv[3] ) : 0.2;
+  const double tolerance = (argc > 4) ? atof( argv[4] ) : 1e-3;
+  const unsigned int numberOfRepetitions = (argc > 5) ? atoi( argv[5] ) : 3;
+
+  ImageType::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+
+  typedef itk::IsotropicResamplerImageFilter< ImageType, ImageType > ResamplerType;
+
+  ResamplerType::SpacingType spacing;
+  spacing.Fill( outputSpacing );
+
+  ResamplerType::Pointer separableResampler = ResamplerType::New();
+  separableResampler->SetInput( image );
+  separableResampler->SetOutputSpacing( spacing );
+  separableResampler->SetDefaultPixelValue( -1024 );
+
+  ResamplerType::Pointer referenceResampler = ResamplerType::New();
+  referenceResampler->SetInput( image );
+  referenceResampler->SetOutputSpacing( spacing );
+  referenceResampler->SetDefaultPixelValue( -1024 );
+  referenceResampler->UseSeparableInterpolationOff();
+
+  itk::TimeProbe separableProbe;
+  itk::TimeProbe referenceProbe;
+
+  try
+    {
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      referenceResampler->Modified();
+      referenceProbe.Start();
+      referenceResampler->Update();
+      referenceProbe.Stop();
+
+      separableResampler->Modified();
+      separableProbe.Start();
+      separableResampler->Update();
+      separableProbe.Stop();
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "ResampleImageFilter      : " << referenceProbe.GetMean() << " s" << std::endl;
+  std::cout << "Separable interpolation  : " << separableProbe.GetMean() << " s" << std::endl;
+
+  const ImageType * separableImage = separableResampler->GetOutput();
+  const ImageType * referenceImage = referenceResampler->GetOutput();
+
+  if( separableImage->GetBufferedRegion() != referenceImage->GetBufferedRegion() ||
+      separableImage->GetSpacing() != referenceImage->GetSpacing() ||
+      separableImage->GetOrigin() != referenceImage->GetOrigin() )
+    {
+    std::cerr << "The geometry of the outputs differs" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageRegionConstIterator< ImageType > IteratorType;
+
+  IteratorType itr1( separableImage, separableImage->GetBufferedRegion() );
+  IteratorType itr2( referenceImage, referenceImage->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+  double maximumDifference = 0.0;
+
+  for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+    {
+    const double difference = vnl_math_abs( itr1.Get() - itr2.Get() );
+    maximumDifference = vnl_math_max( maximumDifference, difference );
+    if( difference > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  std::cout << "Maximum difference : " << maximumDifference << std::endl;
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels differ by more than " << tolerance << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[2] );
+  writer->SetInput( separableImage );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  separableResampler->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
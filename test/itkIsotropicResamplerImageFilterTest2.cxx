@@ -0,0 +1,176 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkIsotropicResamplerImageFilterTest2.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Thick slice scans of 0.7 x 0.7 x 5 mm and 0.7 x 0.7 x 2.5 mm are
+// resampled to 0.7 mm, as LesionSegmentationImageFilter8 does, which only
+// changes the spacing along the slices. The resampler must only interpolate
+// that axis, and match ResampleImageFilter. The timings are reported.
+
+#include "itkIsotropicResamplerImageFilter.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+
+typedef itk::Image< float, 3 >   ImageType;
+
+ImageType::Pointer CreateThickSliceImage( unsigned int inPlaneSize, double sliceSpacing )
+{
+  ImageType::SizeType size;
+  size[0] = inPlaneSize;
+  size[1] = inPlaneSize;
+  size[2] = static_cast< ImageType::SizeValueType >( 100.0 / sliceSpacing );
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 0.7;
+  spacing[2] = sliceSpacing;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->Allocate();
+
+  // A blob in a noisy background, in Hounsfield units.
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+
+  unsigned int seed = 12345;
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const ImageType::IndexType & index = itr.GetIndex();
+
+    double r2 = 0.0;
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      const double x = ( index[d] - 0.5 * size[d] ) * spacing[d];
+      r2 += x * x;
+      }
+
+    seed = seed * 1103515245 + 12345;
+    const double noise = static_cast< double >( ( seed >> 16 ) % 100 ) - 50.0;
+
+    itr.Set( static_cast< float >( -800.0 + 800.0 * vcl_exp( -r2 / 200.0 ) + noise ) );
+    }
+
+  return image;
+}
+
+}
+
+int itkIsotropicResamplerImageFilterTest2( int argc, char * argv [] )
+{
+  const unsigned int inPlaneSize = (argc > 1) ? atoi( argv[1] ) : 256;
+  const double tolerance = (argc > 2) ? atof( argv[2] ) : 0.01;
+  const unsigned int numberOfRepetitions = (argc > 3) ? atoi( argv[3] ) : 3;
+
+  typedef itk::IsotropicResamplerImageFilter< ImageType, ImageType > ResamplerType;
+
+  const double sliceSpacings[2] = { 5.0, 2.5 };
+
+  for( unsigned int s = 0; s < 2; s++ )
+    {
+    ImageType::Pointer image = CreateThickSliceImage( inPlaneSize, sliceSpacings[s] );
+
+    ResamplerType::SpacingType spacing;
+    spacing.Fill( 0.7 );
+
+    ResamplerType::Pointer separableResampler = ResamplerType::New();
+    separableResampler->SetInput( image );
+    separableResampler->SetOutputSpacing( spacing );
+
+    ResamplerType::Pointer referenceResampler = ResamplerType::New();
+    referenceResampler->SetInput( image );
+    referenceResampler->SetOutputSpacing( spacing );
+    referenceResampler->UseSeparableInterpolationOff();
+
+    itk::TimeProbe separableProbe;
+    itk::TimeProbe referenceProbe;
+
+    try
+      {
+      for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+        {
+        referenceResampler->Modified();
+        referenceProbe.Start();
+        referenceResampler->Update();
+        referenceProbe.Stop();
+
+        separableResampler->Modified();
+        separableProbe.Start();
+        separableResampler->Update();
+        separableProbe.Stop();
+        }
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << "0.7 x 0.7 x " << sliceSpacings[s] << " mm, ";
+    std::cout << image->GetLargestPossibleRegion().GetSize() << " to ";
+    std::cout << separableResampler->GetOutput()->GetLargestPossibleRegion().GetSize() << std::endl;
+    std::cout << "  ResampleImageFilter      : " << referenceProbe.GetMean() << " s" << std::endl;
+    std::cout << "  Interpolation along z    : " << separableProbe.GetMean() << " s" << std::endl;
+
+    if( separableResampler->GetNumberOfInterpolatedAxes() != 1 )
+      {
+      std::cerr << "Expected a single interpolated axis, got ";
+      std::cerr << separableResampler->GetNumberOfInterpolatedAxes() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const ImageType * separableImage = separableResampler->GetOutput();
+    const ImageType * referenceImage = referenceResampler->GetOutput();
+
+    if( separableImage->GetBufferedRegion() != referenceImage->GetBufferedRegion() )
+      {
+      std::cerr << "The regions of the outputs differ" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    typedef itk::ImageRegionConstIterator< ImageType > IteratorType;
+
+    IteratorType itr1( separableImage, separableImage->GetBufferedRegion() );
+    IteratorType itr2( referenceImage, referenceImage->GetBufferedRegion() );
+
+    unsigned long numberOfDifferences = 0;
+    double maximumDifference = 0.0;
+
+    for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+      {
+      const double difference = vnl_math_abs( itr1.Get() - itr2.Get() );
+      maximumDifference = vnl_math_max( maximumDifference, difference );
+      if( difference > tolerance )
+        {
+        ++numberOfDifferences;
+        }
+      }
+
+    std::cout << "  Maximum difference       : " << maximumDifference << std::endl;
+
+    if( numberOfDifferences > 0 )
+      {
+      std::cerr << numberOfDifferences << " pixels differ by more than " << tolerance << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkIsotropicResamplerImageFilterTest3.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A region of interest of a thick slice scan is resampled to 0.7 mm straight
+// from the input, as LesionSegmentationImageFilter8 does, and compared with
+// the same region resampled by ResampleImageFilter from the whole input. The
+// output must have the geometry of the cropped region resampled, only the
+// region and its halo may be requested from the input, and the time of
+// cropping then resampling is reported.
+
+#include "itkIsotropicResamplerImageFilter.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+
+typedef itk::Image< float, 3 >   ImageType;
+
+ImageType::Pointer CreateThickSliceImage( unsigned int inPlaneSize, double sliceSpacing )
+{
+  ImageType::SizeType size;
+  size[0] = inPlaneSize;
+  size[1] = inPlaneSize;
+  size[2] = static_cast< ImageType::SizeValueType >( 100.0 / sliceSpacing );
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 0.7;
+  spacing[2] = sliceSpacing;
+
+  ImageType::PointType origin;
+  origin[0] = -120.0;
+  origin[1] = -80.0;
+  origin[2] = 35.0;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->Allocate();
+
+  // A blob in a noisy background, in Hounsfield units.
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+
+  unsigned int seed = 12345;
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const ImageType::IndexType & index = itr.GetIndex();
+
+    double r2 = 0.0;
+    for( unsigned int d = 0; d < 3; d++ )
+      {
+      const double x = ( index[d] - 0.5 * size[d] ) * spacing[d];
+      r2 += x * x;
+      }
+
+    seed = seed * 1103515245 + 12345;
+    const double noise = static_cast< double >( ( seed >> 16 ) % 100 ) - 50.0;
+
+    itr.Set( static_cast< float >( -800.0 + 800.0 * vcl_exp( -r2 / 200.0 ) + noise ) );
+    }
+
+  return image;
+}
+
+}
+
+int itkIsotropicResamplerImageFilterTest3( int argc, char * argv [] )
+{
+  const unsigned int inPlaneSize = (argc > 1) ? atoi( argv[1] ) : 256;
+  const double tolerance = (argc > 2) ? atof( argv[2] ) : 0.1;
+  const unsigned int numberOfRepetitions = (argc > 3) ? atoi( argv[3] ) : 3;
+
+  ImageType::Pointer image = CreateThickSliceImage( inPlaneSize, 2.5 );
+
+  const ImageType::SizeType & imageSize = image->GetLargestPossibleRegion().GetSize();
+
+  // A region of interest around the blob, touching the last slice so that
+  // the halo is cropped on that side.
+  ImageType::RegionType regionOfInterest;
+  regionOfInterest.SetIndex( 0, imageSize[0] / 4 );
+  regionOfInterest.SetIndex( 1, imageSize[1] / 4 );
+  regionOfInterest.SetIndex( 2, imageSize[2] / 3 );
+  regionOfInterest.SetSize( 0, imageSize[0] / 2 );
+  regionOfInterest.SetSize( 1, imageSize[1] / 2 );
+  regionOfInterest.SetSize( 2, imageSize[2] - imageSize[2] / 3 );
+
+  typedef itk::IsotropicResamplerImageFilter< ImageType, ImageType > ResamplerType;
+  typedef itk::RegionOfInterestImageFilter< ImageType, ImageType >   CropFilterType;
+
+  ResamplerType::SpacingType spacing;
+  spacing.Fill( 0.7 );
+
+  ResamplerType::Pointer regionResampler = ResamplerType::New();
+  regionResampler->SetInput( image );
+  regionResampler->SetInputRegion( regionOfInterest );
+  regionResampler->SetOutputSpacing( spacing );
+
+  ResamplerType::Pointer referenceResampler = ResamplerType::New();
+  referenceResampler->SetInput( image );
+  referenceResampler->SetInputRegion( regionOfInterest );
+  referenceResampler->SetOutputSpacing( spacing );
+  referenceResampler->UseSeparableInterpolationOff();
+
+  CropFilterType::Pointer cropFilter = CropFilterType::New();
+  cropFilter->SetInput( image );
+  cropFilter->SetRegionOfInterest( regionOfInterest );
+
+  ResamplerType::Pointer croppedResampler = ResamplerType::New();
+  croppedResampler->SetInput( cropFilter->GetOutput() );
+  croppedResampler->SetOutputSpacing( spacing );
+
+  itk::TimeProbe regionProbe;
+  itk::TimeProbe croppedProbe;
+
+  try
+    {
+    referenceResampler->Update();
+
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      cropFilter->Modified();
+      croppedProbe.Start();
+      croppedResampler->Update();
+      croppedProbe.Stop();
+
+      regionResampler->Modified();
+      regionProbe.Start();
+      regionResampler->Update();
+      regionProbe.Stop();
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Crop then resample        : " << croppedProbe.GetMean() << " s" << std::endl;
+  std::cout << "Resample the region       : " << regionProbe.GetMean() << " s" << std::endl;
+
+  const ImageType * regionImage = regionResampler->GetOutput();
+  const ImageType * referenceImage = referenceResampler->GetOutput();
+  const ImageType * croppedImage = croppedResampler->GetOutput();
+
+  if( regionImage->GetBufferedRegion() != croppedImage->GetBufferedRegion() ||
+      regionImage->GetSpacing() != croppedImage->GetSpacing() ||
+      regionImage->GetOrigin() != croppedImage->GetOrigin() ||
+      regionImage->GetBufferedRegion() != referenceImage->GetBufferedRegion() ||
+      regionImage->GetOrigin() != referenceImage->GetOrigin() )
+    {
+    std::cerr << "The geometry of the outputs differs" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::RegionType supportRegion = regionOfInterest;
+  ImageType::SizeType haloRadius;
+  haloRadius[0] = 0;
+  haloRadius[1] = 0;
+  haloRadius[2] = regionResampler->GetHaloRadius();
+  supportRegion.PadByRadius( haloRadius );
+  supportRegion.Crop( image->GetLargestPossibleRegion() );
+
+  if( image->GetRequestedRegion() != supportRegion )
+    {
+    std::cerr << "The requested region of the input " << image->GetRequestedRegion();
+    std::cerr << " is not limited to the region of interest and its halo" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageRegionConstIterator< ImageType > IteratorType;
+
+  IteratorType itr1( regionImage, regionImage->GetBufferedRegion() );
+  IteratorType itr2( referenceImage, referenceImage->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+  double maximumDifference = 0.0;
+
+  for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+    {
+    const double difference = vnl_math_abs( itr1.Get() - itr2.Get() );
+    maximumDifference = vnl_math_max( maximumDifference, difference );
+    if( difference > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  std::cout << "Maximum difference        : " << maximumDifference << std::endl;
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << numberOfDifferences << " pixels differ by more than " << tolerance << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  regionResampler->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
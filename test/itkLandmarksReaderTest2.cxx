@@ -0,0 +1,249 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkLandmarksReaderTest2.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A seed file with several lesions, and many seeds per lesion, is written by
+// SpatialObjectWriter, as automated detection does. The LandmarksReader must
+// parse all its landmark objects in one pass, and find the points that
+// SpatialObjectReader finds in the scene of the file, in less time. A file
+// that also holds another kind of object must still be read, through its
+// scene.
+
+#include "itkLandmarksReader.h"
+#include "itkLandmarkSpatialObject.h"
+#include "itkGroupSpatialObject.h"
+#include "itkSpatialObjectReader.h"
+#include "itkSpatialObjectWriter.h"
+#include "itkTimeProbe.h"
+
+#include <fstream>
+#include <sstream>
+
+int itkLandmarksReaderTest2( int argc, char * argv [] )
+{
+
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\toutputDirectory [numberOfLesions] [numberOfSeedsPerLesion]";
+    std::cerr << " [numberOfRepetitions]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+
+  typedef itk::LandmarksReader< Dimension >                        LandmarksReaderType;
+  typedef itk::LandmarkSpatialObject< Dimension >                  LandmarkType;
+  typedef LandmarkType::PointListType                              PointListType;
+  typedef LandmarkType::SpatialObjectPointType                     SpatialPointType;
+  typedef itk::GroupSpatialObject< Dimension >                     GroupType;
+  typedef itk::SpatialObjectWriter< Dimension, unsigned short >    SpatialObjectWriterType;
+  typedef itk::SpatialObjectReader< Dimension, unsigned short >    SpatialObjectReaderType;
+  typedef SpatialObjectReaderType::SceneType::ObjectListType       ObjectListType;
+
+  const unsigned int numberOfLesions = (argc > 2) ? atoi( argv[2] ) : 20;
+  const unsigned int numberOfSeedsPerLesion = (argc > 3) ? atoi( argv[3] ) : 200;
+  const unsigned int numberOfRepetitions = (argc > 4) ? atoi( argv[4] ) : 3;
+
+  const std::string directory = argv[1];
+  const std::string fileName = directory + "/LandmarksReaderTest2_Seeds.txt";
+
+  //
+  // Seeds scattered around the center of each lesion
+  //
+  GroupType::Pointer group = GroupType::New();
+
+  unsigned int seed = 12345;
+
+  for( unsigned int l = 0; l < numberOfLesions; l++ )
+    {
+    PointListType points;
+
+    for( unsigned int s = 0; s < numberOfSeedsPerLesion; s++ )
+      {
+      double position[Dimension];
+      for( unsigned int i = 0; i < Dimension; i++ )
+        {
+        seed = seed * 1103515245 + 12345;
+        position[i] = -150.0 + 15.0 * l + 0.001 * ( ( seed >> 8 ) % 20000 ) - 10.0;
+        }
+
+      SpatialPointType point;
+      point.SetPosition( position[0], position[1], position[2] );
+      point.SetColor( 1, 0, 0, 1 );
+      points.push_back( point );
+      }
+
+    std::ostringstream name;
+    name << "Landmark " << l + 1;
+
+    LandmarkType::Pointer landmarks = LandmarkType::New();
+    landmarks->SetPoints( points );
+    landmarks->GetProperty()->SetName( name.str() );
+
+    group->AddSpatialObject( landmarks );
+    }
+
+  SpatialObjectWriterType::Pointer writer = SpatialObjectWriterType::New();
+  writer->SetInput( group );
+  writer->SetFileName( fileName );
+  writer->SetBinaryPoints( false );
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Landmarks parsed by the reader, and read from the scene of the file
+  //
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+  landmarksReader->SetFileName( fileName );
+
+  SpatialObjectReaderType::Pointer sceneReader = SpatialObjectReaderType::New();
+  sceneReader->SetFileName( fileName );
+
+  itk::TimeProbe landmarksProbe;
+  itk::TimeProbe sceneProbe;
+
+  std::vector< const LandmarkType * > sceneLandmarks;
+
+  try
+    {
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      landmarksReader->Modified();
+      landmarksProbe.Start();
+      landmarksReader->Update();
+      landmarksProbe.Stop();
+
+      sceneReader->Modified();
+      sceneProbe.Start();
+      sceneReader->Update();
+
+      ObjectListType * sceneChildren = sceneReader->GetScene()->GetObjects( 999999 );
+
+      sceneLandmarks.clear();
+      for( ObjectListType::const_iterator itr = sceneChildren->begin(); itr != sceneChildren->end(); ++itr )
+        {
+        if( std::string( (*itr)->GetTypeName() ) == "LandmarkSpatialObject" )
+          {
+          sceneLandmarks.push_back( dynamic_cast< const LandmarkType * >( itr->GetPointer() ) );
+          }
+        }
+
+      delete sceneChildren;
+      sceneProbe.Stop();
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Lesions x seeds       : " << numberOfLesions << " x " << numberOfSeedsPerLesion << std::endl;
+  std::cout << "LandmarksReader       : " << landmarksProbe.GetMean() << " s" << std::endl;
+  std::cout << "SpatialObjectReader   : " << sceneProbe.GetMean() << " s" << std::endl;
+
+  if( !landmarksReader->GetIsParsedDirectly() )
+    {
+    std::cerr << "The seed file was not parsed directly" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( landmarksReader->GetNumberOfLandmarkSpatialObjects() != numberOfLesions ||
+      sceneLandmarks.size() != numberOfLesions )
+    {
+    std::cerr << "Expected " << numberOfLesions << " landmark objects, found ";
+    std::cerr << landmarksReader->GetNumberOfLandmarkSpatialObjects() << " and ";
+    std::cerr << sceneLandmarks.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( landmarksReader->GetOutput() != landmarksReader->GetLandmarkSpatialObject( 0 ) )
+    {
+    std::cerr << "The output is not the first landmark object" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for( unsigned int l = 0; l < numberOfLesions; l++ )
+    {
+    const PointListType & points1 = landmarksReader->GetLandmarkSpatialObject( l )->GetPoints();
+    const PointListType & points2 = sceneLandmarks[l]->GetPoints();
+
+    if( points1.size() != points2.size() ||
+        landmarksReader->GetLandmarkSpatialObject( l )->GetProperty()->GetName() !=
+        sceneLandmarks[l]->GetProperty()->GetName() )
+      {
+      std::cerr << "Landmark object " << l << " differs between the two readers" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    for( unsigned int i = 0; i < points1.size(); i++ )
+      {
+      if( points1[i].GetPosition() != points2[i].GetPosition() )
+        {
+        std::cerr << "Error : point " << i << " of landmark object " << l << " has different positions" << std::endl;
+        std::cerr << "Expected position " << points2[i].GetPosition() << std::endl;
+        std::cerr << "Received position " << points1[i].GetPosition() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  //
+  // A file with an object that is not a landmark is read through its scene
+  //
+  const std::string mixedFileName = directory + "/LandmarksReaderTest2_Mixed.txt";
+
+  std::ofstream os( mixedFileName.c_str() );
+  os << "ObjectType = Scene\nNDims = 3\nNObjects = 2\n";
+  os << "ObjectType = Ellipse\nNDims = 3\nName = Nodule\nRadius = 4 4 4\n";
+  os << "ObjectType = Landmark\nNDims = 3\nName = Landmark 1\nBinaryData = False\n";
+  os << "ElementType = MET_FLOAT\nPointDim = x y z red green blue alpha\nNPoints = 2\nPoints = \n";
+  os << "185.238, 175.636, -257.75    1 0 0 1 \n";
+  os << "183.134, 174.233, -257.75    1 0 0 1 \n";
+  os.close();
+
+  LandmarksReaderType::Pointer mixedReader = LandmarksReaderType::New();
+  mixedReader->SetFileName( mixedFileName );
+
+  try
+    {
+    mixedReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( mixedReader->GetIsParsedDirectly() ||
+      mixedReader->GetNumberOfLandmarkSpatialObjects() != 1 ||
+      mixedReader->GetOutput()->GetNumberOfPoints() != 2 )
+    {
+    std::cerr << "The landmarks of " << mixedFileName << " were not read through its scene" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  mixedReader->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
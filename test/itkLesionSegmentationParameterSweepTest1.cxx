@@ -0,0 +1,261 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkLesionSegmentationParameterSweepTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The test sweeps two sigmoid betas, two Canny sigmas and two propagation
+// scalings. The number of executions of each stage must match the
+// dependency analysis: the features that no parameter invalidates run once,
+// the sigmoid and Canny features once per value, their minimum and the fast
+// marching once per pair of values, and the level set once per
+// configuration. One configuration is checked against
+// LesionSegmentationImageFilter8 and the volumes are written as CSV.
+
+#include "itkLesionSegmentationParameterSweep.h"
+#include "itkLesionSegmentationImageFilter8.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+#include "itkTimeProbe.h"
+
+int itkLesionSegmentationParameterSweepTest1( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tinputImage\n\toutputCSVFile ";
+    std::cerr << "\n\t[numberOfThreads]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+  typedef signed short                              InputPixelType;
+  typedef float                                     OutputPixelType;
+  typedef itk::Image< InputPixelType,  Dimension >  InputImageType;
+  typedef itk::Image< OutputPixelType, Dimension >  OutputImageType;
+  typedef itk::ImageFileReader< InputImageType >    InputImageReaderType;
+  typedef itk::LandmarksReader< Dimension >         LandmarksReaderType;
+  typedef itk::LandmarkSpatialObject< Dimension >   SeedSpatialObjectType;
+
+  typedef itk::LesionSegmentationParameterSweep< InputImageType >  SweepType;
+
+  InputImageReaderType::Pointer inputImageReader = InputImageReaderType::New();
+  inputImageReader->SetFileName( argv[2] );
+
+  try
+    {
+    inputImageReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const InputImageType * inputImage = inputImageReader->GetOutput();
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+  const SeedSpatialObjectType * landmarks = landmarksReader->GetOutput();
+
+  SweepType::Pointer sweep = SweepType::New();
+  sweep->SetInput( inputImage );
+  sweep->SetSeeds( landmarks->GetPoints() );
+  sweep->SetRegionOfInterest( inputImage->GetBufferedRegion() );
+  sweep->ResampleThickSliceDataOff();
+
+  if( argc > 4 )
+    {
+    sweep->SetNumberOfThreads( atoi( argv[4] ) );
+    }
+
+  SweepType::ParameterValueListType sigmoidBetas;
+  sigmoidBetas.push_back( -500.0 );
+  sigmoidBetas.push_back( -200.0 );
+
+  SweepType::ParameterValueListType cannySigmas;
+  cannySigmas.push_back( 1.0 );
+  cannySigmas.push_back( 1.5 );
+
+  SweepType::ParameterValueListType propagationScalings;
+  propagationScalings.push_back( 400.0 );
+  propagationScalings.push_back( 500.0 );
+
+  SweepType::ParameterValueListType curvatureScalings;
+  curvatureScalings.push_back( 1.0 );
+
+  sweep->SetParameterValues( SweepType::SigmoidBetaParameter, sigmoidBetas );
+  sweep->SetParameterValues( SweepType::CannySigmaParameter, cannySigmas );
+  sweep->SetParameterValues( SweepType::PropagationScalingParameter, propagationScalings );
+  sweep->SetParameterValues( SweepType::CurvatureScalingParameter, curvatureScalings );
+
+  itk::TimeProbe sweepProbe;
+
+  try
+    {
+    sweepProbe.Start();
+    sweep->Compute();
+    sweepProbe.Stop();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Sweep of " << sweep->GetNumberOfConfigurations() << " configurations : ";
+  std::cout << sweepProbe.GetMean() << " s" << std::endl;
+
+  const unsigned int numberOfConfigurations =
+    sigmoidBetas.size() * cannySigmas.size() * propagationScalings.size() * curvatureScalings.size();
+
+  if( sweep->GetNumberOfConfigurations() != numberOfConfigurations )
+    {
+    std::cerr << "Expected " << numberOfConfigurations << " configurations, got ";
+    std::cerr << sweep->GetNumberOfConfigurations() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Dependency analysis.
+  //
+  if( sweep->IsStageInvalidatedBy( SweepType::LungWallStage, SweepType::SigmoidBetaParameter ) ||
+      sweep->IsStageInvalidatedBy( SweepType::SigmoidStage, SweepType::CannySigmaParameter ) ||
+      sweep->IsStageInvalidatedBy( SweepType::FastMarchingStage, SweepType::PropagationScalingParameter ) ||
+      !sweep->IsStageInvalidatedBy( SweepType::AggregationStage, SweepType::CannySigmaParameter ) ||
+      !sweep->IsStageInvalidatedBy( SweepType::FastMarchingStage, SweepType::SigmoidBetaParameter ) ||
+      !sweep->IsStageInvalidatedBy( SweepType::LevelSetStage, SweepType::CurvatureScalingParameter ) )
+    {
+    std::cerr << "Unexpected dependencies between the parameters and the stages" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::SizeValueType expectedExecutions[SweepType::NumberOfStages];
+  expectedExecutions[SweepType::PreprocessingStage] = 1;
+  expectedExecutions[SweepType::LungWallStage] = 1;
+  expectedExecutions[SweepType::VesselnessStage] = 1;
+  expectedExecutions[SweepType::SigmoidStage] = sigmoidBetas.size();
+  expectedExecutions[SweepType::CannyEdgesStage] = cannySigmas.size();
+  expectedExecutions[SweepType::AggregationStage] = sigmoidBetas.size() * cannySigmas.size();
+  expectedExecutions[SweepType::FastMarchingStage] = sigmoidBetas.size() * cannySigmas.size();
+  expectedExecutions[SweepType::LevelSetStage] = numberOfConfigurations;
+
+  bool executionsMatch = true;
+
+  for( unsigned int s = 0; s < SweepType::NumberOfStages; s++ )
+    {
+    const SweepType::StageType stage = static_cast< SweepType::StageType >( s );
+
+    std::cout << SweepType::GetStageName( stage ) << " : ";
+    std::cout << sweep->GetNumberOfExecutions( stage ) << " executions, ";
+    std::cout << sweep->GetNumberOfPlannedExecutions( stage ) << " planned, ";
+    std::cout << expectedExecutions[s] << " expected" << std::endl;
+
+    if( sweep->GetNumberOfPlannedExecutions( stage ) != expectedExecutions[s] ||
+        sweep->GetNumberOfExecutions( stage ) != expectedExecutions[s] )
+      {
+      executionsMatch = false;
+      }
+    }
+
+  if( !executionsMatch )
+    {
+    std::cerr << "The stage executions do not match the dependency analysis" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for( unsigned int c = 0; c < numberOfConfigurations; c++ )
+    {
+    if( !( sweep->GetConfiguration( c ).Volume > 0.0 ) )
+      {
+      std::cerr << "Configuration " << c << " has an empty segmentation" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  //
+  // Second configuration, with the propagation scaling of
+  // LesionSegmentationImageFilter8, run through the filter.
+  //
+  const SweepType::ConfigurationType & configuration = sweep->GetConfiguration( 1 );
+
+  typedef itk::LesionSegmentationImageFilter8< InputImageType, OutputImageType > SegmentationMethodType;
+
+  SegmentationMethodType::Pointer segmentationMethod = SegmentationMethodType::New();
+  segmentationMethod->SetInput( inputImage );
+  segmentationMethod->SetSeeds( landmarks->GetPoints() );
+  segmentationMethod->SetRegionOfInterest( inputImage->GetBufferedRegion() );
+  segmentationMethod->SetResampleThickSliceData( false );
+  segmentationMethod->SetSigmoidBeta( configuration.Parameters[SweepType::SigmoidBetaParameter] );
+  segmentationMethod->SetSigma(
+    SegmentationMethodType::SigmaArrayType( configuration.Parameters[SweepType::CannySigmaParameter] ) );
+
+  try
+    {
+    segmentationMethod->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const OutputImageType * outputImage = segmentationMethod->GetOutput();
+
+  itk::ImageRegionConstIterator< OutputImageType > itr( outputImage, outputImage->GetBufferedRegion() );
+
+  unsigned long numberOfPixels = 0;
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    if( itr.Get() > sweep->GetSegmentationThreshold() )
+      {
+      ++numberOfPixels;
+      }
+    }
+
+  double pixelVolume = 1.0;
+  for( unsigned int i = 0; i < Dimension; i++ )
+    {
+    pixelVolume *= outputImage->GetSpacing()[i];
+    }
+
+  const double filterVolume = numberOfPixels * pixelVolume;
+
+  std::cout << "Volume from the sweep " << configuration.Volume;
+  std::cout << ", from the filter " << filterVolume << std::endl;
+
+  if( vnl_math_abs( filterVolume - configuration.Volume ) > 0.01 * filterVolume )
+    {
+    std::cerr << "The sweep volume differs from LesionSegmentationImageFilter8" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  try
+    {
+    sweep->WriteCSV( std::string( argv[3] ) );
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  sweep->WriteCSV( std::cout );
+
+  sweep->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkLevelSetFeatureCacheTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A geodesic active contour module and a shape detection module share a
+// feature cache. The speed and advection images must be computed once for
+// both modules and for a second update of the geodesic active contour with
+// another propagation scaling, and once more after the feature image has
+// been modified. The outputs must match a module without cache.
+
+#include "itkLevelSetFeatureCache.h"
+#include "itkGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkShapeDetectionLevelSetSegmentationModule.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+
+typedef itk::GeodesicActiveContourLevelSetSegmentationModule< 3 >   GeodesicModuleType;
+typedef GeodesicModuleType::OutputImageType                         OutputImageType;
+typedef GeodesicModuleType::OutputSpatialObjectType                 OutputSpatialObjectType;
+
+const OutputImageType * GetOutputImage( const itk::SegmentationModule< 3 > * module )
+{
+  return dynamic_cast< const OutputSpatialObjectType * >( module->GetOutput() )->GetImage();
+}
+
+unsigned long CountDifferences( const OutputImageType * image1, const OutputImageType * image2 )
+{
+  typedef itk::ImageRegionConstIterator< OutputImageType > IteratorType;
+
+  IteratorType itr1( image1, image1->GetBufferedRegion() );
+  IteratorType itr2( image2, image2->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+
+  for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+    {
+    if( itr1.Get() != itr2.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  return numberOfDifferences;
+}
+
+}
+
+int itkLevelSetFeatureCacheTest1( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tinputImage\n\tfeatureImage\n\toutputImage ";
+    std::cerr << "\n\t[propagationScaling]\n\t[secondPropagationScaling]";
+    std::cerr << "\n\t[maximumNumberOfIterations]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ShapeDetectionLevelSetSegmentationModule< 3 >   ShapeDetectionModuleType;
+  typedef GeodesicModuleType::FeatureCacheType                 FeatureCacheType;
+
+  typedef GeodesicModuleType::InputImageType       InputImageType;
+  typedef GeodesicModuleType::FeatureImageType     FeatureImageType;
+
+  typedef itk::ImageFileReader< InputImageType >       InputReaderType;
+  typedef itk::ImageFileReader< FeatureImageType >     FeatureReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >      WriterType;
+
+  InputReaderType::Pointer inputReader = InputReaderType::New();
+  FeatureReaderType::Pointer featureReader = FeatureReaderType::New();
+
+  inputReader->SetFileName( argv[1] );
+  featureReader->SetFileName( argv[2] );
+
+  try
+    {
+    inputReader->Update();
+    featureReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double propagationScaling = (argc > 4) ? atof( argv[4] ) : 100.0;
+  const double secondPropagationScaling = (argc > 5) ? atof( argv[5] ) : 200.0;
+  const unsigned int maximumNumberOfIterations = (argc > 6) ? atoi( argv[6] ) : 50;
+
+  typedef GeodesicModuleType::InputSpatialObjectType      InputSpatialObjectType;
+  typedef GeodesicModuleType::FeatureSpatialObjectType    FeatureSpatialObjectType;
+
+  InputSpatialObjectType::Pointer inputObject = InputSpatialObjectType::New();
+  FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+
+  FeatureImageType::Pointer featureImage = featureReader->GetOutput();
+
+  inputObject->SetImage( inputReader->GetOutput() );
+  featureObject->SetImage( featureImage );
+
+  FeatureCacheType::Pointer cache = FeatureCacheType::New();
+
+  GeodesicModuleType::Pointer geodesicModule = GeodesicModuleType::New();
+  geodesicModule->SetFeatureCache( cache );
+
+  ShapeDetectionModuleType::Pointer shapeDetectionModule = ShapeDetectionModuleType::New();
+  shapeDetectionModule->SetFeatureCache( cache );
+
+  GeodesicModuleType::Pointer referenceModule = GeodesicModuleType::New();
+  referenceModule->SetFeatureCache( NULL );
+
+  ShapeDetectionModuleType::Pointer shapeDetectionReferenceModule = ShapeDetectionModuleType::New();
+  shapeDetectionReferenceModule->SetFeatureCache( NULL );
+
+  itk::SegmentationModule< 3 > * modules[4] =
+    { geodesicModule, shapeDetectionModule, referenceModule, shapeDetectionReferenceModule };
+
+  for( unsigned int i = 0; i < 4; i++ )
+    {
+    GeodesicModuleType::Superclass * module =
+      dynamic_cast< GeodesicModuleType::Superclass * >( modules[i] );
+    module->SetInput( inputObject );
+    module->SetFeature( featureObject );
+    module->SetPropagationScaling( propagationScaling );
+    module->SetMaximumNumberOfIterations( maximumNumberOfIterations );
+    }
+
+  itk::TimeProbe cachedProbe;
+  itk::TimeProbe referenceProbe;
+
+  try
+    {
+    cachedProbe.Start();
+    geodesicModule->Update();
+    shapeDetectionModule->Update();
+    cachedProbe.Stop();
+
+    referenceProbe.Start();
+    referenceModule->Update();
+    shapeDetectionReferenceModule->Update();
+    referenceProbe.Stop();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( cache->GetNumberOfSpeedImageComputations() != 1 ||
+      cache->GetNumberOfAdvectionImageComputations() != 1 )
+    {
+    std::cerr << "The modules sharing the cache computed the speed image ";
+    std::cerr << cache->GetNumberOfSpeedImageComputations() << " times and the advection image ";
+    std::cerr << cache->GetNumberOfAdvectionImageComputations() << " times" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( CountDifferences( GetOutputImage( geodesicModule ), GetOutputImage( referenceModule ) ) > 0 ||
+      CountDifferences( GetOutputImage( shapeDetectionModule ),
+                        GetOutputImage( shapeDetectionReferenceModule ) ) > 0 )
+    {
+    std::cerr << "The outputs with the cache differ from the outputs without" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Update again with another propagation scaling.
+  //
+  geodesicModule->SetPropagationScaling( secondPropagationScaling );
+  referenceModule->SetPropagationScaling( secondPropagationScaling );
+
+  try
+    {
+    cachedProbe.Start();
+    geodesicModule->Update();
+    cachedProbe.Stop();
+
+    referenceProbe.Start();
+    referenceModule->Update();
+    referenceProbe.Stop();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Updates with the cache    : " << cachedProbe.GetTotal() << " s" << std::endl;
+  std::cout << "Updates without the cache : " << referenceProbe.GetTotal() << " s" << std::endl;
+
+  if( cache->GetNumberOfSpeedImageComputations() != 1 ||
+      cache->GetNumberOfAdvectionImageComputations() != 1 )
+    {
+    std::cerr << "The second update computed the images again" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( CountDifferences( GetOutputImage( geodesicModule ), GetOutputImage( referenceModule ) ) > 0 )
+    {
+    std::cerr << "The second update with the cache differs from the update without" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // A modified feature image invalidates the cache.
+  //
+  featureImage->Modified();
+
+  try
+    {
+    geodesicModule->Modified();
+    geodesicModule->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( cache->GetNumberOfSpeedImageComputations() != 2 ||
+      cache->GetNumberOfAdvectionImageComputations() != 2 )
+    {
+    std::cerr << "The images were not computed again for the modified feature image" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+
+  writer->SetFileName( argv[3] );
+  writer->SetInput( GetOutputImage( geodesicModule ) );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  cache->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkLocalStructureImageFilterTest2.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Checks the local structure measure of hand picked eigenvalue triples
+// against the omega weight of Sato et al.:
+//
+//   omega(ls,lt) = ( 1 + ls / |lt| )^gamma          if lt <= ls <= 0
+//                = ( 1 - alpha * ls / |lt| )^gamma  if |lt| / alpha > ls > 0
+//                = 0                                otherwise
+//
+// and the measure |l3| omega(l2,l3) omega(l1,l3), with the eigenvalues
+// sorted by magnitude. Both the per pixel operator() and the scanline
+// Evaluate() of the functor are checked.
+
+#include "itkLocalStructureImageFilter.h"
+#include "itkFixedArray.h"
+
+#include <vector>
+
+int itkLocalStructureImageFilterTest2( int, char * [] )
+{
+  typedef itk::FixedArray< double, 3 >                        EigenValueArrayType;
+  typedef itk::Function::LocalStructure< EigenValueArrayType, double >  FunctorType;
+
+  struct TripleType
+    {
+    double Alpha;
+    double Gamma;
+    double Eigenvalues[3];
+    double Expected;
+    };
+
+  const TripleType triples[] = {
+    // Bright sheet: omega(-2,-4) = 0.5^0.5, omega(-1,-4) = 0.75^0.5
+    { 0.25, 0.5, { -1.0, -2.0, -4.0 }, 2.449489742783178 },
+    // Same triple, unsorted
+    { 0.25, 0.5, { -4.0, -1.0, -2.0 }, 2.449489742783178 },
+    // Positive l1 and l2: omega(2,-4) = 0.875^0.5, omega(1,-4) = 0.9375^0.5
+    { 0.25, 0.5, { 2.0, -4.0, 1.0 }, 3.6228441865473595 },
+    // Ideal sheet: both weights are 1
+    { 0.25, 0.5, { 0.0, 0.0, -3.0 }, 3.0 },
+    // Dark structure, l3 > 0 with negative l1 and l2
+    { 0.25, 0.5, { -1.0, -1.0, 5.0 }, 0.0 },
+    // Positive branch within |lt|/alpha: omega(1.5,-4) = 0.25^0.5, omega(1,-4) = 0.5^0.5
+    { 2.0, 0.5, { 1.0, 1.5, -4.0 }, 1.4142135623730951 },
+    // Positive branch beyond |lt|/alpha = 2: omega(3,-4) = 0
+    { 2.0, 0.5, { 1.0, 3.0, -4.0 }, 0.0 },
+    // All eigenvalues zero
+    { 0.25, 0.5, { 0.0, 0.0, 0.0 }, 0.0 }
+  };
+
+  const unsigned int numberOfTriples = sizeof( triples ) / sizeof( triples[0] );
+
+  const double tolerance = 1e-12;
+
+  for( unsigned int t = 0; t < numberOfTriples; t++ )
+    {
+    FunctorType functor;
+    functor.SetAlpha( triples[t].Alpha );
+    functor.SetGamma( triples[t].Gamma );
+
+    EigenValueArrayType eigenvalues;
+    for( unsigned int i = 0; i < 3; i++ )
+      {
+      eigenvalues[i] = triples[t].Eigenvalues[i];
+      }
+
+    const double value = functor( eigenvalues );
+
+    double batchValue = 0.0;
+    functor.Evaluate( &triples[t].Eigenvalues[0], &triples[t].Eigenvalues[1],
+                      &triples[t].Eigenvalues[2], &batchValue, 1 );
+
+    std::cout << "Eigenvalues " << eigenvalues << " alpha " << triples[t].Alpha;
+    std::cout << " gamma " << triples[t].Gamma << " : " << value;
+    std::cout << " scanline " << batchValue << " expected " << triples[t].Expected << std::endl;
+
+    if( !( vnl_math_abs( value - triples[t].Expected ) <= tolerance ) ||
+        !( vnl_math_abs( batchValue - triples[t].Expected ) <= tolerance ) )
+      {
+      std::cerr << "The local structure measure of " << eigenvalues;
+      std::cerr << " is " << value << " per pixel and " << batchValue;
+      std::cerr << " on a scanline, expected " << triples[t].Expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
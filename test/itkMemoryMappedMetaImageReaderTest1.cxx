@@ -0,0 +1,297 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkMemoryMappedMetaImageReaderTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A synthetic volume is written as a MetaImage with a separate raw file, as
+// a single uncompressed file and as a compressed file. The raw file must be
+// mapped in memory, the compressed file read. Whether mapped or read, the
+// reader must produce the volume written, and a region of interest cropped
+// from it must hold the same pixels.
+//
+// Whether the pixels of a single file are mapped depends on the length of
+// its header, so two single files are also written with a header whose
+// length is a multiple of the pixel size, and one whose length is not. The
+// first one must be mapped and the second one read.
+
+#include "itkMemoryMappedMetaImageReader.h"
+#include "itkImage.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkByteSwapper.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+typedef itk::Image< signed short, 3 >   ImageType;
+
+// Writes the image as an uncompressed .mha file, with a comment that makes
+// the length of the header a multiple of the pixel size, or not.
+bool WriteMetaImage( const std::string & fileName, const ImageType * image, bool aligned )
+{
+  const ImageType::SizeType & size = image->GetBufferedRegion().GetSize();
+
+  std::ostringstream fields;
+  fields << "TransformMatrix = 1 0 0 0 1 0 0 0 1\n";
+  fields << "Offset = " << image->GetOrigin()[0] << " " << image->GetOrigin()[1] << " " << image->GetOrigin()[2] << "\n";
+  fields << "ElementSpacing = " << image->GetSpacing()[0] << " " << image->GetSpacing()[1] << " " << image->GetSpacing()[2] << "\n";
+  fields << "DimSize = " << size[0] << " " << size[1] << " " << size[2] << "\n";
+  fields << "ElementType = MET_SHORT\n";
+  fields << "ElementDataFile = LOCAL\n";
+
+  std::string header = "ObjectType = Image\nNDims = 3\nBinaryData = True\nBinaryDataByteOrderMSB = ";
+  header += itk::ByteSwapper< int >::SystemIsBigEndian() ? "True\n" : "False\n";
+  header += "CompressedData = False\n";
+
+  std::string comment = "Comment = Padding";
+  const std::string::size_type headerLength = header.size() + comment.size() + 1 + fields.str().size();
+  if( ( headerLength % sizeof( ImageType::PixelType ) == 0 ) != aligned )
+    {
+    comment += "X";
+    }
+
+  header += comment + "\n" + fields.str();
+
+  std::ofstream os( fileName.c_str(), std::ios::out | std::ios::binary );
+  os.write( header.c_str(), header.size() );
+  os.write( reinterpret_cast< const char * >( image->GetBufferPointer() ),
+            image->GetBufferedRegion().GetNumberOfPixels() * sizeof( ImageType::PixelType ) );
+
+  return !os.fail();
+}
+
+unsigned long CountDifferences( const ImageType * image, const ImageType * reference )
+{
+  itk::ImageRegionConstIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+
+  unsigned long numberOfDifferences = 0;
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    if( itr.Get() != reference->GetPixel( itr.GetIndex() ) )
+      {
+      ++numberOfDifferences;
+      }
+    }
+
+  return numberOfDifferences;
+}
+
+}
+
+int itkMemoryMappedMetaImageReaderTest1( int argc, char * argv [] )
+{
+
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\toutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileWriter< ImageType >                WriterType;
+  typedef itk::MemoryMappedMetaImageReader< ImageType >    ReaderType;
+
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  size[2] = 40;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 0.7;
+  spacing[2] = 1.25;
+
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = -20.0;
+  origin[2] = 30.0;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    const ImageType::IndexType & index = itr.GetIndex();
+    itr.Set( static_cast< signed short >( index[0] + 64 * index[1] - 50 * index[2] - 1024 ) );
+    }
+
+  const std::string directory = argv[1];
+
+#if defined(_WIN32)
+  const bool filesCanBeMapped = false;
+#else
+  const bool filesCanBeMapped = true;
+#endif
+
+  const char * fileNames[3] = {
+    "MemoryMappedMetaImageReaderTest1.mhd",
+    "MemoryMappedMetaImageReaderTest1.mha",
+    "MemoryMappedMetaImageReaderTest1Compressed.mha" };
+
+  ImageType::RegionType roi;
+  roi.SetIndex( 0, 10 );
+  roi.SetIndex( 1, 5 );
+  roi.SetIndex( 2, 20 );
+  roi.SetSize( 0, 20 );
+  roi.SetSize( 1, 30 );
+  roi.SetSize( 2, 12 );
+
+  for( unsigned int f = 0; f < 3; f++ )
+    {
+    const std::string fileName = directory + "/" + fileNames[f];
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( fileName );
+    writer->SetInput( image );
+    writer->SetUseCompression( f == 2 );
+
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName );
+
+    typedef itk::RegionOfInterestImageFilter< ImageType, ImageType > ROIFilterType;
+    ROIFilterType::Pointer roiFilter = ROIFilterType::New();
+    roiFilter->SetInput( reader->GetOutput() );
+    roiFilter->SetRegionOfInterest( roi );
+
+    try
+      {
+      writer->Update();
+      reader->Update();
+      roiFilter->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << fileNames[f] << " memory mapped: " << reader->GetIsMemoryMapped() << std::endl;
+
+    if( ( f == 0 && reader->GetIsMemoryMapped() != filesCanBeMapped ) ||
+        ( f == 2 && reader->GetIsMemoryMapped() ) )
+      {
+      std::cerr << "The pixels of " << fileNames[f] << " should";
+      std::cerr << ( f == 0 && filesCanBeMapped ? "" : " not" ) << " be mapped" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const ImageType * output = reader->GetOutput();
+
+    if( output->GetBufferedRegion() != image->GetBufferedRegion() ||
+        output->GetSpacing() != image->GetSpacing() ||
+        output->GetOrigin() != image->GetOrigin() )
+      {
+      std::cerr << "The geometry of " << fileNames[f] << " differs from the volume written" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    unsigned long numberOfDifferences = CountDifferences( output, image );
+
+    if( numberOfDifferences > 0 )
+      {
+      std::cerr << numberOfDifferences << " pixels of " << fileNames[f];
+      std::cerr << " differ from the volume written" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // The cropped image starts at the index 0
+    ImageType::Pointer cropped = roiFilter->GetOutput();
+    cropped->DisconnectPipeline();
+
+    ImageType::RegionType croppedRegion = roi;
+    croppedRegion.SetIndex( cropped->GetBufferedRegion().GetIndex() );
+
+    itk::ImageRegionConstIteratorWithIndex< ImageType > ctr( cropped, croppedRegion );
+    itk::ImageRegionConstIteratorWithIndex< ImageType > rtr( image, roi );
+
+    for( ctr.GoToBegin(), rtr.GoToBegin(); !ctr.IsAtEnd(); ++ctr, ++rtr )
+      {
+      if( ctr.Get() != rtr.Get() )
+        {
+        ++numberOfDifferences;
+        }
+      }
+
+    if( numberOfDifferences > 0 )
+      {
+      std::cerr << numberOfDifferences << " pixels of the region of interest of " << fileNames[f];
+      std::cerr << " differ from the volume written" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if( f == 0 )
+      {
+      reader->Print( std::cout );
+      }
+    }
+
+  //
+  // Single files whose header length is, or is not, a multiple of the pixel size
+  //
+  for( unsigned int a = 0; a < 2; a++ )
+    {
+    const bool aligned = ( a == 0 );
+
+    const std::string fileName = directory + "/MemoryMappedMetaImageReaderTest1" +
+      ( aligned ? "Aligned.mha" : "Unaligned.mha" );
+
+    if( !WriteMetaImage( fileName, image, aligned ) )
+      {
+      std::cerr << "Could not write " << fileName << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName );
+
+    try
+      {
+      reader->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << fileName << " memory mapped: " << reader->GetIsMemoryMapped() << std::endl;
+
+    if( reader->GetIsMemoryMapped() != ( aligned && filesCanBeMapped ) )
+      {
+      std::cerr << "The pixels of " << fileName << " should";
+      std::cerr << ( aligned && filesCanBeMapped ? "" : " not" ) << " be mapped" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const unsigned long numberOfDifferences = CountDifferences( reader->GetOutput(), image );
+
+    if( numberOfDifferences > 0 )
+      {
+      std::cerr << numberOfDifferences << " pixels of " << fileName;
+      std::cerr << " differ from the volume written" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
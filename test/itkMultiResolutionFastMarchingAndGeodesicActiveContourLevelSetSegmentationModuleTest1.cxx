@@ -0,0 +1,254 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModuleTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The test runs the fast marching and geodesic active contour segmentation
+// at full resolution, and then the coarse to fine version of it, both from
+// the same seed points and features. The timings are reported and the
+// segmented volumes are required to agree within a tolerance.
+
+#include "itkLesionSegmentationMethod.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+#include "itkImageMaskSpatialObject.h"
+#include "itkLungWallFeatureGenerator.h"
+#include "itkSatoVesselnessSigmoidFeatureGenerator.h"
+#include "itkGradientMagnitudeSigmoidFeatureGenerator.h"
+#include "itkSigmoidFeatureGenerator.h"
+#include "itkFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkMinimumFeatureAggregator.h"
+#include "itkTimeProbe.h"
+
+int itkMultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModuleTest1( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tinputImage\n\toutputImage ";
+    std::cerr << "\n\t[numberOfLevels]"
+              << "\n\t[refinementIterations]"
+              << "\n\t[volumeTolerance]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  const unsigned int Dimension = 3;
+  typedef signed short   InputPixelType;
+
+  typedef itk::Image< InputPixelType, Dimension > InputImageType;
+
+  typedef itk::ImageFileReader< InputImageType > InputImageReaderType;
+  InputImageReaderType::Pointer inputImageReader = InputImageReaderType::New();
+
+  inputImageReader->SetFileName( argv[2] );
+
+  try
+    {
+    inputImageReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfLevels = ( argc > 4 ) ? atoi( argv[4] ) : 3;
+  const unsigned int refinementIterations = ( argc > 5 ) ? atoi( argv[5] ) : 20;
+  const double volumeTolerance = ( argc > 6 ) ? atof( argv[6] ) : 0.1;
+
+  typedef itk::LesionSegmentationMethod< Dimension >   MethodType;
+
+  MethodType::Pointer  lesionSegmentationMethod = MethodType::New();
+
+  typedef itk::ImageMaskSpatialObject< Dimension > ImageMaskSpatialObjectType;
+
+  ImageMaskSpatialObjectType::Pointer regionOfInterest = ImageMaskSpatialObjectType::New();
+
+  lesionSegmentationMethod->SetRegionOfInterest( regionOfInterest );
+
+  typedef itk::SatoVesselnessSigmoidFeatureGenerator< Dimension > VesselnessGeneratorType;
+  VesselnessGeneratorType::Pointer vesselnessGenerator = VesselnessGeneratorType::New();
+
+  typedef itk::LungWallFeatureGenerator< Dimension > LungWallGeneratorType;
+  LungWallGeneratorType::Pointer lungWallGenerator = LungWallGeneratorType::New();
+
+  typedef itk::SigmoidFeatureGenerator< Dimension >   SigmoidFeatureGeneratorType;
+  SigmoidFeatureGeneratorType::Pointer  sigmoidGenerator = SigmoidFeatureGeneratorType::New();
+
+  typedef itk::GradientMagnitudeSigmoidFeatureGenerator< Dimension >   GradientMagnitudeSigmoidFeatureGeneratorType;
+  GradientMagnitudeSigmoidFeatureGeneratorType::Pointer  gradientMagnitudeSigmoidGenerator =
+    GradientMagnitudeSigmoidFeatureGeneratorType::New();
+
+  typedef itk::MinimumFeatureAggregator< Dimension >   FeatureAggregatorType;
+  FeatureAggregatorType::Pointer featureAggregator = FeatureAggregatorType::New();
+  featureAggregator->AddFeatureGenerator( lungWallGenerator );
+  featureAggregator->AddFeatureGenerator( vesselnessGenerator );
+  featureAggregator->AddFeatureGenerator( sigmoidGenerator );
+  featureAggregator->AddFeatureGenerator( gradientMagnitudeSigmoidGenerator );
+  lesionSegmentationMethod->AddFeatureGenerator( featureAggregator );
+
+  typedef itk::ImageSpatialObject< Dimension, InputPixelType  > InputImageSpatialObjectType;
+  InputImageSpatialObjectType::Pointer inputObject = InputImageSpatialObjectType::New();
+
+  InputImageType::Pointer inputImage = inputImageReader->GetOutput();
+
+  inputImage->DisconnectPipeline();
+
+  inputObject->SetImage( inputImage );
+
+  lungWallGenerator->SetInput( inputObject );
+  vesselnessGenerator->SetInput( inputObject );
+  sigmoidGenerator->SetInput( inputObject );
+  gradientMagnitudeSigmoidGenerator->SetInput( inputObject );
+  lungWallGenerator->SetLungThreshold( -400 );
+  vesselnessGenerator->SetSigma( 1.0 );
+  vesselnessGenerator->SetAlpha1( 0.5 );
+  vesselnessGenerator->SetAlpha2( 2.0 );
+  vesselnessGenerator->SetSigmoidAlpha( -10.0 );
+  vesselnessGenerator->SetSigmoidBeta( 80.0 );
+  sigmoidGenerator->SetAlpha(  1.0  );
+  sigmoidGenerator->SetBeta( -200.0 );
+  gradientMagnitudeSigmoidGenerator->SetSigma( 1.0 );
+  gradientMagnitudeSigmoidGenerator->SetAlpha( -100.0 );
+  gradientMagnitudeSigmoidGenerator->SetBeta( 300 );
+
+  typedef itk::FastMarchingAndGeodesicActiveContourLevelSetSegmentationModule< Dimension >
+    SingleResolutionModuleType;
+  typedef itk::MultiResolutionFastMarchingAndGeodesicActiveContourLevelSetSegmentationModule< Dimension >
+    MultiResolutionModuleType;
+
+  SingleResolutionModuleType::Pointer singleResolutionModule = SingleResolutionModuleType::New();
+  singleResolutionModule->SetMaximumRMSError( 0.0002 );
+  singleResolutionModule->SetMaximumNumberOfIterations( 300 );
+  singleResolutionModule->SetCurvatureScaling( 1.0 );
+  singleResolutionModule->SetPropagationScaling( 500.0 );
+  singleResolutionModule->SetAdvectionScaling( 0.0 );
+  singleResolutionModule->SetStoppingValue( 5.0 );
+  singleResolutionModule->SetDistanceFromSeeds( 2.0 );
+
+  MultiResolutionModuleType::Pointer multiResolutionModule = MultiResolutionModuleType::New();
+  multiResolutionModule->SetMaximumRMSError( 0.0002 );
+  multiResolutionModule->SetMaximumNumberOfIterations( 300 );
+  multiResolutionModule->SetCurvatureScaling( 1.0 );
+  multiResolutionModule->SetPropagationScaling( 500.0 );
+  multiResolutionModule->SetAdvectionScaling( 0.0 );
+  multiResolutionModule->SetStoppingValue( 5.0 );
+  multiResolutionModule->SetDistanceFromSeeds( 2.0 );
+  multiResolutionModule->SetNumberOfLevels( numberOfLevels );
+  multiResolutionModule->SetRefinementIterations( refinementIterations );
+
+  typedef itk::LandmarksReader< Dimension >    LandmarksReaderType;
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+
+  lesionSegmentationMethod->SetInitialSegmentation( landmarksReader->GetOutput() );
+
+  typedef MultiResolutionModuleType::SpatialObjectType           SpatialObjectType;
+  typedef MultiResolutionModuleType::OutputSpatialObjectType     OutputSpatialObjectType;
+  typedef MultiResolutionModuleType::OutputImageType             OutputImageType;
+
+  MethodType::SegmentationModuleType * modules[2];
+  modules[0] = singleResolutionModule;
+  modules[1] = multiResolutionModule;
+
+  const char * names[2] = { "single resolution", "multiresolution" };
+
+  unsigned long volume[2];
+  OutputImageType::ConstPointer outputImage;
+
+  for( unsigned int run = 0; run < 2; run++ )
+    {
+    lesionSegmentationMethod->SetSegmentationModule( modules[run] );
+
+    // The features are computed by the first run only.
+    itk::TimeProbe probe;
+
+    try
+      {
+      probe.Start();
+      lesionSegmentationMethod->Update();
+      probe.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    SpatialObjectType::ConstPointer segmentation = modules[run]->GetOutput();
+
+    OutputSpatialObjectType::ConstPointer outputObject =
+      dynamic_cast< const OutputSpatialObjectType * >( segmentation.GetPointer() );
+
+    outputImage = outputObject->GetImage();
+
+    volume[run] = 0;
+
+    itk::ImageRegionConstIterator< OutputImageType >
+      itr( outputImage, outputImage->GetBufferedRegion() );
+
+    // Output intensities are inverted, the inside is positive.
+    for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+      {
+      if( itr.Get() > 0.0 )
+        {
+        ++volume[run];
+        }
+      }
+
+    std::cout << names[run] << " : " << probe.GetMean() << " s, ";
+    std::cout << volume[run] << " pixels" << std::endl;
+    }
+
+  typedef itk::ImageFileWriter< OutputImageType >      OutputWriterType;
+  OutputWriterType::Pointer writer = OutputWriterType::New();
+  writer->SetFileName( argv[3] );
+  writer->SetInput( outputImage );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double reference = ( volume[0] > 0 ) ? static_cast< double >( volume[0] ) : 1.0;
+  const double volumeDifference =
+    vnl_math_abs( static_cast< double >( volume[1] ) - static_cast< double >( volume[0] ) ) / reference;
+
+  std::cout << "Relative volume difference " << volumeDifference << std::endl;
+
+  if( volumeDifference > volumeTolerance )
+    {
+    std::cerr << "The multiresolution segmentation differs in volume by more than ";
+    std::cerr << volumeTolerance << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  multiResolutionModule->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
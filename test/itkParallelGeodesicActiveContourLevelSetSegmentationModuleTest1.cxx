@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkParallelGeodesicActiveContourLevelSetSegmentationModuleTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Thread scaling of the parallel geodesic active contour module. The serial
+// module is run once as reference, then the parallel module is run with an
+// increasing number of threads. The timings are reported and the fraction
+// of voxels classified differently from the serial segmentation is required
+// to stay below a tolerance.
+
+#include "itkGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkParallelGeodesicActiveContourLevelSetSegmentationModule.h"
+#include "itkImage.h"
+#include "itkSpatialObject.h"
+#include "itkImageSpatialObject.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMultiThreader.h"
+#include "itkTimeProbe.h"
+
+int itkParallelGeodesicActiveContourLevelSetSegmentationModuleTest1( int argc, char * argv [] )
+{
+
+  if( argc < 4 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << " inputImage featureImage outputImage [maximumNumberOfThreads tolerance]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  const unsigned int Dimension = 3;
+
+  typedef itk::GeodesicActiveContourLevelSetSegmentationModule< Dimension >          SerialModuleType;
+  typedef itk::ParallelGeodesicActiveContourLevelSetSegmentationModule< Dimension >  ParallelModuleType;
+
+  typedef ParallelModuleType::InputImageType       InputImageType;
+  typedef ParallelModuleType::FeatureImageType     FeatureImageType;
+  typedef ParallelModuleType::OutputImageType      OutputImageType;
+
+  typedef itk::ImageFileReader< InputImageType >       InputReaderType;
+  typedef itk::ImageFileReader< FeatureImageType >     FeatureReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >      WriterType;
+
+  InputReaderType::Pointer inputReader = InputReaderType::New();
+  FeatureReaderType::Pointer featureReader = FeatureReaderType::New();
+
+  inputReader->SetFileName( argv[1] );
+  featureReader->SetFileName( argv[2] );
+
+  try
+    {
+    inputReader->Update();
+    featureReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned int maximumNumberOfThreads =
+    itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  double tolerance = 0.05;
+
+  if( argc > 4 )
+    {
+    maximumNumberOfThreads = atoi( argv[4] );
+    }
+
+  if( argc > 5 )
+    {
+    tolerance = atof( argv[5] );
+    }
+
+  typedef ParallelModuleType::InputSpatialObjectType          InputSpatialObjectType;
+  typedef ParallelModuleType::FeatureSpatialObjectType        FeatureSpatialObjectType;
+  typedef ParallelModuleType::OutputSpatialObjectType         OutputSpatialObjectType;
+
+  InputSpatialObjectType::Pointer inputObject = InputSpatialObjectType::New();
+  FeatureSpatialObjectType::Pointer featureObject = FeatureSpatialObjectType::New();
+
+  inputObject->SetImage( inputReader->GetOutput() );
+  featureObject->SetImage( featureReader->GetOutput() );
+
+  SerialModuleType::Pointer serialModule = SerialModuleType::New();
+  serialModule->SetInput( inputObject );
+  serialModule->SetFeature( featureObject );
+  serialModule->InvertOutputIntensitiesOff();
+
+  itk::TimeProbe serialProbe;
+
+  try
+    {
+    serialProbe.Start();
+    serialModule->Update();
+    serialProbe.Stop();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  OutputImageType::ConstPointer reference =
+    dynamic_cast< const OutputSpatialObjectType * >( serialModule->GetOutput() )->GetImage();
+
+  std::cout << "Threads  Time (s)  Differences" << std::endl;
+  std::cout << "serial  " << serialProbe.GetMean() << std::endl;
+
+  OutputImageType::ConstPointer output;
+
+  for( unsigned int numberOfThreads = 1;
+       numberOfThreads <= maximumNumberOfThreads; numberOfThreads++ )
+    {
+    ParallelModuleType::Pointer parallelModule = ParallelModuleType::New();
+    parallelModule->SetInput( inputObject );
+    parallelModule->SetFeature( featureObject );
+    parallelModule->InvertOutputIntensitiesOff();
+    parallelModule->SetNumberOfThreads( numberOfThreads );
+
+    itk::TimeProbe probe;
+
+    try
+      {
+      probe.Start();
+      parallelModule->Update();
+      probe.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    output = dynamic_cast< const OutputSpatialObjectType * >( parallelModule->GetOutput() )->GetImage();
+
+    itk::ImageRegionConstIterator< OutputImageType > rit( reference, reference->GetBufferedRegion() );
+    itk::ImageRegionConstIterator< OutputImageType > oit( output, output->GetBufferedRegion() );
+
+    unsigned long numberOfInsideVoxels = 0;
+    unsigned long numberOfDifferences = 0;
+
+    for( rit.GoToBegin(), oit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++oit )
+      {
+      const bool insideReference = ( rit.Get() < 0.0 );
+      const bool insideOutput = ( oit.Get() < 0.0 );
+      if( insideReference )
+        {
+        ++numberOfInsideVoxels;
+        }
+      if( insideReference != insideOutput )
+        {
+        ++numberOfDifferences;
+        }
+      }
+
+    const double fraction = ( numberOfInsideVoxels > 0 ) ?
+      static_cast< double >( numberOfDifferences ) / numberOfInsideVoxels : 0.0;
+
+    std::cout << numberOfThreads << "  " << probe.GetMean() << "  " << fraction << std::endl;
+
+    if( fraction > tolerance )
+      {
+      std::cerr << "Segmentation with " << numberOfThreads << " threads differs ";
+      std::cerr << "from the serial one in " << numberOfDifferences << " voxels, ";
+      std::cerr << numberOfInsideVoxels << " voxels inside" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+
+  writer->SetFileName( argv[3] );
+  writer->SetInput( output );
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Class name = " << ParallelModuleType::New()->GetNameOfClass() << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkRunLengthSegmentationTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// A level set with two plateaus and a narrow transition region, like those of
+// the segmentation modules, is written as a float MetaImage and as a
+// run-length segmentation: with all its band values, with a narrower band and
+// as a binary mask. The volume estimated from the files read back must match
+// the volume estimated from the image, and the complete band must decode to
+// the image written.
+
+#include "itkRunLengthSegmentationFileWriter.h"
+#include "itkRunLengthSegmentationFileReader.h"
+#include "itkGrayscaleImageSegmentationVolumeEstimator.h"
+#include "itkImageSpatialObject.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itksys/SystemTools.hxx"
+
+int itkRunLengthSegmentationTest1( int argc, char * argv [] )
+{
+
+  if( argc < 2 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\toutputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 3;
+
+  typedef itk::GrayscaleImageSegmentationVolumeEstimator<Dimension>  VolumeEstimatorType;
+  typedef VolumeEstimatorType::InputImageType                        ImageType;
+  typedef VolumeEstimatorType::InputImageSpatialObjectType           ImageSpatialObjectType;
+  typedef itk::RunLengthSegmentationFileWriter< Dimension >          WriterType;
+  typedef itk::RunLengthSegmentationFileReader< Dimension >          ReaderType;
+  typedef ReaderType::SegmentationType                               SegmentationType;
+
+  ImageType::SizeType size;
+  size[0] = 96;
+  size[1] = 96;
+  size[2] = 64;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.6;
+  spacing[1] = 0.6;
+  spacing[2] = 1.0;
+
+  ImageType::PointType origin;
+  origin[0] = -12.0;
+  origin[1] = 7.5;
+  origin[2] = 100.0;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->Allocate();
+
+  //
+  // Sphere whose level set is positive inside, clamped to plateaus at +/-4
+  //
+  ImageType::PointType center;
+  center[0] = origin[0] + 45.0 * spacing[0];
+  center[1] = origin[1] + 50.0 * spacing[1];
+  center[2] = origin[2] + 30.0 * spacing[2];
+
+  const double radius = 12.0;
+
+  itk::ImageRegionIteratorWithIndex< ImageType > itr( image, image->GetBufferedRegion() );
+
+  for( itr.GoToBegin(); !itr.IsAtEnd(); ++itr )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint( itr.GetIndex(), point );
+
+    double value = ( radius - point.EuclideanDistanceTo( center ) ) / spacing[0];
+    value = value > 4.0 ? 4.0 : ( value < -4.0 ? -4.0 : value );
+
+    itr.Set( static_cast< float >( value ) );
+    }
+
+  ImageSpatialObjectType::Pointer imageSpatialObject = ImageSpatialObjectType::New();
+  imageSpatialObject->SetImage( image );
+
+  VolumeEstimatorType::Pointer volumeEstimator = VolumeEstimatorType::New();
+  volumeEstimator->SetInput( imageSpatialObject );
+  volumeEstimator->Update();
+
+  const double imageVolume = volumeEstimator->GetVolume();
+
+  const std::string directory = argv[1];
+  const std::string imageFileName = directory + "/RunLengthSegmentationTest1.mha";
+
+  typedef itk::ImageFileWriter< ImageType > ImageWriterType;
+  ImageWriterType::Pointer imageWriter = ImageWriterType::New();
+  imageWriter->SetFileName( imageFileName );
+  imageWriter->SetInput( image );
+
+  try
+    {
+    imageWriter->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned long imageFileLength =
+    itksys::SystemTools::FileLength( imageFileName.c_str() );
+
+  //
+  // Complete band, narrower band and binary mask
+  //
+  const char * fileNames[3] = {
+    "RunLengthSegmentationTest1.rle",
+    "RunLengthSegmentationTest1Band.rle",
+    "RunLengthSegmentationTest1Mask.rle" };
+
+  for( unsigned int f = 0; f < 3; f++ )
+    {
+    const std::string fileName = directory + "/" + fileNames[f];
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( fileName );
+    writer->SetInput( image );
+    if( f == 1 )
+      {
+      writer->SetNarrowBandWidth( 2.0 );
+      }
+    if( f == 2 )
+      {
+      writer->UseNarrowBandOff();
+      }
+
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( fileName );
+
+    try
+      {
+      writer->Update();
+      reader->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const SegmentationType * segmentation = reader->GetOutput();
+
+    const unsigned long fileLength = itksys::SystemTools::FileLength( fileName.c_str() );
+
+    std::cout << fileNames[f] << ": " << segmentation->GetRuns().size() << " runs, ";
+    std::cout << segmentation->GetBandValues().size() << " band values, ";
+    std::cout << fileLength << " bytes for " << imageFileLength << std::endl;
+
+    if( fileLength * 10 > imageFileLength )
+      {
+      std::cerr << fileNames[f] << " is not ten times smaller than the image" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if( segmentation->GetRegion() != image->GetBufferedRegion() ||
+        segmentation->GetSpacing() != image->GetSpacing() ||
+        segmentation->GetOrigin() != image->GetOrigin() )
+      {
+      std::cerr << "The geometry of " << fileNames[f] << " differs from the image written" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    VolumeEstimatorType::Pointer segmentationVolumeEstimator = VolumeEstimatorType::New();
+    segmentationVolumeEstimator->SetInput( segmentation );
+    segmentationVolumeEstimator->Update();
+
+    const double volume = segmentationVolumeEstimator->GetVolume();
+
+    std::cout << "  volume " << volume << " for " << imageVolume << std::endl;
+
+    // The volume computed from the runs is the volume of the decoded image
+    ImageType::Pointer decodedImage = segmentation->DecodeImage();
+
+    ImageSpatialObjectType::Pointer decodedSpatialObject = ImageSpatialObjectType::New();
+    decodedSpatialObject->SetImage( decodedImage );
+
+    VolumeEstimatorType::Pointer decodedVolumeEstimator = VolumeEstimatorType::New();
+    decodedVolumeEstimator->SetInput( decodedSpatialObject );
+    decodedVolumeEstimator->Update();
+
+    const double decodedVolume = decodedVolumeEstimator->GetVolume();
+
+    if( vnl_math_abs( volume - decodedVolume ) > 1e-6 * decodedVolume )
+      {
+      std::cerr << "The volume of " << fileNames[f] << " differs from the volume of its image ";
+      std::cerr << decodedVolume << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::ImageRegionConstIterator< ImageType > dtr( decodedImage, decodedImage->GetBufferedRegion() );
+    itk::ImageRegionConstIterator< ImageType > rtr( image, image->GetBufferedRegion() );
+
+    unsigned long numberOfDifferences = 0;
+    unsigned long numberOfInsidePixels = 0;
+
+    for( dtr.GoToBegin(), rtr.GoToBegin(); !dtr.IsAtEnd(); ++dtr, ++rtr )
+      {
+      if( dtr.Get() != rtr.Get() )
+        {
+        ++numberOfDifferences;
+        }
+      if( rtr.Get() >= segmentation->GetIsoValue() )
+        {
+        ++numberOfInsidePixels;
+        }
+      }
+
+    // The complete band is lossless
+    if( f == 0 )
+      {
+      if( vnl_math_abs( volume - imageVolume ) > 1e-6 * imageVolume )
+        {
+        std::cerr << "The volume of " << fileNames[f] << " differs from the volume of the image" << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      if( numberOfDifferences > 0 )
+        {
+        std::cerr << numberOfDifferences << " pixels decoded from " << fileNames[f];
+        std::cerr << " differ from the image written" << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      segmentation->Print( std::cout );
+      }
+
+    // The mask holds the pixels inside the iso value
+    const double pixelVolume = spacing[0] * spacing[1] * spacing[2];
+
+    if( f == 2 && vnl_math_abs( volume - numberOfInsidePixels * pixelVolume ) > 1e-6 * volume )
+      {
+      std::cerr << "The volume of " << fileNames[f] << " is not the volume of the ";
+      std::cerr << numberOfInsidePixels << " pixels inside the iso value" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  //
+  // A file that is not a run-length segmentation must be rejected
+  //
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( imageFileName );
+
+  try
+    {
+    reader->Update();
+    std::cerr << "Failed to catch expected exception" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cout << "Caught expected exception" << std::endl;
+    std::cout << excp << std::endl;
+    }
+
+  return EXIT_SUCCESS;
+}
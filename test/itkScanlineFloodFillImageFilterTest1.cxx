@@ -0,0 +1,274 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkScanlineFloodFillImageFilterTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// The scanline flood fill is run against ConnectedThresholdImageFilter and
+// ConfidenceConnectedImageFilter on the same image and seeds, with one
+// thread and with the default number of threads. The timings are reported.
+// The thresholded regions must be identical. The confidence regions may only
+// differ by the rounding of the running statistics, on a small fraction of
+// the pixels.
+
+#include "itkScanlineFloodFillImageFilter.h"
+#include "itkConnectedThresholdImageFilter.h"
+#include "itkConfidenceConnectedImageFilter.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandmarksReader.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+
+typedef itk::Image< float, 3 >            ImageType;
+typedef itk::Image< unsigned char, 3 >    MaskImageType;
+
+void CountPixels( const MaskImageType * image1, const MaskImageType * image2,
+  unsigned long & numberOfPixels, unsigned long & numberOfDifferences )
+{
+  typedef itk::ImageRegionConstIterator< MaskImageType > IteratorType;
+
+  IteratorType itr1( image1, image1->GetBufferedRegion() );
+  IteratorType itr2( image2, image2->GetBufferedRegion() );
+
+  numberOfPixels = 0;
+  numberOfDifferences = 0;
+
+  for( itr1.GoToBegin(), itr2.GoToBegin(); !itr1.IsAtEnd(); ++itr1, ++itr2 )
+    {
+    if( itr1.Get() )
+      {
+      ++numberOfPixels;
+      }
+    if( itr1.Get() != itr2.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    }
+}
+
+}
+
+int itkScanlineFloodFillImageFilterTest1( int argc, char * argv [] )
+{
+
+  if( argc < 6 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << "\n\tlandmarksFile\n\tinputImage\n\toutputImage ";
+    std::cerr << "\n\tlower threshold\n\tupper threshold";
+    std::cerr << "\n\t[sigma multiplier]";
+    std::cerr << "\n\t[fraction of differing pixels in the confidence regions]";
+    std::cerr << "\n\t[number of repetitions]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader< ImageType >         ReaderType;
+  typedef itk::ImageFileWriter< MaskImageType >     WriterType;
+  typedef itk::LandmarksReader< 3 >                 LandmarksReaderType;
+
+  LandmarksReaderType::Pointer landmarksReader = LandmarksReaderType::New();
+  landmarksReader->SetFileName( argv[1] );
+  landmarksReader->Update();
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[2] );
+
+  try
+    {
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double lower = atof( argv[4] );
+  const double upper = atof( argv[5] );
+  const double multiplier = (argc > 6) ? atof( argv[6] ) : 1.7;
+  const double tolerance = (argc > 7) ? atof( argv[7] ) : 0.001;
+  const unsigned int numberOfRepetitions = (argc > 8) ? atoi( argv[8] ) : 3;
+
+  ImageType::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+
+  typedef itk::ScanlineFloodFillImageFilter< ImageType, MaskImageType >       ScanlineFilterType;
+  typedef itk::ConnectedThresholdImageFilter< ImageType, MaskImageType >      ThresholdFilterType;
+  typedef itk::ConfidenceConnectedImageFilter< ImageType, MaskImageType >     ConfidenceFilterType;
+
+  ScanlineFilterType::Pointer scanlineFilter = ScanlineFilterType::New();
+  ScanlineFilterType::Pointer singleThreadFilter = ScanlineFilterType::New();
+  ThresholdFilterType::Pointer thresholdFilter = ThresholdFilterType::New();
+  ConfidenceFilterType::Pointer confidenceFilter = ConfidenceFilterType::New();
+
+  scanlineFilter->SetInput( image );
+  singleThreadFilter->SetInput( image );
+  singleThreadFilter->SetNumberOfThreads( 1 );
+  thresholdFilter->SetInput( image );
+  confidenceFilter->SetInput( image );
+
+  const LandmarksReaderType::SpatialObjectType * landmarks = landmarksReader->GetOutput();
+
+  for( unsigned int i = 0; i < landmarks->GetNumberOfPoints(); i++ )
+    {
+    ImageType::IndexType index;
+    image->TransformPhysicalPointToIndex( landmarks->GetPoints()[i].GetPosition(), index );
+    scanlineFilter->AddSeed( index );
+    singleThreadFilter->AddSeed( index );
+    thresholdFilter->AddSeed( index );
+    confidenceFilter->AddSeed( index );
+    }
+
+  //
+  // Thresholded region.
+  //
+  scanlineFilter->SetLower( lower );
+  scanlineFilter->SetUpper( upper );
+  singleThreadFilter->SetLower( lower );
+  singleThreadFilter->SetUpper( upper );
+  thresholdFilter->SetLower( lower );
+  thresholdFilter->SetUpper( upper );
+
+  itk::TimeProbe thresholdProbe;
+  itk::TimeProbe singleThreadProbe;
+  itk::TimeProbe scanlineProbe;
+
+  try
+    {
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      thresholdFilter->Modified();
+      thresholdProbe.Start();
+      thresholdFilter->Update();
+      thresholdProbe.Stop();
+
+      singleThreadFilter->Modified();
+      singleThreadProbe.Start();
+      singleThreadFilter->Update();
+      singleThreadProbe.Stop();
+
+      scanlineFilter->Modified();
+      scanlineProbe.Start();
+      scanlineFilter->Update();
+      scanlineProbe.Stop();
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "ConnectedThresholdImageFilter   : " << thresholdProbe.GetMean() << " s" << std::endl;
+  std::cout << "Scanline fill, one thread       : " << singleThreadProbe.GetMean() << " s" << std::endl;
+  std::cout << "Scanline fill, " << scanlineFilter->GetNumberOfThreads() << " threads      : ";
+  std::cout << scanlineProbe.GetMean() << " s, " << scanlineFilter->GetNumberOfRounds() << " rounds" << std::endl;
+
+  unsigned long numberOfPixels;
+  unsigned long numberOfDifferences;
+
+  CountPixels( thresholdFilter->GetOutput(), scanlineFilter->GetOutput(), numberOfPixels, numberOfDifferences );
+
+  std::cout << "Thresholded region : " << numberOfPixels << " pixels, ";
+  std::cout << numberOfDifferences << " differences" << std::endl;
+
+  if( numberOfPixels == 0 || numberOfDifferences > 0 ||
+      scanlineFilter->GetNumberOfPixelsInRegion() != numberOfPixels )
+    {
+    std::cerr << "The scanline fill differs from ConnectedThresholdImageFilter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  CountPixels( thresholdFilter->GetOutput(), singleThreadFilter->GetOutput(), numberOfPixels, numberOfDifferences );
+
+  if( numberOfDifferences > 0 )
+    {
+    std::cerr << "The scanline fill with one thread differs from ConnectedThresholdImageFilter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Confidence region, with the settings of the confidence connected module.
+  //
+  scanlineFilter->UseConfidenceThresholdsOn();
+  scanlineFilter->SetMultiplier( multiplier );
+  scanlineFilter->SetNumberOfIterations( 5 );
+  scanlineFilter->SetInitialNeighborhoodRadius( 2 );
+
+  confidenceFilter->SetMultiplier( multiplier );
+  confidenceFilter->SetNumberOfIterations( 5 );
+  confidenceFilter->SetInitialNeighborhoodRadius( 2 );
+
+  itk::TimeProbe confidenceProbe;
+  itk::TimeProbe scanlineConfidenceProbe;
+
+  try
+    {
+    for( unsigned int r = 0; r < numberOfRepetitions; r++ )
+      {
+      confidenceFilter->Modified();
+      confidenceProbe.Start();
+      confidenceFilter->Update();
+      confidenceProbe.Stop();
+
+      scanlineFilter->Modified();
+      scanlineConfidenceProbe.Start();
+      scanlineFilter->Update();
+      scanlineConfidenceProbe.Stop();
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "ConfidenceConnectedImageFilter  : " << confidenceProbe.GetMean() << " s" << std::endl;
+  std::cout << "Scanline fill, confidence       : " << scanlineConfidenceProbe.GetMean() << " s" << std::endl;
+  std::cout << "Mean " << scanlineFilter->GetMean() << " (" << confidenceFilter->GetMean() << "), ";
+  std::cout << "variance " << scanlineFilter->GetVariance() << " (" << confidenceFilter->GetVariance() << ")" << std::endl;
+
+  CountPixels( confidenceFilter->GetOutput(), scanlineFilter->GetOutput(), numberOfPixels, numberOfDifferences );
+
+  std::cout << "Confidence region : " << numberOfPixels << " pixels, ";
+  std::cout << numberOfDifferences << " differences" << std::endl;
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[3] );
+  writer->SetInput( scanlineFilter->GetOutput() );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( numberOfPixels == 0 || numberOfDifferences > tolerance * numberOfPixels )
+    {
+    std::cerr << "The scanline fill differs from ConfidenceConnectedImageFilter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scanlineFilter->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkVesselEnhancingDiffusion3DImageFilterTest1.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Thread scaling of the vessel enhancing diffusion. The filter is run with
+// an increasing number of threads, the timings are reported, and the
+// outputs of all the runs are required to be identical to the output of
+// the single threaded run.
+
+#include "itkVesselEnhancingDiffusion3DImageFilter.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+#include "itkTimeProbe.h"
+
+int itkVesselEnhancingDiffusion3DImageFilterTest1( int argc, char * argv [] )
+{
+
+  if( argc < 3 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << " inputImage outputImage [maximumNumberOfThreads iterations]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::VesselEnhancingDiffusion3DImageFilter< signed short > FilterType;
+  typedef FilterType::ImageType                                      ImageType;
+  typedef itk::ImageFileReader< ImageType >                          ReaderType;
+  typedef itk::ImageFileWriter< ImageType >                          WriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  try
+    {
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned int maximumNumberOfThreads =
+    itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  unsigned int iterations = 3;
+
+  if( argc > 3 )
+    {
+    maximumNumberOfThreads = atoi( argv[3] );
+    }
+
+  if( argc > 4 )
+    {
+    iterations = atoi( argv[4] );
+    }
+
+  ImageType::SpacingType spacing = reader->GetOutput()->GetSpacing();
+  double minSpacing = itk::NumericTraits< double >::max();
+  for (unsigned int i = 0; i < ImageType::ImageDimension; i++)
+    {
+    if (minSpacing > spacing[i])
+      {
+      minSpacing = spacing[i];
+      }
+    }
+
+  std::vector< FilterType::Precision > scales(5);
+  scales[0] = 1.0    * minSpacing;
+  scales[1] = 1.6067 * minSpacing;
+  scales[2] = 2.5833 * minSpacing;
+  scales[3] = 4.15   * minSpacing;
+  scales[4] = 6.66   * minSpacing;
+
+  ImageType::Pointer reference;
+
+  std::cout << "Threads  Time (s)" << std::endl;
+
+  for( unsigned int numberOfThreads = 1;
+       numberOfThreads <= maximumNumberOfThreads; numberOfThreads++ )
+    {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( reader->GetOutput() );
+    filter->SetDefaultPars();
+    filter->SetScales( scales );
+    filter->SetIterations( iterations );
+    filter->SetRecalculateVesselness( 2 );
+    filter->SetTimeStep( 0.0 );
+    filter->SetVerbose( false );
+    filter->SetNumberOfThreads( numberOfThreads );
+
+    itk::TimeProbe probe;
+
+    try
+      {
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << numberOfThreads << "  " << probe.GetMean() << std::endl;
+
+    ImageType::Pointer output = filter->GetOutput();
+    output->DisconnectPipeline();
+
+    if( reference.IsNull() )
+      {
+      reference = output;
+      continue;
+      }
+
+    itk::ImageRegionConstIterator< ImageType > rit( reference, reference->GetBufferedRegion() );
+    itk::ImageRegionConstIterator< ImageType > oit( output, output->GetBufferedRegion() );
+
+    unsigned long numberOfDifferences = 0;
+    for( rit.GoToBegin(), oit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++oit )
+      {
+      if( rit.Get() != oit.Get() )
+        {
+        ++numberOfDifferences;
+        }
+      }
+
+    if( numberOfDifferences != 0 )
+      {
+      std::cerr << "Output with " << numberOfThreads << " threads differs from ";
+      std::cerr << "the single threaded output in " << numberOfDifferences;
+      std::cerr << " pixels" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[2] );
+  writer->SetInput( reference );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program:   Lesion Sizing Toolkit
+  Module:    itkVesselEnhancingDiffusion3DImageFilterTest3.cxx
+
+  Copyright (c) Kitware Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Compares the incremental recalculation of the vesselness and of the
+// diffusion tensor against the recalculation of the whole volume. The
+// diffusion is run twice with the same parameters, first with a zero
+// recalculation tolerance, then with a small one. The RMS difference of the
+// two outputs, relative to the RMS change the full recalculation made to the
+// input, must stay below a bound. The share of blocks recalculated and the
+// runtimes are reported.
+
+#include "itkVesselEnhancingDiffusion3DImageFilter.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkNumericTraits.h"
+#include "itkTimeProbe.h"
+
+#include <vcl_cmath.h>
+
+int itkVesselEnhancingDiffusion3DImageFilterTest3( int argc, char * argv [] )
+{
+
+  if( argc < 3 )
+    {
+    std::cerr << "Missing Arguments" << std::endl;
+    std::cerr << argv[0] << " inputImage outputImage [iterations recalculateVesselness";
+    std::cerr << " recalculationTolerance blockSize bound]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::VesselEnhancingDiffusion3DImageFilter< float >  FilterType;
+  typedef FilterType::ImageType                                ImageType;
+  typedef FilterType::Precision                                Precision;
+  typedef itk::ImageFileReader< ImageType >                    ReaderType;
+  typedef itk::ImageFileWriter< ImageType >                    WriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  try
+    {
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int iterations = (argc > 3) ? atoi( argv[3] ) : 12;
+  const unsigned int recalculateVesselness = (argc > 4) ? atoi( argv[4] ) : 2;
+  const Precision recalculationTolerance = (argc > 5) ? atof( argv[5] ) : 1.0;
+  const unsigned int blockSize = (argc > 6) ? atoi( argv[6] ) : 16;
+  const double bound = (argc > 7) ? atof( argv[7] ) : 0.05;
+
+  const ImageType::SpacingType spacing = reader->GetOutput()->GetSpacing();
+  double minSpacing = itk::NumericTraits< double >::max();
+  for (unsigned int i = 0; i < ImageType::ImageDimension; i++)
+    {
+    if (minSpacing > spacing[i])
+      {
+      minSpacing = spacing[i];
+      }
+    }
+
+  // Explicit stability bound of the filter.
+  const Precision htmax = 0.5 /
+    (  1.0 / (spacing[0] * spacing[0])
+     + 1.0 / (spacing[1] * spacing[1])
+     + 1.0 / (spacing[2] * spacing[2]) );
+
+  std::vector< Precision > scales(3);
+  scales[0] = 1.0    * minSpacing;
+  scales[1] = 1.6067 * minSpacing;
+  scales[2] = 2.5833 * minSpacing;
+
+  ImageType::Pointer diffused[2];
+  double runtime[2];
+  FilterType::Pointer incrementalFilter;
+
+  for( unsigned int run = 0; run < 2; run++ )
+    {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( reader->GetOutput() );
+    filter->SetDefaultPars();
+    filter->SetScales( scales );
+    filter->SetVerbose( false );
+    filter->SetTimeStep( htmax );
+    filter->SetIterations( iterations );
+    filter->SetRecalculateVesselness( recalculateVesselness );
+    filter->SetRecalculationBlockSize( blockSize );
+    filter->SetRecalculationTolerance( run == 0 ? 0.0 : recalculationTolerance );
+
+    itk::TimeProbe probe;
+
+    try
+      {
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    runtime[run] = probe.GetMean();
+
+    diffused[run] = filter->GetOutput();
+    diffused[run]->DisconnectPipeline();
+
+    if( run == 1 )
+      {
+      incrementalFilter = filter;
+      }
+    }
+
+  itk::ImageRegionConstIterator< ImageType >
+    iit( reader->GetOutput(), reader->GetOutput()->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType >
+    fit( diffused[0], diffused[0]->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType >
+    cit( diffused[1], diffused[1]->GetBufferedRegion() );
+
+  double sumOfSquaredDifferences = 0.0;
+  double sumOfSquaredChanges = 0.0;
+  double maximumDifference = 0.0;
+
+  for( iit.GoToBegin(), fit.GoToBegin(), cit.GoToBegin(); !iit.IsAtEnd(); ++iit, ++fit, ++cit )
+    {
+    const double difference = cit.Get() - fit.Get();
+    const double change = fit.Get() - iit.Get();
+    sumOfSquaredDifferences += difference * difference;
+    sumOfSquaredChanges += change * change;
+    if( vcl_abs( difference ) > maximumDifference )
+      {
+      maximumDifference = vcl_abs( difference );
+      }
+    }
+
+  const double relativeError = ( sumOfSquaredChanges > 0.0 ) ?
+    vcl_sqrt( sumOfSquaredDifferences / sumOfSquaredChanges ) : 0.0;
+
+  const itk::SizeValueType numberOfBlocks = incrementalFilter->GetNumberOfIncrementalBlocks();
+  const itk::SizeValueType numberOfRecalculatedBlocks = incrementalFilter->GetNumberOfRecalculatedBlocks();
+
+  std::cout << "Full recalculation        : " << runtime[0] << " s" << std::endl;
+  std::cout << "Incremental recalculation : " << runtime[1] << " s, tolerance ";
+  std::cout << recalculationTolerance << ", blocks of " << blockSize << std::endl;
+  std::cout << "Time saved                : " << runtime[0] - runtime[1] << " s (";
+  std::cout << ( runtime[0] > 0.0 ? 100.0 * ( runtime[0] - runtime[1] ) / runtime[0] : 0.0 ) << "%)" << std::endl;
+  std::cout << "Blocks recalculated       : " << numberOfRecalculatedBlocks << " / " << numberOfBlocks;
+  std::cout << " (" << ( numberOfBlocks > 0 ? 100.0 * numberOfRecalculatedBlocks / numberOfBlocks : 0.0 );
+  std::cout << "%)" << std::endl;
+  std::cout << "Maximum difference        : " << maximumDifference << std::endl;
+  std::cout << "Relative RMS difference   : " << relativeError << " (bound " << bound << ")" << std::endl;
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[2] );
+  writer->SetInput( diffused[1] );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( numberOfBlocks == 0 )
+    {
+    std::cerr << "The incremental recalculation did not run" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( relativeError > bound )
+    {
+    std::cerr << "The incremental recalculation differs from the full one by more than ";
+    std::cerr << bound << " of the change made by the diffusion" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}